@@ -1,9 +1,13 @@
 #include "mainwindow.h"
+#include "Tracer.h"
 
 #include <QApplication>
 
 int main(int argc, char *argv[])
 {
+    // DECODERSCPP_TRACE=trace.json records spans and writes them when the app exits
+    trace::start_from_environment();
+
     QApplication a(argc, argv);
     MainWindow w;
     w.show();
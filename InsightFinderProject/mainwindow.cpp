@@ -1,12 +1,23 @@
 #include "mainwindow.h"
 #include "./ui_mainwindow.h"
+#include "Attribute.h"
+#include "OutputWriter.h"
+#include "Tracer.h"
 
 #include <QFileDialog>
+#include <QFutureWatcher>
+#include <QHeaderView>
 #include <QMessageBox>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QSignalBlocker>
+#include <QStatusBar>
 #include <QTableWidgetItem>
+#include <QThreadPool>
+#include <QtConcurrent>
 
+#include <cmath>
 #include <fstream>
-#include <map>
 #include <unordered_map>
 #include <set>
 #include <algorithm>
@@ -21,108 +32,182 @@ MainWindow::MainWindow(QWidget *parent)
 {
     ui->setupUi(this);
 
-    // Attribute choices for custom insights + heatmap
-    // (labels can be whatever you like, we map them to internal keys)
-    QStringList attrs = {
-        "Primary OS",
-        "Study Time",
-        "Favorite Color",
-        "Hobby",
-        "Region",
-        "Language",
-        "Engineering Focus",
-        "Course Load",
-        "Graduation Year"
-    };
+    // Attribute choices for custom insights + heatmap, in registry order
+    // (comboToKey maps the index back to the attribute's key)
+    QStringList attrs;
+    for (const AttributeInfo &info : attribute_registry()) {
+        attrs << QString::fromUtf8(info.label.data(), static_cast<int>(info.label.size()));
+    }
 
     ui->comboAttrX->addItems(attrs);
     ui->comboAttrY->addItems(attrs);
 
     ui->comboHeatX->addItems(attrs);
     ui->comboHeatY->addItems(attrs);
+
+    // Scoring modes, in ScoringMode order (no signal: nothing to regenerate yet)
+    {
+        QSignalBlocker blocker(ui->comboScoring);
+        ui->comboScoring->addItems({"Confidence", "Lift", "Leverage", "Chi-square (p)", "G-test (p)", "Bayesian"});
+    }
+
+    // Models for the data / insight tables; no sort column until a header is clicked,
+    // so a fresh load shows up in file order without sorting anything
+    m_peopleModel = new PeopleTableModel(this);
+    m_insightModel = new InsightTableModel(this);
+    m_insightModel->setInsights(&m_currentInsights);
+
+    for (QTableView *view : {ui->tablePeople, ui->tableInsights}) {
+        view->setSelectionBehavior(QAbstractItemView::SelectRows);
+        view->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        view->horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
+        view->setSortingEnabled(true);
+    }
+    ui->tablePeople->setModel(m_peopleModel);
+    ui->tableInsights->setModel(m_insightModel);
+
+    // Progress + cancel for background jobs, shown in the status bar while one runs
+    m_progress = new QProgressBar(this);
+    m_progress->setMaximumWidth(200);
+    m_progress->hide();
+    m_btnCancel = new QPushButton("Cancel", this);
+    m_btnCancel->hide();
+    m_heatmapProgress = new QProgressBar(this);
+    m_heatmapProgress->setMaximumWidth(200);
+    m_heatmapProgress->setFormat("Heatmap %v/%m");
+    m_heatmapProgress->hide();
+    ui->statusbar->addPermanentWidget(m_progress);
+    ui->statusbar->addPermanentWidget(m_heatmapProgress);
+    ui->statusbar->addPermanentWidget(m_btnCancel);
+
+    connect(m_btnCancel, &QPushButton::clicked, this, [this]() {
+        cancelJob();
+        cancelHeatmap();
+        ui->statusbar->showMessage("Cancelled.", 3000);
+    });
+    connect(this, &MainWindow::jobProgress, this, &MainWindow::onJobProgress, Qt::QueuedConnection);
+    connect(this, &MainWindow::heatmapCell, this, &MainWindow::onHeatmapCell, Qt::QueuedConnection);
 }
 
 MainWindow::~MainWindow()
 {
+    // jobs emit on this window, so they have to be gone first
+    cancelJob();
+    cancelHeatmap();
+    QThreadPool::globalInstance()->waitForDone();
     delete ui;
 }
 
 // ------------------------------------------------------------
-// Helper: map combo box label -> InsightGenerator attribute key
+// Background jobs
 // ------------------------------------------------------------
 
-std::string MainWindow::comboToKey(const QString &label)
+// Runs work(JobContext) on the global thread pool and done(result) back on the GUI thread.
+// Exceptions from work are shown in a message box titled errorTitle.
+template <typename Result, typename Work, typename Done>
+void MainWindow::startJob(const QString &label, const QString &errorTitle, Work work, Done done)
+{
+    cancelJob();
+
+    JobContext ctx{this, ++m_jobId, std::make_shared<std::atomic<bool>>(false)};
+    m_jobCancelled = ctx.cancelled;
+
+    struct Outcome {
+        Result value{};
+        QString error;
+    };
+
+    auto *watcher = new QFutureWatcher<Outcome>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, id = ctx.id, errorTitle, done]() {
+        Outcome outcome = watcher->result();
+        watcher->deleteLater();
+        if (id != m_jobId) return;   // cancelled or superseded
+
+        m_jobCancelled.reset();
+        setBusy(QString());
+
+        if (!outcome.error.isEmpty()) {
+            QMessageBox::critical(this, errorTitle, outcome.error);
+            return;
+        }
+        done(std::move(outcome.value));
+    });
+
+    setBusy(label);
+    watcher->setFuture(QtConcurrent::run([ctx, work]() {
+        Outcome outcome;
+        try {
+            outcome.value = work(ctx);
+        }
+        catch (const std::exception &e) {
+            outcome.error = QString::fromUtf8(e.what());
+        }
+        return outcome;
+    }));
+}
+
+ProgressCallback MainWindow::JobContext::callback() const
 {
-    QString L = label.toLower();
+    JobContext self = *this;
+    return [self, last = -1](std::size_t done, std::size_t total) mutable {
+        if (self.isCancelled()) return false;
+        if (total > 0) {
+            int perMille = static_cast<int>(std::min<std::size_t>(done, total) * 1000 / total);
+            if (perMille != last) {
+                last = perMille;
+                self.progress(perMille, 1000);
+            }
+        }
+        return true;
+    };
+}
 
-    if (L.contains("os"))          return "os";
-    if (L.contains("study"))       return "study";
-    if (L.contains("color"))       return "color";
-    if (L.contains("hobby"))       return "hobby";
-    if (L.contains("region"))      return "region";
-    if (L.contains("language"))    return "language";
-    if (L.contains("focus"))       return "focus";
-    if (L.contains("course"))      return "course";
-    if (L.contains("graduation"))  return "graduation";
-    if (L.contains("year"))        return "graduation";
+void MainWindow::cancelJob()
+{
+    if (!m_jobCancelled) return;
+
+    // the worker stops at its next progress check (every few thousand rows in the readers,
+    // every pass in the generator) by throwing OperationCancelled; whatever it ends with is
+    // dropped because the id moved on
+    m_jobCancelled->store(true, std::memory_order_relaxed);
+    m_jobCancelled.reset();
+    ++m_jobId;
+    setBusy(QString());
+}
+
+void MainWindow::onJobProgress(quint64 jobId, int done, int total)
+{
+    if (jobId != m_jobId) return;
+    m_progress->setRange(0, total);
+    m_progress->setValue(done);
+}
 
-    // fallback: just lowercase text, InsightGenerator will normalize
-    return L.toStdString();
+// empty label = idle
+void MainWindow::setBusy(const QString &label)
+{
+    const bool busy = !label.isEmpty();
+    m_progress->setRange(0, 0);   // "busy" until the job reports progress
+    m_progress->setVisible(busy);
+    updateCancelButton();
+    if (busy)
+        ui->statusbar->showMessage(label);
+    else
+        ui->statusbar->clearMessage();
+}
+
+void MainWindow::updateCancelButton()
+{
+    m_btnCancel->setVisible(m_jobCancelled || m_heatmapCancelled);
 }
 
 // ------------------------------------------------------------
-// Helper: extract attribute values for heatmap (mirrors InsightGenerator)
+// Helper: map combo box index -> InsightGenerator attribute key
 // ------------------------------------------------------------
 
-std::vector<std::string> MainWindow::extractAttrValues(const Person &person,
-                                                       const std::string &attrKey)
+std::string MainWindow::comboToKey(int index) const
 {
-    // Here we assume attrKey already like: "os", "study", "color", ...
-    // (we normalize in comboToKey)
-    if (attrKey == "os") {
-        PrimaryOS os = person.getPrimaryOS();
-        if (os == PrimaryOS::Unknown) return {};
-        return { to_string(os) };
-    }
-    else if (attrKey == "study") {
-        StudyTime st = person.getStudyTime();
-        if (st == StudyTime::Unknown) return {};
-        return { to_string(st) };
-    }
-    else if (attrKey == "color") {
-        const auto &colors = person.getFavoriteColors();
-        return std::vector<std::string>(colors.begin(), colors.end());
-    }
-    else if (attrKey == "hobby") {
-        const auto &hobbies = person.getHobbies();
-        return std::vector<std::string>(hobbies.begin(), hobbies.end());
-    }
-    else if (attrKey == "region") {
-        Region r = person.getRegion();
-        if (r == Region::Unknown) return {};
-        return { to_string(r) };
-    }
-    else if (attrKey == "language") {
-        const auto &langs = person.getLanguages();
-        return std::vector<std::string>(langs.begin(), langs.end());
-    }
-    else if (attrKey == "focus") {
-        EngineeringFocus f = person.getEngineeringFocus();
-        if (f == EngineeringFocus::Unknown) return {};
-        return { to_string(f) };
-    }
-    else if (attrKey == "course") {
-        int load = person.getCourseLoad();
-        if (load <= 0) return {};
-        return { std::to_string(load) };
-    }
-    else if (attrKey == "graduation") {
-        int year = person.getGraduationYear();
-        if (year <= 0) return {};
-        return { std::to_string(year) };
-    }
-
-    return {};
+    const AttributeInfo *info = attribute_info(static_cast<Attribute>(index));
+    return info ? std::string(info->name) : std::string();
 }
 
 // ------------------------------------------------------------
@@ -150,15 +235,12 @@ void MainWindow::on_btnLoadCsv_clicked()
         return;
     }
 
-    try {
-        PersonCsvReader reader(path.toStdString());
-        m_persons = reader.read();
-        refreshPeopleTable();
-        QMessageBox::information(this, "Loaded", "CSV loaded successfully.");
-    }
-    catch (const std::exception &e) {
-        QMessageBox::critical(this, "CSV Error", e.what());
-    }
+    std::string file = path.toStdString();
+    loadPersons("Loading CSV...", "CSV Error", "CSV loaded successfully.", [file](const ProgressCallback &progress) {
+        PersonCsvReader reader(file);
+        reader.setProgress(progress);
+        return reader.read();
+    });
 }
 
 // ------------------------------------------------------------
@@ -173,15 +255,45 @@ void MainWindow::on_btnFetchJson_clicked()
         return;
     }
 
-    try {
-        PersonJsonReader reader(url.toStdString());
-        m_persons = reader.read();
-        refreshPeopleTable();
-        QMessageBox::information(this, "Loaded", "JSON loaded successfully.");
-    }
-    catch (const std::exception &e) {
-        QMessageBox::critical(this, "JSON Error", e.what());
-    }
+    std::string source = url.toStdString();
+    loadPersons("Fetching JSON...", "JSON Error", "JSON loaded successfully.", [source](const ProgressCallback &progress) {
+        PersonJsonReader reader(source);
+        reader.setProgress(progress);
+        return reader.read();
+    });
+}
+
+// Reading and hashing both happen on the worker; the reader reports how far it is and stops
+// when the load is cancelled, and the current data stays.
+void MainWindow::loadPersons(const QString &label, const QString &errorTitle, const QString &doneMessage,
+                             std::function<std::vector<Person>(const ProgressCallback &)> read)
+{
+    struct Loaded {
+        std::shared_ptr<const std::vector<Person>> persons;
+        std::uint64_t hash = 0;
+    };
+
+    startJob<Loaded>(label, errorTitle,
+        [read](const JobContext &ctx) {
+            auto persons = std::make_shared<const std::vector<Person>>(read(ctx.callback()));
+            if (ctx.isCancelled()) return Loaded{};   // dropped anyway, skip the hash
+            Loaded loaded;
+            loaded.hash = dataset_hash(*persons);
+            loaded.persons = std::move(persons);
+            return loaded;
+        },
+        [this, doneMessage](Loaded loaded) {
+            // a heatmap of the old data is stale now
+            cancelHeatmap();
+            ui->tableHeatmap->clear();
+            ui->tableHeatmap->setRowCount(0);
+            ui->tableHeatmap->setColumnCount(0);
+
+            m_persons = std::move(loaded.persons);
+            m_datasetHash = loaded.hash;
+            refreshPeopleTable();
+            QMessageBox::information(this, "Loaded", doneMessage);
+        });
 }
 
 // ------------------------------------------------------------
@@ -190,27 +302,9 @@ void MainWindow::on_btnFetchJson_clicked()
 
 void MainWindow::refreshPeopleTable()
 {
-    ui->tablePeople->clear();
-    ui->tablePeople->setRowCount(static_cast<int>(m_persons.size()));
-    ui->tablePeople->setColumnCount(7);
-
-    ui->tablePeople->setHorizontalHeaderLabels({
-        "ID","Year","Region","OS","Study Time","Focus","Courses"
-    });
-
-    int r = 0;
-    for (const auto &p : m_persons) {
-        ui->tablePeople->setItem(r, 0, new QTableWidgetItem(QString::fromStdString(p.getId())));
-        ui->tablePeople->setItem(r, 1, new QTableWidgetItem(QString::number(p.getGraduationYear())));
-        ui->tablePeople->setItem(r, 2, new QTableWidgetItem(QString::fromStdString(to_string(p.getRegion()))));
-        ui->tablePeople->setItem(r, 3, new QTableWidgetItem(QString::fromStdString(to_string(p.getPrimaryOS()))));
-        ui->tablePeople->setItem(r, 4, new QTableWidgetItem(QString::fromStdString(to_string(p.getStudyTime()))));
-        ui->tablePeople->setItem(r, 5, new QTableWidgetItem(QString::fromStdString(to_string(p.getEngineeringFocus()))));
-        ui->tablePeople->setItem(r, 6, new QTableWidgetItem(QString::number(p.getCourseLoad())));
-        ++r;
-    }
-
-    ui->tablePeople->resizeColumnsToContents();
+    trace::Span span("gui.refresh_people");
+    m_peopleModel->setPersons(m_persons);
+    ui->tablePeople->resizeColumnsToContents();   // only samples the first rows
 }
 
 // ------------------------------------------------------------
@@ -219,16 +313,48 @@ void MainWindow::refreshPeopleTable()
 
 void MainWindow::on_btnGenerateDefault_clicked()
 {
-    if (m_persons.empty()) {
+    if (m_persons->empty()) {
         QMessageBox::warning(this, "No Data", "Load data first.");
         return;
     }
 
-    auto results = m_generator.generate(m_persons, m_blockedKeys);
-    m_currentInsights = results;
+    regenerateDefault(true);
+}
 
-    refreshInsightsTable();
-    rebuildHeatmap();
+// Changing how insights are scored re-ranks the default insights and the heatmap.
+// Jobs still running keep the engine they started with; new ones get this one.
+void MainWindow::on_comboScoring_currentIndexChanged(int index)
+{
+    if (index < 0) return;
+
+    auto engine = std::make_shared<Engine>();
+    engine->generator = m_engine->generator;
+    engine->generator.setScoring(static_cast<ScoringMode>(index));
+    m_engine = std::move(engine);
+
+    if (!m_persons->empty())
+        regenerateDefault(true);
+}
+
+// Runs the default generator in the background; the job works on snapshots of the
+// data and blocklist, so blocking more keys meanwhile just starts the next run.
+void MainWindow::regenerateDefault(bool thenRebuildHeatmap)
+{
+    auto persons = m_persons;
+    auto engine = m_engine;
+    std::uint64_t hash = m_datasetHash;
+    FingerprintSet suppressed = m_store.suppression();
+
+    startJob<std::vector<Insight>>("Generating insights...", "Generate Error",
+        [engine, persons, hash, suppressed](const JobContext &ctx) {
+            return engine->cache.generate(*persons, hash, suppressed, 0, ctx.callback());
+        },
+        [this, thenRebuildHeatmap](std::vector<Insight> results) {
+            m_currentInsights = std::move(results);
+            refreshInsightsTable();
+            if (thenRebuildHeatmap)
+                rebuildHeatmap();
+        });
 }
 
 // ------------------------------------------------------------
@@ -237,25 +363,19 @@ void MainWindow::on_btnGenerateDefault_clicked()
 
 void MainWindow::refreshInsightsTable()
 {
-    ui->tableInsights->clear();
-    ui->tableInsights->setRowCount(static_cast<int>(m_currentInsights.size()));
-    ui->tableInsights->setColumnCount(5);
-
-    ui->tableInsights->setHorizontalHeaderLabels(
-        {"Key","Description","Score","Support","Population"}
-        );
+    trace::Span span("gui.refresh_insights");
+    m_insightModel->setInsights(&m_currentInsights);
+    ui->tableInsights->resizeColumnsToContents();
+}
 
-    int r = 0;
-    for (const auto &ins : m_currentInsights) {
-        ui->tableInsights->setItem(r, 0, new QTableWidgetItem(QString::fromStdString(ins.key)));
-        ui->tableInsights->setItem(r, 1, new QTableWidgetItem(QString::fromStdString(ins.description)));
-        ui->tableInsights->setItem(r, 2, new QTableWidgetItem(QString::number(ins.score)));
-        ui->tableInsights->setItem(r, 3, new QTableWidgetItem(QString::number(static_cast<int>(ins.support))));
-        ui->tableInsights->setItem(r, 4, new QTableWidgetItem(QString::number(static_cast<int>(ins.population))));
-        ++r;
-    }
+void MainWindow::on_lineFilterPeople_textChanged(const QString &text)
+{
+    m_peopleModel->setFilter(text);
+}
 
-    ui->tableInsights->resizeColumnsToContents();
+void MainWindow::on_lineFilterInsights_textChanged(const QString &text)
+{
+    m_insightModel->setFilter(text);
 }
 
 // ------------------------------------------------------------
@@ -264,19 +384,18 @@ void MainWindow::refreshInsightsTable()
 
 void MainWindow::on_btnBlockSelected_clicked()
 {
-    auto items = ui->tableInsights->selectedItems();
-    if (items.isEmpty()) return;
+    auto rows = ui->tableInsights->selectionModel()->selectedRows();
+    if (rows.isEmpty()) return;
 
-    int row = items.first()->row();
-    if (row < 0 || row >= static_cast<int>(m_currentInsights.size())) return;
+    // the view may be sorted / filtered, so map back to the insight's index
+    std::size_t row = m_insightModel->sourceRow(rows.first().row());
+    if (row >= m_currentInsights.size()) return;
 
-    m_blockedKeys.insert(m_currentInsights[row].key);
+    m_store.addBlockedKey(m_currentInsights[row].key());
     refreshBlockedList();
 
     // Re-run current mode: for simplicity, just re-run default generator
-    auto newResults = m_generator.generate(m_persons, m_blockedKeys);
-    m_currentInsights = newResults;
-    refreshInsightsTable();
+    regenerateDefault(false);
 }
 
 void MainWindow::on_btnUnblock_clicked()
@@ -285,21 +404,19 @@ void MainWindow::on_btnUnblock_clicked()
     if (items.isEmpty()) return;
 
     for (auto *i : items) {
-        m_blockedKeys.erase(i->text().toStdString());
+        m_store.removeBlockedKey(i->text().toStdString());
     }
 
     refreshBlockedList();
 
     // Re-run default generator
-    auto newResults = m_generator.generate(m_persons, m_blockedKeys);
-    m_currentInsights = newResults;
-    refreshInsightsTable();
+    regenerateDefault(false);
 }
 
 void MainWindow::refreshBlockedList()
 {
     ui->listBlocked->clear();
-    for (const auto &k : m_blockedKeys) {
+    for (const auto &k : m_store.getBlockedKeys()) {
         ui->listBlocked->addItem(QString::fromStdString(k));
     }
 }
@@ -315,10 +432,7 @@ void MainWindow::on_btnSaveBlocked_clicked()
 
     if (file.isEmpty()) return;
 
-    std::ofstream out(file.toStdString());
-    for (const auto &k : m_blockedKeys) {
-        out << k << "\n";
-    }
+    m_store.saveBlocked(file.toStdString());
 
     QMessageBox::information(this, "Saved", "Blocked keys saved.");
 }
@@ -334,8 +448,16 @@ void MainWindow::on_btnExportUseful_clicked()
 
     if (file.isEmpty()) return;
 
-    InsightStore s;
-    s.saveUseful(m_currentInsights, file.toStdString());
+    // a plain CSV for spreadsheets, not the saved-insights log
+    std::ofstream out(file.toStdString(), std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        QMessageBox::warning(this, "Error", "Could not write " + file);
+        return;
+    }
+    {
+        BufferedWriter writer(out);
+        write_insights(writer, m_currentInsights, OutputFormat::Csv);
+    }
 
     QMessageBox::information(this, "Saved", "Useful insights exported.");
 }
@@ -346,33 +468,39 @@ void MainWindow::on_btnExportUseful_clicked()
 
 void MainWindow::on_btnGenerateCustom_clicked()
 {
-    if (m_persons.empty()) {
+    if (m_persons->empty()) {
         QMessageBox::warning(this, "No Data", "Load data first.");
         return;
     }
 
-    QString labelX = ui->comboAttrX->currentText();
-    QString labelY = ui->comboAttrY->currentText();
+    std::string keyX = comboToKey(ui->comboAttrX->currentIndex());
+    std::string keyY = comboToKey(ui->comboAttrY->currentIndex());
 
-    if (labelX.isEmpty() || labelY.isEmpty()) {
+    if (keyX.empty() || keyY.empty()) {
         QMessageBox::warning(this, "Error", "Choose two attributes.");
         return;
     }
 
-    std::string keyX = comboToKey(labelX);
-    std::string keyY = comboToKey(labelY);
-
     if (keyX == keyY) {
         QMessageBox::warning(this, "Invalid Pair",
                              "Please pick two different attributes for custom insights.");
         return;
     }
 
-    auto results = m_generator.generateGeneric(m_persons, m_blockedKeys, keyX, keyY);
-    m_currentInsights = results;
-
-    refreshInsightsTable();
-    rebuildHeatmap(); // optional: reflect new pair in heatmap too
+    auto persons = m_persons;
+    auto engine = m_engine;
+    std::uint64_t hash = m_datasetHash;
+    FingerprintSet suppressed = m_store.suppression();
+
+    startJob<std::vector<Insight>>("Generating insights...", "Generate Error",
+        [engine, persons, hash, suppressed, keyX, keyY](const JobContext &ctx) {
+            return engine->cache.generateGeneric(*persons, hash, suppressed, keyX, keyY, 0, ctx.callback());
+        },
+        [this](std::vector<Insight> results) {
+            m_currentInsights = std::move(results);
+            refreshInsightsTable();
+            rebuildHeatmap(); // optional: reflect new pair in heatmap too
+        });
 }
 
 // ------------------------------------------------------------
@@ -386,20 +514,125 @@ void MainWindow::on_btnUpdateHeatmap_clicked()
 
 void MainWindow::rebuildHeatmap()
 {
+    cancelHeatmap();
     ui->tableHeatmap->clear();
 
-    if (m_persons.empty()) {
+    if (m_persons->empty()) {
         ui->tableHeatmap->setRowCount(0);
         ui->tableHeatmap->setColumnCount(0);
         return;
     }
 
-    // Fixed attribute list (same as CLI discover-all)
-    std::vector<std::string> attributes = {
-        "os", "study", "color", "hobby",
-        "region", "language", "focus", "course", "graduation"
+    // Every registered attribute (same as CLI discover-all)
+    std::vector<std::string> attributes;
+    for (const AttributeInfo &info : attribute_registry()) {
+        attributes.emplace_back(info.name);
+    }
+    prepareHeatmap(attributes);
+
+    // Cheapest cells first: enum x enum, then enum x tag, then tag x tag
+    std::vector<std::pair<int, int>> cells;
+    const int n = static_cast<int>(attributes.size());
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            if (i != j) cells.emplace_back(i, j);
+        }
+    }
+    // tag attributes hold a set per person, so their pairs cost the most to count
+    auto cost = [&](const std::pair<int, int> &c) {
+        return attribute_registry()[c.first].multiValued +
+               attribute_registry()[c.second].multiValued;
     };
+    std::stable_sort(cells.begin(), cells.end(),
+                     [&](const auto &a, const auto &b) { return cost(a) < cost(b); });
+
+    const quint64 runId = ++m_heatmapRun;
+    auto cancelled = std::make_shared<std::atomic<bool>>(false);
+    m_heatmapCancelled = cancelled;
+
+    m_heatmapProgress->setRange(0, static_cast<int>(cells.size()));
+    m_heatmapProgress->setValue(0);
+    m_heatmapProgress->show();
+    updateCancelButton();
+
+    auto persons = m_persons;
+    auto engine = m_engine;
+    std::uint64_t hash = m_datasetHash;
+    FingerprintSet suppressedKeys = m_store.suppression();   // same blocklist as the insight table
+
+    auto *watcher = new QFutureWatcher<void>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, runId]() {
+        watcher->deleteLater();
+        onHeatmapFinished(runId);
+    });
+    watcher->setFuture(QtConcurrent::run(
+        [this, runId, cancelled, engine, persons, hash, suppressedKeys, attributes, cells]() {
+            trace::Span span("gui.rebuild_heatmap");
+
+            for (const auto &[i, j] : cells) {
+                if (cancelled->load(std::memory_order_relaxed)) return;
+
+                double score = std::nan("");
+                try {
+                    auto insights = engine->cache.generateGeneric(
+                        *persons,
+                        hash,
+                        suppressedKeys,
+                        attributes[i],
+                        attributes[j]
+                        );
+
+                    if (!insights.empty()) {
+                        int totalScore = 0;
+                        for (const auto& ins : insights) {
+                            totalScore += ins.score;
+                        }
+                        score = static_cast<double>(totalScore) / static_cast<double>(insights.size());
+                    }
+                }
+                catch (const std::exception &) {
+                    // leave the cell empty, like a pair without insights
+                }
+                emit heatmapCell(runId, i, j, score);
+            }
+        }));
+}
+
+void MainWindow::cancelHeatmap()
+{
+    if (!m_heatmapCancelled) return;
+
+    // cells still queued from the old run are dropped because the run id moved on
+    m_heatmapCancelled->store(true, std::memory_order_relaxed);
+    m_heatmapCancelled.reset();
+    ++m_heatmapRun;
+    m_heatmapProgress->hide();
+    updateCancelButton();
+}
+
+void MainWindow::onHeatmapCell(quint64 runId, int row, int col, double score)
+{
+    if (runId != m_heatmapRun) return;
+    setHeatmapCell(row, col, score);
+    m_heatmapProgress->setValue(m_heatmapProgress->value() + 1);
+}
+
+// queued after the run's last heatmapCell, so every cell is in by now
+void MainWindow::onHeatmapFinished(quint64 runId)
+{
+    if (runId != m_heatmapRun) return;
+
+    m_heatmapCancelled.reset();
+    m_heatmapProgress->hide();
+    updateCancelButton();
 
+    ui->tableHeatmap->resizeColumnsToContents();
+    ui->tableHeatmap->resizeRowsToContents();
+}
+
+// headers, the diagonal and a placeholder in every cell still being computed
+void MainWindow::prepareHeatmap(const std::vector<std::string> &attributes)
+{
     const int n = static_cast<int>(attributes.size());
     ui->tableHeatmap->setRowCount(n);
     ui->tableHeatmap->setColumnCount(n);
@@ -412,86 +645,38 @@ void MainWindow::rebuildHeatmap()
     ui->tableHeatmap->setHorizontalHeaderLabels(headers);
     ui->tableHeatmap->setVerticalHeaderLabels(headers);
 
-    // Build a map of (attrX, attrY) -> average score
-    std::map<std::pair<std::string, std::string>, double> scoreMap;
-
-    // Use same blocklist you use for the insight table
-    std::unordered_set<std::string> suppressedKeys = m_blockedKeys;
-
-    for (std::size_t i = 0; i < attributes.size(); ++i) {
-        for (std::size_t j = 0; j < attributes.size(); ++j) {
-            if (i == j) continue; // diagonal handled later
-
-            auto insights = m_generator.generateGeneric(
-                m_persons,
-                suppressedKeys,
-                attributes[i],
-                attributes[j]
-                );
-
-            if (insights.empty()) {
-                continue;
-            }
-
-            int totalScore = 0;
-            for (const auto& ins : insights) {
-                totalScore += ins.score;
-            }
-
-            double avgScore =
-                static_cast<double>(totalScore) / static_cast<double>(insights.size());
-
-            scoreMap[{attributes[i], attributes[j]}] = avgScore;
-        }
-    }
-
-    // Fill table with scores and some basic color coding
     for (int row = 0; row < n; ++row) {
         for (int col = 0; col < n; ++col) {
-            QTableWidgetItem* item = new QTableWidgetItem;
-
-            if (row == col) {
-                item->setText("--");
-                item->setTextAlignment(Qt::AlignCenter);
-                item->setFlags(item->flags() & ~Qt::ItemIsEditable);
-                ui->tableHeatmap->setItem(row, col, item);
-                continue;
-            }
-
-            auto key = std::make_pair(
-                attributes[row],
-                attributes[col]
-                );
-
-            auto it = scoreMap.find(key);
-            if (it == scoreMap.end()) {
-                // no data for this pair
-                item->setText("");
-                item->setFlags(item->flags() & ~Qt::ItemIsEditable);
-                ui->tableHeatmap->setItem(row, col, item);
-                continue;
-            }
-
-            int scoreInt = static_cast<int>(std::round(it->second));
-            item->setText(QString::number(scoreInt));
+            QTableWidgetItem* item = new QTableWidgetItem(row == col ? "--" : "...");
             item->setTextAlignment(Qt::AlignCenter);
             item->setFlags(item->flags() & ~Qt::ItemIsEditable);
-
-            // Weak / moderate / strong coloring
-            QColor bg;
-            if (scoreInt > 65) {
-                bg = QColor(255, 120, 120);   // strong
-            } else if (scoreInt >= 50) {
-                bg = QColor(255, 190, 120);   // moderate
-            } else {
-                bg = QColor(255, 255, 160);   // weak
-            }
-            item->setBackground(bg);
-
             ui->tableHeatmap->setItem(row, col, item);
         }
     }
+}
+
+void MainWindow::setHeatmapCell(int row, int col, double score)
+{
+    QTableWidgetItem* item = ui->tableHeatmap->item(row, col);
+    if (!item) return;
+
+    if (std::isnan(score)) {
+        // no data for this pair
+        item->setText("");
+        return;
+    }
 
-    ui->tableHeatmap->resizeColumnsToContents();
-    ui->tableHeatmap->resizeRowsToContents();
+    int scoreInt = static_cast<int>(std::round(score));
+    item->setText(QString::number(scoreInt));
+
+    // Weak / moderate / strong coloring
+    QColor bg;
+    if (scoreInt > 65) {
+        bg = QColor(255, 120, 120);   // strong
+    } else if (scoreInt >= 50) {
+        bg = QColor(255, 190, 120);   // moderate
+    } else {
+        bg = QColor(255, 255, 160);   // weak
+    }
+    item->setBackground(bg);
 }
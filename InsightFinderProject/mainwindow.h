@@ -2,8 +2,10 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
+#include <atomic>
+#include <functional>
+#include <memory>
 #include <vector>
-#include <unordered_set>
 #include <string>
 
 #include "Person.h"
@@ -12,11 +14,15 @@
 #include "PersonRepository.h"
 #include "PersonEnums.h"
 #include "Insight.h"
+#include "InsightCache.h"
 #include "InsightGenerator.h"
 #include "InsightStore.h"
+#include "tablemodels.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
+class QProgressBar;
+class QPushButton;
 QT_END_NAMESPACE
 
 class MainWindow : public QMainWindow
@@ -27,24 +33,83 @@ public:
     explicit MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+signals:
+    // emitted by background jobs from a worker thread; handled on the GUI thread
+    void jobProgress(quint64 jobId, int done, int total);
+    // one finished heatmap cell from a worker; NaN = no insights for the pair
+    void heatmapCell(quint64 runId, int row, int col, double score);
+
 private:
     Ui::MainWindow *ui;
 
     // Data
-    std::vector<Person> m_persons;
+    // shared with background jobs, so a load can replace it while a job still reads the old one
+    std::shared_ptr<const std::vector<Person>> m_persons = std::make_shared<const std::vector<Person>>();
     std::vector<Insight> m_currentInsights;
-    std::unordered_set<std::string> m_blockedKeys;
+    InsightStore m_store;   // blocklist (checked by fingerprint)
+
+    // the tables read m_persons / m_currentInsights through these, only for visible rows
+    PeopleTableModel *m_peopleModel = nullptr;
+    InsightTableModel *m_insightModel = nullptr;
+
+    // Generator settings and the cache bound to them. A settings change swaps in a new Engine
+    // instead of changing this one, so a running job keeps the snapshot it started with.
+    struct Engine {
+        InsightGenerator generator;
+        InsightCache cache{generator};   // re-generating after block/unblock or heatmap rebuilds hits this
+    };
+    std::shared_ptr<Engine> m_engine = std::make_shared<Engine>();
+    std::uint64_t m_datasetHash = 0;     // dataset_hash(*m_persons), updated on every load
+
+    // Background jobs (QtConcurrent): one at a time, starting a new one cancels the running one.
+    // A job's result is only applied if its id is still m_jobId when it finishes.
+    struct JobContext {
+        MainWindow *window;
+        quint64 id;
+        std::shared_ptr<std::atomic<bool>> cancelled;
+
+        bool isCancelled() const { return cancelled->load(std::memory_order_relaxed); }
+        void progress(int done, int total) const { emit window->jobProgress(id, done, total); }
 
-    InsightGenerator m_generator;
+        // for core calls that take a ProgressCallback: forwards their progress (as per mille,
+        // only when it moves) and stops them once the job is cancelled
+        ProgressCallback callback() const;
+    };
+    quint64 m_jobId = 0;
+    std::shared_ptr<std::atomic<bool>> m_jobCancelled;
+    QProgressBar *m_progress = nullptr;
+    QPushButton *m_btnCancel = nullptr;
+
+    template <typename Result, typename Work, typename Done>
+    void startJob(const QString &label, const QString &errorTitle, Work work, Done done);
+    void cancelJob();
+    void onJobProgress(quint64 jobId, int done, int total);
+    void setBusy(const QString &label);
+
+    // The heatmap streams in its own lane, so generating / blocking meanwhile doesn't stop it;
+    // only a newer rebuild, a new dataset or Cancel does.
+    quint64 m_heatmapRun = 0;
+    std::shared_ptr<std::atomic<bool>> m_heatmapCancelled;
+    QProgressBar *m_heatmapProgress = nullptr;
+
+    void cancelHeatmap();
+    void onHeatmapCell(quint64 runId, int row, int col, double score);
+    void onHeatmapFinished(quint64 runId);
+    void updateCancelButton();
+
+    void loadPersons(const QString &label, const QString &errorTitle, const QString &doneMessage,
+                     std::function<std::vector<Person>(const ProgressCallback &)> read);
+    void regenerateDefault(bool thenRebuildHeatmap);
 
     // Helpers
     void refreshPeopleTable();
     void refreshInsightsTable();
     void refreshBlockedList();
     void rebuildHeatmap();
+    void prepareHeatmap(const std::vector<std::string> &attributes);
+    void setHeatmapCell(int row, int col, double score);
 
-    std::string comboToKey(const QString &label);
-    std::vector<std::string> extractAttrValues(const Person &p, const std::string &attrKey);
+    std::string comboToKey(int index) const;
 
 private slots:
     // Data loading
@@ -55,6 +120,7 @@ private slots:
     // Insight generation
     void on_btnGenerateDefault_clicked();
     void on_btnGenerateCustom_clicked();
+    void on_comboScoring_currentIndexChanged(int index);
 
     // Block / unblock / save / export
     void on_btnBlockSelected_clicked();
@@ -62,6 +128,10 @@ private slots:
     void on_btnSaveBlocked_clicked();
     void on_btnExportUseful_clicked();
 
+    // Table filters
+    void on_lineFilterPeople_textChanged(const QString &text);
+    void on_lineFilterInsights_textChanged(const QString &text);
+
     // Heatmap
     void on_btnUpdateHeatmap_clicked();
 };
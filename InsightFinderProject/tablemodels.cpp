@@ -0,0 +1,233 @@
+#include "tablemodels.h"
+#include "PersonEnums.h"
+
+#include <algorithm>
+#include <cctype>
+#include <string_view>
+
+namespace {
+
+bool containsNoCase(std::string_view haystack, const std::string &needle)
+{
+    auto it = std::search(haystack.begin(), haystack.end(), needle.begin(), needle.end(),
+                          [](char a, char b) {
+                              return std::tolower(static_cast<unsigned char>(a)) == b;
+                          });
+    return it != haystack.end();
+}
+
+bool containsNoCase(int value, const std::string &needle)
+{
+    return containsNoCase(std::to_string(value), needle);
+}
+
+QString text(std::string_view s)
+{
+    return QString::fromUtf8(s.data(), static_cast<int>(s.size()));
+}
+
+}
+
+// ------------------------------------------------------------
+// PermutedTableModel
+// ------------------------------------------------------------
+
+int PermutedTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(m_rows.size());
+}
+
+void PermutedTableModel::sort(int column, Qt::SortOrder order)
+{
+    beginResetModel();
+    m_sortColumn = column;
+    m_sortOrder = order;
+    if (column < 0)
+        rebuildRows();   // back to source order
+    else
+        applyOrder();
+    endResetModel();
+}
+
+void PermutedTableModel::setFilter(const QString &text)
+{
+    std::string filter = text.trimmed().toLower().toStdString();
+    if (filter == m_filter) return;
+
+    beginResetModel();
+    m_filter = std::move(filter);
+    rebuildRows();
+    endResetModel();
+}
+
+void PermutedTableModel::rebuildRows()
+{
+    const std::size_t n = sourceSize();
+    m_rows.clear();
+    m_rows.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        if (m_filter.empty() || matches(i, m_filter))
+            m_rows.push_back(i);
+    }
+    applyOrder();
+}
+
+void PermutedTableModel::applyOrder()
+{
+    if (m_sortColumn < 0) return;
+
+    // stable, so sorting by one column and then another keeps the first order within ties
+    const int column = m_sortColumn;
+    if (m_sortOrder == Qt::AscendingOrder) {
+        std::stable_sort(m_rows.begin(), m_rows.end(),
+                         [&](std::size_t a, std::size_t b) { return lessThan(a, b, column); });
+    } else {
+        std::stable_sort(m_rows.begin(), m_rows.end(),
+                         [&](std::size_t a, std::size_t b) { return lessThan(b, a, column); });
+    }
+}
+
+// ------------------------------------------------------------
+// PeopleTableModel
+// ------------------------------------------------------------
+
+void PeopleTableModel::setPersons(std::shared_ptr<const std::vector<Person>> persons)
+{
+    beginResetModel();
+    m_persons = std::move(persons);
+    rebuildRows();
+    endResetModel();
+}
+
+std::size_t PeopleTableModel::sourceSize() const
+{
+    return m_persons ? m_persons->size() : 0;
+}
+
+int PeopleTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : 7;
+}
+
+QVariant PeopleTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || role != Qt::DisplayRole) return QVariant();
+
+    const Person &p = (*m_persons)[sourceRow(index.row())];
+    switch (index.column()) {
+        case 0: return text(p.getId());
+        case 1: return p.getGraduationYear();
+        case 2: return text(enum_name(p.getRegion()));
+        case 3: return text(enum_name(p.getPrimaryOS()));
+        case 4: return text(enum_name(p.getStudyTime()));
+        case 5: return text(enum_name(p.getEngineeringFocus()));
+        case 6: return p.getCourseLoad();
+    }
+    return QVariant();
+}
+
+QVariant PeopleTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    static const char *const headers[] = {
+        "ID","Year","Region","OS","Study Time","Focus","Courses"
+    };
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole && section >= 0 && section < 7)
+        return QString(headers[section]);
+    return PermutedTableModel::headerData(section, orientation, role);
+}
+
+// enums sort by their displayed name, like the rest of the columns
+bool PeopleTableModel::lessThan(std::size_t a, std::size_t b, int column) const
+{
+    const Person &x = (*m_persons)[a];
+    const Person &y = (*m_persons)[b];
+    switch (column) {
+        case 0: return x.getId() < y.getId();
+        case 1: return x.getGraduationYear() < y.getGraduationYear();
+        case 2: return enum_name(x.getRegion()) < enum_name(y.getRegion());
+        case 3: return enum_name(x.getPrimaryOS()) < enum_name(y.getPrimaryOS());
+        case 4: return enum_name(x.getStudyTime()) < enum_name(y.getStudyTime());
+        case 5: return enum_name(x.getEngineeringFocus()) < enum_name(y.getEngineeringFocus());
+        case 6: return x.getCourseLoad() < y.getCourseLoad();
+    }
+    return false;
+}
+
+bool PeopleTableModel::matches(std::size_t index, const std::string &needle) const
+{
+    const Person &p = (*m_persons)[index];
+    return containsNoCase(p.getId(), needle)
+        || containsNoCase(p.getGraduationYear(), needle)
+        || containsNoCase(enum_name(p.getRegion()), needle)
+        || containsNoCase(enum_name(p.getPrimaryOS()), needle)
+        || containsNoCase(enum_name(p.getStudyTime()), needle)
+        || containsNoCase(enum_name(p.getEngineeringFocus()), needle)
+        || containsNoCase(p.getCourseLoad(), needle);
+}
+
+// ------------------------------------------------------------
+// InsightTableModel
+// ------------------------------------------------------------
+
+void InsightTableModel::setInsights(const std::vector<Insight> *insights)
+{
+    beginResetModel();
+    m_insights = insights;
+    rebuildRows();
+    endResetModel();
+}
+
+std::size_t InsightTableModel::sourceSize() const
+{
+    return m_insights ? m_insights->size() : 0;
+}
+
+int InsightTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : 5;
+}
+
+QVariant InsightTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || role != Qt::DisplayRole) return QVariant();
+
+    const Insight &ins = (*m_insights)[sourceRow(index.row())];
+    switch (index.column()) {
+        case 0: return text(ins.key());
+        case 1: return text(ins.description());
+        case 2: return ins.score;
+        case 3: return static_cast<qulonglong>(ins.support);
+        case 4: return static_cast<qulonglong>(ins.population);
+    }
+    return QVariant();
+}
+
+QVariant InsightTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    static const char *const headers[] = {
+        "Key","Description","Score","Support","Population"
+    };
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole && section >= 0 && section < 5)
+        return QString(headers[section]);
+    return PermutedTableModel::headerData(section, orientation, role);
+}
+
+bool InsightTableModel::lessThan(std::size_t a, std::size_t b, int column) const
+{
+    const Insight &x = (*m_insights)[a];
+    const Insight &y = (*m_insights)[b];
+    switch (column) {
+        case 0: return x.key() < y.key();
+        case 1: return x.description() < y.description();
+        case 2: return x.score < y.score;
+        case 3: return x.support < y.support;
+        case 4: return x.population < y.population;
+    }
+    return false;
+}
+
+bool InsightTableModel::matches(std::size_t index, const std::string &needle) const
+{
+    const Insight &ins = (*m_insights)[index];
+    return containsNoCase(ins.key(), needle) || containsNoCase(ins.description(), needle);
+}
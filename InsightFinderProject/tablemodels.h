@@ -0,0 +1,100 @@
+#ifndef TABLEMODELS_H
+#define TABLEMODELS_H
+
+#include <QAbstractTableModel>
+#include <QString>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Insight.h"
+#include "Person.h"
+
+/**
+ * Base for the people / insight tables: the view asks for cells of visible rows only,
+ * and sorting and filtering just rearrange m_rows (view row -> source index), so the
+ * data itself is never copied or turned into items.
+ */
+class PermutedTableModel : public QAbstractTableModel
+{
+public:
+    using QAbstractTableModel::QAbstractTableModel;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    // case-insensitive substring over every column; "" shows all rows
+    void setFilter(const QString &text);
+
+    // source index of a view row (what selections have to be mapped through)
+    std::size_t sourceRow(int row) const { return m_rows[static_cast<std::size_t>(row)]; }
+
+protected:
+    virtual std::size_t sourceSize() const = 0;
+    virtual bool lessThan(std::size_t a, std::size_t b, int column) const = 0;
+    // needle is already lower case
+    virtual bool matches(std::size_t index, const std::string &needle) const = 0;
+
+    // call between beginResetModel / endResetModel when the source changes
+    void rebuildRows();
+
+private:
+    std::vector<std::size_t> m_rows;
+    std::string m_filter;   // lower case
+    int m_sortColumn = -1;
+    Qt::SortOrder m_sortOrder = Qt::AscendingOrder;
+
+    void applyOrder();
+};
+
+/** People table: ID, Year, Region, OS, Study Time, Focus, Courses. */
+class PeopleTableModel : public PermutedTableModel
+{
+    Q_OBJECT
+
+public:
+    using PermutedTableModel::PermutedTableModel;
+
+    // shares the list with MainWindow (and any background job still reading it)
+    void setPersons(std::shared_ptr<const std::vector<Person>> persons);
+
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+protected:
+    std::size_t sourceSize() const override;
+    bool lessThan(std::size_t a, std::size_t b, int column) const override;
+    bool matches(std::size_t index, const std::string &needle) const override;
+
+private:
+    std::shared_ptr<const std::vector<Person>> m_persons;
+};
+
+/** Insights table: Key, Description, Score, Support, Population. */
+class InsightTableModel : public PermutedTableModel
+{
+    Q_OBJECT
+
+public:
+    using PermutedTableModel::PermutedTableModel;
+
+    // the vector stays owned by the caller; call again after it changes
+    void setInsights(const std::vector<Insight> *insights);
+
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+protected:
+    std::size_t sourceSize() const override;
+    bool lessThan(std::size_t a, std::size_t b, int column) const override;
+    bool matches(std::size_t index, const std::string &needle) const override;
+
+private:
+    const std::vector<Insight> *m_insights = nullptr;
+};
+
+#endif // TABLEMODELS_H
@@ -0,0 +1,83 @@
+#include "BenchData.h"
+#include "DatasetGenerator.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <sstream>
+
+namespace bench {
+
+namespace {
+
+DatasetGenerator generatorFor(std::size_t rows) {
+    DatasetConfig config;
+    config.rows = rows;
+    config.seed = 42;
+    config.rules = {
+        parse_planted_rule("region=china:language=mandarin:0.9"),
+        parse_planted_rule("os=macos:study=morning:0.7"),
+    };
+    return DatasetGenerator(config);
+}
+
+const std::string& datasetFile(std::size_t rows, DatasetFormat format, const char* extension) {
+    static std::map<std::pair<std::size_t, std::string>, std::string> cache;
+    auto it = cache.find({rows, extension});
+    if (it != cache.end()) {
+        return it->second;
+    }
+
+    std::string path = (std::filesystem::temp_directory_path()
+                        / ("decoderscpp_bench_" + std::to_string(rows) + extension)).string();
+    generatorFor(rows).writeFile(path, format);
+    return cache.emplace(std::make_pair(rows, std::string(extension)), path).first->second;
+}
+
+}
+
+const std::vector<Person>& persons(std::size_t rows) {
+    static std::map<std::size_t, std::unique_ptr<std::vector<Person>>> cache;
+    auto& slot = cache[rows];
+    if (!slot) {
+        slot = std::make_unique<std::vector<Person>>(generatorFor(rows).generate());
+    }
+    return *slot;
+}
+
+const std::string& csvPath(std::size_t rows) {
+    return datasetFile(rows, DatasetFormat::Csv, ".csv");
+}
+
+const std::string& binaryPath(std::size_t rows) {
+    return datasetFile(rows, DatasetFormat::Binary, ".bin");
+}
+
+const std::string& jsonText(std::size_t rows) {
+    static std::map<std::size_t, std::string> cache;
+    auto it = cache.find(rows);
+    if (it != cache.end()) {
+        return it->second;
+    }
+
+    std::ostringstream out;
+    generatorFor(rows).write(out, DatasetFormat::Json);
+    return cache.emplace(rows, out.str()).first->second;
+}
+
+void datasetSizes(benchmark::internal::Benchmark* b) {
+    std::size_t maxRows = 10000000;
+    if (const char* env = std::getenv("DECODERSCPP_BENCH_MAX_ROWS")) {
+        maxRows = std::strtoull(env, nullptr, 10);
+    }
+
+    for (std::size_t rows : {1000, 100000, 1000000, 10000000}) {
+        if (rows <= maxRows) {
+            b->Arg(static_cast<std::int64_t>(rows));
+        }
+    }
+    b->Unit(benchmark::kMillisecond);
+}
+
+}
@@ -0,0 +1,31 @@
+#ifndef BENCH_DATA_H
+#define BENCH_DATA_H
+
+#include "Person.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * Shared datasets for the benchmarks.
+ *
+ * Each size is built once by DatasetGenerator (fixed seed, a couple of planted rules)
+ * and reused by every benchmark that asks for it, the same goes for the file renderings of it.
+ */
+namespace bench {
+
+const std::vector<Person>& persons(std::size_t rows);
+const std::string& csvPath(std::size_t rows);      // written to the temp directory
+const std::string& binaryPath(std::size_t rows);   // same, PersonBinaryReader format
+const std::string& jsonText(std::size_t rows);     // {"people":[...]} like the JSON endpoint
+
+// registers the 1k/100k/1M/10M row sizes, skipping anything above
+// DECODERSCPP_BENCH_MAX_ROWS when that's set in the environment
+void datasetSizes(benchmark::internal::Benchmark* b);
+
+}
+
+#endif // BENCH_DATA_H
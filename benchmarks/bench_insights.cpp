@@ -0,0 +1,112 @@
+#include "BenchData.h"
+#include "InsightGenerator.h"
+#include "InsightStore.h"
+
+#include <benchmark/benchmark.h>
+
+static void BM_Generate(benchmark::State& state) {
+    const auto rows = static_cast<std::size_t>(state.range(0));
+    const auto& persons = bench::persons(rows);
+    InsightGenerator generator;
+    FingerprintSet suppressed;
+
+    for (auto _ : state) {
+        auto insights = generator.generate(persons, suppressed);
+        benchmark::DoNotOptimize(insights.data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * rows));
+}
+BENCHMARK(BM_Generate)->Apply(bench::datasetSizes);
+
+static void BM_GenerateTopK(benchmark::State& state) {
+    const auto rows = static_cast<std::size_t>(state.range(0));
+    const auto& persons = bench::persons(rows);
+    InsightGenerator generator;
+    FingerprintSet suppressed;
+
+    for (auto _ : state) {
+        auto insights = generator.generate(persons, suppressed, 10);
+        benchmark::DoNotOptimize(insights.data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * rows));
+}
+BENCHMARK(BM_GenerateTopK)->Apply(bench::datasetSizes);
+
+static void BM_GeneratePair(benchmark::State& state, InsightPairType which) {
+    const auto rows = static_cast<std::size_t>(state.range(0));
+    const auto& persons = bench::persons(rows);
+    InsightGenerator generator;
+    FingerprintSet suppressed;
+
+    for (auto _ : state) {
+        auto insights = generator.generatePair(persons, suppressed, which);
+        benchmark::DoNotOptimize(insights.data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * rows));
+}
+BENCHMARK_CAPTURE(BM_GeneratePair, os_study, InsightPairType::OsStudy)->Apply(bench::datasetSizes);
+BENCHMARK_CAPTURE(BM_GeneratePair, color_hobby, InsightPairType::ColorHobby)->Apply(bench::datasetSizes);
+BENCHMARK_CAPTURE(BM_GeneratePair, region_language, InsightPairType::RegionLanguage)->Apply(bench::datasetSizes);
+BENCHMARK_CAPTURE(BM_GeneratePair, focus_course, InsightPairType::FocusCourse)->Apply(bench::datasetSizes);
+
+static void BM_GenerateGeneric(benchmark::State& state, const char* attrX, const char* attrY) {
+    const auto rows = static_cast<std::size_t>(state.range(0));
+    const auto& persons = bench::persons(rows);
+    InsightGenerator generator;
+    FingerprintSet suppressed;
+
+    for (auto _ : state) {
+        auto insights = generator.generateGeneric(persons, suppressed, attrX, attrY);
+        benchmark::DoNotOptimize(insights.data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * rows));
+}
+BENCHMARK_CAPTURE(BM_GenerateGeneric, enum_enum, "os", "study")->Apply(bench::datasetSizes);
+BENCHMARK_CAPTURE(BM_GenerateGeneric, tag_tag, "hobby", "language")->Apply(bench::datasetSizes);
+
+// the 36 pairs cmdDiscoverAll scores for the 9x9 heat map
+static void BM_DiscoverAll(benchmark::State& state) {
+    static const char* ATTRIBUTES[] = {
+        "os", "study", "color", "hobby", "region", "language", "focus", "course", "graduation"
+    };
+    constexpr std::size_t COUNT = sizeof(ATTRIBUTES) / sizeof(ATTRIBUTES[0]);
+
+    const auto rows = static_cast<std::size_t>(state.range(0));
+    const auto& persons = bench::persons(rows);
+    InsightGenerator generator;
+    FingerprintSet suppressed;
+
+    for (auto _ : state) {
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < COUNT; ++i) {
+            for (std::size_t j = i + 1; j < COUNT; ++j) {
+                total += generator.generateGeneric(persons, suppressed, ATTRIBUTES[i], ATTRIBUTES[j]).size();
+            }
+        }
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * rows));
+}
+BENCHMARK(BM_DiscoverAll)->Apply(bench::datasetSizes);
+
+// half of the generated insights blocked, filtered the post-hoc way
+static void BM_FilterBlocked(benchmark::State& state) {
+    const auto rows = static_cast<std::size_t>(state.range(0));
+    std::vector<Insight> insights;
+    insights.reserve(rows);
+    InsightStore store;
+    for (std::size_t i = 0; i < rows; ++i) {
+        std::string key = "insight_" + std::to_string(i);
+        if (i % 2 == 0) {
+            store.addBlockedKey(key);
+        }
+        insights.push_back(Insight::fromText(std::move(key), ""));
+    }
+
+    for (auto _ : state) {
+        auto kept = store.filterBlocked(insights);
+        benchmark::DoNotOptimize(kept.data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * rows));
+}
+BENCHMARK(BM_FilterBlocked)->Apply(bench::datasetSizes);
@@ -0,0 +1,66 @@
+#include "BenchData.h"
+#include "PersonBinaryReader.h"
+#include "PersonCsvReader.h"
+#include "PersonJsonReader.h"
+#include "PersonRepository.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <filesystem>
+
+static void BM_CsvRead(benchmark::State& state) {
+    const auto rows = static_cast<std::size_t>(state.range(0));
+    const std::string& path = bench::csvPath(rows);
+
+    for (auto _ : state) {
+        PersonCsvReader reader(path);
+        auto persons = reader.read();
+        benchmark::DoNotOptimize(persons.data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * rows));
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * std::filesystem::file_size(path)));
+}
+BENCHMARK(BM_CsvRead)->Apply(bench::datasetSizes);
+
+static void BM_BinaryRead(benchmark::State& state) {
+    const auto rows = static_cast<std::size_t>(state.range(0));
+    const std::string& path = bench::binaryPath(rows);
+
+    for (auto _ : state) {
+        PersonBinaryReader reader(path);
+        auto persons = reader.read();
+        benchmark::DoNotOptimize(persons.data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * rows));
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * std::filesystem::file_size(path)));
+}
+BENCHMARK(BM_BinaryRead)->Apply(bench::datasetSizes);
+
+static void BM_JsonParse(benchmark::State& state) {
+    const auto rows = static_cast<std::size_t>(state.range(0));
+    const std::string& json = bench::jsonText(rows);
+    PersonJsonReader reader("");
+
+    for (auto _ : state) {
+        auto persons = reader.parseJson(json);
+        benchmark::DoNotOptimize(persons.data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * rows));
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * json.size()));
+}
+BENCHMARK(BM_JsonParse)->Apply(bench::datasetSizes);
+
+static void BM_SaveToCsv(benchmark::State& state) {
+    const auto rows = static_cast<std::size_t>(state.range(0));
+    PersonRepository repo;
+    repo.setPersons(bench::persons(rows));
+    const std::string path = (std::filesystem::temp_directory_path() / "decoderscpp_bench_save.csv").string();
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(repo.saveToCsv(path));
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * rows));
+    std::remove(path.c_str());
+}
+BENCHMARK(BM_SaveToCsv)->Apply(bench::datasetSizes);
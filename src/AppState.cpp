@@ -1,5 +1,6 @@
 #include "AppState.h"
 #include "PersonCsvReader.h"
+#include "Tracer.h"
 
 #include <fstream>
 #include <iostream>  
@@ -50,6 +51,7 @@ void AppState::saveLastDatasetPath() const {
 }
 
 void AppState::loadDataset(const std::string& csvPath) {
+    trace::Span span("app.load_dataset", csvPath);
     PersonCsvReader reader(csvPath);
     std::vector<Person> people = reader.read();
 
@@ -0,0 +1,54 @@
+#include "Attribute.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace {
+std::string lowercase(std::string_view input) {
+    std::string result(input);
+    std::transform(result.begin(), result.end(), result.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return result;
+}
+} // namespace
+
+Attribute parse_attribute(const std::string& s) {
+    std::string normalized = lowercase(s);
+
+    // mapping synonyms to the main names to prevent errors
+    for (const AttributeInfo& info : attribute_registry()) {
+        if (normalized == info.name || normalized == lowercase(info.label)) {
+            return info.attr;
+        }
+        for (std::size_t i = 0; i < info.synonymCount; ++i) {
+            if (normalized == info.synonyms[i]) {
+                return info.attr;
+            }
+        }
+    }
+    return Attribute::Unknown;
+}
+
+const AttributeInfo* attribute_info(Attribute attr) {
+    std::size_t index = static_cast<std::size_t>(attr);
+    return index < ATTRIBUTE_COUNT ? &attribute_registry()[index] : nullptr;
+}
+
+std::string_view enum_name(Attribute attr) {
+    const AttributeInfo* info = attribute_info(attr);
+    return info ? info->name : "unknown";
+}
+
+std::string to_string(Attribute attr) {
+    return std::string(enum_name(attr));
+}
+
+bool is_tag_attribute(Attribute attr) {
+    const AttributeInfo* info = attribute_info(attr);
+    return info && info->multiValued;
+}
+
+std::string attribute_display_name(Attribute attr) {
+    const AttributeInfo* info = attribute_info(attr);
+    return std::string(info ? info->displayName : "unknown");
+}
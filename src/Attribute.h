@@ -0,0 +1,65 @@
+#ifndef ATTRIBUTE_H
+#define ATTRIBUTE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * The Person attributes insights can be generated over.
+ * Resolved once from user input ("os", "hobbies", "gradyear", ...) so the
+ * generators can work with a small id instead of comparing strings.
+ */
+enum class Attribute : std::uint8_t {
+    Os,
+    Study,
+    Color,
+    Hobby,
+    Region,
+    Language,
+    Focus,
+    Course,
+    Graduation,
+    Unknown
+};
+
+constexpr std::size_t ATTRIBUTE_COUNT = static_cast<std::size_t>(Attribute::Unknown);
+
+/**
+ * Runtime view of one attribute's AttributeTraits (AttributeRegistry.h), for code that
+ * only has an Attribute value: parsing, combo boxes, display text.
+ */
+struct AttributeInfo {
+    Attribute attr = Attribute::Unknown;
+    std::string_view name;           // key name, e.g. "os"
+    std::string_view displayName;    // in sentences, e.g. "primary OS"
+    std::string_view label;          // in the GUI, e.g. "Primary OS"
+    const std::string_view* synonyms = nullptr;
+    std::size_t synonymCount = 0;
+    bool multiValued = false;        // a set of free-form tags per person
+    bool numeric = false;            // an integer (course load, year) that can be binned
+    std::size_t cardinality = 0;     // distinct codes of a closed enum, 0 when open-ended
+};
+
+// every attribute, in enum order
+const std::array<AttributeInfo, ATTRIBUTE_COUNT>& attribute_registry();
+
+// nullptr for Unknown
+const AttributeInfo* attribute_info(Attribute attr);
+
+// accepts the name, the GUI label or any synonym, case-insensitive
+Attribute   parse_attribute(const std::string& s);
+
+// short name used in generic insight keys, e.g. "os", "study"
+std::string      to_string(Attribute attr);
+std::string_view enum_name(Attribute attr);
+
+// what gets shown to the user, e.g. "primary OS", "study time"
+std::string attribute_display_name(Attribute attr);
+
+// color, hobby and language hold a set of free-form tags per person; the rest one value
+bool is_tag_attribute(Attribute attr);
+
+#endif // ATTRIBUTE_H
@@ -0,0 +1,64 @@
+#include "AttributeRegistry.h"
+
+namespace {
+
+template <Attribute A>
+constexpr AttributeInfo makeInfo() {
+    using Traits = AttributeTraits<A>;
+    AttributeInfo info;
+    info.attr = A;
+    info.name = Traits::name;
+    info.displayName = Traits::displayName;
+    info.label = Traits::label;
+    info.synonyms = Traits::synonyms.data();
+    info.synonymCount = Traits::synonyms.size();
+    info.multiValued = Traits::multiValued;
+    info.numeric = Traits::numeric;
+    info.cardinality = Traits::cardinality;
+    return info;
+}
+
+template <Attribute A>
+constexpr CodeReader makeCodeReader() {
+    if constexpr (AttributeTraits<A>::multiValued) {
+        return nullptr;
+    } else {
+        return &AttributeTraits<A>::code;
+    }
+}
+
+// one entry per Attribute; a value without traits stops the build here
+template <std::size_t... I>
+constexpr std::array<AttributeInfo, ATTRIBUTE_COUNT> makeRegistry(std::index_sequence<I...>) {
+    return {{makeInfo<static_cast<Attribute>(I)>()...}};
+}
+
+template <std::size_t... I>
+constexpr std::array<ValueExtractor, ATTRIBUTE_COUNT> makeExtractors(std::index_sequence<I...>) {
+    return {{&attribute_values<static_cast<Attribute>(I)>...}};
+}
+
+template <std::size_t... I>
+constexpr std::array<CodeReader, ATTRIBUTE_COUNT> makeCodeReaders(std::index_sequence<I...>) {
+    return {{makeCodeReader<static_cast<Attribute>(I)>()...}};
+}
+
+constexpr auto REGISTRY = makeRegistry(std::make_index_sequence<ATTRIBUTE_COUNT>{});
+constexpr auto EXTRACTORS = makeExtractors(std::make_index_sequence<ATTRIBUTE_COUNT>{});
+constexpr auto CODE_READERS = makeCodeReaders(std::make_index_sequence<ATTRIBUTE_COUNT>{});
+
+} // namespace
+
+const std::array<AttributeInfo, ATTRIBUTE_COUNT>& attribute_registry() {
+    return REGISTRY;
+}
+
+ValueExtractor value_extractor(Attribute attr) {
+    std::size_t index = static_cast<std::size_t>(attr);
+    return index < ATTRIBUTE_COUNT ? EXTRACTORS[index] : nullptr;
+}
+
+CodeReader code_reader(Attribute attr) {
+    std::size_t index = static_cast<std::size_t>(attr);
+    return index < ATTRIBUTE_COUNT ? CODE_READERS[index] : nullptr;
+}
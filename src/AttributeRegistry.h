@@ -0,0 +1,220 @@
+#ifndef ATTRIBUTE_REGISTRY_H
+#define ATTRIBUTE_REGISTRY_H
+
+#include "Attribute.h"
+#include "Insight.h"
+#include "Person.h"
+#include "PersonEnums.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+/**
+ * Compile-time description of every Attribute: its names, the shape of its values and how
+ * to read them from a Person. This is the one place an attribute is defined; the runtime
+ * registry (attribute_registry), parse_attribute and the extractors below are all generated
+ * from these specializations, so an Attribute without one doesn't compile.
+ *
+ * Single-valued attributes have code(person), the value id or NO_VALUE when it's unknown, and
+ * text(code), the value as insights show it.
+ * Multi-valued (tag) attributes have tags(person), interned into an InsightValuePool by the
+ * extractors. cardinality is the number of distinct codes when it's a closed enum, 0 otherwise;
+ * numeric ones have integer codes that can be binned into ranges (see NumericBinning.h).
+ */
+template <Attribute A>
+struct AttributeTraits;
+
+constexpr std::uint32_t NO_VALUE = 0xFFFFFFFFu;
+
+template <>
+struct AttributeTraits<Attribute::Os> {
+    static constexpr std::string_view name = "os";
+    static constexpr std::string_view displayName = "primary OS";
+    static constexpr std::string_view label = "Primary OS";
+    static constexpr std::array<std::string_view, 2> synonyms{"primary_os", "primaryos"};
+    static constexpr bool multiValued = false;
+    static constexpr bool numeric = false;
+    static constexpr std::size_t cardinality = static_cast<std::size_t>(PrimaryOS::Unknown);
+
+    static std::uint32_t code(const Person& p) {
+        PrimaryOS os = p.getPrimaryOS();
+        return os == PrimaryOS::Unknown ? NO_VALUE : static_cast<std::uint32_t>(os);
+    }
+    static std::string text(std::uint32_t code) { return to_string(static_cast<PrimaryOS>(code)); }
+};
+
+template <>
+struct AttributeTraits<Attribute::Study> {
+    static constexpr std::string_view name = "study";
+    static constexpr std::string_view displayName = "study time";
+    static constexpr std::string_view label = "Study Time";
+    static constexpr std::array<std::string_view, 2> synonyms{"studytime", "study_time"};
+    static constexpr bool multiValued = false;
+    static constexpr bool numeric = false;
+    static constexpr std::size_t cardinality = static_cast<std::size_t>(StudyTime::Unknown);
+
+    static std::uint32_t code(const Person& p) {
+        StudyTime st = p.getStudyTime();
+        return st == StudyTime::Unknown ? NO_VALUE : static_cast<std::uint32_t>(st);
+    }
+    static std::string text(std::uint32_t code) { return to_string(static_cast<StudyTime>(code)); }
+};
+
+template <>
+struct AttributeTraits<Attribute::Color> {
+    static constexpr std::string_view name = "color";
+    static constexpr std::string_view displayName = "favorite color";
+    static constexpr std::string_view label = "Favorite Color";
+    static constexpr std::array<std::string_view, 3> synonyms{"favoritecolor", "favourite_color", "favoritecolors"};
+    static constexpr bool multiValued = true;
+    static constexpr bool numeric = false;
+    static constexpr std::size_t cardinality = 0;
+
+    static const std::unordered_set<std::string>& tags(const Person& p) { return p.getFavoriteColors(); }
+};
+
+template <>
+struct AttributeTraits<Attribute::Hobby> {
+    static constexpr std::string_view name = "hobby";
+    static constexpr std::string_view displayName = "hobby";
+    static constexpr std::string_view label = "Hobby";
+    static constexpr std::array<std::string_view, 1> synonyms{"hobbies"};
+    static constexpr bool multiValued = true;
+    static constexpr bool numeric = false;
+    static constexpr std::size_t cardinality = 0;
+
+    static const std::unordered_set<std::string>& tags(const Person& p) { return p.getHobbies(); }
+};
+
+template <>
+struct AttributeTraits<Attribute::Region> {
+    static constexpr std::string_view name = "region";
+    static constexpr std::string_view displayName = "region";
+    static constexpr std::string_view label = "Region";
+    static constexpr std::array<std::string_view, 1> synonyms{"area"};
+    static constexpr bool multiValued = false;
+    static constexpr bool numeric = false;
+    static constexpr std::size_t cardinality = static_cast<std::size_t>(Region::Unknown);
+
+    static std::uint32_t code(const Person& p) {
+        Region r = p.getRegion();
+        return r == Region::Unknown ? NO_VALUE : static_cast<std::uint32_t>(r);
+    }
+    static std::string text(std::uint32_t code) { return to_string(static_cast<Region>(code)); }
+};
+
+template <>
+struct AttributeTraits<Attribute::Language> {
+    static constexpr std::string_view name = "language";
+    static constexpr std::string_view displayName = "language";
+    static constexpr std::string_view label = "Language";
+    static constexpr std::array<std::string_view, 2> synonyms{"lang", "languages"};
+    static constexpr bool multiValued = true;
+    static constexpr bool numeric = false;
+    static constexpr std::size_t cardinality = 0;
+
+    static const std::unordered_set<std::string>& tags(const Person& p) { return p.getLanguages(); }
+};
+
+template <>
+struct AttributeTraits<Attribute::Focus> {
+    static constexpr std::string_view name = "focus";
+    static constexpr std::string_view displayName = "engineering focus";
+    static constexpr std::string_view label = "Engineering Focus";
+    static constexpr std::array<std::string_view, 4> synonyms{"major", "engineering", "engfocus", "engineeringfocus"};
+    static constexpr bool multiValued = false;
+    static constexpr bool numeric = false;
+    static constexpr std::size_t cardinality = static_cast<std::size_t>(EngineeringFocus::Unknown);
+
+    static std::uint32_t code(const Person& p) {
+        EngineeringFocus f = p.getEngineeringFocus();
+        return f == EngineeringFocus::Unknown ? NO_VALUE : static_cast<std::uint32_t>(f);
+    }
+    static std::string text(std::uint32_t code) { return to_string(static_cast<EngineeringFocus>(code)); }
+};
+
+template <>
+struct AttributeTraits<Attribute::Course> {
+    static constexpr std::string_view name = "course";
+    static constexpr std::string_view displayName = "course load";
+    static constexpr std::string_view label = "Course Load";
+    static constexpr std::array<std::string_view, 3> synonyms{"courseload", "load", "courses"};
+    static constexpr bool multiValued = false;
+    static constexpr bool numeric = true;
+    static constexpr std::size_t cardinality = 0;
+
+    static std::uint32_t code(const Person& p) {
+        int load = p.getCourseLoad();
+        return load > 0 ? static_cast<std::uint32_t>(load) : NO_VALUE;
+    }
+    static std::string text(std::uint32_t code) { return std::to_string(code); }
+};
+
+template <>
+struct AttributeTraits<Attribute::Graduation> {
+    static constexpr std::string_view name = "graduation";
+    static constexpr std::string_view displayName = "graduation year";
+    static constexpr std::string_view label = "Graduation Year";
+    static constexpr std::array<std::string_view, 2> synonyms{"gradyear", "year"};
+    static constexpr bool multiValued = false;
+    static constexpr bool numeric = true;
+    static constexpr std::size_t cardinality = 0;
+
+    static std::uint32_t code(const Person& p) {
+        int year = p.getGraduationYear();
+        return year > 0 ? static_cast<std::uint32_t>(year) : NO_VALUE;
+    }
+    static std::string text(std::uint32_t code) { return std::to_string(code); }
+};
+
+// the value ids of A for one person: its code, or its tags interned into `pool`
+template <Attribute A>
+void attribute_values(const Person& person, InsightValuePool& pool, std::vector<std::uint32_t>& out) {
+    out.clear();
+    if constexpr (AttributeTraits<A>::multiValued) {
+        for (const std::string& tag : AttributeTraits<A>::tags(person)) {
+            out.push_back(pool.intern(tag));
+        }
+    } else {
+        std::uint32_t code = AttributeTraits<A>::code(person);
+        if (code != NO_VALUE) {
+            out.push_back(code);
+        }
+    }
+}
+
+using ValueExtractor = void (*)(const Person&, InsightValuePool&, std::vector<std::uint32_t>&);
+using CodeReader = std::uint32_t (*)(const Person&);
+
+// resolved once per query, so the counting loops call straight into the accessor;
+// both return nullptr for Unknown, code_reader also for tag attributes
+ValueExtractor value_extractor(Attribute attr);
+CodeReader code_reader(Attribute attr);
+
+/**
+ * Calls f(std::integral_constant<Attribute, A>{}) with the A matching `attr` (which must not be
+ * Unknown), for code that wants one instantiation per attribute rather than a pointer.
+ */
+template <typename F, std::size_t... I>
+decltype(auto) visit_attribute_impl(Attribute attr, F&& f, std::index_sequence<I...>) {
+    using Result = decltype(f(std::integral_constant<Attribute, Attribute::Os>{}));
+    using Fn = Result (*)(F&&);
+    static constexpr Fn table[] = {
+        [](F&& g) -> Result { return g(std::integral_constant<Attribute, static_cast<Attribute>(I)>{}); }...
+    };
+    return table[static_cast<std::size_t>(attr)](std::forward<F>(f));
+}
+
+template <typename F>
+decltype(auto) visit_attribute(Attribute attr, F&& f) {
+    return visit_attribute_impl(attr, std::forward<F>(f), std::make_index_sequence<ATTRIBUTE_COUNT>{});
+}
+
+#endif // ATTRIBUTE_REGISTRY_H
@@ -1,27 +1,50 @@
 #include "Cli.h"
+#include "Instrumentation.h"
+#include "Tracer.h"
 #include <iostream>
 #include <sstream>
 #include <unordered_set>
 #include <algorithm>
+#include <cstdio>
 #include <map>
+#include <stdexcept>
+#include <utility>
 
 using namespace std;
 
-Cli::Cli() {
+namespace {
+
+// a whole non-negative number; stoul alone takes "5abc" as 5 and wraps "-5"
+size_t parse_count(const string& text) {
+    if (text.empty() || text[0] < '0' || text[0] > '9')
+        throw invalid_argument(text);
+    size_t used = 0;
+    size_t value = stoul(text, &used);
+    if (used != text.size())
+        throw invalid_argument(text);
+    return value;
+}
+
+}
+
+Cli::Cli(bool timing, OutputFormat format) : timing(timing), format(format) {
     // try loading saved knowledge
-    store.loadUseful("insights_saved.csv");
+    store.loadUseful("insights_saved.csv", true);
     store.loadBlocked("blocked_keys.txt");
 }
 
 void Cli::run() {
-    cout << "Insight Finder CLI\n";
-    cout << "Type 'help' for a list of commands.\n";
+    info() << "Insight Finder CLI\n";
+    info() << "Type 'help' for a list of commands.\n";
 
     string line;
 
     while (true) {
-        cout << "> ";
-        getline(cin, line);
+        info() << "> ";
+        if (!getline(cin, line)) {  // end of piped input or Ctrl-D
+            info() << "\n";
+            break;
+        }
 
         if (line.empty())
             continue;
@@ -30,231 +53,405 @@ void Cli::run() {
         string cmd;
         ss >> cmd;
 
-        if (cmd == "help") {
-            printHelp();
+        if (cmd == "quit" || cmd == "exit") {
+            info() << "Exiting...\n";
+            break;
         }
-        else if (cmd == "quit" || cmd == "exit") {
-            cout << "Exiting...\n";
+
+        execute(line);
+    }
+}
+
+int Cli::runBatch(const vector<string>& commands) {
+    batch = true;
+    for (size_t i = 0; i < commands.size(); i++) {
+        stringstream ss(commands[i]);
+        string cmd;
+        ss >> cmd;
+        if (cmd == "quit" || cmd == "exit")
             break;
+
+        if (!execute(commands[i])) {
+            cerr << "error: command " << (i + 1) << " failed: " << commands[i] << "\n";
+            return EXIT_COMMAND_FAILED;
         }
-        else if (cmd == "load") {
-            string path;
-            ss >> path;
-            cmdLoad(path);
-        }
-        else if (cmd == "load-json") {
-            cmdLoadJson();
-        }
-        else if (cmd == "load-json-custom") {
-            string url;
-            getline(ss, url);
-            // Trim leading whitespace
-            size_t start = url.find_first_not_of(" \t");
-            if (start != string::npos) {
-                url = url.substr(start);
-            }
-            if (url.empty()) {
-                cout << "Usage: load-json-custom <url>\n";
-                cout << "Example: load-json-custom http://example.com/data.json\n";
-            } else {
-                cmdLoadJsonCustom(url);
-            }
+    }
+    return EXIT_OK;
+}
+
+int Cli::runScript(istream& in) {
+    stringstream text;
+    text << in.rdbuf();
+    return runBatch(split_batch_commands(text.str()));
+}
+
+bool Cli::execute(const string& line) {
+    stringstream ss(line);
+    string cmd;
+    ss >> cmd;
+    if (cmd.empty())
+        return true;
+
+    vector<instr::PhaseEntry> before;
+    if (timing)
+        before = instr::snapshot();
+
+    bool ok = false;
+    try {
+        string phase = "cli." + cmd;
+        instr::ScopedTimer commandTimer(phase.c_str());
+        ok = dispatch(cmd, ss);
+    } catch (const exception& ex) {
+        // readers throw on missing files / columns; report it instead of dying
+        info() << "Error: " << ex.what() << "\n";
+        ok = false;
+    }
+
+    if (timing && cmd != "stats")
+        info() << instr::format_report(instr::difference(before, instr::snapshot()));
+    return ok;
+}
+
+vector<string> split_batch_commands(const string& text) {
+    vector<string> commands;
+    string current;
+    auto flush = [&]() {
+        size_t first = current.find_first_not_of(" \t\r");
+        if (first != string::npos) {
+            size_t last = current.find_last_not_of(" \t\r");
+            commands.push_back(current.substr(first, last - first + 1));
         }
-        else if (cmd == "save-dataset") {
-            cmdSaveDataset();
+        current.clear();
+    };
+
+    bool comment = false;  // '#' at the start of a command runs to the end of the line
+    for (char c : text) {
+        if (c == '\n') {
+            comment = false;
+            flush();
         }
-        else if (cmd == "save-as") {
-            string filename;
-            ss >> filename;
-            if (filename.empty()) {
-                cout << "Usage: save-as <filename.csv>\n";
-            } else {
-                cmdSaveAs(filename);
-            }
+        else if (comment) {
+            continue;
+        }
+        else if (c == ';') {
+            flush();
+        }
+        else if (c == '#' && current.find_first_not_of(" \t\r") == string::npos) {
+            comment = true;
+        }
+        else {
+            current += c;
+        }
+    }
+    flush();
+    return commands;
+}
+
+// runs one command; the rest of the line is still in ss for the arguments
+bool Cli::dispatch(const string& cmd, stringstream& ss) {
+    if (cmd == "help") {
+        printHelp();
+    }
+    else if (cmd == "load") {
+        string path;
+        ss >> path;
+        if (path.empty()) {
+            info() << "Usage: load <file.csv>\n";
+            return false;
+        }
+        return cmdLoad(path);
+    }
+    else if (cmd == "load-json") {
+        return cmdLoadJson();
+    }
+    else if (cmd == "load-json-custom") {
+        string url;
+        getline(ss, url);
+        // Trim leading whitespace
+        size_t start = url.find_first_not_of(" \t");
+        if (start != string::npos) {
+            url = url.substr(start);
         }
-        else if (cmd == "list") {
-            cmdListPeople();
+        if (url.empty()) {
+            info() << "Usage: load-json-custom <url>\n";
+            info() << "Example: load-json-custom http://example.com/data.json\n";
+            return false;
+        }
+        return cmdLoadJsonCustom(url);
+    }
+    else if (cmd == "save-dataset") {
+        return cmdSaveDataset();
+    }
+    else if (cmd == "save-as") {
+        string filename;
+        ss >> filename;
+        if (filename.empty()) {
+            info() << "Usage: save-as <filename.csv>\n";
+            return false;
         }
-        else if (cmd == "add") {
+        return cmdSaveAs(filename);
+    }
+    else if (cmd == "list") {
+        cmdListPeople();
+    }
+    else if (cmd == "add" || cmd == "edit") {
+        // both prompt field by field on stdin, which a script can't answer
+        if (batch) {
+            info() << "'" << cmd << "' is interactive and not available in batch mode.\n";
+            return false;
+        }
+        if (cmd == "add") {
             cmdAddPerson();
+            return true;
         }
-        else if (cmd == "edit") {
-            size_t idx;
-            ss >> idx;
-            cmdEditPerson(idx);
+        size_t idx;
+        if (!(ss >> idx)) {
+            info() << "Usage: edit <index>\n";
+            return false;
         }
-        else if (cmd == "remove") {
-            size_t idx;
-            ss >> idx;
-            cmdRemovePerson(idx);
+        return cmdEditPerson(idx);
+    }
+    else if (cmd == "remove") {
+        size_t idx;
+        if (!(ss >> idx)) {
+            info() << "Usage: remove <index>\n";
+            return false;
         }
+        return cmdRemovePerson(idx);
+    }
 
 
 
-        else if (cmd == "generate") { //same as the original generate
-            cmdGenerateAuto();
-        }
-        else if (cmd == "generate-auto") { //same as the original generate got error when i only have 1
-            cmdGenerateAuto();
-        }
-        else if (cmd == "generate-custom") {  // user picks categories
-            string topic_a, topic_b;
-            ss >> topic_a >> topic_b;
-            if (topic_a.empty() || topic_b.empty()) {
-                cout << "Usage: generate-custom <topic1> <topic2>\n";
-            } else {
-                cmdGenerateCustom(topic_a, topic_b);
+    else if (cmd == "generate" || cmd == "generate-auto") { //same as the original generate, optional top-k count
+        string k;
+        size_t limit = 0;
+        ss >> k;
+        try {
+            if (!k.empty()) {
+                limit = parse_count(k);
             }
+        } catch (const exception&) {
+            info() << "Usage: generate [top-k]\n";
+            return false;
         }
-        else if (cmd == "discover-best") {  // creative feature - 6x6 matrix
-            cmdDiscoverBest();
+        return cmdGenerateAuto(limit);
+    }
+    else if (cmd == "generate-custom") {  // user picks categories
+        string topic_a, topic_b, k;
+        size_t limit = 0;
+        ss >> topic_a >> topic_b >> k;
+        try {
+            if (!k.empty()) {
+                limit = parse_count(k);
+            }
+        } catch (const exception&) {
+            topic_b.clear();
         }
-        else if (cmd == "discover-all") {  // full 9x9 matrix
-            cmdDiscoverAll();
+        if (topic_a.empty() || topic_b.empty()) {
+            info() << "Usage: generate-custom <topic1> <topic2> [top-k]\n";
+            return false;
         }
+        return cmdGenerateCustom(topic_a, topic_b, limit);
+    }
+    else if (cmd == "mine") {  // multi-attribute rules
+        return cmdMine(ss);
+    }
+    else if (cmd == "query") {  // filter / group by / count
+        return cmdQuery(ss);
+    }
+    else if (cmd == "discover-best") {  // creative feature - 6x6 matrix
+        return cmdDiscoverBest();
+    }
+    else if (cmd == "discover-all") {  // full 9x9 matrix
+        return cmdDiscoverAll();
+    }
 
-        else if (cmd == "list-insights") {
-            cmdListInsights();
-        }
-        else if (cmd == "save") {
-            vector<size_t> idxs;
-            string filename = "insights_saved.csv";  // default
-            string token;
-            
-            // parse and optional filename
-            while (ss >> token) {
-                // error handling file name
-                if (token.find('.') != string::npos || token.find('/') != string::npos) {
-                    filename = token;
-                } else {
-                    // try to parse as index
-                    try {
-                        size_t idx = stoul(token);
-                        idxs.push_back(idx);
-                    } catch (...) {
-                        cout << "Invalid index or filename: " << token << "\n";
-                    }
+    else if (cmd == "list-insights") {
+        cmdListInsights();
+    }
+    else if (cmd == "save") {
+        vector<size_t> idxs;
+        string filename = "insights_saved.csv";  // default
+        bool badToken = false;
+        string token;
+        
+        // parse and optional filename
+        while (ss >> token) {
+            // error handling file name
+            if (token.find('.') != string::npos || token.find('/') != string::npos) {
+                filename = token;
+            } else {
+                // try to parse as index
+                try {
+                    size_t idx = stoul(token);
+                    idxs.push_back(idx);
+                } catch (...) {
+                    info() << "Invalid index or filename: " << token << "\n";
+                    badToken = true;
                 }
             }
-            cmdSaveUseful(idxs, filename);
-        }
-        else if (cmd == "discard") {
-            vector<size_t> idxs;
-            string filename = "blocked_keys.txt";  // default
-            string token;
-            
-            // parse  and optional filename
-            while (ss >> token) {
-                // check if filename
-                if (token.find('.') != string::npos || token.find('/') != string::npos) {
-                    filename = token;
-                } else {
-                    // parse as index
-                    try {
-                        size_t idx = stoul(token);
-                        idxs.push_back(idx);
-                    } catch (...) {
-                        cout << "Invalid index or filename: " << token << "\n";
-                    }
+        }
+        return cmdSaveUseful(idxs, filename) && !badToken;
+    }
+    else if (cmd == "discard") {
+        vector<size_t> idxs;
+        string filename = "blocked_keys.txt";  // default
+        bool badToken = false;
+        string token;
+        
+        // parse  and optional filename
+        while (ss >> token) {
+            // check if filename
+            if (token.find('.') != string::npos || token.find('/') != string::npos) {
+                filename = token;
+            } else {
+                // parse as index
+                try {
+                    size_t idx = stoul(token);
+                    idxs.push_back(idx);
+                } catch (...) {
+                    info() << "Invalid index or filename: " << token << "\n";
+                    badToken = true;
                 }
             }
-            cmdDiscard(idxs, filename);
-        }
-        else if (cmd == "list-saved") {
-            cmdListSaved();
-        }
-        else {
-            cout << "Unknown command. Type 'help'.\n";
         }
+        return cmdDiscard(idxs, filename) && !badToken;
+    }
+    else if (cmd == "list-saved") {
+        cmdListSaved();
+    }
+    else if (cmd == "trace") {
+        string action, filename;
+        ss >> action >> filename;
+        return cmdTrace(action, filename.empty() ? "trace.json" : filename);
+    }
+    else if (cmd == "format") {
+        string name;
+        ss >> name;
+        return cmdFormat(name);
+    }
+    else if (cmd == "cache") {
+        string action, arg;
+        ss >> action >> arg;
+        return cmdCache(action, arg);
     }
+    else if (cmd == "approx") {
+        string action, arg;
+        ss >> action >> arg;
+        return cmdApprox(action, arg);
+    }
+    else if (cmd == "sketch") {
+        string arg;
+        ss >> arg;
+        return cmdSketch(arg);
+    }
+    else if (cmd == "score") {
+        string mode;
+        ss >> mode;
+        return cmdScore(mode);
+    }
+    else if (cmd == "bins") {
+        string mode, count;
+        ss >> mode >> count;
+        return cmdBins(mode, count);
+    }
+    else if (cmd == "stats") {
+        string arg;
+        ss >> arg;
+        cmdStats(arg == "reset");
+    }
+    else {
+        info() << "Unknown command. Type 'help'.\n";
+        return false;
+    }
+    return true;
 }
 
-void Cli::cmdLoad(const string& path) {
+bool Cli::cmdLoad(const string& path) {
     PersonCsvReader reader(path);
     vector<Person> persons = reader.read();
 
-    repo.setPersons(persons);
+    repo.setPersons(std::move(persons));  // no second copy of the dataset
     currentDatasetPath = path;  //remember path for save-dataset
+    if (diskCache)
+        cache.setDiskDirectory(path + ".cache");
 
-    cout << "Loaded " << repo.size() << " people.\n";
+    info() << "Loaded " << repo.size() << " people.\n";
+    return true;
 }
 
-void Cli::cmdLoadJson() {
+bool Cli::cmdLoadJson() {
     // default URL from project requirements
     const string defaultUrl = "http://gist.githubusercontent.com/esolovey-bu/cba6c1b4eedd0a621ce879e6e6299d28/raw/sample_people.json?v=2";
     
-    cout << "Fetching JSON from default URL...\n";
-    cout << "URL: " << defaultUrl << "\n";
+    info() << "Fetching JSON from default URL...\n";
+    info() << "URL: " << defaultUrl << "\n";
     
     PersonJsonReader reader(defaultUrl);
     vector<Person> persons = reader.read();
     
     if (persons.empty()) {
-        cout << "Failed to load or no people found in JSON.\n";
-        return;
+        info() << "Failed to load or no people found in JSON.\n";
+        return false;
     }
     
-    repo.setPersons(persons);
+    repo.setPersons(std::move(persons));
     currentDatasetPath = "";  // JSON loaded, no local file path
-    cout << "Loaded " << repo.size() << " people from JSON.\n";
+    info() << "Loaded " << repo.size() << " people from JSON.\n";
+    return true;
 }
 
-void Cli::cmdLoadJsonCustom(const string& url) {
-    cout << "Fetching JSON from custom URL...\n";
-    cout << "URL: " << url << "\n";
+bool Cli::cmdLoadJsonCustom(const string& url) {
+    info() << "Fetching JSON from custom URL...\n";
+    info() << "URL: " << url << "\n";
     
     PersonJsonReader reader(url);
     vector<Person> persons = reader.read();
     
     if (persons.empty()) {
-        cout << "Failed to load or no people found in JSON.\n";
-        cout << "Make sure the URL is correct and returns valid JSON.\n";
-        return;
+        info() << "Failed to load or no people found in JSON.\n";
+        info() << "Make sure the URL is correct and returns valid JSON.\n";
+        return false;
     }
     
-    repo.setPersons(persons);
+    repo.setPersons(std::move(persons));
     currentDatasetPath = "";  // JSON loaded, no local file path
-    cout << "Loaded " << repo.size() << " people from custom JSON URL.\n";
+    info() << "Loaded " << repo.size() << " people from custom JSON URL.\n";
+    return true;
 }
 
-void Cli::cmdSaveDataset() {
+bool Cli::cmdSaveDataset() {
     if (currentDatasetPath.empty()) {
-        cout << "No dataset path set. Use 'save-as <filename.csv>' first.\n";
-        return;
+        info() << "No dataset path set. Use 'save-as <filename.csv>' first.\n";
+        return false;
     }
     
-    if (repo.saveToCsv(currentDatasetPath)) {
-        cout << "Dataset saved to: " << currentDatasetPath << "\n";
-    } else {
-        cout << "Failed to save dataset.\n";
+    if (!repo.saveToCsv(currentDatasetPath)) {
+        info() << "Failed to save dataset.\n";
+        return false;
     }
+    info() << "Dataset saved to: " << currentDatasetPath << "\n";
+    return true;
 }
 
-void Cli::cmdSaveAs(const string& filename) {
+bool Cli::cmdSaveAs(const string& filename) {
     if (repo.size() == 0) {
-        cout << "No data to save. Load a dataset first.\n";
-        return;
+        info() << "No data to save. Load a dataset first.\n";
+        return false;
     }
     
-    if (repo.saveToCsv(filename)) {
-        currentDatasetPath = filename;  // update current path
-        cout << "Dataset saved to: " << filename << "\n";
-    } else {
-        cout << "Failed to save dataset.\n";
+    if (!repo.saveToCsv(filename)) {
+        info() << "Failed to save dataset.\n";
+        return false;
     }
+    currentDatasetPath = filename;  // update current path
+    info() << "Dataset saved to: " << filename << "\n";
+    return true;
 }
 
 void Cli::cmdListPeople() const {
-    const auto& persons = repo.getAll();
-
-    if (persons.empty()) {
-        cout << "No people loaded.\n";
-        return;
-    }
-
-    for (size_t i = 0; i < persons.size(); i++) {
-        cout << i << ") " << persons[i].toString() << "\n";
-    }
+    BufferedWriter out(cout);
+    write_persons(out, repo.getAll(), format);
 }
 
 
@@ -272,69 +469,69 @@ void Cli::cmdListPeople() const {
 
 
 void Cli::cmdAddPerson() {
-    cout << "=== Add New Person ===\n";
+    info() << "=== Add New Person ===\n";
     string input;
     PersonBuilder builder;
     
     // ID
-    cout << "ID (nickname or identifier): ";
+    info() << "ID (nickname or identifier): ";
     getline(cin, input);
     if (input.empty()) {
-        cout << "Cancelled - ID required.\n";
+        info() << "Cancelled - ID required.\n";
         return;
     }
     builder.setId(input);
     
     // Graduation Year
-    cout << "Graduation Year (e.g., 2025): ";
+    info() << "Graduation Year (e.g., 2025): ";
     getline(cin, input);
     if (!input.empty()) builder.setGraduationYear(stoi(input));
     
     // Region
-    cout << "Region (us-northeast, us-west, china, etc.): ";
+    info() << "Region (us-northeast, us-west, china, etc.): ";
     getline(cin, input);
     if (!input.empty()) builder.setRegion(input);
     
     // Primary OS
-    cout << "Primary OS (Windows, MacOS, Linux): ";
+    info() << "Primary OS (Windows, MacOS, Linux): ";
     getline(cin, input);
     if (!input.empty()) builder.setPrimaryOS(input);
     
     // Engineering Focus
-    cout << "Engineering Focus (cybersecurity, electronics, etc.): ";
+    info() << "Engineering Focus (cybersecurity, electronics, etc.): ";
     getline(cin, input);
     if (!input.empty()) builder.setEngineeringFocus(input);
     
     // Study Time
-    cout << "Study Time (Morning, Afternoon, Night): ";
+    info() << "Study Time (Morning, Afternoon, Night): ";
     getline(cin, input);
     if (!input.empty()) builder.setStudyTime(input);
     
     // Course Load
-    cout << "Course Load (number of courses): ";
+    info() << "Course Load (number of courses): ";
     getline(cin, input);
     if (!input.empty()) builder.setCourseLoad(stoi(input));
     
     // Favorite Colors
-    cout << "Favorite Colors (comma-separated, e.g., blue,green): ";
+    info() << "Favorite Colors (comma-separated, e.g., blue,green): ";
     getline(cin, input);
     if (!input.empty()) builder.setColorsFromString(input);
     
     // Hobbies
-    cout << "Hobbies (comma-separated, e.g., gaming,reading): ";
+    info() << "Hobbies (comma-separated, e.g., gaming,reading): ";
     getline(cin, input);
     if (!input.empty()) builder.setHobbiesFromString(input);
     
     // Languages
-    cout << "Languages (comma-separated, e.g., english,spanish): ";
+    info() << "Languages (comma-separated, e.g., english,spanish): ";
     getline(cin, input);
     if (!input.empty()) builder.setLanguagesFromString(input);
     
     // Build and add person using PersonBuilder
     repo.addPerson(builder.build());
     
-    cout << "Person added! Total: " << repo.size() << " people.\n";
-    cout << "Use 'save-dataset' or 'save-as <file>' to save changes.\n";
+    info() << "Person added! Total: " << repo.size() << " people.\n";
+    info() << "Use 'save-dataset' or 'save-as <file>' to save changes.\n";
 }
 
 
@@ -352,15 +549,15 @@ void Cli::cmdAddPerson() {
 
 
 
-void Cli::cmdEditPerson(size_t index) {
+bool Cli::cmdEditPerson(size_t index) {
     if (index >= repo.size()) {
-        cout << "Invalid index.\n";
-        return;
+        info() << "Invalid index.\n";
+        return false;
     }
     
     const Person& current = repo.get(index);
-    cout << "=== Editing Person " << index << " ===\n";
-    cout << "Press Enter to keep current value.\n\n";
+    info() << "=== Editing Person " << index << " ===\n";
+    info() << "Press Enter to keep current value.\n\n";
     
     // Start with current values using PersonBuilder
     PersonBuilder builder;
@@ -369,75 +566,77 @@ void Cli::cmdEditPerson(size_t index) {
     string input;
     
     // ID
-    cout << "ID [" << current.getId() << "]: ";
+    info() << "ID [" << current.getId() << "]: ";
     getline(cin, input);
     if (!input.empty()) builder.setId(input);
     
     // Graduation Year
-    cout << "Graduation Year [" << current.getGraduationYear() << "]: ";
+    info() << "Graduation Year [" << current.getGraduationYear() << "]: ";
     getline(cin, input);
     if (!input.empty()) builder.setGraduationYear(stoi(input));
     
     // Region
-    cout << "Region [" << to_string(current.getRegion()) << "]: ";
+    info() << "Region [" << to_string(current.getRegion()) << "]: ";
     getline(cin, input);
     if (!input.empty()) builder.setRegion(input);
     
     // Primary OS
-    cout << "Primary OS [" << to_string(current.getPrimaryOS()) << "]: ";
+    info() << "Primary OS [" << to_string(current.getPrimaryOS()) << "]: ";
     getline(cin, input);
     if (!input.empty()) builder.setPrimaryOS(input);
     
     // Engineering Focus
-    cout << "Engineering Focus [" << to_string(current.getEngineeringFocus()) << "]: ";
+    info() << "Engineering Focus [" << to_string(current.getEngineeringFocus()) << "]: ";
     getline(cin, input);
     if (!input.empty()) builder.setEngineeringFocus(input);
     
     // Study Time
-    cout << "Study Time [" << to_string(current.getStudyTime()) << "]: ";
+    info() << "Study Time [" << to_string(current.getStudyTime()) << "]: ";
     getline(cin, input);
     if (!input.empty()) builder.setStudyTime(input);
     
     // Course Load
-    cout << "Course Load [" << current.getCourseLoad() << "]: ";
+    info() << "Course Load [" << current.getCourseLoad() << "]: ";
     getline(cin, input);
     if (!input.empty()) builder.setCourseLoad(stoi(input));
     
     // Favorite Colors
-    cout << "Current colors: ";
-    for (const auto& c : current.getFavoriteColors()) cout << c << " ";
-    cout << "\nNew colors (comma-separated, or Enter to keep): ";
+    info() << "Current colors: ";
+    for (const auto& c : current.getFavoriteColors()) info() << c << " ";
+    info() << "\nNew colors (comma-separated, or Enter to keep): ";
     getline(cin, input);
     if (!input.empty()) builder.setColorsFromString(input);
     
     // Hobbies
-    cout << "Current hobbies: ";
-    for (const auto& h : current.getHobbies()) cout << h << " ";
-    cout << "\nNew hobbies (comma-separated, or Enter to keep): ";
+    info() << "Current hobbies: ";
+    for (const auto& h : current.getHobbies()) info() << h << " ";
+    info() << "\nNew hobbies (comma-separated, or Enter to keep): ";
     getline(cin, input);
     if (!input.empty()) builder.setHobbiesFromString(input);
     
     // Languages
-    cout << "Current languages: ";
-    for (const auto& l : current.getLanguages()) cout << l << " ";
-    cout << "\nNew languages (comma-separated, or Enter to keep): ";
+    info() << "Current languages: ";
+    for (const auto& l : current.getLanguages()) info() << l << " ";
+    info() << "\nNew languages (comma-separated, or Enter to keep): ";
     getline(cin, input);
     if (!input.empty()) builder.setLanguagesFromString(input);
     
     // Build updated person and replace using PersonBuilder
     repo.updatePerson(index, builder.build());
     
-    cout << "Person updated!\n";
-    cout << "Use 'save-dataset' or 'save-as <file>' to save changes.\n";
+    info() << "Person updated!\n";
+    info() << "Use 'save-dataset' or 'save-as <file>' to save changes.\n";
+    return true;
 }
 
-void Cli::cmdRemovePerson(size_t index) {
+bool Cli::cmdRemovePerson(size_t index) {
     if (index >= repo.size()) {
-        cout << "Invalid index.\n";
-        return;
+        info() << "Invalid index.\n";
+        return false;
     }
     repo.removePerson(index);
-    cout << "Person removed.\n";
+    info() << "Person removed.\n";
+    return true;
 }
 
 
@@ -448,46 +647,77 @@ void Cli::cmdRemovePerson(size_t index) {
 
 
 
-void Cli::cmdGenerateAuto() {
-    cout << "Generating insights automatically...\n";
-
-    // Step 1: get people
-    vector<Person> all = repo.getAll();
-
-    // Step 2: get blocked keys
-    unordered_set<string> suppressedKeys;
-    // store already holds them internally but we pass nothing for now
-    // the generator receives them as a parameter
-    // store.filterBlocked will handle suppression after generation
+bool Cli::cmdGenerateAuto(size_t limit) {
+    // Step 1: get people (no copy)
+    const vector<Person>& all = repo.getAll();
+    if (all.empty()) {
+        info() << "No data loaded. Use 'load <csv>' first.\n";
+        return false;
+    }
 
-    // Step 3: generate everything
-    auto raw = generator.generate(all, suppressedKeys);
+    info() << "Generating insights automatically...\n";
 
-    // Step 4: filter based on InsightStore blocklist
-    lastGenerated = store.filterBlocked(raw);
+    // Step 2: generate everything (or only the best `limit`); the blocklist is
+    // checked inside the generator so blocked insights never get built
+    lastGenerated = cache.generate(all, repo.contentHash(), store.suppression(), limit);
 
-    cout << "Generated " << lastGenerated.size() << " insights.\n";
+    info() << "Generated " << lastGenerated.size() << " insights.\n";
+    return true;
 }
 
-void Cli::cmdGenerateCustom(const string& attr1, const string& attr2) {
-    cout << "Generating insights matching '" << attr1
-         << "' and '" << attr2 << "'...\n";
-
-    vector<Person> all = repo.getAll();
-    unordered_set<string> suppressedKeys;
+bool Cli::cmdGenerateCustom(const string& attr1, const string& attr2, size_t limit) {
+    for (const string& name : {attr1, attr2}) {
+        if (parse_attribute(name) == Attribute::Unknown) {
+            info() << "Unknown attribute '" << name << "'. Type 'help' to see the attributes.\n";
+            return false;
+        }
+    }
 
-    // generic generator for any combination
-    auto raw = generator.generateGeneric(all, suppressedKeys, attr1, attr2);
+    info() << "Generating insights matching '" << attr1
+         << "' and '" << attr2 << "'...\n";
 
-    // uses the blocklist
-    lastGenerated = store.filterBlocked(raw);
+    const vector<Person>& all = repo.getAll();
+
+    if (approximate) {
+        // sampled: not cached, each call draws its sample (same seed, so same result)
+        ApproximateInsights approx = generator.generateGenericApprox(
+            all, store.suppression(), attr1, attr2, sampling, verifySample, limit);
+
+        lastGenerated.clear();
+        size_t borderline = 0, verified = 0;
+        for (size_t i = 0; i < approx.insights.size(); ++i) {
+            const ApproximateInsight& a = approx.insights[i];
+            lastGenerated.push_back(a.insight);
+            if (a.borderline) ++borderline;
+            if (a.verified) ++verified;
+
+            char line[160];
+            snprintf(line, sizeof(line), "  %zu) confidence %.0f%% [%.0f%%, %.0f%%], support ~%.0f [%.0f, %.0f]%s\n",
+                     i, a.insight.confidence() * 100.0, a.confidence.low * 100.0, a.confidence.high * 100.0,
+                     (a.support.low + a.support.high) / 2.0, a.support.low, a.support.high,
+                     a.verified ? " (verified)" : a.borderline ? " (borderline)" : "");
+            info() << line;
+        }
+        info() << "Sampled " << approx.sampleRows << " of " << approx.populationRows << " rows; ";
+        if (verifySample && verified > 0) {
+            info() << "some were borderline, so all " << verified << " kept insight(s) were re-counted and scored on the full data.\n";
+        } else if (verifySample) {
+            info() << "nothing borderline to re-check.\n";
+        } else {
+            info() << borderline << " borderline insight(s) ('approx verify on' re-checks them exactly).\n";
+        }
+    } else {
+        // generic generator for any combination, uses the blocklist
+        lastGenerated = cache.generateGeneric(all, repo.contentHash(), store.suppression(), attr1, attr2, limit);
+    }
 
     if (lastGenerated.empty()) {
-        cout << "No insights matched those attributes.\n";
+        info() << "No insights matched those attributes.\n";
     } else {
-        cout << "Generated " << lastGenerated.size()
+        info() << "Generated " << lastGenerated.size()
              << " matching insights.\n";
     }
+    return true;
 }
 
 
@@ -497,24 +727,71 @@ void Cli::cmdGenerateCustom(const string& attr1, const string& attr2) {
 
 
 
-void Cli::cmdListInsights() const {
-    if (lastGenerated.empty()) {
-        cout << "No insights generated yet.\n";
-        return;
+bool Cli::cmdMine(stringstream& ss) {
+    RuleOptions options;
+    options.scoring = generator.scoring();
+    size_t limit = 0;
+    string key, value;
+    try {
+        while (ss >> key >> value) {
+            if (key == "support") options.minSupport = stod(value);
+            else if (key == "confidence") options.minConfidence = stod(value);
+            else if (key == "lift") options.minLift = stod(value);
+            else if (key == "length") options.maxLength = stoul(value);
+            else if (key == "top") limit = stoul(value);
+            else if (key == "threads") options.threads = static_cast<unsigned>(stoul(value));
+            else if (key == "attrs") {
+                stringstream list(value);
+                string name;
+                while (getline(list, name, ',')) {
+                    Attribute attr = parse_attribute(name);
+                    if (attr == Attribute::Unknown) throw invalid_argument(name);
+                    options.attributes.push_back(attr);
+                }
+            }
+            else throw invalid_argument(key);
+            key.clear();
+        }
+        if (!key.empty()) throw invalid_argument(key);
+
+        info() << "Mining rules (support " << options.minSupport * 100.0 << "%, confidence "
+               << options.minConfidence * 100.0 << "%, up to " << options.maxLength << " items)...\n";
+        MinedRules mined = RuleMiner(options).mine(repo.getAll(), store.suppression(), limit);
+        lastGenerated = std::move(mined.rules);
+        info() << "Found " << mined.frequentItemsets << " frequent itemsets over " << mined.frequentItems
+               << " items, " << lastGenerated.size() << " rules ('list-insights' shows them).\n";
+        return true;
+    } catch (const exception& e) {
+        info() << "Usage: mine [support <s>] [confidence <c>] [lift <l>] [length <k>] [top <n>]\n"
+               << "            [threads <t>] [attrs <a,b,...>]   (" << e.what() << ")\n";
+        return false;
     }
+}
 
-    for (size_t i = 0; i < lastGenerated.size(); i++) {
-        const Insight& x = lastGenerated[i];
-        cout << i << ") "
-             << "[Score " << x.score << "] "
-             << x.description << "\n";
+bool Cli::cmdQuery(stringstream& ss) {
+    string text;
+    getline(ss, text);
+    try {
+        QueryResult result = repo.query(parse_cohort_query(text));
+        BufferedWriter out(cout);
+        write_query_result(out, result, format);
+        return true;
+    } catch (const exception& e) {
+        info() << "Usage: query [attr=value[,value...]|attr=low-high]... [by attr[,attr...]] [avg attr]\n"
+               << "             [threads <t>]   (" << e.what() << ")\n";
+        return false;
     }
 }
 
-void Cli::cmdSaveUseful(const vector<size_t>& indexes, const string& filename) {
+void Cli::cmdListInsights() const {
+    BufferedWriter out(cout);
+    write_insights(out, lastGenerated, format);
+}
+
+bool Cli::cmdSaveUseful(const vector<size_t>& indexes, const string& filename) {
     if (indexes.empty()) {
-        cout << "Usage: save <index1> <index2> ... [filename.csv]\n";
-        return;
+        info() << "Usage: save <index1> <index2> ... [filename.csv]\n";
+        return false;
     }
 
     vector<Insight> chosen;
@@ -522,106 +799,294 @@ void Cli::cmdSaveUseful(const vector<size_t>& indexes, const string& filename) {
     for (size_t idx : indexes) {
         if (idx < lastGenerated.size()) {
             chosen.push_back(lastGenerated[idx]);
-            cout << "Saved insight: " << lastGenerated[idx].description << "\n";
+            info() << "Saved insight: " << lastGenerated[idx].description() << "\n";
         }
     }
 
-    store.saveUseful(chosen, filename);
-    cout << "Saved to: " << filename << "\n";
+    size_t added = store.saveUseful(chosen, filename);
+    if (added < chosen.size()) {
+        info() << (chosen.size() - added) << " of them were already saved.\n";
+    }
+    info() << "Saved to: " << filename << "\n";
+    return true;
 }
 
-void Cli::cmdDiscard(const vector<size_t>& indexes, const string& filename) {
+bool Cli::cmdDiscard(const vector<size_t>& indexes, const string& filename) {
     if (indexes.empty()) {
-        cout << "Usage: discard <index1> <index2> ... [filename.txt]\n";
-        return;
+        info() << "Usage: discard <index1> <index2> ... [filename.txt]\n";
+        return false;
     }
 
     for (size_t idx : indexes) {
         if (idx < lastGenerated.size()) {
-            store.addBlockedKey(lastGenerated[idx].key);
-            cout << "Discarded insight: " << lastGenerated[idx].description << "\n";
+            store.addBlockedKey(lastGenerated[idx].key());
+            info() << "Discarded insight: " << lastGenerated[idx].description() << "\n";
         }
     }
 
     store.saveBlocked(filename);
-    cout << "Blocked keys saved to: " << filename << "\n";
+    info() << "Blocked keys saved to: " << filename << "\n";
+    return true;
+}
+
+bool Cli::cmdFormat(const string& name) {
+    if (name.empty()) {
+        info() << "Output format: " << to_string(format) << "\n";
+        return true;
+    }
+    try {
+        format = parse_output_format(name);
+    } catch (const invalid_argument&) {
+        info() << "Usage: format text | json | ndjson | csv | binary\n";
+        return false;
+    }
+    info() << "Output format: " << to_string(format) << "\n";
+    return true;
+}
+
+bool Cli::cmdCache(const string& action, const string& arg) {
+    if (action.empty() || action == "stats") {
+        InsightCache::Stats s = cache.stats();
+        string directory = cache.diskDirectory();
+        info() << "Result cache: " << s.entries << " in memory, " << s.hits << " hits, "
+               << s.diskHits << " from disk, " << s.misses << " misses\n";
+        info() << "Disk tier: " << (directory.empty() ? "off" : directory) << "\n";
+    }
+    else if (action == "clear") {
+        cache.clear();
+        info() << "Result cache cleared (files on disk are kept).\n";
+    }
+    else if (action == "disk" && (arg == "on" || arg == "off")) {
+        diskCache = arg == "on";
+        // next to the dataset; picked up by the next load if nothing is loaded from a file yet
+        cache.setDiskDirectory(diskCache && !currentDatasetPath.empty() ? currentDatasetPath + ".cache" : "");
+        info() << "Disk cache " << arg << ".\n";
+    }
+    else {
+        info() << "Usage: cache [stats] | clear | disk on|off\n";
+        return false;
+    }
+    return true;
+}
+
+bool Cli::cmdApprox(const string& action, const string& arg) {
+    try {
+        if (action == "on" || action == "off") {
+            approximate = action == "on";
+        }
+        else if (action == "rows" && !arg.empty()) {
+            sampling.size = stoul(arg);
+            approximate = true;
+        }
+        else if (action == "margin" && !arg.empty()) {
+            double margin = stod(arg);
+            sample_size_for_margin(margin);   // validates
+            sampling.margin = margin;
+            sampling.size = 0;
+            approximate = true;
+        }
+        else if (action == "stratify" && !arg.empty()) {
+            Attribute by = arg == "none" ? Attribute::Unknown : parse_attribute(arg);
+            if (is_tag_attribute(by) || (by == Attribute::Unknown && arg != "none")) {
+                info() << "Can only stratify by os, study, region, focus, course or graduation.\n";
+                return false;
+            }
+            sampling.stratifyBy = by;
+        }
+        else if (action == "verify" && (arg == "on" || arg == "off")) {
+            verifySample = arg == "on";
+        }
+        else if (!action.empty()) {
+            info() << "Usage: approx [on|off] | rows <n> | margin <m> | stratify <attr|none> | verify on|off\n";
+            return false;
+        }
+    } catch (const exception&) {
+        info() << "Invalid value: " << arg << "\n";
+        return false;
+    }
+
+    info() << "Approximate mode: " << (approximate ? "on" : "off") << ", ";
+    if (sampling.size != 0) {
+        info() << sampling.size << " rows";
+    } else {
+        info() << sample_size_for_margin(sampling.margin) << " rows (margin " << sampling.margin << ")";
+    }
+    info() << ", " << (sampling.stratifyBy == Attribute::Unknown ? "uniform" : "stratified by " + to_string(sampling.stratifyBy))
+           << ", verify " << (verifySample ? "on" : "off") << "\n";
+    return true;
+}
+
+bool Cli::cmdSketch(const string& arg) {
+    if (arg == "off") {
+        generator.setTagSketchCapacity(0);
+    }
+    else if (!arg.empty()) {
+        try {
+            size_t counters = stoul(arg);
+            if (counters == 0) {
+                throw invalid_argument(arg);
+            }
+            generator.setTagSketchCapacity(counters);
+        } catch (const exception&) {
+            info() << "Usage: sketch [off|<counters>]\n";
+            return false;
+        }
+    }
+
+    if (generator.tagSketchCapacity() == 0) {
+        info() << "Tag counting: exact\n";
+    } else {
+        info() << "Tag counting: sketched, " << generator.tagSketchCapacity() << " counters per cohort\n";
+    }
+    return true;
+}
+
+bool Cli::cmdScore(const string& mode) {
+    if (!mode.empty()) {
+        try {
+            generator.setScoring(parse_scoring_mode(mode));
+        } catch (const invalid_argument&) {
+            info() << "Usage: score [confidence|lift|leverage|chi2|gtest|bayes]\n";
+            return false;
+        }
+    }
+    info() << "Scoring: " << to_string(generator.scoring()) << "\n";
+    return true;
+}
+
+bool Cli::cmdBins(const string& mode, const string& count) {
+    if (!mode.empty()) {
+        try {
+            BinningOptions options = generator.binning();
+            options.mode = parse_binning_mode(mode);
+            if (!count.empty()) {
+                options.bins = stoul(count);
+            }
+            if (options.bins < 2) {
+                throw invalid_argument(count);
+            }
+            generator.setBinning(options);
+        } catch (const exception&) {
+            info() << "Usage: bins [off|width|quantile] [bins]\n";
+            return false;
+        }
+    }
+
+    const BinningOptions& binning = generator.binning();
+    if (binning.mode == BinningMode::Off) {
+        info() << "Numeric binning: off\n";
+    } else {
+        info() << "Numeric binning: " << binning.bins
+               << (binning.mode == BinningMode::EqualWidth ? " equal-width" : " quantile")
+               << " ranges for course load and graduation year\n";
+    }
+    return true;
+}
+
+// discover-* in approximate mode; says how exact the result is
+vector<PairScore> Cli::approximatePairs(const vector<Person>& all, const FingerprintSet& suppressed,
+                                        const vector<string>& attributes) {
+    ApproximatePairScores approx = generator.scorePairsApprox(all, suppressed, attributes, sampling);
+    char line[128];
+    snprintf(line, sizeof(line), "Approximate: sampled %zu of %zu rows, proportions +-%.1f%% (95%%), wider for small cohorts\n\n",
+             approx.sampleRows, approx.populationRows, approx.margin * 100.0);
+    info() << line;
+    return std::move(approx.pairs);
+}
+
+ostream& Cli::info() const {
+    return format == OutputFormat::Text ? cout : cerr;
+}
+
+void Cli::cmdStats(bool reset) {
+    if (!instr::enabled()) {
+        info() << "Instrumentation was compiled out (DECODERSCPP_INSTRUMENTATION=OFF).\n";
+        return;
+    }
+    if (reset) {
+        instr::reset();
+        info() << "Timing stats cleared.\n";
+        return;
+    }
+    info() << instr::format_report(instr::snapshot());
+}
+
+bool Cli::cmdTrace(const string& action, const string& filename) {
+    if (!instr::enabled()) {
+        info() << "Tracing was compiled out (DECODERSCPP_INSTRUMENTATION=OFF).\n";
+        return false;
+    }
+    if (action == "start") {
+        trace::start();
+        info() << "Tracing started.\n";
+    }
+    else if (action == "stop") {
+        trace::stop();
+        info() << "Tracing stopped.\n";
+    }
+    else if (action == "dump") {
+        if (trace::write_chrome_trace(filename))
+            info() << "Trace written to: " << filename << " (open in https://ui.perfetto.dev)\n";
+        else {
+            info() << "Could not write trace to: " << filename << "\n";
+            return false;
+        }
+    }
+    else {
+        info() << "Usage: trace start | stop | dump [file.json]\n";
+        return false;
+    }
+    return true;
 }
 
 void Cli::cmdListSaved() const {
     const auto& saved = store.getUseful();
     if (saved.empty()) {
-        cout << "No saved insights.\n";
+        info() << "No saved insights.\n";
         return;
     }
 
     for (size_t i = 0; i < saved.size(); i++) {
-        cout << i << ") " << saved[i].description
+        info() << i << ") " << saved[i].description()
              << " (score=" << saved[i].score << ")\n";
     }
 }
 
-void Cli::cmdDiscoverBest() {
-    cout << "===========================================\n";
-    cout << "  DISCOVERING STRONGEST RELATIONSHIPS\n";
-    cout << "===========================================\n\n";
-    cout << "6x6 Heat Map (36 cells, 15 unique pairs)\n";
-    cout << "Use 'discover-all' for 9x9 heat map (81 cells, 36 pairs).\n\n";
+bool Cli::cmdDiscoverBest() {
+    info() << "===========================================\n";
+    info() << "  DISCOVERING STRONGEST RELATIONSHIPS\n";
+    info() << "===========================================\n\n";
+    info() << "6x6 Heat Map (36 cells, 15 unique pairs)\n";
+    info() << "Use 'discover-all' for 9x9 heat map (81 cells, 36 pairs).\n\n";
 
     //edge case
-    vector<Person> all = repo.getAll();
+    const vector<Person>& all = repo.getAll();
     if (all.empty()) {
-        cout << "No data loaded. Use 'load <csv>' first.\n";
-        return;
+        info() << "No data loaded. Use 'load <csv>' first.\n";
+        return false;
     }
 
-    unordered_set<string> suppressedKeys;
+    FingerprintSet suppressedKeys;
 
     // Define 6 core attributes (original)
     vector<string> attributes = {
         "os", "study", "color", "hobby", "region", "language"
     };
 
-    struct CombinationResult {
-        string attrX;
-        string attrY;
-        int count = 0;
-        int totalScore = 0;
-        double avgScore = 0.0;
-    };
-
-    vector<CombinationResult> results;
+    // test all combinations, sorted by average score in descending order
+    vector<PairScore> results = approximate
+        ? approximatePairs(all, suppressedKeys, attributes)
+        : cache.scorePairs(all, repo.contentHash(), suppressedKeys, attributes);
 
-    // test all combinations
-    for (size_t i = 0; i < attributes.size(); i++) {
-        for (size_t j = i + 1; j < attributes.size(); j++) {
-            auto insights = generator.generateGeneric(all, suppressedKeys, 
-                                                     attributes[i], attributes[j]);
-            
-            if (!insights.empty()) {
-                CombinationResult result;
-                result.attrX = attributes[i];
-                result.attrY = attributes[j];
-                result.count = insights.size();
-                
-                for (const auto& ins : insights) {
-                    result.totalScore += ins.score;
-                }
-                result.avgScore = static_cast<double>(result.totalScore) / result.count;
-                
-                results.push_back(result);
-            }
-        }
+    if (format != OutputFormat::Text) {
+        BufferedWriter out(cout);
+        write_pair_scores(out, results, format);
+        return true;
     }
 
-    // sort by average score in descending order
-    sort(results.begin(), results.end(), 
-         [](const CombinationResult& a, const CombinationResult& b) {
-             return a.avgScore > b.avgScore;
-         });
-
     // shows top 10 strongest relationships
-    cout << "TOP 10 STRONGEST RELATIONSHIPS:\n";
-    cout << "============================================\n\n";
+    info() << "TOP 10 STRONGEST RELATIONSHIPS:\n";
+    info() << "============================================\n\n";
 
     int displayCount = min(10, static_cast<int>(results.size()));
     for (int i = 0; i < displayCount; i++) {
@@ -631,10 +1096,10 @@ void Cli::cmdDiscoverBest() {
         int barLength = static_cast<int>(r.avgScore / 5);
         string bar(barLength, '#');
         
-        cout << i + 1 << ". " << r.attrX << " ←→ " << r.attrY << "\n";
-        cout << "   Avg Score: " << static_cast<int>(r.avgScore) << "/100  ";
-        cout << bar << "\n";
-        cout << "   Insights Found: " << r.count << "\n\n";
+        info() << i + 1 << ". " << r.attrX << " ←→ " << r.attrY << "\n";
+        info() << "   Avg Score: " << static_cast<int>(r.avgScore) << "/100  ";
+        info() << bar << "\n";
+        info() << "   Insights Found: " << r.count << "\n\n";
     }
 
     // lookup map 
@@ -651,26 +1116,26 @@ void Cli::cmdDiscoverBest() {
     const string RESET = "\033[0m";  // reset color
 
     // matrix 1 symbols 
-    cout << "============================================\n";
-    cout << "CORRELATION STRENGTH MATRIX (SYMBOLS):\n";
-    cout << "============================================\n\n";
-    cout << "Legend: " << YELLOW << "." << RESET << " <50 (weak)  " << ORANGE << "+" << RESET << " 50-65 (moderate)  " << RED << "*" << RESET << " >65 (strong)\n\n";
+    info() << "============================================\n";
+    info() << "CORRELATION STRENGTH MATRIX (SYMBOLS):\n";
+    info() << "============================================\n\n";
+    info() << "Legend: " << YELLOW << "." << RESET << " <50 (weak)  " << ORANGE << "+" << RESET << " 50-65 (moderate)  " << RED << "*" << RESET << " >65 (strong)\n\n";
 
     // display attribute labels
-    cout << "        ";
+    info() << "        ";
     for (const auto& attr : attributes) {
-        cout << attr.substr(0, 4) << " ";
+        info() << attr.substr(0, 4) << " ";
     }
-    cout << "\n";
+    info() << "\n";
 
     // show symbol matrix
     for (size_t i = 0; i < attributes.size(); i++) {
-        cout << attributes[i].substr(0, 7);
-        for (size_t pad = attributes[i].length(); pad < 8; pad++) cout << " ";
+        info() << attributes[i].substr(0, 7);
+        for (size_t pad = attributes[i].length(); pad < 8; pad++) info() << " ";
         
         for (size_t j = 0; j < attributes.size(); j++) {
             if (i == j) {
-                cout << " -   ";
+                info() << " -   ";
             } else {
                 auto it = scoreMap.find({attributes[i], attributes[j]});
                 if (it != scoreMap.end()) {
@@ -681,36 +1146,36 @@ void Cli::cmdDiscoverBest() {
                     else if (score >= 50) { symbol = '+'; color = ORANGE; }
                     else { symbol = '.'; color = YELLOW; }
                     
-                    cout << " " << color << symbol << RESET << "   ";
+                    info() << " " << color << symbol << RESET << "   ";
                 } else {
-                    cout << " -   ";
+                    info() << " -   ";
                 }
             }
         }
-        cout << "\n";
+        info() << "\n";
     }
 
     // matrix 2: numbers
-    cout << "\n============================================\n";
-    cout << "CORRELATION STRENGTH MATRIX (SCORES):\n";
-    cout << "============================================\n\n";
-    cout << "Color Scale: " << YELLOW << "<50" << RESET << " (weak)  " << ORANGE << "50-65" << RESET << " (moderate)  " << RED << ">65" << RESET << " (strong)\n\n";
+    info() << "\n============================================\n";
+    info() << "CORRELATION STRENGTH MATRIX (SCORES):\n";
+    info() << "============================================\n\n";
+    info() << "Color Scale: " << YELLOW << "<50" << RESET << " (weak)  " << ORANGE << "50-65" << RESET << " (moderate)  " << RED << ">65" << RESET << " (strong)\n\n";
 
     // display attribute labels
-    cout << "        ";
+    info() << "        ";
     for (const auto& attr : attributes) {
-        cout << attr.substr(0, 4) << "  ";
+        info() << attr.substr(0, 4) << "  ";
     }
-    cout << "\n";
+    info() << "\n";
 
     // show score matrix 
     for (size_t i = 0; i < attributes.size(); i++) {
-        cout << attributes[i].substr(0, 7);
-        for (size_t pad = attributes[i].length(); pad < 8; pad++) cout << " ";
+        info() << attributes[i].substr(0, 7);
+        for (size_t pad = attributes[i].length(); pad < 8; pad++) info() << " ";
         
         for (size_t j = 0; j < attributes.size(); j++) {
             if (i == j) {
-                cout << "  --  ";
+                info() << "  --  ";
             } else {
                 auto it = scoreMap.find({attributes[i], attributes[j]});
                 if (it != scoreMap.end()) {
@@ -720,85 +1185,68 @@ void Cli::cmdDiscoverBest() {
                     else if (scoreInt >= 50) color = ORANGE;
                     else color = YELLOW;
                     
-                    if (scoreInt < 10) cout << "  ";
-                    else if (scoreInt < 100) cout << " ";
-                    cout << color << scoreInt << RESET << "  ";
+                    if (scoreInt < 10) info() << "  ";
+                    else if (scoreInt < 100) info() << " ";
+                    info() << color << scoreInt << RESET << "  ";
                 } else {
-                    cout << "  --  ";
+                    info() << "  --  ";
                 }
             }
         }
-        cout << "\n";
+        info() << "\n";
     }
 
-    cout << "\n============================================\n";
-    cout << "Use 'generate-custom <attr1> <attr2>' to explore!\n";
-    cout << "============================================\n";
+    info() << "\n============================================\n";
+    info() << "Use 'generate-custom <attr1> <attr2>' to explore!\n";
+    info() << "============================================\n";
+    return true;
 }
 
-void Cli::cmdDiscoverAll() {
-    cout << "===========================================\n";
-    cout << "  FULL RELATIONSHIP ANALYSIS (9x9)\n";
-    cout << "===========================================\n\n";
-    cout << "9x9 Heat Map (81 cells, 36 unique pairs)\n\n";
+bool Cli::cmdDiscoverAll() {
+    info() << "===========================================\n";
+    info() << "  FULL RELATIONSHIP ANALYSIS (9x9)\n";
+    info() << "===========================================\n\n";
+    info() << "9x9 Heat Map (81 cells, 36 unique pairs)\n\n";
 
-    vector<Person> all = repo.getAll();
+    const vector<Person>& all = repo.getAll();
     if (all.empty()) {
-        cout << "No data loaded. Use 'load <csv>' first.\n";
-        return;
+        info() << "No data loaded. Use 'load <csv>' first.\n";
+        return false;
     }
 
-    unordered_set<string> suppressedKeys;
-
-    // 9 attributes
-    vector<string> attributes = {
-        "os", "study", "color", "hobby", "region", "language", "focus", "course", "graduation"
-    };
-
-    struct CombinationResult {
-        string attrX;
-        string attrY;
-        int count = 0;
-        int totalScore = 0;
-        double avgScore = 0.0;
-    };
+    FingerprintSet suppressedKeys;
 
-    vector<CombinationResult> results;
+    // every registered attribute
+    vector<string> attributes;
+    for (const AttributeInfo& entry : attribute_registry()) {
+        attributes.emplace_back(entry.name);
+    }
 
-    for (size_t i = 0; i < attributes.size(); i++) {
-        for (size_t j = i + 1; j < attributes.size(); j++) {
-            auto insights = generator.generateGeneric(all, suppressedKeys, 
-                                                     attributes[i], attributes[j]);
-            if (!insights.empty()) {
-                CombinationResult result;
-                result.attrX = attributes[i];
-                result.attrY = attributes[j];
-                result.count = insights.size();
-                for (const auto& ins : insights) {
-                    result.totalScore += ins.score;
-                }
-                result.avgScore = static_cast<double>(result.totalScore) / result.count;
-                results.push_back(result);
-            }
-        }
+    vector<PairScore> results;
+    {
+        trace::Span matrixSpan("discover_all.matrix");
+        results = approximate
+            ? approximatePairs(all, suppressedKeys, attributes)
+            : cache.scorePairs(all, repo.contentHash(), suppressedKeys, attributes);
     }
 
-    sort(results.begin(), results.end(), 
-         [](const CombinationResult& a, const CombinationResult& b) {
-             return a.avgScore > b.avgScore;
-         });
+    if (format != OutputFormat::Text) {
+        BufferedWriter out(cout);
+        write_pair_scores(out, results, format);
+        return true;
+    }
 
-    cout << "TOP 10 STRONGEST RELATIONSHIPS:\n";
-    cout << "============================================\n\n";
+    info() << "TOP 10 STRONGEST RELATIONSHIPS:\n";
+    info() << "============================================\n\n";
 
     int displayCount = min(10, static_cast<int>(results.size()));
     for (int i = 0; i < displayCount; i++) {
         const auto& r = results[i];
         int barLength = static_cast<int>(r.avgScore / 5);
         string bar(barLength, '#');
-        cout << i + 1 << ". " << r.attrX << " <-> " << r.attrY << "\n";
-        cout << "   Avg Score: " << static_cast<int>(r.avgScore) << "/100  " << bar << "\n";
-        cout << "   Insights Found: " << r.count << "\n\n";
+        info() << i + 1 << ". " << r.attrX << " <-> " << r.attrY << "\n";
+        info() << "   Avg Score: " << static_cast<int>(r.avgScore) << "/100  " << bar << "\n";
+        info() << "   Insights Found: " << r.count << "\n\n";
     }
 
     map<pair<string, string>, double> scoreMap;
@@ -812,26 +1260,26 @@ void Cli::cmdDiscoverAll() {
     const string YELLOW = "\033[93m";
     const string RESET = "\033[0m";
 
-    cout << "============================================\n";
-    cout << "FULL 9x9 CORRELATION MATRIX:\n";
-    cout << "============================================\n\n";
-    cout << "Color Scale: " << YELLOW << "<50" << RESET << " (weak)  " 
+    info() << "============================================\n";
+    info() << "FULL 9x9 CORRELATION MATRIX:\n";
+    info() << "============================================\n\n";
+    info() << "Color Scale: " << YELLOW << "<50" << RESET << " (weak)  " 
          << ORANGE << "50-65" << RESET << " (moderate)  " 
          << RED << ">65" << RESET << " (strong)\n\n";
 
-    cout << "        ";
+    info() << "        ";
     for (const auto& attr : attributes) {
-        cout << attr.substr(0, 4) << "  ";
+        info() << attr.substr(0, 4) << "  ";
     }
-    cout << "\n";
+    info() << "\n";
 
     for (size_t i = 0; i < attributes.size(); i++) {
-        cout << attributes[i].substr(0, 7);
-        for (size_t pad = attributes[i].length(); pad < 8; pad++) cout << " ";
+        info() << attributes[i].substr(0, 7);
+        for (size_t pad = attributes[i].length(); pad < 8; pad++) info() << " ";
         
         for (size_t j = 0; j < attributes.size(); j++) {
             if (i == j) {
-                cout << "  --  ";
+                info() << "  --  ";
             } else {
                 auto it = scoreMap.find({attributes[i], attributes[j]});
                 if (it != scoreMap.end()) {
@@ -841,50 +1289,69 @@ void Cli::cmdDiscoverAll() {
                     else if (scoreInt >= 50) color = ORANGE;
                     else color = YELLOW;
                     
-                    if (scoreInt < 10) cout << "  ";
-                    else if (scoreInt < 100) cout << " ";
-                    cout << color << scoreInt << RESET << "  ";
+                    if (scoreInt < 10) info() << "  ";
+                    else if (scoreInt < 100) info() << " ";
+                    info() << color << scoreInt << RESET << "  ";
                 } else {
-                    cout << "  --  ";
+                    info() << "  --  ";
                 }
             }
         }
-        cout << "\n";
+        info() << "\n";
     }
 
-    cout << "\n============================================\n";
-    cout << "Use 'generate-custom <attr1> <attr2>' to explore!\n";
-    cout << "============================================\n";
+    info() << "\n============================================\n";
+    info() << "Use 'generate-custom <attr1> <attr2>' to explore!\n";
+    info() << "============================================\n";
+    return true;
 }
 
 void Cli::printHelp() const {
-    cout << "Commands:\n";
-    cout << "\n  === Data Loading ===\n";
-    cout << "  load <csv>              Load dataset from CSV file\n";
-    cout << "  load-json               Load from default JSON URL\n";
-    cout << "  load-json-custom <url>  Load from custom JSON URL\n";
-    cout << "  list                    List loaded people\n";
-    cout << "\n  === Data Persistence ===\n";
-    cout << "  save-dataset            Save to current CSV file\n";
-    cout << "  save-as <file.csv>      Save dataset to new file\n";
-    cout << "\n  === Person Management ===\n";
-    cout << "  add                     Add a person\n";
-    cout << "  edit <index>            Edit a person\n";
-    cout << "  remove <index>          Remove a person\n";
-    cout << "\n  === Insight Generation ===\n";
-    cout << "  generate                Generate all 4 default insights\n";
-    cout << "  generate-auto           Same as 'generate'\n";
-    cout << "  generate-custom a b     Generate insights for ANY attribute pair\n";
-    cout << "                          Supports: os, study, color, hobby, region,\n";
-    cout << "                                    language, focus, course, graduation\n";
-    cout << "  discover-best           6x6 heat map (36 cells, 15 pairs)\n";
-    cout << "  discover-all            9x9 heat map (81 cells, 36 pairs)\n";
-    cout << "\n  === Insight Management ===\n";
-    cout << "  list-insights           Show generated insights\n";
-    cout << "  save <i1 i2...> [file]  Save insights (default: insights_saved.csv)\n";
-    cout << "  discard <i1 i2...> [file] Block insights (default: blocked_keys.txt)\n";
-    cout << "  list-saved              Show saved insights\n";
-    cout << "\n  === General ===\n";
-    cout << "  help                    Show this list\n";
-    cout << "  quit                    Exit program\n";
+    info() << "Commands:\n";
+    info() << "\n  === Data Loading ===\n";
+    info() << "  load <csv>              Load dataset from CSV file\n";
+    info() << "  load-json               Load from default JSON URL\n";
+    info() << "  load-json-custom <url>  Load from custom JSON URL\n";
+    info() << "  list                    List loaded people\n";
+    info() << "\n  === Data Persistence ===\n";
+    info() << "  save-dataset            Save to current CSV file\n";
+    info() << "  save-as <file.csv>      Save dataset to new file\n";
+    info() << "\n  === Person Management ===\n";
+    info() << "  add                     Add a person\n";
+    info() << "  edit <index>            Edit a person\n";
+    info() << "  remove <index>          Remove a person\n";
+    info() << "\n  === Insight Generation ===\n";
+    info() << "  generate [k]            Generate all 4 default insights (only top k if given)\n";
+    info() << "  generate-auto [k]       Same as 'generate'\n";
+    info() << "  generate-custom a b [k] Generate insights for ANY attribute pair\n";
+    info() << "                          Supports: os, study, color, hobby, region,\n";
+    info() << "                                    language, focus, course, graduation\n";
+    info() << "  mine [support s] [confidence c] [lift l] [length k] [top n] [threads t] [attrs a,b]\n";
+    info() << "                          Multi-attribute rules, e.g. os & study -> hobby\n";
+    info() << "  discover-best           6x6 heat map (36 cells, 15 pairs)\n";
+    info() << "  discover-all            9x9 heat map (81 cells, 36 pairs)\n";
+    info() << "\n  === Insight Management ===\n";
+    info() << "  list-insights           Show generated insights\n";
+    info() << "  save <i1 i2...> [file]  Save insights (default: insights_saved.csv)\n";
+    info() << "  discard <i1 i2...> [file] Block insights (default: blocked_keys.txt)\n";
+    info() << "  list-saved              Show saved insights\n";
+    info() << "\n  === General ===\n";
+    info() << "  format [fmt]            Output of list/list-insights/discover-*: text, json,\n";
+    info() << "                          ndjson, csv or binary\n";
+    info() << "  cache [stats|clear]     Result cache for generate/discover\n";
+    info() << "  cache disk on|off       Also keep cached results in <dataset>.cache/\n";
+    info() << "  approx [on|off]         generate-custom / discover-* on a sample, with intervals\n";
+    info() << "  approx rows <n> | margin <m>  Sample size, or the +- a sample should give\n";
+    info() << "  approx stratify <attr|none>   Stratified sample by a single-valued attribute\n";
+    info() << "  approx verify on|off    Re-count borderline approximate insights exactly\n";
+    info() << "  sketch [off|<counters>] Count hobby/color/language Ys in bounded memory\n";
+    info() << "  score [mode]            Rank by confidence (default), lift, leverage, chi2,\n";
+    info() << "                          gtest or bayes\n";
+    info() << "  bins [off|width|quantile] [n]  Group course load / graduation year into n ranges\n";
+    info() << "  query <filters> [by a,b] [avg attr]  Count people per group, e.g.\n";
+    info() << "                          query os=linux region=dach study=night by hobby\n";
+    info() << "  stats [reset]           Time, rows/s, bytes/s and allocations per phase\n";
+    info() << "  trace start|stop|dump [file]  Record spans, write Chrome trace JSON\n";
+    info() << "  help                    Show this list\n";
+    info() << "  quit                    Exit program\n";
 }
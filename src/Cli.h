@@ -5,53 +5,103 @@
 #include "PersonCsvReader.h"
 #include "PersonJsonReader.h"
 #include "PersonBuilder.h"
+#include "InsightCache.h"
 #include "InsightGenerator.h"
 #include "InsightStore.h"
+#include "OutputWriter.h"
+#include "RuleMiner.h"
+#include "Sampling.h"
 
+#include <istream>
+#include <sstream>
 #include <string>
 #include <vector>
 
 using namespace std;
 
+// Splits batch input into single commands: one per line or separated by ';'.
+// Blank entries and '#' comment lines are dropped.
+vector<string> split_batch_commands(const string& text);
+
 // CLI provides all user-facing text commands.
 class Cli {
 public:
-    Cli();
+    // timing = print the phases each command went through (the --timing flag)
+    // format = how list, list-insights and discover-* print (the --format flag)
+    explicit Cli(bool timing = false, OutputFormat format = OutputFormat::Text);
 
     // Starts the command loop
     void run();
 
+    // Batch mode: runs the commands in order without prompts and stops at the first
+    // one that fails. Returns the process exit code (0 ok, 1 a command failed).
+    int runBatch(const vector<string>& commands);
+    int runScript(istream& in);
+
+    // Runs a single command line; false if it failed (bad usage, unknown command,
+    // failed load/save, or an exception from a reader).
+    bool execute(const string& line);
+
+    // exit codes for main
+    static constexpr int EXIT_OK = 0;
+    static constexpr int EXIT_COMMAND_FAILED = 1;
+    static constexpr int EXIT_USAGE = 2;
+
 private:
     PersonRepository repo;
     InsightGenerator generator;
+    InsightCache cache{generator};   // generate/discover results by dataset + blocklist + query
     InsightStore store;
     string currentDatasetPath;  // data persistence
+    bool diskCache = false;     // keep cached results in <dataset>.cache/ ("cache disk on")
+    bool timing = false;
+    bool batch = false;         // no prompts; add/edit are refused
+    OutputFormat format = OutputFormat::Text;
+    bool approximate = false;   // generate-custom / discover-* run on a sample ("approx")
+    bool verifySample = false;  // re-count borderline approximate insights on the full data
+    SampleOptions sampling;
 
     vector<Insight> lastGenerated;   // cached insights from "generate"
 
-    // Commands
-    void cmdLoad(const string& path);
-    void cmdLoadJson();  // default URL
-    void cmdLoadJsonCustom(const string& url); //user  URL
-    void cmdSaveDataset();  // save to current file
-    void cmdSaveAs(const string& filename);  // save to new file
+    // Commands (the ones that can fail return false so batch mode can stop)
+    bool cmdLoad(const string& path);
+    bool cmdLoadJson();  // default URL
+    bool cmdLoadJsonCustom(const string& url); //user  URL
+    bool cmdSaveDataset();  // save to current file
+    bool cmdSaveAs(const string& filename);  // save to new file
     void cmdListPeople() const;
     void cmdAddPerson();
-    void cmdEditPerson(size_t index);
-    void cmdRemovePerson(size_t index);
+    bool cmdEditPerson(size_t index);
+    bool cmdRemovePerson(size_t index);
 
-    void cmdGenerateAuto(); // original generate function
-    void cmdGenerateCustom(const std::string& a, const std::string& b);
-    void cmdDiscoverBest();  // 6x6 heat map (36 cells, 15 pairs)
-    void cmdDiscoverAll();   // 9x9 heat map (81 cells, 36 pairs)
+    bool cmdGenerateAuto(size_t limit = 0); // original generate function, limit > 0 keeps only the top results
+    bool cmdGenerateCustom(const std::string& a, const std::string& b, size_t limit = 0);
+    bool cmdDiscoverBest();  // 6x6 heat map (36 cells, 15 pairs)
+    bool cmdDiscoverAll();   // 9x9 heat map (81 cells, 36 pairs)
+    bool cmdMine(stringstream& ss);   // association rules over all attributes
+    bool cmdQuery(stringstream& ss);  // filter / group by / count or average
 
     void cmdListInsights() const;
-    void cmdSaveUseful(const vector<size_t>& indexes, const string& filename);
-    void cmdDiscard(const vector<size_t>& indexes, const string& filename);
+    bool cmdSaveUseful(const vector<size_t>& indexes, const string& filename);
+    bool cmdDiscard(const vector<size_t>& indexes, const string& filename);
 
     void cmdListSaved() const;
+    void cmdStats(bool reset);   // everything the instrumentation recorded so far
+    bool cmdTrace(const string& action, const string& filename);
+
+    bool cmdFormat(const string& name);
+    bool cmdCache(const string& action, const string& arg);
+    bool cmdApprox(const string& action, const string& arg);
+    bool cmdSketch(const string& arg);
+    bool cmdScore(const string& mode);
+    bool cmdBins(const string& mode, const string& count);
 
     // helper
+    bool dispatch(const string& cmd, stringstream& ss);
+    vector<PairScore> approximatePairs(const vector<Person>& all, const FingerprintSet& suppressed,
+                                       const vector<string>& attributes);
+    // where messages go: stdout for text, stderr otherwise so stdout only carries data
+    ostream& info() const;
     void printHelp() const;
 };
 
@@ -0,0 +1,452 @@
+#include "CohortQuery.h"
+
+#include "AttributeRegistry.h"
+#include "Bits.h"
+#include "Instrumentation.h"
+#include "Tracer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+// below this many words (64 rows each) a chunk isn't worth its own thread
+constexpr std::size_t MIN_WORDS_PER_THREAD = 256;
+
+// grouped ids are packed 16 bits each into one 64-bit key
+constexpr std::size_t GROUP_ID_BITS = 16;
+
+std::string lowercase(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+bool equalsIgnoreCase(const std::string& a, const std::string& b) {
+    if (a.size() != b.size()) return false;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i])))
+            return false;
+    }
+    return true;
+}
+
+std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> parts;
+    std::istringstream in(text);
+    std::string part;
+    while (std::getline(in, part, ',')) {
+        if (!part.empty()) parts.push_back(part);
+    }
+    return parts;
+}
+
+Attribute attributeNamed(const std::string& name) {
+    Attribute attr = parse_attribute(name);
+    if (attr == Attribute::Unknown) {
+        throw std::invalid_argument("Unknown attribute: " + name);
+    }
+    return attr;
+}
+
+long long parseNumber(const std::string& text) {
+    std::size_t used = 0;
+    long long value = std::stoll(text, &used);
+    if (used != text.size()) {
+        throw std::invalid_argument("Not a number: " + text);
+    }
+    return value;
+}
+
+struct Aggregate {
+    std::size_t count = 0;
+    double sum = 0.0;
+    std::size_t averaged = 0;
+};
+
+using GroupMap = std::unordered_map<std::uint64_t, Aggregate>;
+
+}
+
+CohortQuery parse_cohort_query(const std::string& text) {
+    CohortQuery query;
+    std::istringstream in(text);
+    std::string token;
+
+    while (in >> token) {
+        std::string word = lowercase(token);
+        if (word == "where" || word == "and") {
+            continue;
+        }
+        if (word == "by") {
+            std::string list;
+            if (!(in >> list)) throw std::invalid_argument("'by' needs attributes, e.g. by study,region");
+            for (const std::string& name : splitList(list)) {
+                Attribute attr = attributeNamed(name);
+                if (std::find(query.groupBy.begin(), query.groupBy.end(), attr) != query.groupBy.end()) {
+                    throw std::invalid_argument("Grouped by " + to_string(attr) + " twice");
+                }
+                query.groupBy.push_back(attr);
+            }
+            continue;
+        }
+        if (word == "avg" || word == "average") {
+            std::string name;
+            if (!(in >> name)) throw std::invalid_argument("'avg' needs a numeric attribute");
+            query.average = attributeNamed(name);
+            continue;
+        }
+        if (word == "threads") {
+            std::string count;
+            if (!(in >> count)) throw std::invalid_argument("'threads' needs a number");
+            query.threads = static_cast<unsigned>(parseNumber(count));
+            continue;
+        }
+
+        std::size_t eq = token.find('=');
+        if (eq == std::string::npos || eq == 0 || eq + 1 == token.size()) {
+            throw std::invalid_argument("Expected attribute=value, got: " + token);
+        }
+        QueryPredicate predicate;
+        predicate.attr = attributeNamed(token.substr(0, eq));
+        std::string value = token.substr(eq + 1);
+
+        // "4-6" on a number is a range; region names have dashes too, so only numbers get this
+        std::size_t dash = value.find('-', 1);
+        if (attribute_info(predicate.attr)->numeric && dash != std::string::npos) {
+            predicate.isRange = true;
+            predicate.low = parseNumber(value.substr(0, dash));
+            predicate.high = parseNumber(value.substr(dash + 1));
+            if (predicate.low > predicate.high) {
+                throw std::invalid_argument("Empty range: " + value);
+            }
+        } else {
+            predicate.values = splitList(value);
+        }
+        query.filters.push_back(std::move(predicate));
+    }
+
+    if (query.groupBy.size() > CohortQuery::MAX_GROUP_BY) {
+        throw std::invalid_argument("Can group by at most " + std::to_string(CohortQuery::MAX_GROUP_BY) + " attributes");
+    }
+    if (query.average != Attribute::Unknown && !attribute_info(query.average)->numeric) {
+        throw std::invalid_argument("Can only average a numeric attribute, not " + to_string(query.average));
+    }
+    return query;
+}
+
+// ------------------------------------------------------------
+// Index
+// ------------------------------------------------------------
+
+PersonIndex::PersonIndex(const std::vector<Person>& persons)
+    : m_persons(persons), m_rows(persons.size()), m_words((persons.size() + 63) / 64) {}
+
+const PersonIndex::Column& PersonIndex::column(Attribute attr) const {
+    const std::size_t slot = static_cast<std::size_t>(attr);
+    std::call_once(m_built[slot], [&] {
+        visit_attribute(attr, [&](auto a) { buildColumn<decltype(a)::value>(m_columns[slot]); });
+        ++m_builtColumns;
+    });
+    return m_columns[slot];
+}
+
+template <Attribute A>
+void PersonIndex::buildColumn(Column& column) const {
+    using Traits = AttributeTraits<A>;
+    instr::ScopedTimer timer("query.index");
+    timer.addRows(m_rows);
+    column.multiValued = Traits::multiValued;
+    column.numeric = Traits::numeric;
+
+    // ids first, counting how many rows have each; indexRows then sizes their rows to fit
+    std::vector<std::size_t> support;
+    if constexpr (Traits::multiValued) {
+        std::unordered_map<std::string, std::uint32_t> idOf;
+        column.offsets.reserve(m_rows + 1);
+        column.offsets.push_back(0);
+        for (std::size_t row = 0; row < m_rows; ++row) {
+            for (const std::string& tag : Traits::tags(m_persons[row])) {
+                auto [it, added] = idOf.emplace(tag, static_cast<std::uint32_t>(column.dictionary.size()));
+                if (added) {
+                    column.dictionary.push_back(tag);
+                    support.push_back(0);
+                }
+                column.tagIds.push_back(it->second);
+                support[it->second]++;
+            }
+            column.offsets.push_back(static_cast<std::uint32_t>(column.tagIds.size()));
+        }
+    } else {
+        std::unordered_map<std::uint32_t, std::uint32_t> idOf;
+        column.ids.assign(m_rows, NO_ID);
+        for (std::size_t row = 0; row < m_rows; ++row) {
+            std::uint32_t code = Traits::code(m_persons[row]);
+            if (code == NO_VALUE) {
+                continue;
+            }
+            auto [it, added] = idOf.emplace(code, static_cast<std::uint32_t>(column.dictionary.size()));
+            if (added) {
+                column.dictionary.push_back(Traits::text(code));
+                if (Traits::numeric) column.numbers.push_back(code);
+                support.push_back(0);
+            }
+            column.ids[row] = it->second;
+            support[it->second]++;
+        }
+    }
+    indexRows(column, support);
+}
+
+// a row list costs 4 bytes a row against the bitmap's n/8, so values on fewer than one row
+// in 32 are listed
+void PersonIndex::indexRows(Column& column, const std::vector<std::size_t>& support) const {
+    const std::size_t values = column.dictionary.size();
+    column.bitmaps.resize(values);
+    column.lists.resize(values);
+    for (std::size_t id = 0; id < values; ++id) {
+        if (support[id] < 2 * m_words) {
+            column.lists[id].reserve(support[id]);
+        } else {
+            column.bitmaps[id].assign(m_words, 0);
+        }
+    }
+
+    auto add = [&](std::uint32_t id, std::size_t row) {
+        if (column.bitmaps[id].empty()) {
+            column.lists[id].push_back(static_cast<std::uint32_t>(row));
+        } else {
+            column.bitmaps[id][row / 64] |= std::uint64_t{1} << (row % 64);
+        }
+    };
+    for (std::size_t row = 0; row < m_rows; ++row) {
+        if (column.multiValued) {
+            for (std::uint32_t i = column.offsets[row]; i < column.offsets[row + 1]; ++i) {
+                add(column.tagIds[i], row);
+            }
+        } else if (column.ids[row] != NO_ID) {
+            add(column.ids[row], row);
+        }
+    }
+}
+
+// the rows passing every filter, as a bitmap; the rows themselves are never read
+std::vector<std::uint64_t> PersonIndex::select(const std::vector<QueryPredicate>& filters) const {
+    std::vector<std::uint64_t> selection(m_words, ~std::uint64_t{0});
+    if (m_rows % 64 != 0) {
+        selection.back() = (std::uint64_t{1} << (m_rows % 64)) - 1;
+    }
+
+    std::vector<std::uint64_t> any(m_words);
+    for (const QueryPredicate& predicate : filters) {
+        const AttributeInfo* info = attribute_info(predicate.attr);
+        if (!info) {
+            throw std::invalid_argument("Can't filter on an unknown attribute");
+        }
+        const Column& column = this->column(predicate.attr);
+        if (predicate.isRange && !column.numeric) {
+            throw std::invalid_argument("Ranges only work on numeric attributes, not " + to_string(predicate.attr));
+        }
+
+        // OR of the matching values' rows, then AND into the selection
+        std::fill(any.begin(), any.end(), 0);
+        for (std::size_t id = 0; id < column.dictionary.size(); ++id) {
+            bool hit = predicate.isRange
+                ? column.numbers[id] >= predicate.low && column.numbers[id] <= predicate.high
+                : std::any_of(predicate.values.begin(), predicate.values.end(),
+                              [&](const std::string& v) { return equalsIgnoreCase(column.dictionary[id], v); });
+            if (!hit) {
+                continue;
+            }
+            if (column.bitmaps[id].empty()) {
+                for (std::uint32_t row : column.lists[id]) {
+                    any[row / 64] |= std::uint64_t{1} << (row % 64);
+                }
+                continue;
+            }
+            const std::uint64_t* bits = column.bitmaps[id].data();
+            for (std::size_t w = 0; w < m_words; ++w) {
+                any[w] |= bits[w];
+            }
+        }
+        for (std::size_t w = 0; w < m_words; ++w) {
+            selection[w] &= any[w];
+        }
+    }
+    return selection;
+}
+
+QueryResult PersonIndex::run(const CohortQuery& query) const {
+    instr::ScopedTimer timer("query.run");
+    timer.addRows(m_rows);
+    trace::Span span("query.run");
+
+    if (query.groupBy.size() > CohortQuery::MAX_GROUP_BY) {
+        throw std::invalid_argument("Can group by at most " + std::to_string(CohortQuery::MAX_GROUP_BY) + " attributes");
+    }
+    for (Attribute attr : query.groupBy) {
+        if (!attribute_info(attr)) {
+            throw std::invalid_argument("Can't group by an unknown attribute");
+        }
+        if (column(attr).dictionary.size() > (std::size_t{1} << GROUP_ID_BITS)) {
+            throw std::invalid_argument("Too many distinct values to group by " + to_string(attr));
+        }
+    }
+    const bool averaging = query.average != Attribute::Unknown;
+    if (averaging && !(attribute_info(query.average) && attribute_info(query.average)->numeric)) {
+        throw std::invalid_argument("Can only average a numeric attribute, not " + to_string(query.average));
+    }
+
+    QueryResult result;
+    result.groupBy = query.groupBy;
+    result.average = query.average;
+    result.population = m_rows;
+
+    const std::vector<std::uint64_t> selection = select(query.filters);
+    for (std::uint64_t word : selection) {
+        result.matched += static_cast<std::size_t>(popcount64(word));
+    }
+
+    if (query.groupBy.empty() && !averaging) {
+        QueryGroup everyone;
+        everyone.count = result.matched;
+        result.groups.push_back(std::move(everyone));
+        return result;
+    }
+
+    if (query.groupBy.size() == 1 && !averaging) {
+        // per value, a popcount of the selection against its bitmap or a bit test per listed row
+        const Column& column = this->column(query.groupBy[0]);
+        for (std::size_t id = 0; id < column.dictionary.size(); ++id) {
+            std::size_t count = 0;
+            if (column.bitmaps[id].empty()) {
+                for (std::uint32_t row : column.lists[id]) {
+                    count += static_cast<std::size_t>((selection[row / 64] >> (row % 64)) & 1);
+                }
+            } else {
+                const std::uint64_t* bits = column.bitmaps[id].data();
+                for (std::size_t w = 0; w < m_words; ++w) {
+                    count += static_cast<std::size_t>(popcount64(selection[w] & bits[w]));
+                }
+            }
+            if (count != 0) {
+                QueryGroup group;
+                group.values.push_back(column.dictionary[id]);
+                group.count = count;
+                result.groups.push_back(std::move(group));
+            }
+        }
+    } else {
+        const std::size_t groupCount = query.groupBy.size();
+        std::array<const Column*, CohortQuery::MAX_GROUP_BY> grouped{};
+        for (std::size_t g = 0; g < groupCount; ++g) {
+            grouped[g] = &column(query.groupBy[g]);
+        }
+        const Column* averaged = averaging ? &column(query.average) : nullptr;
+
+        unsigned threads = query.threads != 0 ? query.threads : std::max(1u, std::thread::hardware_concurrency());
+        threads = static_cast<unsigned>(std::max<std::size_t>(1, std::min<std::size_t>(threads, m_words / MIN_WORDS_PER_THREAD)));
+        std::vector<GroupMap> partial(threads);
+
+        // each thread walks the selected rows of its share of the words into its own map
+        auto aggregateChunk = [&](unsigned t) {
+            GroupMap& groups = partial[t];
+            const std::size_t begin = m_words * t / threads;
+            const std::size_t end = m_words * (t + 1) / threads;
+            std::array<const std::uint32_t*, CohortQuery::MAX_GROUP_BY> first{}, last{}, cursor{};
+
+            for (std::size_t w = begin; w < end; ++w) {
+                for (std::uint64_t word = selection[w]; word != 0; word &= word - 1) {
+                    const std::size_t row = w * 64 + static_cast<std::size_t>(lowest_bit(word));
+
+                    // each grouped attribute's ids for this row: its value, or all of its tags
+                    bool hasGroup = true;
+                    for (std::size_t g = 0; g < groupCount && hasGroup; ++g) {
+                        const Column& column = *grouped[g];
+                        if (column.multiValued) {
+                            first[g] = column.tagIds.data() + column.offsets[row];
+                            last[g] = column.tagIds.data() + column.offsets[row + 1];
+                        } else {
+                            first[g] = &column.ids[row];
+                            last[g] = first[g] + (column.ids[row] == NO_ID ? 0 : 1);
+                        }
+                        hasGroup = first[g] != last[g];
+                    }
+                    if (!hasGroup) {
+                        continue;   // no value to be grouped under
+                    }
+
+                    const std::uint32_t averagedId = averaged ? averaged->ids[row] : NO_ID;
+
+                    // one group per combination, so a person with 3 hobbies counts in 3 hobby groups
+                    cursor = first;
+                    for (bool more = true; more;) {
+                        std::uint64_t key = 0;
+                        for (std::size_t g = 0; g < groupCount; ++g) {
+                            key = (key << GROUP_ID_BITS) | *cursor[g];
+                        }
+                        Aggregate& cell = groups[key];
+                        cell.count++;
+                        if (averagedId != NO_ID) {
+                            cell.sum += static_cast<double>(averaged->numbers[averagedId]);
+                            cell.averaged++;
+                        }
+
+                        more = false;
+                        for (std::size_t g = groupCount; g-- > 0;) {
+                            if (++cursor[g] != last[g]) {
+                                more = true;
+                                break;
+                            }
+                            cursor[g] = first[g];
+                        }
+                    }
+                }
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < threads; ++t) {
+            workers.emplace_back(aggregateChunk, t);
+        }
+        aggregateChunk(0);
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+
+        GroupMap& merged = partial[0];
+        for (unsigned t = 1; t < threads; ++t) {
+            for (const auto& [key, part] : partial[t]) {
+                Aggregate& total = merged[key];
+                total.count += part.count;
+                total.sum += part.sum;
+                total.averaged += part.averaged;
+            }
+        }
+
+        const std::uint64_t idMask = (std::uint64_t{1} << GROUP_ID_BITS) - 1;
+        for (const auto& [key, aggregate] : merged) {
+            QueryGroup group;
+            group.values.resize(groupCount);
+            std::uint64_t rest = key;
+            for (std::size_t g = groupCount; g-- > 0;) {
+                group.values[g] = grouped[g]->dictionary[static_cast<std::size_t>(rest & idMask)];
+                rest >>= GROUP_ID_BITS;
+            }
+            group.count = aggregate.count;
+            group.averaged = aggregate.averaged;
+            group.average = aggregate.averaged ? aggregate.sum / static_cast<double>(aggregate.averaged) : 0.0;
+            result.groups.push_back(std::move(group));
+        }
+    }
+
+    std::sort(result.groups.begin(), result.groups.end(), [](const QueryGroup& a, const QueryGroup& b) {
+        if (a.count != b.count) return a.count > b.count;
+        return a.values < b.values;
+    });
+    return result;
+}
@@ -0,0 +1,118 @@
+#ifndef COHORT_QUERY_H
+#define COHORT_QUERY_H
+
+#include "Attribute.h"
+#include "Person.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * One filter of a CohortQuery: the attribute is any of `values` (the text insights show,
+ * case-insensitive) or, for a numeric attribute, a number from `low` to `high`.
+ * For a tag attribute it holds when any of the person's tags does.
+ */
+struct QueryPredicate {
+    Attribute attr = Attribute::Unknown;
+    std::vector<std::string> values;
+    bool isRange = false;
+    long long low = 0;
+    long long high = 0;
+};
+
+/**
+ * "Filter by predicates, group by attributes, count / average", e.g. how many Linux users
+ * in DACH study at night, or the average graduation year per region and study time.
+ */
+struct CohortQuery {
+    static constexpr std::size_t MAX_GROUP_BY = 4;
+
+    std::vector<QueryPredicate> filters;       // all of them have to hold
+    std::vector<Attribute> groupBy;            // a tag attribute puts a person in one group per tag
+    Attribute average = Attribute::Unknown;    // numeric attribute averaged per group, if any
+    unsigned threads = 0;                      // 0 = one per core
+};
+
+struct QueryGroup {
+    std::vector<std::string> values;   // one per groupBy attribute
+    std::size_t count = 0;
+    double average = 0.0;              // over the members that have the averaged attribute
+    std::size_t averaged = 0;          // how many of them that is
+};
+
+struct QueryResult {
+    std::vector<Attribute> groupBy;
+    Attribute average = Attribute::Unknown;
+    std::vector<QueryGroup> groups;    // largest first; a single group without values when not grouped
+    std::size_t matched = 0;           // people passing the filters (grouped or not)
+    std::size_t population = 0;
+};
+
+// "os=linux region=dach,central-europe course=4-6 by study,hobby avg graduation threads 4";
+// a leading "where" and "and" between filters are allowed. throws std::invalid_argument
+CohortQuery parse_cohort_query(const std::string& text);
+
+/**
+ * Column store of a dataset for CohortQuery. A column is built in one pass over the people
+ * the first time a query references its attribute, so an index only ever holds the columns
+ * that were asked for. It keeps a reference to `persons`, which have to outlive it unchanged.
+ *
+ * Every column is dictionary encoded (a small id per distinct value) and keeps the rows of
+ * each id: a bitmap for a frequent value, a sorted row list for one whose list is smaller
+ * than its bitmap would be. Filters never look at the rows: a predicate is the OR of its
+ * values' rows and the filters are ANDed together, n/64 words at a time. Counting per value
+ * of a single grouped attribute is then a popcount of the selection against each value's
+ * rows; anything else (several groups, averages) walks only the selected rows, split into
+ * chunks aggregated on separate threads and merged at the end. run() is safe to call from
+ * several threads at once; each column is built by whichever of them needs it first.
+ */
+class PersonIndex {
+public:
+    explicit PersonIndex(const std::vector<Person>& persons);
+
+    // throws std::invalid_argument for a query this index can't answer (e.g. a range on a tag)
+    QueryResult run(const CohortQuery& query) const;
+
+    std::size_t rows() const { return m_rows; }
+
+    // how many columns the queries so far have built
+    std::size_t builtColumns() const { return m_builtColumns.load(); }
+
+private:
+    static constexpr std::uint32_t NO_ID = 0xFFFFFFFFu;
+
+    struct Column {
+        bool multiValued = false;
+        bool numeric = false;
+        std::vector<std::string> dictionary;          // value text per id
+        std::vector<long long> numbers;               // numeric columns: the number per id
+        std::vector<std::uint32_t> ids;               // single-valued: id per row, NO_ID when unknown
+        std::vector<std::uint32_t> offsets;           // tags: row r has tagIds[offsets[r] .. offsets[r + 1])
+        std::vector<std::uint32_t> tagIds;
+        std::vector<std::vector<std::uint64_t>> bitmaps;   // per id, its rows; empty when listed
+        std::vector<std::vector<std::uint32_t>> lists;     // per id, its rows in order; empty when a bitmap
+    };
+
+    // the column of an attribute, built on first use
+    const Column& column(Attribute attr) const;
+
+    template <Attribute A>
+    void buildColumn(Column& column) const;
+    void indexRows(Column& column, const std::vector<std::size_t>& support) const;
+
+    std::vector<std::uint64_t> select(const std::vector<QueryPredicate>& filters) const;
+
+    const std::vector<Person>& m_persons;
+    std::size_t m_rows = 0;
+    std::size_t m_words = 0;
+    mutable std::array<Column, ATTRIBUTE_COUNT> m_columns;
+    mutable std::array<std::once_flag, ATTRIBUTE_COUNT> m_built;
+    mutable std::atomic<std::size_t> m_builtColumns{0};
+};
+
+#endif // COHORT_QUERY_H
@@ -0,0 +1,390 @@
+#include "DatasetGenerator.h"
+#include "PersonBinaryReader.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace {
+
+const char* const BASE_COLORS[] = {
+    "blue", "red", "green", "black", "white", "purple", "orange", "yellow", "pink", "gray", "sage", "teal"
+};
+const char* const BASE_HOBBIES[] = {
+    "reading", "gaming", "hiking", "cycling", "cooking", "music", "soccer", "basketball", "photography",
+    "chess", "drawing", "swimming", "running", "movies", "travel", "dancing", "climbing", "skiing"
+};
+const char* const BASE_LANGUAGES[] = {
+    "english", "spanish", "mandarin", "hindi", "french", "arabic", "russian", "japanese", "korean",
+    "portuguese", "german", "italian", "vietnamese", "turkish"
+};
+
+// the real words first, then "hobby21", "hobby22", ... for bigger cardinalities
+template <std::size_t N>
+std::vector<std::string> vocabulary(const char* const (&base)[N], const std::string& prefix, std::size_t count) {
+    std::vector<std::string> out;
+    out.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        out.push_back(i < N ? std::string(base[i]) : prefix + std::to_string(i + 1));
+    }
+    return out;
+}
+
+// cumulative Zipf weights 1/rank^s; empty (uniform) when s == 0
+std::vector<double> zipfCdf(std::size_t count, double skew) {
+    std::vector<double> cdf;
+    if (skew <= 0.0 || count == 0) {
+        return cdf;
+    }
+    cdf.reserve(count);
+    double total = 0.0;
+    for (std::size_t rank = 1; rank <= count; ++rank) {
+        total += 1.0 / std::pow(static_cast<double>(rank), skew);
+        cdf.push_back(total);
+    }
+    for (double& c : cdf) {
+        c /= total;
+    }
+    return cdf;
+}
+
+std::string lower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::tolower(c); });
+    return s;
+}
+
+// the text a single valued attribute is compared with in a PlantedRule
+std::string scalarText(const DatasetGenerator::Row& row, Attribute attr) {
+    switch (attr) {
+        case Attribute::Os:         return lower(to_string(row.primaryOS));
+        case Attribute::Study:      return to_string(row.studyTime);
+        case Attribute::Region:     return to_string(row.region);
+        case Attribute::Focus:      return to_string(row.engineeringFocus);
+        case Attribute::Course:     return std::to_string(row.courseLoad);
+        case Attribute::Graduation: return std::to_string(row.graduationYear);
+        default:                    return {};
+    }
+}
+
+// same spelling scalarText produces, so "MacOS" / "Morning" in a rule still match
+std::string normalizeScalar(Attribute attr, const std::string& value) {
+    switch (attr) {
+        case Attribute::Os:     return lower(to_string(parse_primary_os(value)));
+        case Attribute::Study:  return to_string(parse_study_time(value));
+        case Attribute::Region: return to_string(parse_region(value));
+        case Attribute::Focus:  return to_string(parse_engineering_focus(value));
+        default:                return value;
+    }
+}
+
+std::string joinTags(const std::vector<std::string>& tags) {
+    std::string out;
+    for (const auto& t : tags) {
+        if (!out.empty()) out += '-';
+        out += t;
+    }
+    return out;
+}
+
+void writeJsonString(std::ostream& out, const std::string& s) {
+    out << '"';
+    for (char c : s) {
+        if (c == '"' || c == '\\') out << '\\';
+        out << c;
+    }
+    out << '"';
+}
+
+void writeLe(std::ostream& out, std::uint64_t value, int bytes) {
+    char buf[8];
+    for (int i = 0; i < bytes; ++i) {
+        buf[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+    out.write(buf, bytes);
+}
+
+void writeBinaryString(std::ostream& out, const std::string& s) {
+    std::size_t length = std::min<std::size_t>(s.size(), 0xFFFF);
+    writeLe(out, length, 2);
+    out.write(s.data(), static_cast<std::streamsize>(length));
+}
+
+void writeBinaryTags(std::ostream& out, const std::vector<std::string>& tags) {
+    writeLe(out, tags.size(), 2);
+    for (const auto& t : tags) {
+        writeBinaryString(out, t);
+    }
+}
+
+}
+
+PlantedRule parse_planted_rule(const std::string& text) {
+    std::vector<std::string> parts;
+    std::size_t start = 0;
+    while (true) {
+        std::size_t colon = text.find(':', start);
+        parts.push_back(text.substr(start, colon - start));
+        if (colon == std::string::npos) break;
+        start = colon + 1;
+    }
+    if (parts.size() < 2 || parts.size() > 3) {
+        throw std::invalid_argument("Planted rule should look like region=china:language=mandarin[:0.8]: " + text);
+    }
+
+    auto side = [&](const std::string& part, Attribute& attr, std::string& value) {
+        std::size_t eq = part.find('=');
+        if (eq == std::string::npos) {
+            throw std::invalid_argument("Missing '=' in planted rule: " + part);
+        }
+        attr = parse_attribute(part.substr(0, eq));
+        value = part.substr(eq + 1);
+        if (attr == Attribute::Unknown || value.empty()) {
+            throw std::invalid_argument("Unknown attribute or empty value in planted rule: " + part);
+        }
+    };
+
+    PlantedRule rule;
+    side(parts[0], rule.attrX, rule.valueX);
+    side(parts[1], rule.attrY, rule.valueY);
+    if (is_tag_attribute(rule.attrX)) {
+        throw std::invalid_argument("Planted rules need a single valued attribute on the left: " + text);
+    }
+    if (rule.attrY == Attribute::Course || rule.attrY == Attribute::Graduation) {
+        // applyRule writes these straight into the row, so check them now rather than per row
+        std::size_t used = 0;
+        try {
+            std::stoi(rule.valueY, &used);
+        } catch (const std::exception&) {
+            used = 0;
+        }
+        if (used == 0 || used != rule.valueY.size()) {
+            throw std::invalid_argument("Planted rule needs a whole number for " + parts[1]);
+        }
+    }
+    if (parts.size() == 3) {
+        std::size_t used = 0;
+        try {
+            rule.strength = std::stod(parts[2], &used);
+        } catch (const std::exception&) {
+            used = 0;
+        }
+        if (used == 0 || used != parts[2].size() || !(rule.strength >= 0.0 && rule.strength <= 1.0)) {
+            throw std::invalid_argument("Planted rule strength should be between 0 and 1: " + parts[2]);
+        }
+    }
+    return rule;
+}
+
+DatasetFormat parse_dataset_format(const std::string& text) {
+    std::string f = lower(text);
+    if (f == "csv") return DatasetFormat::Csv;
+    if (f == "json") return DatasetFormat::Json;
+    if (f == "bin" || f == "binary") return DatasetFormat::Binary;
+    throw std::invalid_argument("Unknown dataset format: " + text);
+}
+
+Person DatasetGenerator::Row::toPerson() const {
+    return Person(id, graduationYear, region, primaryOS, engineeringFocus, studyTime, courseLoad,
+                  {favoriteColors.begin(), favoriteColors.end()},
+                  {hobbies.begin(), hobbies.end()},
+                  {languages.begin(), languages.end()});
+}
+
+DatasetGenerator::DatasetGenerator(DatasetConfig config)
+    : m_config(std::move(config)),
+      m_colors(vocabulary(BASE_COLORS, "color", m_config.colorCount)),
+      m_hobbies(vocabulary(BASE_HOBBIES, "hobby", m_config.hobbyCount)),
+      m_languages(vocabulary(BASE_LANGUAGES, "language", m_config.languageCount)),
+      m_hobbyCdf(zipfCdf(m_config.hobbyCount, m_config.hobbySkew)),
+      m_languageCdf(zipfCdf(m_config.languageCount, m_config.languageSkew)) {
+
+    for (const auto& name : all_region_strings()) {
+        Region r = parse_region(name);
+        if (r != Region::Unknown) m_regions.push_back(r);
+    }
+    for (const auto& name : all_engineering_focus_strings()) {
+        EngineeringFocus f = parse_engineering_focus(name);
+        if (f != EngineeringFocus::Unknown) m_focuses.push_back(f);
+    }
+
+    for (PlantedRule& rule : m_config.rules) {
+        rule.valueX = normalizeScalar(rule.attrX, rule.valueX);
+    }
+
+    reset();
+}
+
+void DatasetGenerator::reset() {
+    m_rng.seed(m_config.seed);
+    m_nextId = 0;
+}
+
+// mt19937_64 output is the same everywhere, std:: distributions aren't, so these are done by hand
+double DatasetGenerator::uniform() {
+    return static_cast<double>(m_rng() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+std::size_t DatasetGenerator::below(std::size_t n) {
+    return n == 0 ? 0 : static_cast<std::size_t>(m_rng() % n);
+}
+
+std::size_t DatasetGenerator::sampleCdf(const std::vector<double>& cdf) {
+    double u = uniform();
+    auto it = std::upper_bound(cdf.begin(), cdf.end(), u);
+    return std::min<std::size_t>(static_cast<std::size_t>(it - cdf.begin()), cdf.size() - 1);
+}
+
+void DatasetGenerator::drawTags(std::vector<std::string>& out, const std::vector<std::string>& vocabulary,
+                                const std::vector<double>* cdf, std::size_t maxCount) {
+    if (vocabulary.empty() || maxCount == 0) {
+        return;
+    }
+    std::size_t count = 1 + below(maxCount);
+    for (std::size_t i = 0; i < count; ++i) {
+        std::size_t index = (cdf && !cdf->empty()) ? sampleCdf(*cdf) : below(vocabulary.size());
+        const std::string& tag = vocabulary[index];
+        if (std::find(out.begin(), out.end(), tag) == out.end()) {
+            out.push_back(tag);
+        }
+    }
+}
+
+void DatasetGenerator::applyRule(const PlantedRule& rule, Row& row) {
+    if (scalarText(row, rule.attrX) != rule.valueX || uniform() >= rule.strength) {
+        return;
+    }
+
+    switch (rule.attrY) {
+        case Attribute::Os:         row.primaryOS = parse_primary_os(rule.valueY); break;
+        case Attribute::Study:      row.studyTime = parse_study_time(rule.valueY); break;
+        case Attribute::Region:     row.region = parse_region(rule.valueY); break;
+        case Attribute::Focus:      row.engineeringFocus = parse_engineering_focus(rule.valueY); break;
+        case Attribute::Course:     row.courseLoad = std::stoi(rule.valueY); break;
+        case Attribute::Graduation: row.graduationYear = std::stoi(rule.valueY); break;
+        case Attribute::Color:
+        case Attribute::Hobby:
+        case Attribute::Language: {
+            auto& tags = rule.attrY == Attribute::Color ? row.favoriteColors
+                       : rule.attrY == Attribute::Hobby ? row.hobbies
+                       : row.languages;
+            if (std::find(tags.begin(), tags.end(), rule.valueY) == tags.end()) {
+                tags.push_back(rule.valueY);
+            }
+            break;
+        }
+        case Attribute::Unknown:
+            break;
+    }
+}
+
+DatasetGenerator::Row DatasetGenerator::nextRow() {
+    static const PrimaryOS OSES[] = {PrimaryOS::MacOS, PrimaryOS::Windows, PrimaryOS::Linux};
+    static const StudyTime TIMES[] = {StudyTime::Morning, StudyTime::Afternoon, StudyTime::Night};
+
+    Row row;
+    row.id = "p" + std::to_string(m_nextId++);
+
+    int years = std::max(1, m_config.lastGraduationYear - m_config.firstGraduationYear + 1);
+    row.graduationYear = m_config.firstGraduationYear + static_cast<int>(below(static_cast<std::size_t>(years)));
+    row.region = m_regions[below(m_regions.size())];
+    row.primaryOS = OSES[below(3)];
+    row.engineeringFocus = m_focuses[below(m_focuses.size())];
+    row.studyTime = TIMES[below(3)];
+
+    int loads = std::max(1, m_config.maxCourseLoad - m_config.minCourseLoad + 1);
+    row.courseLoad = m_config.minCourseLoad + static_cast<int>(below(static_cast<std::size_t>(loads)));
+
+    drawTags(row.favoriteColors, m_colors, nullptr, m_config.maxColors);
+    drawTags(row.hobbies, m_hobbies, &m_hobbyCdf, m_config.maxHobbies);
+    drawTags(row.languages, m_languages, &m_languageCdf, m_config.maxLanguages);
+
+    for (const PlantedRule& rule : m_config.rules) {
+        applyRule(rule, row);
+    }
+    return row;
+}
+
+std::vector<Person> DatasetGenerator::generate() {
+    reset();
+    std::vector<Person> persons;
+    persons.reserve(m_config.rows);
+    for (std::size_t i = 0; i < m_config.rows; ++i) {
+        persons.push_back(nextRow().toPerson());
+    }
+    return persons;
+}
+
+bool DatasetGenerator::write(std::ostream& out, DatasetFormat format) {
+    reset();
+
+    switch (format) {
+        case DatasetFormat::Csv:
+            out << "id,graduationYear,region,primaryOS,engineeringFocus,studyTime,courseLoad,"
+                   "favoriteColors,hobbies,languages\n";
+            for (std::size_t i = 0; i < m_config.rows; ++i) {
+                Row r = nextRow();
+                out << r.id << ',' << r.graduationYear << ','
+                    << enum_name(r.region) << ',' << enum_name(r.primaryOS) << ','
+                    << enum_name(r.engineeringFocus) << ',' << enum_name(r.studyTime) << ','
+                    << r.courseLoad << ','
+                    << joinTags(r.favoriteColors) << ',' << joinTags(r.hobbies) << ','
+                    << joinTags(r.languages) << '\n';
+            }
+            break;
+
+        case DatasetFormat::Json:
+            out << "{\"people\":[";
+            for (std::size_t i = 0; i < m_config.rows; ++i) {
+                Row r = nextRow();
+                out << (i == 0 ? "\n" : ",\n") << "{\"id\":";
+                writeJsonString(out, r.id);
+                out << ",\"graduationYear\":" << r.graduationYear
+                    << ",\"region\":\"" << enum_name(r.region) << '"'
+                    << ",\"primaryOS\":\"" << enum_name(r.primaryOS) << '"'
+                    << ",\"engineeringFocus\":\"" << enum_name(r.engineeringFocus) << '"'
+                    << ",\"studyTime\":\"" << enum_name(r.studyTime) << '"'
+                    << ",\"courseLoad\":" << r.courseLoad
+                    << ",\"favoriteColors\":";
+                writeJsonString(out, joinTags(r.favoriteColors));
+                out << ",\"hobbies\":";
+                writeJsonString(out, joinTags(r.hobbies));
+                out << ",\"languages\":";
+                writeJsonString(out, joinTags(r.languages));
+                out << '}';
+            }
+            out << "\n]}\n";
+            break;
+
+        case DatasetFormat::Binary:
+            out.write(PersonBinaryReader::MAGIC, sizeof(PersonBinaryReader::MAGIC));
+            writeLe(out, PersonBinaryReader::VERSION, 4);
+            writeLe(out, m_config.rows, 8);
+            for (std::size_t i = 0; i < m_config.rows; ++i) {
+                Row r = nextRow();
+                writeBinaryString(out, r.id);
+                writeLe(out, static_cast<std::uint32_t>(r.graduationYear), 4);
+                writeLe(out, static_cast<std::uint8_t>(r.region), 1);
+                writeLe(out, static_cast<std::uint8_t>(r.primaryOS), 1);
+                writeLe(out, static_cast<std::uint8_t>(r.engineeringFocus), 1);
+                writeLe(out, static_cast<std::uint8_t>(r.studyTime), 1);
+                writeLe(out, static_cast<std::uint32_t>(r.courseLoad), 4);
+                writeBinaryTags(out, r.favoriteColors);
+                writeBinaryTags(out, r.hobbies);
+                writeBinaryTags(out, r.languages);
+            }
+            break;
+    }
+
+    return static_cast<bool>(out);
+}
+
+bool DatasetGenerator::writeFile(const std::string& path, DatasetFormat format) {
+    std::ofstream out(path, format == DatasetFormat::Binary ? std::ios::binary : std::ios::out);
+    if (!out.is_open()) {
+        return false;
+    }
+    return write(out, format);
+}
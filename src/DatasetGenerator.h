@@ -0,0 +1,128 @@
+#ifndef DATASET_GENERATOR_H
+#define DATASET_GENERATOR_H
+
+#include "Attribute.h"
+#include "Person.h"
+#include "PersonEnums.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * A relationship baked into a generated dataset:
+ * people whose `attrX` is `valueX` get `attrY` = `valueY` with probability `strength`.
+ * attrX has to be a single valued attribute (os, study, region, focus, course, graduation);
+ * for tag attributes on the Y side the value is added to the person's tags.
+ */
+struct PlantedRule {
+    Attribute attrX = Attribute::Unknown;
+    std::string valueX;
+    Attribute attrY = Attribute::Unknown;
+    std::string valueY;
+    double strength = 0.8;
+};
+
+// "region=china:language=mandarin[:0.8]", throws std::invalid_argument if it doesn't parse
+PlantedRule parse_planted_rule(const std::string& text);
+
+/**
+ * Settings for DatasetGenerator. The same config (seed included) always produces the same rows.
+ */
+struct DatasetConfig {
+    std::size_t rows = 1000;
+    std::uint64_t seed = 1;
+
+    // how many distinct tag values there are
+    std::size_t colorCount = 10;
+    std::size_t hobbyCount = 20;
+    std::size_t languageCount = 12;
+
+    // most tags a single person gets (at least one each)
+    std::size_t maxColors = 2;
+    std::size_t maxHobbies = 3;
+    std::size_t maxLanguages = 2;
+
+    // Zipf exponents for picking hobbies/languages (0 = uniform)
+    double hobbySkew = 1.1;
+    double languageSkew = 1.1;
+
+    int firstGraduationYear = 2024;
+    int lastGraduationYear = 2029;
+    int minCourseLoad = 1;
+    int maxCourseLoad = 6;
+
+    std::vector<PlantedRule> rules;
+};
+
+enum class DatasetFormat {
+    Csv,      // same columns as PersonRepository::saveToCsv
+    Json,     // {"people":[...]} like the JSON endpoint PersonJsonReader reads
+    Binary    // see PersonBinaryReader
+};
+
+// "csv", "json", "bin"/"binary"; throws std::invalid_argument for anything else
+DatasetFormat parse_dataset_format(const std::string& text);
+
+/**
+ * Deterministic synthetic Person data for load testing and for checking that
+ * InsightGenerator finds relationships that were put there on purpose.
+ *
+ * Rows are produced one at a time, so writing a dataset never holds all of it in memory.
+ */
+class DatasetGenerator {
+public:
+    explicit DatasetGenerator(DatasetConfig config);
+
+    // one generated row; tags are kept in the order they were drawn so output is stable
+    struct Row {
+        std::string id;
+        int graduationYear = 0;
+        Region region = Region::Unknown;
+        PrimaryOS primaryOS = PrimaryOS::Unknown;
+        EngineeringFocus engineeringFocus = EngineeringFocus::Unknown;
+        StudyTime studyTime = StudyTime::Unknown;
+        int courseLoad = 0;
+        std::vector<std::string> favoriteColors;
+        std::vector<std::string> hobbies;
+        std::vector<std::string> languages;
+
+        Person toPerson() const;
+    };
+
+    Row nextRow();
+    std::vector<Person> generate();   // all config.rows people (starts over from the seed)
+
+    // streams config.rows rows in the given format (starts over from the seed)
+    bool write(std::ostream& out, DatasetFormat format);
+    bool writeFile(const std::string& path, DatasetFormat format);
+
+    const DatasetConfig& config() const { return m_config; }
+
+private:
+    DatasetConfig m_config;
+    std::mt19937_64 m_rng;
+    std::size_t m_nextId = 0;
+
+    std::vector<std::string> m_colors;
+    std::vector<std::string> m_hobbies;
+    std::vector<std::string> m_languages;
+    std::vector<double> m_hobbyCdf;
+    std::vector<double> m_languageCdf;
+
+    std::vector<Region> m_regions;
+    std::vector<EngineeringFocus> m_focuses;
+
+    void reset();
+    double uniform();
+    std::size_t below(std::size_t n);
+    std::size_t sampleCdf(const std::vector<double>& cdf);
+    void drawTags(std::vector<std::string>& out, const std::vector<std::string>& vocabulary,
+                  const std::vector<double>* cdf, std::size_t maxCount);
+    void applyRule(const PlantedRule& rule, Row& row);
+};
+
+#endif // DATASET_GENERATOR_H
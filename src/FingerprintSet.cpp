@@ -0,0 +1,130 @@
+#include "FingerprintSet.h"
+
+namespace {
+constexpr std::uint64_t FNV_OFFSET = 14695981039346656037ULL;
+constexpr std::uint64_t FNV_PRIME = 1099511628211ULL;
+constexpr std::size_t MIN_CAPACITY = 16;
+}
+
+std::uint64_t fingerprint_key(std::string_view key) {
+    std::uint64_t hash = FNV_OFFSET;
+    for (char c : key) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+std::size_t FingerprintSet::slotFor(std::uint64_t fingerprint) const {
+    // fingerprints are already hashes, just fold the high bits in before masking
+    std::uint64_t mixed = fingerprint ^ (fingerprint >> 29);
+    return static_cast<std::size_t>(mixed) & (m_slots.size() - 1);
+}
+
+void FingerprintSet::grow() {
+    std::vector<std::uint64_t> old = std::move(m_slots);
+    m_slots.assign(old.empty() ? MIN_CAPACITY : old.size() * 2, 0);
+
+    for (std::uint64_t fingerprint : old) {
+        if (fingerprint == 0) continue;
+        std::size_t i = slotFor(fingerprint);
+        while (m_slots[i] != 0) {
+            i = (i + 1) & (m_slots.size() - 1);
+        }
+        m_slots[i] = fingerprint;
+    }
+}
+
+bool FingerprintSet::insert(std::uint64_t fingerprint) {
+    if (fingerprint == 0) {
+        if (m_hasZero) return false;
+        m_hasZero = true;
+        m_size++;
+        return true;
+    }
+
+    // keep the load factor under 1/2 so probe chains stay short
+    if ((m_size + 1) * 2 > m_slots.size()) {
+        grow();
+    }
+
+    std::size_t i = slotFor(fingerprint);
+    while (m_slots[i] != 0) {
+        if (m_slots[i] == fingerprint) return false;
+        i = (i + 1) & (m_slots.size() - 1);
+    }
+    m_slots[i] = fingerprint;
+    m_size++;
+    return true;
+}
+
+bool FingerprintSet::contains(std::uint64_t fingerprint) const {
+    if (fingerprint == 0) return m_hasZero;
+    if (m_slots.empty()) return false;
+
+    std::size_t i = slotFor(fingerprint);
+    while (m_slots[i] != 0) {
+        if (m_slots[i] == fingerprint) return true;
+        i = (i + 1) & (m_slots.size() - 1);
+    }
+    return false;
+}
+
+namespace {
+// splitmix64 finalizer, so summing members doesn't cancel out like xor of equal pairs would
+std::uint64_t mix(std::uint64_t x) {
+    x ^= x >> 30; x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27; x *= 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+}
+
+std::uint64_t FingerprintSet::digest() const {
+    std::uint64_t sum = mix(m_size);
+    for (std::uint64_t slot : m_slots) {
+        if (slot != 0) sum += mix(slot);
+    }
+    if (m_hasZero) sum += mix(0);
+    return sum;
+}
+
+bool FingerprintSet::erase(std::uint64_t fingerprint) {
+    if (fingerprint == 0) {
+        if (!m_hasZero) return false;
+        m_hasZero = false;
+        m_size--;
+        return true;
+    }
+    if (m_slots.empty()) return false;
+
+    const std::size_t mask = m_slots.size() - 1;
+    std::size_t i = slotFor(fingerprint);
+    while (m_slots[i] != fingerprint) {
+        if (m_slots[i] == 0) return false;
+        i = (i + 1) & mask;
+    }
+
+    // backward-shift deletion: pull later entries of the same probe chain into the hole
+    std::size_t hole = i;
+    std::size_t j = i;
+    while (true) {
+        j = (j + 1) & mask;
+        if (m_slots[j] == 0) break;
+        std::size_t home = slotFor(m_slots[j]);
+        // entry at j may move into the hole only if its home isn't between hole and j (cyclically)
+        bool between = (hole <= j) ? (hole < home && home <= j) : (hole < home || home <= j);
+        if (!between) {
+            m_slots[hole] = m_slots[j];
+            hole = j;
+        }
+    }
+    m_slots[hole] = 0;
+    m_size--;
+    return true;
+}
+
+void FingerprintSet::clear() {
+    m_slots.clear();
+    m_size = 0;
+    m_hasZero = false;
+}
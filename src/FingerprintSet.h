@@ -0,0 +1,47 @@
+#ifndef FINGERPRINT_SET_H
+#define FINGERPRINT_SET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/**
+ * Stable 64-bit fingerprint (FNV-1a) of an insight key like
+ * "primary_os = MacOS -> study_time = Night".
+ * Insight::fingerprint() produces the same value straight from its fields,
+ * so a blocklist read from disk matches freshly generated insights.
+ */
+std::uint64_t fingerprint_key(std::string_view key);
+
+/**
+ * Flat open-addressing hash set of fingerprints (linear probing, power-of-two table).
+ * Used for the blocklist so a suppression check is one or two probes and never allocates.
+ */
+class FingerprintSet {
+public:
+    FingerprintSet() = default;
+
+    // returns true if the fingerprint wasn't there yet
+    bool insert(std::uint64_t fingerprint);
+    bool erase(std::uint64_t fingerprint);
+    bool contains(std::uint64_t fingerprint) const;
+
+    void clear();
+    std::size_t size() const { return m_size; }
+
+    // same value for the same members no matter the insertion order (what the result cache keys on)
+    std::uint64_t digest() const;
+    bool empty() const { return m_size == 0; }
+
+private:
+    // 0 marks an empty slot, so a real fingerprint of 0 is tracked separately
+    std::vector<std::uint64_t> m_slots;
+    std::size_t m_size = 0;
+    bool m_hasZero = false;
+
+    std::size_t slotFor(std::uint64_t fingerprint) const;
+    void grow();
+};
+
+#endif // FINGERPRINT_SET_H
@@ -0,0 +1,36 @@
+#include "HeavyHitters.h"
+
+#include <algorithm>
+
+SpaceSaving::SpaceSaving(std::size_t capacity)
+    : m_capacity(capacity == 0 ? 1 : capacity) {}
+
+void SpaceSaving::add(std::uint32_t item) {
+    ++m_total;
+
+    for (Counter& c : m_counters) {
+        if (c.item == item) {
+            ++c.count;
+            return;
+        }
+    }
+
+    if (m_counters.size() < m_capacity) {
+        m_counters.push_back({item, 1, 0});
+        return;
+    }
+
+    // full: the smallest counter is handed over; its count becomes the newcomer's error
+    auto smallest = std::min_element(m_counters.begin(), m_counters.end(),
+                                     [](const Counter& a, const Counter& b) { return a.count < b.count; });
+    smallest->item = item;
+    smallest->error = smallest->count;
+    ++smallest->count;
+}
+
+std::vector<SpaceSaving::Counter> SpaceSaving::top() const {
+    std::vector<Counter> counters = m_counters;
+    std::stable_sort(counters.begin(), counters.end(),
+                     [](const Counter& a, const Counter& b) { return a.count > b.count; });
+    return counters;
+}
@@ -0,0 +1,40 @@
+#ifndef HEAVY_HITTERS_H
+#define HEAVY_HITTERS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Space-Saving heavy hitters sketch (Metwally, Agrawal, El Abbadi) over value ids.
+ *
+ * Keeps at most `capacity` counters however many distinct values go through it. Every value
+ * added more than total()/capacity times is guaranteed to hold a counter, and a counter
+ * brackets the value's true count: count - error <= true count <= count.
+ * The counters are few, so they live in one small vector that is scanned linearly.
+ */
+class SpaceSaving {
+public:
+    struct Counter {
+        std::uint32_t item = 0;
+        std::size_t count = 0;   // upper bound of the true count
+        std::size_t error = 0;   // how much of count may belong to evicted values
+    };
+
+    explicit SpaceSaving(std::size_t capacity);
+
+    void add(std::uint32_t item);
+
+    std::size_t total() const { return m_total; }
+    std::size_t capacity() const { return m_capacity; }
+
+    // counters, highest count first
+    std::vector<Counter> top() const;
+
+private:
+    std::size_t m_capacity;
+    std::size_t m_total = 0;
+    std::vector<Counter> m_counters;
+};
+
+#endif // HEAVY_HITTERS_H
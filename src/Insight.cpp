@@ -0,0 +1,236 @@
+#include "Insight.h"
+#include "FingerprintSet.h"
+#include "PersonEnums.h"
+
+#include <cctype>
+#include <charconv>
+#include <cstdio>
+#include <sstream>
+
+namespace {
+// not necessary but a nice helper for natural sounding/looking english sentences
+std::string describeStudyTime(StudyTime studyTime) {
+    switch (studyTime) {
+        case StudyTime::Morning:
+            return "mornings";
+        case StudyTime::Afternoon:
+            return "afternoons";
+        case StudyTime::Night:
+            return "nights";
+        default:
+            return "day";
+    }
+}
+// key text goes either into a string (key()) or straight into the hash (fingerprint()),
+// both fed by writeKey so the two can never disagree
+struct StringSink {
+    std::string& out;
+    void put(std::string_view text, bool lower = false) {
+        if (!lower) {
+            out.append(text);
+            return;
+        }
+        for (char c : text) {
+            out.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+        }
+    }
+};
+
+struct HashSink {
+    std::uint64_t hash = fingerprint_key("");
+    void put(std::string_view text, bool lower = false) {
+        for (char c : text) {
+            unsigned char byte = static_cast<unsigned char>(c);
+            if (lower) byte = static_cast<unsigned char>(std::tolower(byte));
+            hash ^= byte;
+            hash *= 1099511628211ULL;  // FNV-1a prime, same as fingerprint_key
+        }
+    }
+};
+
+template <typename Sink>
+void writeValue(const Insight& insight, Attribute attr, std::uint32_t value, bool lower, Sink& sink) {
+    switch (attr) {
+        case Attribute::Os:     sink.put(enum_name(static_cast<PrimaryOS>(value)), lower); break;
+        case Attribute::Study:  sink.put(enum_name(static_cast<StudyTime>(value)), lower); break;
+        case Attribute::Region: sink.put(enum_name(static_cast<Region>(value)), lower); break;
+        case Attribute::Focus:  sink.put(enum_name(static_cast<EngineeringFocus>(value)), lower); break;
+        case Attribute::Course:
+        case Attribute::Graduation: {
+            if (is_range_value(value)) {
+                if (insight.values) sink.put(insight.values->text(value & ~RANGE_VALUE));
+                break;
+            }
+            char digits[16];
+            auto result = std::to_chars(digits, digits + sizeof(digits), value);
+            sink.put(std::string_view(digits, static_cast<std::size_t>(result.ptr - digits)));
+            break;
+        }
+        case Attribute::Color:
+        case Attribute::Hobby:
+        case Attribute::Language:
+            if (insight.values) sink.put(insight.values->text(value), lower);
+            break;
+        default:
+            break;
+    }
+}
+
+// "<label x> = <x> -> <label y> = <y>", labels and lowercasing depend on which generator made it
+template <typename Sink>
+void writeKey(const Insight& insight, Sink& sink) {
+    std::string_view labelX;
+    std::string_view labelY;
+    bool lowerX = false;
+    bool lowerY = false;
+
+    switch (insight.kind) {
+        case InsightKind::OsStudy:
+            labelX = "primary_os"; labelY = "study_time";
+            break;
+        case InsightKind::ColorHobby:
+            labelX = "favorite_color"; labelY = "hobby";
+            lowerX = lowerY = true;
+            break;
+        case InsightKind::RegionLanguage:
+            labelX = "region"; labelY = "language";
+            lowerY = true;
+            break;
+        case InsightKind::FocusCourse:
+            labelX = "engineering_focus"; labelY = "course_load";
+            break;
+        case InsightKind::Generic:
+        case InsightKind::Rule:
+            labelX = enum_name(insight.attrX); labelY = enum_name(insight.attrY);
+            lowerX = lowerY = true;
+            break;
+        case InsightKind::Text:
+            return;
+    }
+
+    sink.put(labelX);
+    sink.put(" = ");
+    writeValue(insight, insight.attrX, insight.valueX, lowerX, sink);
+    for (const InsightTerm& term : insight.moreX) {
+        sink.put(" & ");
+        sink.put(enum_name(term.attr));
+        sink.put(" = ");
+        writeValue(insight, term.attr, term.value, true, sink);
+    }
+    sink.put(" -> ");
+    sink.put(labelY);
+    sink.put(" = ");
+    writeValue(insight, insight.attrY, insight.valueY, lowerY, sink);
+}
+} // namespace
+
+std::uint32_t InsightValuePool::intern(const std::string& value) {
+    auto it = m_ids.find(value);
+    if (it != m_ids.end()) {
+        return it->second;
+    }
+
+    std::uint32_t id = static_cast<std::uint32_t>(m_values.size());
+    m_values.push_back(value);
+    m_ids.emplace(m_values.back(), id);
+    return id;
+}
+
+Insight Insight::fromText(std::string key, std::string description) {
+    Insight insight;
+    insight.m_key = std::move(key);
+    insight.m_description = std::move(description);
+    return insight;
+}
+
+std::string Insight::valueText(Attribute attr, std::uint32_t value) const {
+    switch (attr) {
+        case Attribute::Os:       return to_string(static_cast<PrimaryOS>(value));
+        case Attribute::Study:    return to_string(static_cast<StudyTime>(value));
+        case Attribute::Region:   return to_string(static_cast<Region>(value));
+        case Attribute::Focus:    return to_string(static_cast<EngineeringFocus>(value));
+        case Attribute::Course:
+        case Attribute::Graduation:
+            if (is_range_value(value)) {
+                return values ? values->text(value & ~RANGE_VALUE) : std::string();
+            }
+            return std::to_string(value);
+        case Attribute::Color:
+        case Attribute::Hobby:
+        case Attribute::Language:
+            return values ? values->text(value) : std::string();
+        default:
+            return std::string();
+    }
+}
+
+const std::string& Insight::key() const {
+    if (!m_key.empty() || kind == InsightKind::Text) {
+        return m_key;
+    }
+
+    StringSink sink{m_key};
+    writeKey(*this, sink);
+    return m_key;
+}
+
+std::uint64_t Insight::fingerprint() const {
+    if (kind == InsightKind::Text || !m_key.empty()) {
+        return fingerprint_key(m_key);
+    }
+
+    HashSink sink;
+    writeKey(*this, sink);
+    return sink.hash;
+}
+
+const std::string& Insight::description() const {
+    if (!m_description.empty() || kind == InsightKind::Text) {
+        return m_description;
+    }
+
+    std::string x = valueText(attrX, valueX);
+    std::string y = valueText(attrY, valueY);
+
+    std::ostringstream sentence;
+    switch (kind) {
+        case InsightKind::OsStudy:
+            sentence << "People whose primary OS is " << x
+                     << " tend to study in the " << describeStudyTime(static_cast<StudyTime>(valueY)) << ".";
+            break;
+        case InsightKind::ColorHobby:
+            sentence << "People whose favorite color is " << x
+                     << " tend to have a hobby of " << y << ".";
+            break;
+        case InsightKind::RegionLanguage:
+            sentence << "People from " << x
+                     << " tend to speak " << y << ".";
+            break;
+        case InsightKind::FocusCourse:
+            sentence << "People whose engineering focus is " << x
+                     << " tend to take about " << y << " courses.";
+            break;
+        case InsightKind::Generic:
+            sentence << "People whose " << attribute_display_name(attrX)
+                     << " is " << x
+                     << " tend to have " << attribute_display_name(attrY)
+                     << " of " << y << ".";
+            break;
+        case InsightKind::Rule: {
+            sentence << "People whose " << attribute_display_name(attrX) << " is " << x;
+            for (const InsightTerm& term : moreX) {
+                sentence << " and whose " << attribute_display_name(term.attr)
+                         << " is " << valueText(term.attr, term.value);
+            }
+            char times[32];
+            std::snprintf(times, sizeof(times), "%.1f", lift);
+            sentence << " tend to have " << attribute_display_name(attrY)
+                     << " of " << y << " (" << times << "x as often as everyone).";
+            break;
+        }
+        case InsightKind::Text:
+            break;
+    }
+    m_description = sentence.str();
+    return m_description;
+}
@@ -1,17 +1,83 @@
 #ifndef INSIGHT_H
 #define INSIGHT_H
 
+#include "Attribute.h"
+
 #include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Which sentence (and key format) an insight is rendered with.
+ */
+enum class InsightKind : std::uint8_t {
+    Text,            // only key/description text is known (loaded from disk, built by hand)
+    OsStudy,         // the 4 built-in pairs from InsightGenerator::generate
+    ColorHobby,
+    RegionLanguage,
+    FocusCourse,
+    Generic,         // InsightGenerator::generateGeneric(attrX, attrY)
+    Rule             // RuleMiner: attrX = valueX & moreX... -> attrY = valueY
+};
+
+/**
+ * One attribute = value condition, for the antecedent terms of a mined rule past the first.
+ */
+struct InsightTerm {
+    Attribute attr = Attribute::Unknown;
+    std::uint32_t value = 0;
+};
+
+// a numeric value binned into a range: RANGE_VALUE | id of its label ("4-5") in the insight's
+// value pool. plain numbers (course load, year) never have the top bit set
+constexpr std::uint32_t RANGE_VALUE = 0x80000000u;
+
+inline bool is_range_value(std::uint32_t value) {
+    return (value & RANGE_VALUE) != 0;
+}
+
+/**
+ * Owns the text of tag values (colors, hobbies, languages) seen during one generation run.
+ * Insights point at them by id so candidates don't each carry their own strings.
+ */
+class InsightValuePool {
+public:
+    std::uint32_t intern(const std::string& value);
+    const std::string& text(std::uint32_t id) const { return m_values[id]; }
+    std::size_t size() const { return m_values.size(); }
+
+private:
+    std::deque<std::string> m_values;  // deque so the string_views below stay valid
+    std::unordered_map<std::string_view, std::uint32_t> m_ids;
+};
 
 /**
  * Represents a single generated insight in natural language (not full english sentence).
  * The key uniquely identifies the insight so it can be tracked
  * across multiple generation runs for the same dataset.
+ *
+ * Generated insights only store which attributes/values they relate plus the counts;
+ * key() and description() are written the first time they're asked for and then cached.
  */
 struct Insight {
-    std::string key;
-    std::string description;
+    InsightKind kind = InsightKind::Text;
+    Attribute attrX = Attribute::Unknown;
+    Attribute attrY = Attribute::Unknown;
+    std::uint32_t valueX = 0;     // enum value, number (course load / year), range or id into `values` for tags
+    std::uint32_t valueY = 0;
+    std::shared_ptr<const InsightValuePool> values;
+
+    // Rule only: the rest of the antecedent (attrX/valueX is its first term) and
+    // confidence / the share of everyone with valueY. A rule with a single term has
+    // the same key as the Generic insight for that pair, so one blocklist entry covers both.
+    std::vector<InsightTerm> moreX;
+    double lift = 0.0;
+
     int score = 0;                // 0-100 quality score
     std::size_t support = 0;      // number of matching records / the number of people such that both details/attributes holds true for
 
@@ -23,7 +89,21 @@ struct Insight {
         }
         return static_cast<double>(support) / static_cast<double>(population);
     }
+
+    const std::string& key() const;
+    const std::string& description() const;
+
+    // 64-bit hash of key(), computed from the fields without building the key string
+    std::uint64_t fingerprint() const;
+
+    // an insight that is just text, e.g. read back from insights_saved.csv
+    static Insight fromText(std::string key, std::string description);
+
+private:
+    mutable std::string m_key;          // rendered on first use
+    mutable std::string m_description;
+
+    std::string valueText(Attribute attr, std::uint32_t value) const;
 };
 
 #endif // INSIGHT_H
-
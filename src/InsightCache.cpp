@@ -0,0 +1,285 @@
+#include "InsightCache.h"
+#include "Attribute.h"
+#include "InsightLog.h"
+#include "Instrumentation.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char* const FILE_HEADER = "#insight-cache v1";
+
+std::string hex(std::uint64_t value) {
+    char buf[17];
+    std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(value));
+    return buf;
+}
+
+// "OS", "primary_os" and "os" are the same query
+std::string attributeKey(const std::string& name) {
+    Attribute attr = parse_attribute(name);
+    if (attr != Attribute::Unknown) {
+        return to_string(attr);
+    }
+    std::string lowered;
+    for (char c : name) lowered += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return lowered;
+}
+
+// sketched counting may pick a different Y on a tie and the scoring modes rank differently,
+// so both get their own keys; the default settings keep the keys they always had
+std::string baseKey(std::uint64_t datasetHash, const FingerprintSet& suppressed, const InsightGenerator& generator) {
+    std::string key = "v" + std::to_string(InsightCache::GENERATOR_VERSION) + '|' + hex(datasetHash) + '|' +
+                      hex(suppressed.digest()) + '|';
+    if (generator.tagSketchCapacity() != 0) {
+        key += 's' + std::to_string(generator.tagSketchCapacity()) + '|';
+    }
+    if (generator.scoring() != ScoringMode::Confidence) {
+        key += to_string(generator.scoring()) + '|';
+    }
+    if (generator.binning().mode != BinningMode::Off) {
+        key += 'b' + to_string(generator.binning().mode) + std::to_string(generator.binning().bins) + '|';
+    }
+    return key;
+}
+
+}
+
+InsightCache::InsightCache(const InsightGenerator& generator, std::size_t capacity)
+    : m_generator(generator), m_capacity(capacity == 0 ? 1 : capacity) {}
+
+void InsightCache::setDiskDirectory(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_diskDirectory = directory;
+}
+
+std::string InsightCache::diskDirectory() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_diskDirectory;
+}
+
+void InsightCache::setDiskCapacity(std::size_t files) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_diskCapacity = files == 0 ? 1 : files;
+}
+
+std::vector<Insight> InsightCache::generate(const std::vector<Person>& persons, std::uint64_t datasetHash,
+                                            const FingerprintSet& suppressed, std::size_t limit,
+                                            const ProgressCallback& progress) {
+    std::string key = baseKey(datasetHash, suppressed, m_generator) + "generate|" + std::to_string(limit);
+    return getOrCompute(key, [&] {
+        Entry entry;
+        entry.insights = m_generator.generate(persons, suppressed, limit, progress);
+        return entry;
+    })->insights;
+}
+
+std::vector<Insight> InsightCache::generateGeneric(const std::vector<Person>& persons, std::uint64_t datasetHash,
+                                                   const FingerprintSet& suppressed,
+                                                   const std::string& attrX, const std::string& attrY,
+                                                   std::size_t limit, const ProgressCallback& progress) {
+    std::string key = baseKey(datasetHash, suppressed, m_generator) + "generic|" + attributeKey(attrX) + '|' +
+                      attributeKey(attrY) + '|' + std::to_string(limit);
+    return getOrCompute(key, [&] {
+        Entry entry;
+        entry.insights = m_generator.generateGeneric(persons, suppressed, attrX, attrY, limit, progress);
+        return entry;
+    })->insights;
+}
+
+std::vector<PairScore> InsightCache::scorePairs(const std::vector<Person>& persons, std::uint64_t datasetHash,
+                                                const FingerprintSet& suppressed,
+                                                const std::vector<std::string>& attributes) {
+    std::string key = baseKey(datasetHash, suppressed, m_generator) + "pairs";
+    for (const auto& attr : attributes) {
+        key += '|' + attributeKey(attr);
+    }
+    return getOrCompute(key, [&] {
+        Entry entry;
+        entry.pairs = m_generator.scorePairs(persons, suppressed, attributes);
+        return entry;
+    })->pairs;
+}
+
+template <typename Compute>
+InsightCache::EntryPtr InsightCache::getOrCompute(const std::string& key, Compute compute) {
+    std::string directory;
+    std::size_t diskCapacity = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_index.find(key);
+        if (it != m_index.end()) {
+            m_lru.splice(m_lru.begin(), m_lru, it->second);
+            ++m_stats.hits;
+            instr::count("cache.hit");
+            return it->second->second;
+        }
+        directory = m_diskDirectory;
+        diskCapacity = m_diskCapacity;
+    }
+
+    if (!directory.empty()) {
+        if (EntryPtr entry = readFile(key, directory)) {
+            // the file's time is its place in the disk tier's LRU order
+            std::error_code ec;
+            fs::last_write_time(filePath(key, directory), fs::file_time_type::clock::now(), ec);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_stats.diskHits;
+            instr::count("cache.disk_hit");
+            remember(key, entry);
+            return entry;
+        }
+    }
+
+    auto entry = std::make_shared<const Entry>(compute());
+    if (!directory.empty()) {
+        writeFile(key, *entry, directory);
+        pruneDisk(directory, diskCapacity);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_stats.misses;
+    instr::count("cache.miss");
+    remember(key, entry);
+    return entry;
+}
+
+// with m_mutex held
+void InsightCache::remember(const std::string& key, EntryPtr entry) {
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {  // another thread computed it meanwhile
+        it->second->second = std::move(entry);
+        m_lru.splice(m_lru.begin(), m_lru, it->second);
+        return;
+    }
+    m_lru.emplace_front(key, std::move(entry));
+    m_index[key] = m_lru.begin();
+    while (m_lru.size() > m_capacity) {
+        m_index.erase(m_lru.back().first);
+        m_lru.pop_back();
+    }
+}
+
+void InsightCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_lru.clear();
+    m_index.clear();
+}
+
+InsightCache::Stats InsightCache::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats s = m_stats;
+    s.entries = m_lru.size();
+    return s;
+}
+
+std::string InsightCache::filePath(const std::string& key, const std::string& directory) const {
+    return (fs::path(directory) / (hex(fingerprint_key(key)) + ".cache")).string();
+}
+
+/*
+ * Cache file:
+ *   #insight-cache v1
+ *   <full key>               (checked, so a hash collision is just a miss)
+ *   insights <n>
+ *   <n InsightLog records>
+ *   pairs <m>
+ *   <m lines: x \t y \t count \t total score \t average>
+ */
+InsightCache::EntryPtr InsightCache::readFile(const std::string& key, const std::string& directory) const {
+    std::ifstream in(filePath(key, directory));
+    if (!in) {
+        return nullptr;
+    }
+
+    std::string line;
+    if (!std::getline(in, line) || line != FILE_HEADER) return nullptr;
+    if (!std::getline(in, line) || line != key) return nullptr;
+
+    Entry entry;
+    std::size_t count = 0;
+    if (!std::getline(in, line) || std::sscanf(line.c_str(), "insights %zu", &count) != 1) return nullptr;
+    entry.insights.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        Insight insight;
+        if (!std::getline(in, line) || !decode_insight_record(line, insight)) return nullptr;
+        entry.insights.push_back(std::move(insight));
+    }
+
+    if (!std::getline(in, line) || std::sscanf(line.c_str(), "pairs %zu", &count) != 1) return nullptr;
+    entry.pairs.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        PairScore pair;
+        if (!std::getline(in, line)) return nullptr;
+        std::istringstream fields(line);
+        if (!std::getline(fields, pair.attrX, '\t') || !std::getline(fields, pair.attrY, '\t') ||
+            !(fields >> pair.count >> pair.totalScore >> pair.avgScore)) {
+            return nullptr;
+        }
+        entry.pairs.push_back(std::move(pair));
+    }
+    return std::make_shared<const Entry>(std::move(entry));
+}
+
+void InsightCache::writeFile(const std::string& key, const Entry& entry, const std::string& directory) const {
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+
+    // written next to the final name and renamed, so readers never see half a file
+    std::string path = filePath(key, directory);
+    std::string tmp = path + ".tmp" + hex(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        if (!out) return;
+        out << FILE_HEADER << '\n' << key << '\n';
+        out << "insights " << entry.insights.size() << '\n';
+        for (const Insight& insight : entry.insights) {
+            out << encode_insight_record(insight);
+        }
+        out << "pairs " << entry.pairs.size() << '\n';
+        char avg[32];
+        for (const PairScore& pair : entry.pairs) {
+            std::snprintf(avg, sizeof(avg), "%.17g", pair.avgScore);
+            out << pair.attrX << '\t' << pair.attrY << '\t' << pair.count << '\t'
+                << pair.totalScore << '\t' << avg << '\n';
+        }
+        if (!out) {
+            out.close();
+            fs::remove(tmp, ec);
+            return;
+        }
+    }
+    fs::rename(tmp, path, ec);
+    if (ec) fs::remove(tmp, ec);
+}
+
+// deletes the oldest cache files until `keep` are left; other files in the directory are left alone
+void InsightCache::pruneDisk(const std::string& directory, std::size_t keep) const {
+    std::error_code ec;
+    std::vector<std::pair<fs::file_time_type, fs::path>> files;
+    for (fs::directory_iterator it(directory, ec); !ec && it != fs::directory_iterator(); it.increment(ec)) {
+        if (it->path().extension() == ".cache") {
+            std::error_code timeError;
+            files.emplace_back(it->last_write_time(timeError), it->path());
+        }
+    }
+    if (files.size() <= keep) {
+        return;
+    }
+
+    std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+    for (std::size_t i = keep; i < files.size(); ++i) {
+        fs::remove(files[i].second, ec);
+        instr::count("cache.disk_evict");
+    }
+}
@@ -0,0 +1,97 @@
+#ifndef INSIGHT_CACHE_H
+#define INSIGHT_CACHE_H
+
+#include "FingerprintSet.h"
+#include "Insight.h"
+#include "InsightGenerator.h"
+#include "Person.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Memoizes InsightGenerator results.
+ *
+ * Entries are keyed by the dataset hash (PersonRepository::contentHash / dataset_hash),
+ * the blocklist digest, the query and its parameters, and GENERATOR_VERSION, so any
+ * change to the data, the blocklist or the scoring is simply a different key.
+ * The newest `capacity` results are kept in memory (LRU). With a disk directory set,
+ * results are also written there, one file per key, and read back on a memory miss, so
+ * they survive restarts. The directory is bounded too: after a write, the least recently
+ * used files beyond the disk capacity are deleted (a disk hit counts as a use). Insights read back from disk are plain text insights
+ * (key, description and counts), like the ones InsightStore loads.
+ *
+ * Thread safe; a miss runs the generator outside the lock, so two threads asking for the
+ * same thing at once may both compute it.
+ */
+class InsightCache {
+public:
+    // bump when InsightGenerator's thresholds or scoring change, so old disk entries stop matching
+    static constexpr std::uint32_t GENERATOR_VERSION = 1;
+    static constexpr std::size_t DEFAULT_DISK_CAPACITY = 256;   // files
+
+    explicit InsightCache(const InsightGenerator& generator, std::size_t capacity = 64);
+
+    // "" (the default) keeps the cache in memory only; the directory is created on first write
+    void setDiskDirectory(const std::string& directory);
+    std::string diskDirectory() const;
+    void setDiskCapacity(std::size_t files);
+
+    // same as the InsightGenerator functions, plus the hash of `persons`; progress only
+    // hears from a miss, and a cancelled one caches nothing
+    std::vector<Insight> generate(const std::vector<Person>& persons, std::uint64_t datasetHash,
+                                  const FingerprintSet& suppressed, std::size_t limit = 0,
+                                  const ProgressCallback& progress = {});
+    std::vector<Insight> generateGeneric(const std::vector<Person>& persons, std::uint64_t datasetHash,
+                                         const FingerprintSet& suppressed,
+                                         const std::string& attrX, const std::string& attrY,
+                                         std::size_t limit = 0, const ProgressCallback& progress = {});
+    std::vector<PairScore> scorePairs(const std::vector<Person>& persons, std::uint64_t datasetHash,
+                                      const FingerprintSet& suppressed,
+                                      const std::vector<std::string>& attributes);
+
+    // drops the memory tier (files on disk stay)
+    void clear();
+
+    struct Stats {
+        std::size_t hits = 0;       // answered from memory
+        std::size_t diskHits = 0;   // answered from a file
+        std::size_t misses = 0;     // had to run the generator
+        std::size_t entries = 0;    // results in memory now
+    };
+    Stats stats() const;
+
+private:
+    struct Entry {
+        std::vector<Insight> insights;
+        std::vector<PairScore> pairs;
+    };
+    using EntryPtr = std::shared_ptr<const Entry>;
+
+    const InsightGenerator& m_generator;
+    std::size_t m_capacity;
+    std::string m_diskDirectory;
+    std::size_t m_diskCapacity = DEFAULT_DISK_CAPACITY;
+
+    mutable std::mutex m_mutex;
+    std::list<std::pair<std::string, EntryPtr>> m_lru;   // most recently used first
+    std::unordered_map<std::string, std::list<std::pair<std::string, EntryPtr>>::iterator> m_index;
+    Stats m_stats;
+
+    template <typename Compute>
+    EntryPtr getOrCompute(const std::string& key, Compute compute);
+
+    void remember(const std::string& key, EntryPtr entry);
+    std::string filePath(const std::string& key, const std::string& directory) const;
+    EntryPtr readFile(const std::string& key, const std::string& directory) const;
+    void writeFile(const std::string& key, const Entry& entry, const std::string& directory) const;
+    void pruneDisk(const std::string& directory, std::size_t keep) const;
+};
+
+#endif // INSIGHT_CACHE_H
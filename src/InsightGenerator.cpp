@@ -1,12 +1,17 @@
 #include "InsightGenerator.h"
 
+#include "AttributeRegistry.h"
+#include "HeavyHitters.h"
+#include "Instrumentation.h"
+#include "Tracer.h"
 #include "PersonEnums.h"
 
 #include <algorithm>
+#include <array>
 #include <cctype>
 #include <cmath>
 #include <map>
-#include <sstream>
+#include <memory>
 #include <string>
 #include <unordered_map>
 
@@ -23,150 +28,412 @@ constexpr double MIN_REGION_CONFIDENCE = 0.50;
 constexpr std::size_t MIN_FOCUS_SUPPORT = 3;
 constexpr double MIN_FOCUS_CONFIDENCE = 0.50;
 
-std::string lowercase(const std::string& input) {
-    std::string result = input;
-    std::transform(result.begin(), result.end(), result.begin(),
-                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
-    return result;
+// same ordering generate() has always used: score, then support, then description.
+// description() is only rendered here when score and support tie
+bool ranksBefore(const Insight& lhs, const Insight& rhs) {
+    if (lhs.score != rhs.score) {
+        return lhs.score > rhs.score; //insights generated in descending order by score
+    }
+    if (lhs.support != rhs.support) {
+        return lhs.support > rhs.support; //if they have the same score, then return the one with higher support first
+    }
+    return lhs.description() < rhs.description();
 }
-} // namespace
 
-std::vector<Insight> InsightGenerator::generate(
-    const std::vector<Person>& persons,
-    const std::unordered_set<std::string>& suppressedKeys) const {
-    std::vector<Insight> insights;
+// collects candidates; with a limit it keeps a min-heap of the best `limit` seen so far
+// (worst one on top) so nothing has to be fully sorted
+class TopKCollector {
+public:
+    explicit TopKCollector(std::size_t limit) : limit(limit) {}
+
+    void offer(Insight candidate) {
+        if (limit == 0 || items.size() < limit) {
+            items.push_back(std::move(candidate));
+            if (limit != 0) {
+                std::push_heap(items.begin(), items.end(), ranksBefore);
+            }
+            return;
+        }
 
-    auto osInsights = generatePrimaryOsToStudyTime(persons, suppressedKeys);
-    insights.insert(insights.end(), osInsights.begin(), osInsights.end());
+        // heap is full: only swap out the current worst if the new one beats it
+        if (!ranksBefore(candidate, items.front())) {
+            return;
+        }
+        std::pop_heap(items.begin(), items.end(), ranksBefore);
+        items.back() = std::move(candidate);
+        std::push_heap(items.begin(), items.end(), ranksBefore);
+    }
 
-    auto colorInsights = generateFavoriteColorToHobby(persons, suppressedKeys);
-    insights.insert(insights.end(), colorInsights.begin(), colorInsights.end());
+    // best first
+    std::vector<Insight> finish() {
+        std::sort(items.begin(), items.end(), ranksBefore);
+        return std::move(items);
+    }
 
-    auto regionInsights = generateRegionToLanguage(persons, suppressedKeys);
-    insights.insert(insights.end(), regionInsights.begin(), regionInsights.end());
+private:
+    std::size_t limit;
+    std::vector<Insight> items;
+};
+
+// one table's insights and the Y total of each, kept as columns so they can all be
+// scored in one score_cells call once the table is done
+class ScoredCandidates {
+public:
+    void add(Insight insight, std::size_t yTotal) {
+        support.push_back(insight.support);
+        cohort.push_back(insight.population);
+        yTotals.push_back(yTotal);
+        insights.push_back(std::move(insight));
+    }
 
-    auto focusInsights = generateEngineeringFocusToCourseLoad(persons, suppressedKeys);
-    insights.insert(insights.end(), focusInsights.begin(), focusInsights.end());
+    std::vector<Insight> finish(ScoringMode mode, std::size_t population, std::size_t limit) {
+        std::vector<int> scores(insights.size());
+        score_cells(mode, support.data(), cohort.data(), yTotals.data(), insights.size(), population, scores.data());
 
-    std::sort(insights.begin(), insights.end(), [](const Insight& lhs, const Insight& rhs) {
-        if (lhs.score != rhs.score) {
-            return lhs.score > rhs.score; //insights generated in descending order by score
+        TopKCollector collector(limit);
+        for (std::size_t i = 0; i < insights.size(); ++i) {
+            insights[i].score = scores[i];
+            collector.offer(std::move(insights[i]));
         }
-        if (lhs.support != rhs.support) {
-            return lhs.support > rhs.support; //if they have the same score, then return the one with higher support first
-        }
-        return lhs.description < rhs.description;
-    });
+        return collector.finish();
+    }
 
-    return insights;
+private:
+    std::vector<std::size_t> support;
+    std::vector<std::size_t> cohort;
+    std::vector<std::size_t> yTotals;
+    std::vector<Insight> insights;
+};
+
+// interns every tag of a person once so the counting loops below only deal with ids
+void internTags(const std::unordered_set<std::string>& tags,
+                InsightValuePool& pool,
+                std::vector<std::uint32_t>& out) {
+    out.clear();
+    for (const std::string& tag : tags) {
+        out.push_back(pool.intern(tag));
+    }
 }
 
-std::vector<Insight> InsightGenerator::generatePair(
-    const std::vector<Person>& persons,
-    const std::unordered_set<std::string>& suppressedKeys,
-    InsightPairType which) const
-{
-    switch (which) {
-        case InsightPairType::OsStudy:
-            return generatePrimaryOsToStudyTime(persons, suppressedKeys);
-
-        case InsightPairType::ColorHobby:
-            return generateFavoriteColorToHobby(persons, suppressedKeys);
+// picks the most common Y of a cohort. if the user blocked that insight, the next most common Y
+// gets a chance instead of the cohort just going silent. makeInsight(y) builds the text-less
+// candidate for a Y so only its fingerprint is looked at here.
+// returns the support of the chosen Y (0 when every Y is blocked)
+template <typename Counts, typename MakeInsight>
+std::size_t pickBestY(const Counts& counts,
+                      const FingerprintSet& suppressed,
+                      MakeInsight makeInsight,
+                      Insight& chosen) {
+    auto best = std::max_element(
+        counts.begin(), counts.end(),
+        [](const auto& lhs, const auto& rhs) { return lhs.second < rhs.second; });
+
+    if (best == counts.end()) {
+        return 0;
+    }
 
-        case InsightPairType::RegionLanguage:
-            return generateRegionToLanguage(persons, suppressedKeys);
+    chosen = makeInsight(best->first);
+    if (suppressed.empty() || !suppressed.contains(chosen.fingerprint())) {
+        return best->second;
+    }
 
-        case InsightPairType::FocusCourse:
-            return generateEngineeringFocusToCourseLoad(persons, suppressedKeys);
+    // rare path: the winner is blocked, walk the others from most to least common
+    using Key = typename Counts::key_type;
+    std::vector<std::pair<std::size_t, Key>> ranked;
+    ranked.reserve(counts.size());
+    for (auto it = counts.begin(); it != counts.end(); ++it) {
+        if (it != best) {
+            ranked.emplace_back(it->second, it->first);
+        }
     }
+    std::stable_sort(ranked.begin(), ranked.end(),
+                     [](const auto& lhs, const auto& rhs) { return lhs.first > rhs.first; });
 
-    return {};
+    for (const auto& [count, y] : ranked) {
+        chosen = makeInsight(y);
+        if (!suppressed.contains(chosen.fingerprint())) {
+            return count;
+        }
+    }
+    return 0;
 }
 
+// one cohort's row of a flat count table
+struct CountRow {
+    const std::size_t* counts;
+    std::size_t n;
+
+    std::size_t size() const { return n; }
+    std::size_t operator[](std::size_t i) const { return counts[i]; }
+};
+
+// pickBestY for a cohort counted into an array indexed by Y (a std::array, so the argmax runs
+// over a compile-time number of slots, or a CountRow); ties go to the lowest index like they
+// do in a std::map. chosenCode gets the index the insight was made from
+template <typename Counts, typename MakeInsight>
+std::size_t pickBestCode(const Counts& counts,
+                         const FingerprintSet& suppressed,
+                         MakeInsight makeInsight,
+                         Insight& chosen,
+                         std::size_t& chosenCode) {
+    const std::size_t n = counts.size();
+    if (n == 0) {
+        return 0;
+    }
+    std::size_t best = 0;
+    for (std::size_t y = 1; y < n; ++y) {
+        best = counts[y] > counts[best] ? y : best;
+    }
+    if (counts[best] == 0) {
+        return 0;
+    }
 
-//eligible population counts the number of people that can even be considered; their attributes for aren't empty
-
-std::vector<Insight> InsightGenerator::generatePrimaryOsToStudyTime(
-    const std::vector<Person>& persons,
-    const std::unordered_set<std::string>& suppressedKeys) const {
-    struct Distribution {
-        std::size_t cohortSize = 0;
-        std::map<StudyTime, std::size_t> studyCounts;
-    };
+    chosen = makeInsight(static_cast<std::uint32_t>(best));
+    if (suppressed.empty() || !suppressed.contains(chosen.fingerprint())) {
+        chosenCode = best;
+        return counts[best];
+    }
 
-    std::map<PrimaryOS, Distribution> osDistributions;
-    std::size_t eligiblePopulation = 0; // number of people who have knwon OS and known study time
+    // rare path: the winner is blocked, walk the others from most to least common
+    std::vector<std::uint32_t> ranked(n);
+    for (std::size_t y = 0; y < n; ++y) {
+        ranked[y] = static_cast<std::uint32_t>(y);
+    }
+    std::stable_sort(ranked.begin(), ranked.end(),
+                     [&](std::uint32_t lhs, std::uint32_t rhs) { return counts[lhs] > counts[rhs]; });
 
-    for (const Person& person : persons) {
-        PrimaryOS os = person.getPrimaryOS();
-        StudyTime study = person.getStudyTime();
-        if (os == PrimaryOS::Unknown || study == StudyTime::Unknown) { //uses 'unknown' because os and study times are enums
+    for (std::uint32_t y : ranked) {
+        if (counts[y] == 0) {
+            break;
+        }
+        if (y == best) {
             continue;
         }
-
-        eligiblePopulation++;
-        Distribution& dist = osDistributions[os];
-        dist.cohortSize++;
-        dist.studyCounts[study]++;
+        chosen = makeInsight(y);
+        if (!suppressed.contains(chosen.fingerprint())) {
+            chosenCode = y;
+            return counts[y];
+        }
     }
+    return 0;
+}
 
-    std::vector<Insight> insights;
-    if (eligiblePopulation == 0) {
-        return insights;
-    }
+/**
+ * Counting kernel for a pair of closed enums (os, study, region, focus). Both cardinalities
+ * are known at compile time, so the whole table is one std::array of counts (44 x 32 at the
+ * most, ~11 KB) that stays in L1, the row/column totals are fixed-length sums, and nothing
+ * is hashed or allocated per person.
+ */
+template <Attribute X, Attribute Y>
+struct EnumPairTable {
+    static constexpr std::size_t NX = AttributeTraits<X>::cardinality;
+    static constexpr std::size_t NY = AttributeTraits<Y>::cardinality;
+    static_assert(NX > 0 && NY > 0, "enum pair kernels need two closed enums");
+
+    std::array<std::array<std::size_t, NY>, NX> joint{};
+    std::array<std::size_t, NX> cohort{};
+    std::array<std::size_t, NY> yTotals{};
+    std::size_t eligiblePopulation = 0;
 
-    for (const auto& [os, dist] : osDistributions) {
-        if (dist.cohortSize < MIN_OS_SUPPORT) {
-            continue;
+    explicit EnumPairTable(const std::vector<Person>& persons) {
+        for (const Person& person : persons) {
+            std::uint32_t x = AttributeTraits<X>::code(person);
+            std::uint32_t y = AttributeTraits<Y>::code(person);
+            if (x == NO_VALUE || y == NO_VALUE) {
+                continue;
+            }
+            joint[x][y]++;
         }
 
-        auto best = std::max_element(
-            dist.studyCounts.begin(), dist.studyCounts.end(),
-            [](const auto& lhs, const auto& rhs) { return lhs.second < rhs.second; });
+        // the margins come out of the table instead of being counted per person
+        for (std::size_t x = 0; x < NX; ++x) {
+            for (std::size_t y = 0; y < NY; ++y) {
+                cohort[x] += joint[x][y];
+                yTotals[y] += joint[x][y];
+            }
+            eligiblePopulation += cohort[x];
+        }
+    }
+};
+
+template <Attribute X, Attribute Y>
+std::vector<Insight> generateEnumPair(const std::vector<Person>& persons,
+                                      const FingerprintSet& suppressed,
+                                      InsightKind kind,
+                                      std::size_t minSupport,
+                                      double minConfidence,
+                                      ScoringMode scoring,
+                                      std::size_t limit) {
+    EnumPairTable<X, Y> table(persons);
+    if (table.eligiblePopulation == 0) {
+        return {};
+    }
 
-        if (best == dist.studyCounts.end()) {
+    ScoredCandidates candidates;
+    for (std::size_t x = 0; x < table.NX; ++x) {
+        if (table.cohort[x] < minSupport) {
             continue;
         }
 
-        std::size_t support = best->second;
-        double confidence = static_cast<double>(support) / static_cast<double>(dist.cohortSize);
-        if (confidence < MIN_OS_CONFIDENCE) {
+        Insight insight;
+        std::size_t chosenY = 0;
+        std::size_t support = pickBestCode(table.joint[x], suppressed, [&](std::uint32_t y) {
+            Insight candidate;
+            candidate.kind = kind;
+            candidate.attrX = X;
+            candidate.attrY = Y;
+            candidate.valueX = static_cast<std::uint32_t>(x);
+            candidate.valueY = y;
+            return candidate;
+        }, insight, chosenY);
+
+        if (support == 0) {
             continue;
         }
 
-        std::string key = "primary_os = " + to_string(os) + " -> study_time = " + to_string(best->first);
-        if (suppressedKeys.count(key) > 0) {
+        double confidence = static_cast<double>(support) / static_cast<double>(table.cohort[x]);
+        if (confidence < minConfidence) {
             continue;
         }
 
-        Insight insight;
-        insight.key = key;
         insight.support = support;
-        insight.population = dist.cohortSize;
-        insight.score = scoreFromCounts(support, dist.cohortSize, eligiblePopulation);
+        insight.population = table.cohort[x];
+        candidates.add(std::move(insight), table.yTotals[chosenY]);
+    }
 
-        std::ostringstream sentence;
-        sentence << "People whose primary OS is " << to_string(os)
-                 << " tend to study in the " << describeStudyTime(best->first) << ".";
-        insight.description = sentence.str();
+    return candidates.finish(scoring, table.eligiblePopulation, limit);
+}
 
-        insights.push_back(std::move(insight));
+// runs generateEnumPair<X, Y> for a pair only known at runtime; false if either isn't a closed enum
+bool dispatchEnumPair(Attribute attrX, Attribute attrY, std::vector<Insight>& out,
+                      const std::vector<Person>& persons, const FingerprintSet& suppressed,
+                      InsightKind kind, std::size_t minSupport, double minConfidence,
+                      ScoringMode scoring, std::size_t limit) {
+    const AttributeInfo* infoX = attribute_info(attrX);
+    const AttributeInfo* infoY = attribute_info(attrY);
+    if (!infoX || !infoY || infoX->cardinality == 0 || infoY->cardinality == 0) {
+        return false;
+    }
+
+    return visit_attribute(attrX, [&](auto x) {
+        return visit_attribute(attrY, [&](auto y) {
+            constexpr Attribute X = decltype(x)::value;
+            constexpr Attribute Y = decltype(y)::value;
+            if constexpr (AttributeTraits<X>::cardinality > 0 && AttributeTraits<Y>::cardinality > 0) {
+                out = generateEnumPair<X, Y>(persons, suppressed, kind, minSupport, minConfidence,
+                                             scoring, limit);
+                return true;
+            } else {
+                return false;
+            }
+        });
+    });
+}
+} // namespace
+
+std::vector<Insight> InsightGenerator::generate(
+    const std::vector<Person>& persons,
+    const FingerprintSet& suppressed,
+    std::size_t limit,
+    const ProgressCallback& progress) const {
+    instr::ScopedTimer timer("generate");
+    timer.addRows(persons.size());
+    std::vector<Insight> insights;
+    constexpr std::size_t PASSES = 4;
+
+    // in top-k mode each pair hands back at most `limit`, so this merge stays small
+    report_progress(progress, 0, PASSES);
+    auto osInsights = generatePrimaryOsToStudyTime(persons, suppressed, limit);
+    insights.insert(insights.end(), osInsights.begin(), osInsights.end());
+
+    report_progress(progress, 1, PASSES);
+    auto colorInsights = generateFavoriteColorToHobby(persons, suppressed, limit);
+    insights.insert(insights.end(), colorInsights.begin(), colorInsights.end());
+
+    report_progress(progress, 2, PASSES);
+    auto regionInsights = generateRegionToLanguage(persons, suppressed, limit);
+    insights.insert(insights.end(), regionInsights.begin(), regionInsights.end());
+
+    report_progress(progress, 3, PASSES);
+    auto focusInsights = generateEngineeringFocusToCourseLoad(persons, suppressed, limit);
+    insights.insert(insights.end(), focusInsights.begin(), focusInsights.end());
+    report_progress(progress, PASSES, PASSES);
+
+    {
+        trace::Span merge("generate.merge");
+        std::sort(insights.begin(), insights.end(), ranksBefore);
+
+        if (limit > 0 && insights.size() > limit) {
+            insights.resize(limit);
+        }
     }
 
     return insights;
 }
 
+std::vector<Insight> InsightGenerator::generatePair(
+    const std::vector<Person>& persons,
+    const FingerprintSet& suppressed,
+    InsightPairType which,
+    std::size_t limit) const
+{
+    switch (which) {
+        case InsightPairType::OsStudy:
+            return generatePrimaryOsToStudyTime(persons, suppressed, limit);
+
+        case InsightPairType::ColorHobby:
+            return generateFavoriteColorToHobby(persons, suppressed, limit);
+
+        case InsightPairType::RegionLanguage:
+            return generateRegionToLanguage(persons, suppressed, limit);
+
+        case InsightPairType::FocusCourse:
+            return generateEngineeringFocusToCourseLoad(persons, suppressed, limit);
+    }
+
+    return {};
+}
+
+
+//eligible population counts the number of people that can even be considered; their attributes for aren't empty
+
+std::vector<Insight> InsightGenerator::generatePrimaryOsToStudyTime(
+    const std::vector<Person>& persons,
+    const FingerprintSet& suppressed,
+    std::size_t limit) const {
+    instr::ScopedTimer timer("generate.os_study");
+    timer.addRows(persons.size());
+
+    return generateEnumPair<Attribute::Os, Attribute::Study>(
+        persons, suppressed, InsightKind::OsStudy, MIN_OS_SUPPORT, MIN_OS_CONFIDENCE, m_scoring, limit);
+}
+
 std::vector<Insight> InsightGenerator::generateFavoriteColorToHobby(
     const std::vector<Person>& persons,
-    const std::unordered_set<std::string>& suppressedKeys) const {
+    const FingerprintSet& suppressed,
+    std::size_t limit) const {
+    if (m_tagSketchCapacity != 0) {
+        return generateTagSketched(persons, suppressed, InsightKind::ColorHobby,
+                                   Attribute::Color, Attribute::Hobby,
+                                   MIN_COLOR_SUPPORT, MIN_COLOR_CONFIDENCE, limit);
+    }
+
+    instr::ScopedTimer timer("generate.color_hobby");
+    timer.addRows(persons.size());
+
     struct ColorDistribution {
         std::size_t cohortSize = 0;
-        std::unordered_map<std::string, std::size_t> hobbyCounts;
+        std::unordered_map<std::uint32_t, std::size_t> hobbyCounts;
     };
 
-    std::unordered_map<std::string, ColorDistribution> colorDistributions;
+    auto pool = std::make_shared<InsightValuePool>();
+    std::unordered_map<std::uint32_t, ColorDistribution> colorDistributions;
+    std::unordered_map<std::uint32_t, std::size_t> hobbyTotals;
     std::size_t eligiblePopulation = 0;
 
+    std::vector<std::uint32_t> colorIds;
+    std::vector<std::uint32_t> hobbyIds;
+
     for (const Person& person : persons) {
         const auto& colors = person.getFavoriteColors();
         const auto& hobbies = person.getHobbies();
@@ -175,73 +442,87 @@ std::vector<Insight> InsightGenerator::generateFavoriteColorToHobby(
         }
 
         eligiblePopulation++;
-        for (const std::string& color : colors) {
+        internTags(colors, *pool, colorIds);
+        internTags(hobbies, *pool, hobbyIds);
+        for (std::uint32_t hobby : hobbyIds) {
+            hobbyTotals[hobby]++;
+        }
+        for (std::uint32_t color : colorIds) {
             ColorDistribution& dist = colorDistributions[color];
             dist.cohortSize++;
-            for (const std::string& hobby : hobbies) {
+            for (std::uint32_t hobby : hobbyIds) {
                 dist.hobbyCounts[hobby]++;
             }
         }
     }
 
-    std::vector<Insight> insights;
     if (eligiblePopulation == 0) {
-        return insights;
+        return {};
     }
 
+    ScoredCandidates candidates;
+
     for (auto& [color, dist] : colorDistributions) {
         if (dist.cohortSize < MIN_COLOR_SUPPORT) {
             continue;
         }
 
-        auto best = std::max_element(
-            dist.hobbyCounts.begin(), dist.hobbyCounts.end(),
-            [](const auto& lhs, const auto& rhs) { return lhs.second < rhs.second; });
-
-        if (best == dist.hobbyCounts.end()) {
+        Insight insight;
+        std::size_t support = pickBestY(dist.hobbyCounts, suppressed, [&pool, color = color](std::uint32_t hobby) {
+            Insight candidate;
+            candidate.kind = InsightKind::ColorHobby;
+            candidate.attrX = Attribute::Color;
+            candidate.attrY = Attribute::Hobby;
+            candidate.valueX = color;
+            candidate.valueY = hobby;
+            candidate.values = pool;
+            return candidate;
+        }, insight);
+
+        if (support == 0) {
             continue;
         }
 
-        std::size_t support = best->second;
         double confidence = static_cast<double>(support) / static_cast<double>(dist.cohortSize);
         if (confidence < MIN_COLOR_CONFIDENCE) {
             continue;
         }
 
-        std::string key = "favorite_color = " + lowercase(color) + " -> hobby = " + lowercase(best->first);
-        if (suppressedKeys.count(key) > 0) {
-            continue;
-        }
-
-        Insight insight;
-        insight.key = key;
         insight.support = support;
         insight.population = dist.cohortSize;
-        insight.score = scoreFromCounts(support, dist.cohortSize, eligiblePopulation);
-
-        std::ostringstream sentence;
-        sentence << "People whose favorite color is " << color
-                 << " tend to have a hobby of " << best->first << ".";
-        insight.description = sentence.str();
-
-        insights.push_back(std::move(insight));
+        std::size_t yTotal = hobbyTotals[insight.valueY];
+        candidates.add(std::move(insight), yTotal);
     }
 
-    return insights;
+    return candidates.finish(m_scoring, eligiblePopulation, limit);
 }
 
 
 std::vector<Insight> InsightGenerator::generateRegionToLanguage(
     const std::vector<Person>& persons,
-    const std::unordered_set<std::string>& suppressedKeys) const {
+    const FingerprintSet& suppressed,
+    std::size_t limit) const {
+    if (m_tagSketchCapacity != 0) {
+        return generateTagSketched(persons, suppressed, InsightKind::RegionLanguage,
+                                   Attribute::Region, Attribute::Language,
+                                   MIN_REGION_SUPPORT, MIN_REGION_CONFIDENCE, limit);
+    }
+
+    instr::ScopedTimer timer("generate.region_language");
+    timer.addRows(persons.size());
+
     struct RegionLangDistribution {
         std::size_t cohortSize = 0;                         // # people in this region (with known languages)
-        std::unordered_map<std::string, std::size_t> languageCounts;
+        std::unordered_map<std::uint32_t, std::size_t> languageCounts;
     };
 
+    auto pool = std::make_shared<InsightValuePool>();
     std::map<Region, RegionLangDistribution> regionDistributions;
+    std::unordered_map<std::uint32_t, std::size_t> languageTotals;
     std::size_t eligiblePopulation = 0; // people with known region AND at least one language
 
+    std::vector<std::uint32_t> languageIds;
+
     for (const Person& person : persons) {
         Region region = person.getRegion();
         const auto& languages = person.getLanguages();
@@ -254,161 +535,160 @@ std::vector<Insight> InsightGenerator::generateRegionToLanguage(
         RegionLangDistribution& dist = regionDistributions[region];
         dist.cohortSize++;
 
-        for (const std::string& lang : languages) {
+        internTags(languages, *pool, languageIds);
+        for (std::uint32_t lang : languageIds) {
             dist.languageCounts[lang]++;
+            languageTotals[lang]++;
         }
     }
 
-    std::vector<Insight> insights;
     if (eligiblePopulation == 0) {
-        return insights;
+        return {};
     }
 
+    ScoredCandidates candidates;
+
     for (auto& [region, dist] : regionDistributions) {
         if (dist.cohortSize < MIN_REGION_SUPPORT) {
             continue;
         }
 
-        auto best = std::max_element(
-            dist.languageCounts.begin(), dist.languageCounts.end(),
-            [](const auto& lhs, const auto& rhs) { return lhs.second < rhs.second; });
-
-        if (best == dist.languageCounts.end()) {
+        Insight insight;
+        std::size_t support = pickBestY(dist.languageCounts, suppressed, [&pool, region = region](std::uint32_t lang) {
+            Insight candidate;
+            candidate.kind = InsightKind::RegionLanguage;
+            candidate.attrX = Attribute::Region;
+            candidate.attrY = Attribute::Language;
+            candidate.valueX = static_cast<std::uint32_t>(region);
+            candidate.valueY = lang;
+            candidate.values = pool;
+            return candidate;
+        }, insight);
+
+        if (support == 0) {
             continue;
         }
 
-        std::size_t support = best->second;
         double confidence = static_cast<double>(support) / static_cast<double>(dist.cohortSize);
         if (confidence < MIN_REGION_CONFIDENCE) {
             continue;
         }
 
-        std::string key = "region = " + to_string(region) +
-                          " -> language = " + lowercase(best->first);
-        if (suppressedKeys.count(key) > 0) {
-            continue;
-        }
-
-        Insight insight;
-        insight.key = key;
         insight.support = support;
         insight.population = dist.cohortSize;
-        insight.score = scoreFromCounts(support, dist.cohortSize, eligiblePopulation);
-
-        std::ostringstream sentence;
-        sentence << "People from " << to_string(region)
-                 << " tend to speak " << best->first << ".";
-        insight.description = sentence.str();
-
-        insights.push_back(std::move(insight));
+        std::size_t yTotal = languageTotals[insight.valueY];
+        candidates.add(std::move(insight), yTotal);
     }
 
-    return insights;
+    return candidates.finish(m_scoring, eligiblePopulation, limit);
 }
 
 std::vector<Insight> InsightGenerator::generateEngineeringFocusToCourseLoad(
     const std::vector<Person>& persons,
-    const std::unordered_set<std::string>& suppressedKeys) const {
-    struct FocusLoadDistribution {
-        std::size_t cohortSize = 0;             // # people with this focus and valid courseLoad
-        std::map<int, std::size_t> loadCounts;  // courseLoad value -> count
-    };
-
-    std::map<EngineeringFocus, FocusLoadDistribution> focusDistributions;
-    std::size_t eligiblePopulation = 0; // people with known focus and positive courseLoad
-
+    const FingerprintSet& suppressed,
+    std::size_t limit) const {
+    instr::ScopedTimer timer("generate.focus_course");
+    timer.addRows(persons.size());
+
+    constexpr std::size_t FOCUS_COUNT = AttributeTraits<Attribute::Focus>::cardinality;
+    using FocusTraits = AttributeTraits<Attribute::Focus>;
+    using CourseTraits = AttributeTraits<Attribute::Course>;
+
+    // pass 1: which course loads occur (people with known focus and positive courseLoad),
+    // so the table below can be plain arrays indexed by focus and load (or load range)
+    IntHistogram loads;
     for (const Person& person : persons) {
-        EngineeringFocus focus = person.getEngineeringFocus();
-        int load = person.getCourseLoad();
-
-        if (focus == EngineeringFocus::Unknown || load <= 0) { //eng focuses are enums while load is a number
+        std::uint32_t focus = FocusTraits::code(person);
+        std::uint32_t load = CourseTraits::code(person);
+        if (focus == NO_VALUE || load == NO_VALUE) { //eng focuses are enums while load is a number
             continue;
         }
-
-        eligiblePopulation++;
-        FocusLoadDistribution& dist = focusDistributions[focus];
-        dist.cohortSize++;
-        dist.loadCounts[load]++;
+        loads.add(static_cast<int>(load));
     }
 
-    std::vector<Insight> insights;
+    const std::size_t eligiblePopulation = loads.total();
     if (eligiblePopulation == 0) {
-        return insights;
+        return {};
     }
 
-    for (const auto& [focus, dist] : focusDistributions) {
-        if (dist.cohortSize < MIN_FOCUS_SUPPORT) {
+    const bool binned = m_binning.mode != BinningMode::Off;
+    NumericBins bins = binned ? NumericBins::build(loads, m_binning) : NumericBins::identity(loads);
+    const std::size_t loadCount = bins.size();
+
+    std::shared_ptr<InsightValuePool> pool;
+    std::vector<std::uint32_t> loadValues(loadCount);
+    if (binned) {
+        pool = std::make_shared<InsightValuePool>();
+    }
+    for (std::size_t b = 0; b < loadCount; ++b) {
+        loadValues[b] = binned ? RANGE_VALUE | pool->intern(bins.label(b))
+                               : static_cast<std::uint32_t>(bins.low(b));
+    }
+
+    // pass 2: focus x load counts
+    std::vector<std::size_t> joint(FOCUS_COUNT * loadCount, 0);
+    for (const Person& person : persons) {
+        std::uint32_t focus = FocusTraits::code(person);
+        std::uint32_t load = CourseTraits::code(person);
+        if (focus == NO_VALUE || load == NO_VALUE) {
             continue;
         }
+        joint[focus * loadCount + bins.binOf(static_cast<int>(load))]++;
+    }
+
+    std::array<std::size_t, FOCUS_COUNT> cohort{};
+    std::vector<std::size_t> loadTotals(loadCount, 0);
+    for (std::size_t f = 0; f < FOCUS_COUNT; ++f) {
+        for (std::size_t b = 0; b < loadCount; ++b) {
+            cohort[f] += joint[f * loadCount + b];
+            loadTotals[b] += joint[f * loadCount + b];
+        }
+    }
 
-        auto best = std::max_element(
-            dist.loadCounts.begin(), dist.loadCounts.end(),
-            [](const auto& lhs, const auto& rhs) { return lhs.second < rhs.second; });
+    ScoredCandidates candidates;
 
-        if (best == dist.loadCounts.end()) {
+    for (std::size_t f = 0; f < FOCUS_COUNT; ++f) {
+        if (cohort[f] < MIN_FOCUS_SUPPORT) {
             continue;
         }
 
-        std::size_t support = best->second;
-        double confidence = static_cast<double>(support) / static_cast<double>(dist.cohortSize);
-        if (confidence < MIN_FOCUS_CONFIDENCE) {
+        Insight insight;
+        CountRow row{joint.data() + f * loadCount, loadCount};
+        std::size_t bin = 0;
+        std::size_t support = pickBestCode(row, suppressed, [&](std::uint32_t b) {
+            Insight candidate;
+            candidate.kind = InsightKind::FocusCourse;
+            candidate.attrX = Attribute::Focus;
+            candidate.attrY = Attribute::Course;
+            candidate.valueX = static_cast<std::uint32_t>(f);
+            candidate.valueY = loadValues[b];
+            candidate.values = pool;
+            return candidate;
+        }, insight, bin);
+
+        if (support == 0) {
             continue;
         }
 
-        std::string key = "engineering_focus = " + to_string(focus) +
-                          " -> course_load = " + std::to_string(best->first);
-        if (suppressedKeys.count(key) > 0) {
+        double confidence = static_cast<double>(support) / static_cast<double>(cohort[f]);
+        if (confidence < MIN_FOCUS_CONFIDENCE) {
             continue;
         }
 
-        Insight insight;
-        insight.key = key;
         insight.support = support;
-        insight.population = dist.cohortSize;
-        insight.score = scoreFromCounts(support, dist.cohortSize, eligiblePopulation);
-
-        std::ostringstream sentence;
-        sentence << "People whose engineering focus is " << to_string(focus)
-                 << " tend to take about " << best->first << " courses.";
-        insight.description = sentence.str();
-
-        insights.push_back(std::move(insight));
+        insight.population = cohort[f];
+        candidates.add(std::move(insight), loadTotals[bin]);
     }
 
-    return insights;
+    return candidates.finish(m_scoring, eligiblePopulation, limit);
 }
 
 
 int InsightGenerator::scoreFromCounts(std::size_t support,
                                       std::size_t cohortSize,
                                       std::size_t globalPopulation) {
-    if (support == 0 || cohortSize == 0 || globalPopulation == 0) {
-        return 0;
-    }
-
-    double confidence = static_cast<double>(support) / static_cast<double>(cohortSize);
-    double coverage = static_cast<double>(support) / static_cast<double>(globalPopulation);
-    double rawScore = (confidence * 0.7 + coverage * 0.3) * 100.0;
-    if (rawScore < 0.0) {
-        rawScore = 0.0;
-    } else if (rawScore > 100.0) {
-        rawScore = 100.0;
-    }
-
-    return static_cast<int>(std::round(rawScore));
-}
-
-std::string InsightGenerator::describeStudyTime(StudyTime studyTime) {
-    switch (studyTime) {
-        case StudyTime::Morning:
-            return "mornings";
-        case StudyTime::Afternoon:
-            return "afternoons";
-        case StudyTime::Night:
-            return "nights";
-        default:
-            return "day";
-    }
+    // the confidence mode doesn't look at the Y total
+    return score_cell(ScoringMode::Confidence, support, cohortSize, 0, globalPopulation);
 }
 
 
@@ -418,213 +698,551 @@ std::string InsightGenerator::describeStudyTime(StudyTime studyTime) {
 //supports any topic combination
 
 namespace {
-    // helper that makes sure it's all lowercase and consistent
-    std::string normalizeAttrName(const std::string& attr) {
-        std::string normalized = lowercase(attr);
-        
-        // mapping synonyms to the main names to prevent derrors
-        if (normalized == "os" || normalized == "primary_os" || normalized == "primaryos")
-            return "os";
-        if (normalized == "study" || normalized == "studytime" || normalized == "study_time")
-            return "study";
-        if (normalized == "color" || normalized == "favoritecolor" || normalized == "favourite_color" || normalized == "favoritecolors")
-            return "color";
-        if (normalized == "hobby" || normalized == "hobbies")
-            return "hobby";
-        if (normalized == "region" || normalized == "area")
-            return "region";
-        if (normalized == "language" || normalized == "lang" || normalized == "languages")
-            return "language";
-        if (normalized == "focus" || normalized == "major" || normalized == "engineering" || normalized == "engfocus" || normalized == "engineeringfocus")
-            return "focus";
-        if (normalized == "course" || normalized == "courseload" || normalized == "load" || normalized == "courses")
-            return "course";
-        if (normalized == "graduation" || normalized == "gradyear" || normalized == "year")
-            return "graduation";
-        
-        return normalized;
-    }
-
-    // gets the values from a Person
-    std::vector<std::string> extractAttributeValues(const Person& person, const std::string& attrName) {
-        std::string attr = normalizeAttrName(attrName);
-        
-        if (attr == "os") {
-            PrimaryOS os = person.getPrimaryOS();
-            if (os == PrimaryOS::Unknown) return {};
-            return {to_string(os)};
-        }
-        else if (attr == "study") {
-            StudyTime st = person.getStudyTime();
-            if (st == StudyTime::Unknown) return {};
-            return {to_string(st)};
-        }
-        else if (attr == "color") {
-            const auto& colors = person.getFavoriteColors();
-            return std::vector<std::string>(colors.begin(), colors.end());
-        }
-        else if (attr == "hobby") {
-            const auto& hobbies = person.getHobbies();
-            return std::vector<std::string>(hobbies.begin(), hobbies.end());
-        }
-        else if (attr == "region") {
-            Region r = person.getRegion();
-            if (r == Region::Unknown) return {};
-            return {to_string(r)};
-        }
-        else if (attr == "language") {
-            const auto& langs = person.getLanguages();
-            return std::vector<std::string>(langs.begin(), langs.end());
-        }
-        else if (attr == "focus") {
-            EngineeringFocus f = person.getEngineeringFocus();
-            if (f == EngineeringFocus::Unknown) return {};
-            return {to_string(f)};
-        }
-        else if (attr == "course") {
-            int load = person.getCourseLoad();
-            if (load <= 0) return {};
-            return {std::to_string(load)};
-        }
-        else if (attr == "graduation") {
-            int year = person.getGraduationYear();
-            if (year <= 0) return {};
-            return {std::to_string(year)};
-        }
-        
-        return {};
-    }
-
-    // what gets shown to the user
-    std::string getAttributeDisplayName(const std::string& attrName) {
-        std::string attr = normalizeAttrName(attrName);
-        
-        if (attr == "os") return "primary OS";
-        if (attr == "study") return "study time";
-        if (attr == "color") return "favorite color";
-        if (attr == "hobby") return "hobby";
-        if (attr == "region") return "region";
-        if (attr == "language") return "language";
-        if (attr == "focus") return "engineering focus";
-        if (attr == "course") return "course load";
-        if (attr == "graduation") return "graduation year";
-        
-        return attrName;
-    }
-
     constexpr std::size_t MIN_GENERIC_SUPPORT = 2;
     constexpr double MIN_GENERIC_CONFIDENCE = 0.50; //loser bounds but some insights are still under 50 
-}
 
-std::vector<Insight> InsightGenerator::generateGeneric(
-    const std::vector<Person>& persons,
-    const std::unordered_set<std::string>& suppressedKeys,
-    const std::string& attrX,
-    const std::string& attrY) const {
-    
     //for each X  count occurrences of Y 
     struct Distribution {
         std::size_t cohortSize = 0;
-        std::unordered_map<std::string, std::size_t> yCounts;
+        std::unordered_map<std::uint32_t, std::size_t> yCounts;
+    };
+
+    struct GenericCounts {
+        std::shared_ptr<InsightValuePool> pool = std::make_shared<InsightValuePool>();
+        std::unordered_map<std::uint32_t, Distribution> distributions;
+        std::unordered_map<std::uint32_t, std::size_t> yTotals;   // people with each Y
+        std::size_t eligiblePopulation = 0;
+    };
+
+    // reads one attribute's value ids; with binning on, a numeric attribute's number is
+    // swapped for the range value of its bin
+    struct AttributeReader {
+        ValueExtractor extract = nullptr;
+        std::shared_ptr<const NumericBins> bins;
+        std::vector<std::uint32_t> binValues;   // bin -> RANGE_VALUE | label id
+
+        explicit operator bool() const { return extract != nullptr; }
+
+        void operator()(const Person& person, InsightValuePool& pool, std::vector<std::uint32_t>& out) const {
+            extract(person, pool, out);
+            if (bins) {
+                for (std::uint32_t& value : out) {
+                    value = binValues[bins->binOf(static_cast<int>(value))];
+                }
+            }
+        }
     };
-    
-    std::unordered_map<std::string, Distribution> distributions;
-    std::size_t eligiblePopulation = 0;
-    
-    // Nnames for x and y
-    std::string normX = normalizeAttrName(attrX);
-    std::string normY = normalizeAttrName(attrY);
-    
 
+    // the bins come from one pass over the attribute's numbers
+    AttributeReader makeReader(const std::vector<Person>& persons, Attribute attr,
+                               const BinningOptions& binning, InsightValuePool& pool) {
+        AttributeReader reader;
+        reader.extract = value_extractor(attr);
+        const AttributeInfo* info = attribute_info(attr);
+        if (binning.mode == BinningMode::Off || !info || !info->numeric) {
+            return reader;
+        }
 
+        CodeReader code = code_reader(attr);
+        IntHistogram histogram;
+        for (const Person& person : persons) {
+            std::uint32_t value = code(person);
+            if (value != NO_VALUE) {
+                histogram.add(static_cast<int>(value));
+            }
+        }
 
-    // goes thriough csv and build distributions
-    for (const Person& person : persons) {
-        std::vector<std::string> xValues = extractAttributeValues(person, normX);
-        std::vector<std::string> yValues = extractAttributeValues(person, normY);
-        
-        if (xValues.empty() || yValues.empty()) {
-            continue;
+        auto bins = std::make_shared<NumericBins>(NumericBins::build(histogram, binning));
+        for (std::size_t b = 0; b < bins->size(); ++b) {
+            reader.binValues.push_back(RANGE_VALUE | pool.intern(bins->label(b)));
         }
-        
-        eligiblePopulation++;
-        
-        //for each X this person has
-        for (const std::string& xVal : xValues) {
-            Distribution& dist = distributions[xVal];
-            dist.cohortSize++;
+        reader.bins = std::move(bins);
+        return reader;
+    }
+
+    GenericCounts countGeneric(const std::vector<Person>& persons, Attribute normX, Attribute normY,
+                               const BinningOptions& binning) {
+        GenericCounts counts;
+
+        AttributeReader extractX = makeReader(persons, normX, binning, *counts.pool);
+        AttributeReader extractY = makeReader(persons, normY, binning, *counts.pool);
+        if (!extractX || !extractY) {
+            return counts;
+        }
+
+        std::vector<std::uint32_t> xValues;
+        std::vector<std::uint32_t> yValues;
+
+        // goes thriough csv and build distributions
+        for (const Person& person : persons) {
+            extractX(person, *counts.pool, xValues);
+            extractY(person, *counts.pool, yValues);
             
-            // count each Y 
-            for (const std::string& yVal : yValues) {
-                dist.yCounts[yVal]++;
+            if (xValues.empty() || yValues.empty()) {
+                continue;
+            }
+            
+            counts.eligiblePopulation++;
+            for (std::uint32_t yVal : yValues) {
+                counts.yTotals[yVal]++;
+            }
+            
+            //for each X this person has
+            for (std::uint32_t xVal : xValues) {
+                Distribution& dist = counts.distributions[xVal];
+                dist.cohortSize++;
+                
+                // count each Y 
+                for (std::uint32_t yVal : yValues) {
+                    dist.yCounts[yVal]++;
+                }
             }
         }
+        return counts;
     }
+
+    // finds most common (not blocked) Y value for this X;
+    // key and sentence are only written when someone asks for them
+    std::size_t pickGenericY(const GenericCounts& counts, std::uint32_t xValue, const Distribution& dist,
+                             const FingerprintSet& suppressed, Attribute normX, Attribute normY,
+                             Insight& insight) {
+        return pickBestY(dist.yCounts, suppressed, [&](std::uint32_t yValue) {
+            Insight candidate;
+            candidate.kind = InsightKind::Generic;
+            candidate.attrX = normX;
+            candidate.attrY = normY;
+            candidate.valueX = xValue;
+            candidate.valueY = yValue;
+            candidate.values = counts.pool;
+            return candidate;
+        }, insight);
+    }
+}
+
+std::vector<Insight> InsightGenerator::generateGeneric(
+    const std::vector<Person>& persons,
+    const FingerprintSet& suppressed,
+    const std::string& attrX,
+    const std::string& attrY,
+    std::size_t limit,
+    const ProgressCallback& progress) const {
+    instr::ScopedTimer timer("generate.generic");
+    timer.addRows(persons.size());
+    trace::Span span("generate.generic.pair", attrX, attrY);
+    report_progress(progress, 0, 2);
+
+    // resolve x and y once instead of per person
+    Attribute normX = parse_attribute(attrX);
+    Attribute normY = parse_attribute(attrY);
+
+    if (m_tagSketchCapacity != 0 && is_tag_attribute(normY)) {
+        return generateTagSketched(persons, suppressed, InsightKind::Generic, normX, normY,
+                                   MIN_GENERIC_SUPPORT, MIN_GENERIC_CONFIDENCE, limit);
+    }
+
+    // two closed enums: a fixed-size table instead of hashed distributions
+    std::vector<Insight> enumInsights;
+    if (dispatchEnumPair(normX, normY, enumInsights, persons, suppressed, InsightKind::Generic,
+                         MIN_GENERIC_SUPPORT, MIN_GENERIC_CONFIDENCE, m_scoring, limit)) {
+        return enumInsights;
+    }
+
+    GenericCounts counts = countGeneric(persons, normX, normY, m_binning);
+    report_progress(progress, 1, 2);
     
-    std::vector<Insight> insights;
-    
-    if (eligiblePopulation == 0) {
-        return insights;
+    if (counts.eligiblePopulation == 0) {
+        return {};
     }
+
+    ScoredCandidates candidates;
     
     // generates insights for stornger patterns/relationships
-    for (const auto& [xValue, dist] : distributions) {
+    for (const auto& [xValue, dist] : counts.distributions) {
         if (dist.cohortSize < MIN_GENERIC_SUPPORT) {
             continue;
         }
         
-        // finds most common Y value for this X
-        auto best = std::max_element(
-            dist.yCounts.begin(), dist.yCounts.end(),
-            [](const auto& lhs, const auto& rhs) { return lhs.second < rhs.second; });
+        Insight insight;
+        std::size_t support = pickGenericY(counts, xValue, dist, suppressed, normX, normY, insight);
         
-        if (best == dist.yCounts.end()) {
+        if (support == 0) {
             continue;
         }
         
-        std::size_t support = best->second;
         double confidence = static_cast<double>(support) / static_cast<double>(dist.cohortSize);
         
         if (confidence < MIN_GENERIC_CONFIDENCE) {
             continue;
         }
         
-        // generatea key
-        std::string key = normX + " = " + lowercase(xValue) + " -> " + normY + " = " + lowercase(best->first);
-        
-        if (suppressedKeys.count(key) > 0) {
-            continue;
-        }
-        
-        // creates insight
-        Insight insight;
-        insight.key = key;
         insight.support = support;
         insight.population = dist.cohortSize;
-        insight.score = scoreFromCounts(support, dist.cohortSize, eligiblePopulation);
-        
-        // user facing description
-        std::ostringstream sentence;
-        sentence << "People whose " << getAttributeDisplayName(normX) 
-                 << " is " << xValue
-                 << " tend to have " << getAttributeDisplayName(normY)
-                 << " of " << best->first << ".";
-        insight.description = sentence.str();
-        
-        insights.push_back(std::move(insight));
+        std::size_t yTotal = counts.yTotals[insight.valueY];
+        candidates.add(std::move(insight), yTotal);
     }
     
     // orders insight output by score
-    std::sort(insights.begin(), insights.end(), [](const Insight& lhs, const Insight& rhs) {
-        if (lhs.score != rhs.score) {
-            return lhs.score > rhs.score;
+    return candidates.finish(m_scoring, counts.eligiblePopulation, limit);
+}
+
+std::vector<Insight> InsightGenerator::generateTagSketched(
+    const std::vector<Person>& persons,
+    const FingerprintSet& suppressed,
+    InsightKind kind,
+    Attribute attrX,
+    Attribute attrY,
+    std::size_t minSupport,
+    double minConfidence,
+    std::size_t limit) const {
+    instr::ScopedTimer timer("generate.sketched");
+    timer.addRows(persons.size());
+
+    struct Cohort {
+        explicit Cohort(std::size_t counters) : ys(counters) {}
+
+        std::size_t size = 0;
+        SpaceSaving ys;
+        std::vector<std::pair<std::uint32_t, std::size_t>> candidates;   // Y -> exact count (pass 2)
+    };
+
+    auto pool = std::make_shared<InsightValuePool>();
+    AttributeReader extractX = makeReader(persons, attrX, m_binning, *pool);
+    AttributeReader extractY = makeReader(persons, attrY, m_binning, *pool);
+    if (!extractX || !extractY) {
+        return {};
+    }
+
+    std::unordered_map<std::uint32_t, Cohort> cohorts;
+    std::size_t eligiblePopulation = 0;
+
+    std::vector<std::uint32_t> xValues;
+    std::vector<std::uint32_t> yValues;
+
+    // pass 1: exact cohort sizes, a sketch of each cohort's Ys
+    for (const Person& person : persons) {
+        extractX(person, *pool, xValues);
+        extractY(person, *pool, yValues);
+        if (xValues.empty() || yValues.empty()) {
+            continue;
         }
-        if (lhs.support != rhs.support) {
-            return lhs.support > rhs.support;
+
+        eligiblePopulation++;
+        for (std::uint32_t xVal : xValues) {
+            Cohort& cohort = cohorts.try_emplace(xVal, m_tagSketchCapacity).first->second;
+            cohort.size++;
+            for (std::uint32_t yVal : yValues) {
+                cohort.ys.add(yVal);
+            }
         }
-        return lhs.description < rhs.description;
-    });
-    
-    return insights;
+    }
+
+    if (eligiblePopulation == 0) {
+        return {};
+    }
+
+    auto makeInsight = [&](std::uint32_t xValue, std::uint32_t yValue) {
+        Insight candidate;
+        candidate.kind = kind;
+        candidate.attrX = attrX;
+        candidate.attrY = attrY;
+        candidate.valueX = xValue;
+        candidate.valueY = yValue;
+        candidate.values = pool;
+        return candidate;
+    };
+
+    // the Ys that can still win a cohort: not blocked, and estimated at least as high as
+    // the best one's lower bound
+    bool anyCandidates = false;
+    for (auto& [xValue, cohort] : cohorts) {
+        if (cohort.size < minSupport) {
+            continue;
+        }
+
+        std::size_t lowerBound = 0;
+        for (const SpaceSaving::Counter& c : cohort.ys.top()) {
+            if (!cohort.candidates.empty() && c.count < lowerBound) {
+                break;
+            }
+            if (!suppressed.empty() && suppressed.contains(makeInsight(xValue, c.item).fingerprint())) {
+                continue;
+            }
+            if (cohort.candidates.empty()) {
+                // not even the upper bound clears the threshold: nothing in this cohort can
+                if (static_cast<double>(c.count) < minConfidence * static_cast<double>(cohort.size)) {
+                    break;
+                }
+                lowerBound = c.count - c.error;
+            }
+            cohort.candidates.emplace_back(c.item, 0);
+        }
+        anyCandidates = anyCandidates || !cohort.candidates.empty();
+    }
+
+    if (!anyCandidates) {
+        return {};
+    }
+
+    // Y totals for the scoring modes, only for Ys that are a candidate somewhere
+    std::unordered_map<std::uint32_t, std::size_t> yTotals;
+    for (const auto& [xValue, cohort] : cohorts) {
+        for (const auto& candidate : cohort.candidates) {
+            yTotals.emplace(candidate.first, 0);
+        }
+    }
+
+    // pass 2: exact counts, for the candidates only
+    for (const Person& person : persons) {
+        extractX(person, *pool, xValues);
+        extractY(person, *pool, yValues);
+        if (xValues.empty() || yValues.empty()) {
+            continue;
+        }
+
+        for (std::uint32_t yVal : yValues) {
+            auto total = yTotals.find(yVal);
+            if (total != yTotals.end()) {
+                total->second++;
+            }
+        }
+
+        for (std::uint32_t xVal : xValues) {
+            auto& candidates = cohorts.find(xVal)->second.candidates;
+            for (auto& [yVal, count] : candidates) {
+                if (std::find(yValues.begin(), yValues.end(), yVal) != yValues.end()) {
+                    count++;
+                }
+            }
+        }
+    }
+
+    ScoredCandidates scored;
+
+    for (const auto& [xValue, cohort] : cohorts) {
+        if (cohort.candidates.empty()) {
+            continue;
+        }
+
+        // ties go to the higher estimate, which comes first
+        auto best = std::max_element(
+            cohort.candidates.begin(), cohort.candidates.end(),
+            [](const auto& lhs, const auto& rhs) { return lhs.second < rhs.second; });
+        std::size_t support = best->second;
+
+        double confidence = static_cast<double>(support) / static_cast<double>(cohort.size);
+        if (support == 0 || confidence < minConfidence) {
+            continue;
+        }
+
+        Insight insight = makeInsight(xValue, best->first);
+        insight.support = support;
+        insight.population = cohort.size;
+        scored.add(std::move(insight), yTotals[best->first]);
+    }
+
+    return scored.finish(m_scoring, eligiblePopulation, limit);
+}
+
+ApproximateInsights InsightGenerator::generateGenericApprox(
+    const std::vector<Person>& persons,
+    const FingerprintSet& suppressed,
+    const std::string& attrX,
+    const std::string& attrY,
+    const SampleOptions& options,
+    bool verify,
+    std::size_t limit) const {
+    instr::ScopedTimer timer("generate.generic_approx");
+    trace::Span span("generate.generic_approx.pair", attrX, attrY);
+
+    std::vector<Person> sample = draw_sample(persons, options);
+    timer.addRows(sample.size());
+
+    ApproximateInsights result = approximateOnSample(sample, persons.size(), suppressed, attrX, attrY);
+
+    if (verify) {
+        verifyBorderline(persons, suppressed, attrX, attrY, result);
+    }
+
+    std::sort(result.insights.begin(), result.insights.end(),
+              [](const ApproximateInsight& a, const ApproximateInsight& b) {
+                  return ranksBefore(a.insight, b.insight);
+              });
+    if (limit != 0 && result.insights.size() > limit) {
+        result.insights.resize(limit);
+    }
+    return result;
+}
+
+ApproximateInsights InsightGenerator::approximateOnSample(
+    const std::vector<Person>& sample,
+    std::size_t populationRows,
+    const FingerprintSet& suppressed,
+    const std::string& attrX,
+    const std::string& attrY) const {
+    ApproximateInsights result;
+    result.populationRows = populationRows;
+    result.sampleRows = sample.size();
+
+    Attribute normX = parse_attribute(attrX);
+    Attribute normY = parse_attribute(attrY);
+    GenericCounts counts = countGeneric(sample, normX, normY, m_binning);
+
+    const double scale = sample.empty()
+        ? 0.0 : static_cast<double>(populationRows) / static_cast<double>(sample.size());
+
+    for (const auto& [xValue, dist] : counts.distributions) {
+        if (dist.cohortSize < MIN_GENERIC_SUPPORT) {
+            continue;
+        }
+
+        ApproximateInsight approx;
+        std::size_t support = pickGenericY(counts, xValue, dist, suppressed, normX, normY, approx.insight);
+        if (support == 0) {
+            continue;
+        }
+
+        // keep everything whose interval reaches the threshold; the ones that also
+        // reach below it could go either way on the full data
+        approx.confidence = wilson_interval(support, dist.cohortSize);
+        if (approx.confidence.high < MIN_GENERIC_CONFIDENCE) {
+            continue;
+        }
+        approx.borderline = approx.confidence.low < MIN_GENERIC_CONFIDENCE;
+
+        ConfidenceInterval share = wilson_interval(support, sample.size());
+        approx.support = {share.low * static_cast<double>(sample.size()) * scale,
+                          share.high * static_cast<double>(sample.size()) * scale};
+
+        approx.insight.support = support;
+        approx.insight.population = dist.cohortSize;
+        result.insights.push_back(std::move(approx));
+    }
+
+    // scored on the sample's own table, like the exact search scores the full one
+    const std::size_t found = result.insights.size();
+    std::vector<std::size_t> support(found), cohort(found), yTotal(found);
+    for (std::size_t i = 0; i < found; ++i) {
+        const Insight& insight = result.insights[i].insight;
+        support[i] = insight.support;
+        cohort[i] = insight.population;
+        yTotal[i] = counts.yTotals[insight.valueY];
+    }
+    std::vector<int> scores(found);
+    score_cells(m_scoring, support.data(), cohort.data(), yTotal.data(), found, counts.eligiblePopulation, scores.data());
+    for (std::size_t i = 0; i < found; ++i) {
+        result.insights[i].insight.score = scores[i];
+    }
+    return result;
+}
+
+// one exact pass over the full data, only when something is borderline. every candidate is
+// then replaced by its exact counterpart (so all scores come from the full table, not a mix
+// of sample and full-table scores), or dropped if the exact search didn't keep it
+void InsightGenerator::verifyBorderline(
+    const std::vector<Person>& persons,
+    const FingerprintSet& suppressed,
+    const std::string& attrX,
+    const std::string& attrY,
+    ApproximateInsights& result) const {
+    bool any = std::any_of(result.insights.begin(), result.insights.end(),
+                           [](const ApproximateInsight& a) { return a.borderline; });
+    if (!any) {
+        return;
+    }
+
+    std::unordered_map<std::uint64_t, Insight> exact;
+    for (Insight& insight : generateGeneric(persons, suppressed, attrX, attrY)) {
+        exact.emplace(insight.fingerprint(), std::move(insight));
+    }
+
+    std::vector<ApproximateInsight> kept;
+    kept.reserve(result.insights.size());
+    for (ApproximateInsight& approx : result.insights) {
+        auto it = exact.find(approx.insight.fingerprint());
+        if (it == exact.end()) {
+            continue;
+        }
+        approx.insight = it->second;
+        double confidence = approx.insight.confidence();
+        double support = static_cast<double>(approx.insight.support);
+        approx.confidence = {confidence, confidence};
+        approx.support = {support, support};
+        approx.borderline = false;
+        approx.verified = true;
+        kept.push_back(std::move(approx));
+    }
+    result.insights = std::move(kept);
+}
+
+std::vector<PairScore> InsightGenerator::scorePairs(
+    const std::vector<Person>& persons,
+    const FingerprintSet& suppressed,
+    const std::vector<std::string>& attributes) const {
+    std::vector<PairScore> results;
+
+    for (std::size_t i = 0; i < attributes.size(); i++) {
+        for (std::size_t j = i + 1; j < attributes.size(); j++) {
+            auto insights = generateGeneric(persons, suppressed, attributes[i], attributes[j]);
+            if (insights.empty()) {
+                continue;
+            }
+
+            PairScore result;
+            result.attrX = attributes[i];
+            result.attrY = attributes[j];
+            result.count = static_cast<int>(insights.size());
+            for (const auto& ins : insights) {
+                result.totalScore += ins.score;
+            }
+            result.avgScore = static_cast<double>(result.totalScore) / result.count;
+            results.push_back(std::move(result));
+        }
+    }
+
+    std::sort(results.begin(), results.end(),
+              [](const PairScore& a, const PairScore& b) { return a.avgScore > b.avgScore; });
+    return results;
 }
 
+ApproximatePairScores InsightGenerator::scorePairsApprox(
+    const std::vector<Person>& persons,
+    const FingerprintSet& suppressed,
+    const std::vector<std::string>& attributes,
+    const SampleOptions& options) const {
+    instr::ScopedTimer timer("generate.pairs_approx");
+
+    // one sample shared by every pair
+    std::vector<Person> sample = draw_sample(persons, options);
+    timer.addRows(sample.size());
+
+    ApproximatePairScores result;
+    result.populationRows = persons.size();
+    result.sampleRows = sample.size();
+    result.margin = margin_for_sample_size(sample.size());
+
+    // like scorePairs, but only insights that clear the threshold on the sample count;
+    // borderline ones would mostly be tiny cohorts passing by chance
+    for (std::size_t i = 0; i < attributes.size(); i++) {
+        for (std::size_t j = i + 1; j < attributes.size(); j++) {
+            ApproximateInsights found = approximateOnSample(sample, persons.size(), suppressed,
+                                                            attributes[i], attributes[j]);
+            PairScore pair;
+            pair.attrX = attributes[i];
+            pair.attrY = attributes[j];
+            for (const ApproximateInsight& a : found.insights) {
+                if (a.borderline) continue;
+                pair.count++;
+                pair.totalScore += a.insight.score;
+            }
+            if (pair.count == 0) {
+                continue;
+            }
+            pair.avgScore = static_cast<double>(pair.totalScore) / pair.count;
+            result.pairs.push_back(std::move(pair));
+        }
+    }
+
+    std::sort(result.pairs.begin(), result.pairs.end(),
+              [](const PairScore& a, const PairScore& b) { return a.avgScore > b.avgScore; });
+    return result;
+}
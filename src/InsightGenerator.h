@@ -1,11 +1,15 @@
 #ifndef INSIGHT_GENERATOR_H
 #define INSIGHT_GENERATOR_H
 
+#include "FingerprintSet.h"
 #include "Insight.h"
+#include "NumericBinning.h"
 #include "Person.h"
+#include "Progress.h"
+#include "Sampling.h"
+#include "Scoring.h"
 
 #include <string>
-#include <unordered_set>
 #include <vector>
 
 /**
@@ -20,50 +24,173 @@ enum class InsightPairType {
     FocusCourse
 };
 
+/**
+ * One attribute pair from discover-best / discover-all: how many insights it produced
+ * and their average score.
+ */
+struct PairScore {
+    std::string attrX;
+    std::string attrY;
+    int count = 0;
+    int totalScore = 0;
+    double avgScore = 0.0;
+};
+
+/**
+ * An insight found on a sample (approximate mode). Its counts are the sample's; the
+ * intervals (95%, Wilson) say where the full dataset's values most likely are.
+ */
+struct ApproximateInsight {
+    Insight insight;
+    ConfidenceInterval confidence;   // support / cohort
+    ConfidenceInterval support;      // estimated support in the full dataset, in rows
+    bool borderline = false;         // the confidence interval straddles the threshold
+    bool verified = false;           // re-counted on the full dataset, counts are exact
+};
+
+struct ApproximateInsights {
+    std::vector<ApproximateInsight> insights;
+    std::size_t sampleRows = 0;
+    std::size_t populationRows = 0;
+};
+
+struct ApproximatePairScores {
+    std::vector<PairScore> pairs;
+    std::size_t sampleRows = 0;
+    std::size_t populationRows = 0;
+    double margin = 0.0;             // worst case +- of a proportion over the whole sample (95%)
+};
+
 class InsightGenerator {
 public:
+    // Bounded-memory counting for tag Ys (color -> hobby, region -> language, generic pairs
+    // with a tag Y): instead of an exact count per distinct Y, every cohort keeps a Space-Saving
+    // sketch of `counters` entries, and only the Ys that can still win are recounted exactly in
+    // a second pass. Any Y that clears the 50% thresholds is guaranteed to be in the sketch as
+    // long as `counters` is at least twice the most tags a person has, so results match the exact
+    // mode. 0 (the default) counts exactly.
+    void setTagSketchCapacity(std::size_t counters) { m_tagSketchCapacity = counters; }
+    std::size_t tagSketchCapacity() const { return m_tagSketchCapacity; }
+
+    // how insights are scored and ranked (see ScoringMode); which Y a cohort gets doesn't change
+    void setScoring(ScoringMode mode) { m_scoring = mode; }
+    ScoringMode scoring() const { return m_scoring; }
+
+    // Numeric attributes (course load, graduation year) on either side of focus -> course load and
+    // generic pairs are grouped into ranges ("course = 4-5") worked out from the data in one
+    // pass before counting. Off (the default) keeps every distinct number as its own value.
+    void setBinning(const BinningOptions& options) { m_binning = options; }
+    const BinningOptions& binning() const { return m_binning; }
+
+    // limit > 0 switches to top-k mode: only the best `limit` insights are kept (bounded heap)
+    // and only those get a description written. limit == 0 returns everything like before.
+    // progress is told about each of the four pair passes (see Progress.h)
     std::vector<Insight> generate(
         const std::vector<Person>& persons,
-        const std::unordered_set<std::string>& suppressedKeys) const;
+        const FingerprintSet& suppressed,
+        std::size_t limit = 0,
+        const ProgressCallback& progress = {}) const;
 
     std::vector<Insight> generatePair(
         const std::vector<Person>& persons,
-        const std::unordered_set<std::string>& suppressedKeys,
-        InsightPairType which) const;
+        const FingerprintSet& suppressed,
+        InsightPairType which,
+        std::size_t limit = 0) const;
 
-    // insights for any combination
+    // insights for any combination; progress hears about the counting and scoring passes
     std::vector<Insight> generateGeneric(
         const std::vector<Person>& persons,
-        const std::unordered_set<std::string>& suppressedKeys,
+        const FingerprintSet& suppressed,
         const std::string& attrX,
-        const std::string& attrY) const;
+        const std::string& attrY,
+        std::size_t limit = 0,
+        const ProgressCallback& progress = {}) const;
+
+    // runs generateGeneric for every pair of `attributes` (the discover heat maps);
+    // pairs without insights are left out, the rest come back best average first
+    std::vector<PairScore> scorePairs(
+        const std::vector<Person>& persons,
+        const FingerprintSet& suppressed,
+        const std::vector<std::string>& attributes) const;
+
+    // Approximate mode: generateGeneric on a sample (see SampleOptions). Cohorts whose
+    // confidence interval reaches the threshold are kept; those whose interval straddles it
+    // are flagged borderline. with verify, a borderline result costs one exact pass over the
+    // full data, and then every insight is checked and scored against it
+    ApproximateInsights generateGenericApprox(
+        const std::vector<Person>& persons,
+        const FingerprintSet& suppressed,
+        const std::string& attrX,
+        const std::string& attrY,
+        const SampleOptions& options,
+        bool verify = false,
+        std::size_t limit = 0) const;
+
+    // scorePairs on one sample shared by all pairs, counting only insights that clear
+    // the threshold with their whole interval
+    ApproximatePairScores scorePairsApprox(
+        const std::vector<Person>& persons,
+        const FingerprintSet& suppressed,
+        const std::vector<std::string>& attributes,
+        const SampleOptions& options) const;
+
+    // scores the insight from 0-100 considering how strong it is from within the group and overall
+    static int scoreFromCounts(std::size_t support,
+                               std::size_t cohortSize,
+                               std::size_t globalPopulation);
 
 private:
-    // suppressed keys will be the insights that user rejects; they get added to a csv file we will create and these functions will check
-    // over that file so it doesn't display an insight the user has already rejected
+    std::size_t m_tagSketchCapacity = 0;
+    ScoringMode m_scoring = ScoringMode::Confidence;
+    BinningOptions m_binning;
+
+    // the sketched counting described at setTagSketchCapacity, for any X and a tag Y
+    std::vector<Insight> generateTagSketched(
+        const std::vector<Person>& persons,
+        const FingerprintSet& suppressed,
+        InsightKind kind,
+        Attribute attrX,
+        Attribute attrY,
+        std::size_t minSupport,
+        double minConfidence,
+        std::size_t limit) const;
+
+    // the approximate search on an already drawn sample, unsorted and unverified
+    ApproximateInsights approximateOnSample(
+        const std::vector<Person>& sample,
+        std::size_t populationRows,
+        const FingerprintSet& suppressed,
+        const std::string& attrX,
+        const std::string& attrY) const;
+
+    void verifyBorderline(
+        const std::vector<Person>& persons,
+        const FingerprintSet& suppressed,
+        const std::string& attrX,
+        const std::string& attrY,
+        ApproximateInsights& result) const;
+
+    // suppressed holds the fingerprints of insights the user rejected (blocked_keys.txt, see InsightStore::suppression).
+    // it's checked while picking the best Y of each cohort, so a rejected Y is skipped and the next best one can show up
     std::vector<Insight> generatePrimaryOsToStudyTime(
         const std::vector<Person>& persons,
-        const std::unordered_set<std::string>& suppressedKeys) const;
+        const FingerprintSet& suppressed,
+        std::size_t limit) const;
 
     std::vector<Insight> generateFavoriteColorToHobby(
         const std::vector<Person>& persons,
-        const std::unordered_set<std::string>& suppressedKeys) const;
+        const FingerprintSet& suppressed,
+        std::size_t limit) const;
 
     std::vector<Insight> generateRegionToLanguage(
         const std::vector<Person>& persons,
-        const std::unordered_set<std::string>& supressedKeys) const;
+        const FingerprintSet& suppressed,
+        std::size_t limit) const;
 
     std::vector<Insight> generateEngineeringFocusToCourseLoad(
         const std::vector<Person>& persons,
-        const std::unordered_set<std::string>& supressedKeys) const;
-
-    // scores the insight from 0-100 considering how strong it is from within the group and overall
-    static int scoreFromCounts(std::size_t support,
-                               std::size_t cohortSize,
-                               std::size_t globalPopulation);
-
-    // not necessary but a nice helper for natural sounding/looking english sentences
-    static std::string describeStudyTime(StudyTime studyTime);
+        const FingerprintSet& suppressed,
+        std::size_t limit) const;
 };
 
 #endif // INSIGHT_GENERATOR_H
\ No newline at end of file
@@ -0,0 +1,469 @@
+#include "InsightLog.h"
+#include "FingerprintSet.h"
+
+#include <array>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <unordered_set>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const std::string LOG_HEADER = "#insight-log v1";
+const char INDEX_MAGIC[8] = {'I', 'F', 'I', 'D', 'X', '0', '0', '1'};
+constexpr std::size_t INDEX_HEADER_SIZE = sizeof(INDEX_MAGIC) + sizeof(std::uint64_t);
+constexpr std::size_t FIELD_COUNT = 6;  // crc, key, description, score, support, population
+
+std::uint32_t crc32(std::string_view data) {
+    static const std::array<std::uint32_t, 256> table = [] {
+        std::array<std::uint32_t, 256> t{};
+        for (std::uint32_t i = 0; i < 256; ++i) {
+            std::uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+
+    std::uint32_t crc = 0xFFFFFFFFu;
+    for (unsigned char ch : data) {
+        crc = table[(crc ^ ch) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+void appendEscaped(std::string& out, const std::string& field) {
+    for (char c : field) {
+        switch (c) {
+            case '\\': out += "\\\\"; break;
+            case '\t': out += "\\t"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            default: out += c;
+        }
+    }
+}
+
+std::string unescape(std::string_view field) {
+    std::string out;
+    out.reserve(field.size());
+    for (std::size_t i = 0; i < field.size(); ++i) {
+        char c = field[i];
+        if (c == '\\' && i + 1 < field.size()) {
+            char next = field[++i];
+            switch (next) {
+                case 't': out += '\t'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                default: out += next;
+            }
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+// one full line, newline included
+std::string encodeRecord(const Insight& insight) {
+    std::string payload;
+    appendEscaped(payload, insight.key());
+    payload += '\t';
+    appendEscaped(payload, insight.description());
+    payload += '\t';
+    payload += std::to_string(insight.score);
+    payload += '\t';
+    payload += std::to_string(insight.support);
+    payload += '\t';
+    payload += std::to_string(insight.population);
+
+    char crc[9];
+    std::snprintf(crc, sizeof(crc), "%08x", static_cast<unsigned>(crc32(payload)));
+
+    std::string line(crc);
+    line += '\t';
+    line += payload;
+    line += '\n';
+    return line;
+}
+
+// false for anything that isn't a whole record with a matching checksum
+bool decodeRecord(std::string_view line, Insight& out) {
+    if (line.size() < 9 || line[8] != '\t') {
+        return false;
+    }
+
+    std::string_view payload = line.substr(9);
+    std::uint32_t expected = 0;
+    try {
+        expected = static_cast<std::uint32_t>(std::stoul(std::string(line.substr(0, 8)), nullptr, 16));
+    } catch (...) {
+        return false;
+    }
+    if (crc32(payload) != expected) {
+        return false;
+    }
+
+    std::array<std::string_view, FIELD_COUNT - 1> fields;
+    std::size_t count = 0;
+    std::size_t start = 0;
+    while (count < fields.size()) {
+        std::size_t tab = payload.find('\t', start);
+        if (tab == std::string_view::npos) {
+            fields[count++] = payload.substr(start);
+            break;
+        }
+        fields[count++] = payload.substr(start, tab - start);
+        start = tab + 1;
+    }
+    if (count != fields.size()) {
+        return false;
+    }
+
+    try {
+        out = Insight::fromText(unescape(fields[0]), unescape(fields[1]));
+        out.score = std::stoi(std::string(fields[2]));
+        out.support = std::stoull(std::string(fields[3]));
+        out.population = std::stoull(std::string(fields[4]));
+    } catch (...) {
+        return false;
+    }
+    return true;
+}
+
+// the pre-log format: key,description,score,support,population; false for anything else
+bool parseLegacyLine(const std::string& line, Insight& out) {
+    std::size_t keyEnd = line.find(',');
+    std::size_t descriptionEnd = keyEnd == std::string::npos ? keyEnd : line.find(',', keyEnd + 1);
+    if (keyEnd == 0 || descriptionEnd == std::string::npos) {
+        return false;
+    }
+
+    std::stringstream ss(line.substr(descriptionEnd + 1));
+    int score = 0;
+    long long support = 0, population = 0;
+    char comma1 = 0, comma2 = 0;
+    if (!(ss >> score >> comma1 >> support >> comma2 >> population) || comma1 != ',' || comma2 != ','
+        || support < 0 || population < 0) {
+        return false;
+    }
+    ss >> std::ws;
+    if (!ss.eof()) {
+        return false;
+    }
+
+    out = Insight::fromText(line.substr(0, keyEnd), line.substr(keyEnd + 1, descriptionEnd - keyEnd - 1));
+    out.score = score;
+    out.support = static_cast<std::size_t>(support);
+    out.population = static_cast<std::size_t>(population);
+    return true;
+}
+
+std::uint64_t fileSize(const std::string& path) {
+    std::error_code ec;
+    auto size = fs::file_size(path, ec);
+    return ec ? 0 : static_cast<std::uint64_t>(size);
+}
+
+}
+
+InsightLog::InsightLog(std::string path) : m_path(std::move(path)) {}
+
+std::string InsightLog::indexPath() const {
+    return m_path + ".idx";
+}
+
+bool InsightLog::open(bool migrateLegacy) {
+    m_index.clear();
+
+    // nothing to read yet; the first append creates the log and its index
+    if (!fs::exists(m_path) || fileSize(m_path) == 0) {
+        m_logSize = 0;
+        return true;
+    }
+
+    std::string first;
+    {
+        std::ifstream log(m_path, std::ios::binary);
+        if (!log.is_open()) {
+            return false;
+        }
+        std::getline(log, first);
+    }
+    if (first != LOG_HEADER && (!migrateLegacy || !this->migrateLegacy())) {
+        return false;
+    }
+
+    m_logSize = fileSize(m_path);
+    if (!loadIndex()) {
+        rebuildIndex();
+    }
+    return true;
+}
+
+// rewrites an old comma separated file as a log, dropping repeated keys; the file is
+// left untouched unless every line is an old record
+bool InsightLog::migrateLegacy() {
+    std::vector<Insight> insights;
+    {
+        std::ifstream in(m_path);
+        std::string line;
+        std::unordered_set<std::uint64_t> seen;
+        Insight i;
+        while (std::getline(in, line)) {
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (line.empty()) {
+                continue;
+            }
+            if (!parseLegacyLine(line, i)) {
+                return false;
+            }
+            if (seen.insert(i.fingerprint()).second) {
+                insights.push_back(i);
+            }
+        }
+    }
+
+    std::string tmp = m_path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            return false;
+        }
+        out << LOG_HEADER << '\n';
+        for (const Insight& i : insights) {
+            out << encodeRecord(i);
+        }
+        if (!out) {
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(tmp, m_path, ec);
+    fs::remove(indexPath(), ec);
+    return true;
+}
+
+// reads the side index and catches up on anything appended after it was written;
+// false if it's missing or doesn't describe this log
+bool InsightLog::loadIndex() {
+    std::ifstream idx(indexPath(), std::ios::binary);
+    if (!idx.is_open()) {
+        return false;
+    }
+
+    char magic[sizeof(INDEX_MAGIC)];
+    std::uint64_t covered = 0;
+    idx.read(magic, sizeof(magic));
+    idx.read(reinterpret_cast<char*>(&covered), sizeof(covered));
+    if (!idx || std::string_view(magic, sizeof(magic)) != std::string_view(INDEX_MAGIC, sizeof(INDEX_MAGIC))
+        || covered > m_logSize || covered <= LOG_HEADER.size()) {
+        return false;
+    }
+
+    std::uint64_t entry[2];
+    while (idx.read(reinterpret_cast<char*>(entry), sizeof(entry))) {
+        if (entry[1] >= covered) {
+            m_index.clear();
+            return false;
+        }
+        m_index.emplace(entry[0], entry[1]);
+    }
+    idx.close();
+
+    if (covered < m_logSize) {
+        std::vector<std::pair<std::uint64_t, std::uint64_t>> added;
+        scanInto(covered, added);
+        appendIndex(added);
+    }
+    return true;
+}
+
+void InsightLog::rebuildIndex() {
+    m_index.clear();
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> added;
+    scanInto(LOG_HEADER.size() + 1, added);
+    writeIndex();
+}
+
+// indexes every good record from `from` to the end; a torn last line is cut off
+// so the next append starts on a fresh line
+void InsightLog::scanInto(std::uint64_t from,
+                          std::vector<std::pair<std::uint64_t, std::uint64_t>>& added) {
+    std::ifstream log(m_path, std::ios::binary);
+    log.seekg(static_cast<std::streamoff>(from));
+
+    std::uint64_t offset = from;
+    std::string line;
+    Insight insight;
+    while (std::getline(log, line)) {
+        if (log.eof()) {
+            break;  // no trailing newline
+        }
+        if (decodeRecord(line, insight) && !findOffset(insight.key(), insight.fingerprint())) {
+            m_index.emplace(insight.fingerprint(), offset);
+            added.emplace_back(insight.fingerprint(), offset);
+        }
+        offset += line.size() + 1;
+    }
+    log.close();
+
+    if (offset < m_logSize) {
+        std::error_code ec;
+        fs::resize_file(m_path, offset, ec);
+        if (!ec) {
+            m_logSize = offset;
+        }
+    }
+}
+
+void InsightLog::writeIndex() const {
+    std::ofstream idx(indexPath(), std::ios::binary | std::ios::trunc);
+    if (!idx.is_open()) {
+        return;
+    }
+    idx.write(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    idx.write(reinterpret_cast<const char*>(&m_logSize), sizeof(m_logSize));
+    for (const auto& [fingerprint, offset] : m_index) {
+        std::uint64_t entry[2] = {fingerprint, offset};
+        idx.write(reinterpret_cast<const char*>(entry), sizeof(entry));
+    }
+}
+
+// adds entries to the end of the index, then moves its "covered" mark up to the log size
+void InsightLog::appendIndex(const std::vector<std::pair<std::uint64_t, std::uint64_t>>& added) const {
+    std::fstream idx(indexPath(), std::ios::binary | std::ios::in | std::ios::out);
+    if (!idx.is_open()) {
+        writeIndex();
+        return;
+    }
+    idx.seekp(0, std::ios::end);
+    for (const auto& [fingerprint, offset] : added) {
+        std::uint64_t entry[2] = {fingerprint, offset};
+        idx.write(reinterpret_cast<const char*>(entry), sizeof(entry));
+    }
+    idx.flush();
+    idx.seekp(sizeof(INDEX_MAGIC));
+    idx.write(reinterpret_cast<const char*>(&m_logSize), sizeof(m_logSize));
+}
+
+bool InsightLog::append(const Insight& insight) {
+    return appendAll({insight}) == 1;
+}
+
+std::size_t InsightLog::appendAll(const std::vector<Insight>& insights) {
+    if (insights.empty()) {
+        return 0;
+    }
+
+    bool created = fileSize(m_path) == 0;
+    std::ofstream log(m_path, std::ios::binary | std::ios::app);
+    if (!log.is_open()) {
+        return 0;
+    }
+    if (created) {
+        m_index.clear();
+        log << LOG_HEADER << '\n';
+        m_logSize = LOG_HEADER.size() + 1;
+    }
+
+    // records written by this call are still in `log`'s buffer where readAt can't see them,
+    // so repeats within the batch are caught by key here
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> added;
+    std::unordered_set<std::string> written;
+    for (const Insight& insight : insights) {
+        std::uint64_t fingerprint = insight.fingerprint();
+        if (written.count(insight.key()) || findOffset(insight.key(), fingerprint)) {
+            continue;
+        }
+
+        std::string line = encodeRecord(insight);
+        if (!log.write(line.data(), static_cast<std::streamsize>(line.size()))) {
+            break;
+        }
+        written.insert(insight.key());
+        m_index.emplace(fingerprint, m_logSize);
+        added.emplace_back(fingerprint, m_logSize);
+        m_logSize += line.size();
+    }
+    log.close();
+
+    if (created) {
+        writeIndex();   // replaces any index left behind by a deleted log
+    } else if (!added.empty()) {
+        appendIndex(added);
+    }
+    return added.size();
+}
+
+// is this exact key already in the log (fingerprint hit, then the record is read to rule out a collision)
+bool InsightLog::findOffset(const std::string& key, std::uint64_t fingerprint) const {
+    auto range = m_index.equal_range(fingerprint);
+    for (auto it = range.first; it != range.second; ++it) {
+        auto stored = readAt(it->second);
+        if (stored && stored->key() == key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool InsightLog::contains(const std::string& key) const {
+    return findOffset(key, fingerprint_key(key));
+}
+
+std::optional<Insight> InsightLog::find(const std::string& key) const {
+    auto range = m_index.equal_range(fingerprint_key(key));
+    for (auto it = range.first; it != range.second; ++it) {
+        auto stored = readAt(it->second);
+        if (stored && stored->key() == key) {
+            return stored;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<Insight> InsightLog::readAt(std::uint64_t offset) const {
+    std::ifstream log(m_path, std::ios::binary);
+    log.seekg(static_cast<std::streamoff>(offset));
+
+    std::string line;
+    Insight insight;
+    if (!std::getline(log, line) || !decodeRecord(line, insight)) {
+        return std::nullopt;
+    }
+    return insight;
+}
+
+std::vector<Insight> InsightLog::readAll() const {
+    std::vector<Insight> insights;
+    insights.reserve(m_index.size());
+
+    std::ifstream log(m_path, std::ios::binary);
+    std::string line;
+    std::getline(log, line);  // header
+
+    Insight insight;
+    while (std::getline(log, line)) {
+        if (decodeRecord(line, insight)) {
+            insights.push_back(insight);
+        }
+    }
+    return insights;
+}
+
+std::string encode_insight_record(const Insight& insight) {
+    return encodeRecord(insight);
+}
+
+bool decode_insight_record(std::string_view line, Insight& out) {
+    return decodeRecord(line, out);
+}
@@ -0,0 +1,75 @@
+#ifndef INSIGHT_LOG_H
+#define INSIGHT_LOG_H
+
+#include "Insight.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// one checksummed log record (newline included) and back; also used by InsightCache's files
+std::string encode_insight_record(const Insight& insight);
+bool decode_insight_record(std::string_view line, Insight& out);
+
+/**
+ * InsightLog
+ *
+ * Append-only file of saved (useful) insights.
+ *
+ * Log file:   "#insight-log v1" header line, then one record per line:
+ *             <crc32 hex>\t<key>\t<description>\t<score>\t<support>\t<population>
+ *             fields are backslash-escaped so commas, tabs and newlines are safe,
+ *             and records whose checksum doesn't match (torn writes) are skipped.
+ * Index file: <log>.idx, fingerprint -> byte offset of every record plus how much of the
+ *             log it covers. Opening only reads the index (and scans whatever was appended
+ *             after it), so lookups by key never need a full parse of the log.
+ *
+ * Appends are de-duplicated by key. An old comma separated saved-insights file is only
+ * rewritten as a log when the caller asks for it; any other file that isn't a log is
+ * left alone and refused.
+ */
+class InsightLog {
+public:
+    explicit InsightLog(std::string path);
+
+    // loads (or rebuilds) the index; a missing or empty log isn't created until the first
+    // append. false for a file that isn't a log, unless migrateLegacy is set and every line
+    // of it is an old key,description,score,support,population record
+    bool open(bool migrateLegacy = false);
+
+    // false if the key is already in the log or the write failed
+    bool append(const Insight& insight);
+    std::size_t appendAll(const std::vector<Insight>& insights);
+
+    bool contains(const std::string& key) const;
+    std::optional<Insight> find(const std::string& key) const;
+
+    // full scan in file order (what list-saved shows)
+    std::vector<Insight> readAll() const;
+
+    std::size_t size() const { return m_index.size(); }
+    const std::string& path() const { return m_path; }
+
+private:
+    std::string m_path;
+    std::unordered_multimap<std::uint64_t, std::uint64_t> m_index;  // key fingerprint -> record offset
+    std::uint64_t m_logSize = 0;
+
+    std::string indexPath() const;
+
+    bool migrateLegacy();
+    bool loadIndex();
+    void rebuildIndex();
+    void scanInto(std::uint64_t from, std::vector<std::pair<std::uint64_t, std::uint64_t>>& added);
+    void writeIndex() const;
+    void appendIndex(const std::vector<std::pair<std::uint64_t, std::uint64_t>>& added) const;
+
+    std::optional<Insight> readAt(std::uint64_t offset) const;
+    bool findOffset(const std::string& key, std::uint64_t fingerprint) const;
+};
+
+#endif // INSIGHT_LOG_H
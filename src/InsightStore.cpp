@@ -1,39 +1,29 @@
 #include "InsightStore.h"
+#include "Instrumentation.h"
+#include <algorithm>
 #include <fstream>
-#include <sstream>
+#include <stdexcept>
 
 using namespace std;
 
-// Load saved useful insights from CSV
-void InsightStore::loadUseful(const string& filename) {
+// Open the saved useful insights log (index only)
+void InsightStore::loadUseful(const string& filename, bool migrateLegacy) {
+    instr::ScopedTimer timer("store.load_useful");
 
     usefulInsights.clear();
-    ifstream file(filename);
-
-    if (!file.is_open())
-        return;
-
-    string line;
-    while (getline(file, line)) {
-        stringstream ss(line);
-        Insight i;
-
-        getline(ss, i.key, ',');
-        getline(ss, i.description, ',');
-
-        ss >> i.score; ss.ignore();
-        ss >> i.support; ss.ignore();
-        ss >> i.population; ss.ignore();
+    usefulParsed = false;
+    usefulLog = make_unique<InsightLog>(filename);
 
-        usefulInsights.push_back(i);
-    }
-    file.close();
+    if (!usefulLog->open(migrateLegacy))
+        usefulLog.reset();
 }
 
 // Load blocked insight keys from text file
 void InsightStore::loadBlocked(const string& filename) {
+    instr::ScopedTimer timer("store.load_blocked");
 
     blockedKeys.clear();
+    blockedFingerprints.clear();
     ifstream file(filename);
 
     if (!file.is_open())
@@ -42,33 +32,39 @@ void InsightStore::loadBlocked(const string& filename) {
     string key;
 
     while (getline(file, key)) {
-        blockedKeys.insert(key);
+        addBlockedKey(key);
     }
+    timer.addRows(blockedKeys.size());
 
     file.close();
 }
 
-// Append useful insights to CSV
-void InsightStore::saveUseful(const vector<Insight>& insights,
-                              const string& filename) {
+// Append useful insights to the log
+size_t InsightStore::saveUseful(const vector<Insight>& insights,
+                                const string& filename) {
+    instr::ScopedTimer timer("store.save_useful");
+    timer.addRows(insights.size());
 
-    ofstream file(filename, ios::app);
-    if (!file.is_open())
-        return;
+    if (usefulLog && usefulLog->path() == filename) {
+        size_t added = usefulLog->appendAll(insights);
 
-    for (const Insight& i : insights) {
-        file << i.key << ","
-             << i.description << ","
-             << i.score << ","
-             << i.support << ","
-             << i.population << "\n";
+        // list-saved re-reads the log next time
+        if (added > 0)
+            usefulParsed = false;
+        return added;
     }
 
-    file.close();
+    InsightLog log(filename);
+    if (!log.open())
+        throw runtime_error("Not an insight log: " + filename);
+
+    return log.appendAll(insights);
 }
 
 // Save blocklist to text file
 void InsightStore::saveBlocked(const string& filename) {
+    instr::ScopedTimer timer("store.save_blocked");
+    timer.addRows(blockedKeys.size());
 
     ofstream file(filename);
     if (!file.is_open())
@@ -82,28 +78,61 @@ void InsightStore::saveBlocked(const string& filename) {
 }
 
 void InsightStore::addBlockedKey(const string& key) {
-    blockedKeys.insert(key);
+    if (blockedFingerprints.insert(fingerprint_key(key))) {
+        blockedKeys.push_back(key);
+    }
+}
+
+void InsightStore::removeBlockedKey(const string& key) {
+    if (blockedFingerprints.erase(fingerprint_key(key))) {
+        blockedKeys.erase(remove(blockedKeys.begin(), blockedKeys.end(), key), blockedKeys.end());
+    }
 }
 
 bool InsightStore::isBlocked(const string& key) const {
-    return blockedKeys.find(key) != blockedKeys.end();
+    return blockedFingerprints.contains(fingerprint_key(key));
+}
+
+bool InsightStore::isBlocked(const Insight& insight) const {
+    return blockedFingerprints.contains(insight.fingerprint());
 }
 
 // Remove blocked insights before showing them to the user
 vector<Insight> InsightStore::filterBlocked(const vector<Insight>& insights) const {
+    instr::ScopedTimer timer("store.filter_blocked");
+    timer.addRows(insights.size());
 
     vector<Insight> result;
 
     for (const Insight& i : insights) {
-        if (!isBlocked(i.key)) {
+        if (!isBlocked(i)) {
             result.push_back(i);
         }
     }
 
+    instr::count("store.blocked_filtered", insights.size() - result.size());
     return result;
 }
 
 const vector<Insight>& InsightStore::getUseful() const {
+    if (!usefulParsed && usefulLog) {
+        instr::ScopedTimer timer("store.read_useful");
+        usefulInsights = usefulLog->readAll();
+        usefulParsed = true;
+        timer.addRows(usefulInsights.size());
+    }
     return usefulInsights;
 }
 
+bool InsightStore::isSaved(const string& key) const {
+    return usefulLog && usefulLog->contains(key);
+}
+
+const vector<string>& InsightStore::getBlockedKeys() const {
+    return blockedKeys;
+}
+
+const FingerprintSet& InsightStore::suppression() const {
+    return blockedFingerprints;
+}
+
@@ -1,10 +1,12 @@
 
 #ifndef DECODERSCPP_INSIGHTSTORE_H
 #define DECODERSCPP_INSIGHTSTORE_H
+#include "FingerprintSet.h"
 #include "Insight.h"
+#include "InsightLog.h"
+#include <memory>
 #include <string>
 #include <vector>
-#include <unordered_set>
 
 using namespace std;
 
@@ -13,29 +15,47 @@ using namespace std;
  *
  * Saves useful insights to disk and keeps a blocklist of suppressed insight keys.
  * Blocked insights are never generated again for the same dataset.
+ * The blocklist is checked through 64-bit key fingerprints; the text keys are
+ * only kept around for display and for blocked_keys.txt.
+ * Useful insights live in an InsightLog; opening it only reads its index,
+ * the records themselves are parsed the first time getUseful() is called.
  */
 class InsightStore {
 public:
     InsightStore() = default;
 
-    void loadUseful(const string& filename);
+    // migrateLegacy lets an old comma separated insights_saved.csv be rewritten as a log
+    void loadUseful(const string& filename, bool migrateLegacy = false);
     void loadBlocked(const string& filename);
 
-    void saveUseful(const vector<Insight>& insights,
-                    const string& filename);
+    // appends to the log, skipping insights that were saved before; returns how many were new.
+    // throws runtime_error if filename is some other, non-log file
+    size_t saveUseful(const vector<Insight>& insights,
+                      const string& filename);
 
     void saveBlocked(const string& filename);
 
     void addBlockedKey(const string& key);
+    void removeBlockedKey(const string& key);
     bool isBlocked(const string& key) const;
+    bool isBlocked(const Insight& insight) const;
 
+    // post-filter for insights that were generated without suppression (copies the survivors)
     vector<Insight> filterBlocked(const vector<Insight>& insights) const;
 
     const vector<Insight>& getUseful() const;
+    bool isSaved(const string& key) const;
+    const vector<string>& getBlockedKeys() const;
+
+    // the blocklist as the suppression check InsightGenerator consults while picking each best Y
+    const FingerprintSet& suppression() const;
 
 private:
-    vector<Insight> usefulInsights;
-    unordered_set<string> blockedKeys;
+    unique_ptr<InsightLog> usefulLog;
+    mutable vector<Insight> usefulInsights;
+    mutable bool usefulParsed = false;
+    vector<string> blockedKeys;           // text form, in the order they were blocked
+    FingerprintSet blockedFingerprints;   // what lookups actually use
 };
 
 #endif
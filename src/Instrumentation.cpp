@@ -0,0 +1,195 @@
+#include "Instrumentation.h"
+#include "Tracer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#if DECODERSCPP_INSTRUMENTATION
+#include <atomic>
+#include <map>
+#include <mutex>
+#endif
+
+namespace instr {
+
+#if DECODERSCPP_INSTRUMENTATION
+
+namespace {
+
+std::atomic<std::uint64_t> g_allocations{0};
+thread_local std::uint64_t t_allocations = 0;
+
+struct Registry {
+    std::mutex mutex;
+    std::map<std::string, PhaseStats> phases;
+};
+
+// leaked on purpose so timers in static destructors still have somewhere to report
+Registry& registry() {
+    static Registry* r = new Registry;
+    return *r;
+}
+
+}
+
+void note_allocation() {
+    ++t_allocations;
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+ScopedTimer::ScopedTimer(const char* phase)
+    : m_phase(phase), m_start(trace::now()), m_startAllocations(t_allocations) {}
+
+ScopedTimer::~ScopedTimer() {
+    std::uint64_t end = trace::now();
+    std::uint64_t elapsed = end - m_start;
+    std::uint64_t allocated = t_allocations - m_startAllocations;
+    trace::record(m_phase, m_start, end);
+
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    PhaseStats& s = r.phases[m_phase];
+    s.calls += 1;
+    s.nanos += elapsed;
+    s.rows += m_rows;
+    s.bytes += m_bytes;
+    s.allocations += allocated;
+}
+
+void count(const char* name, std::uint64_t n) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.phases[name].calls += n;
+}
+
+std::uint64_t allocations() {
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+std::uint64_t thread_allocations() {
+    return t_allocations;
+}
+
+bool counting_allocations() {
+    // any binary with the counting operator new has allocated long before anyone asks
+    return allocations() > 0;
+}
+
+std::vector<PhaseEntry> snapshot() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    std::vector<PhaseEntry> out;
+    out.reserve(r.phases.size());
+    for (const auto& [name, stats] : r.phases) {
+        out.push_back({name, stats});
+    }
+    return out;
+}
+
+void reset() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.phases.clear();
+}
+
+#else
+
+std::vector<PhaseEntry> snapshot() { return {}; }
+void reset() {}
+
+#endif
+
+std::vector<PhaseEntry> difference(const std::vector<PhaseEntry>& before,
+                                   const std::vector<PhaseEntry>& after) {
+    std::vector<PhaseEntry> out;
+    auto b = before.begin();
+    for (const PhaseEntry& a : after) {
+        while (b != before.end() && b->name < a.name) ++b;
+
+        PhaseEntry d = a;
+        if (b != before.end() && b->name == a.name) {
+            d.stats.calls -= b->stats.calls;
+            d.stats.nanos -= b->stats.nanos;
+            d.stats.rows -= b->stats.rows;
+            d.stats.bytes -= b->stats.bytes;
+            d.stats.allocations -= b->stats.allocations;
+        }
+        if (d.stats.calls > 0) {
+            out.push_back(std::move(d));
+        }
+    }
+    return out;
+}
+
+std::size_t peak_rss_bytes() {
+#if defined(__unix__) || defined(__APPLE__)
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#if defined(__APPLE__)
+    return static_cast<std::size_t>(usage.ru_maxrss);          // bytes on macOS
+#else
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024;   // kilobytes on Linux
+#endif
+#else
+    return 0;
+#endif
+}
+
+namespace {
+
+// 1234567 -> "1.23M"
+std::string compact(double value) {
+    const char* suffix = "";
+    if (value >= 1e9) { value /= 1e9; suffix = "G"; }
+    else if (value >= 1e6) { value /= 1e6; suffix = "M"; }
+    else if (value >= 1e3) { value /= 1e3; suffix = "k"; }
+
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), value >= 100 ? "%.0f%s" : "%.3g%s", value, suffix);
+    return buf;
+}
+
+}
+
+std::string format_report(const std::vector<PhaseEntry>& phases) {
+    std::ostringstream out;
+    char line[160];
+    bool counted = counting_allocations();
+
+    std::snprintf(line, sizeof(line), "%-24s %7s %11s %10s %10s %10s\n",
+                  "phase", "calls", "wall ms", "rows/s", "bytes/s", "allocs");
+    out << line;
+
+    for (const PhaseEntry& p : phases) {
+        double seconds = static_cast<double>(p.stats.nanos) / 1e9;
+        std::string rows = (p.stats.rows && seconds > 0) ? compact(p.stats.rows / seconds) : "-";
+        std::string bytes = (p.stats.bytes && seconds > 0) ? compact(p.stats.bytes / seconds) : "-";
+        std::string allocs = p.stats.nanos && counted ? compact(static_cast<double>(p.stats.allocations)) : "-";
+
+        if (p.stats.nanos == 0) {
+            // plain counter
+            std::snprintf(line, sizeof(line), "%-24s %7llu %11s %10s %10s %10s\n",
+                          p.name.c_str(), static_cast<unsigned long long>(p.stats.calls), "-", "-", "-", "-");
+        } else {
+            std::snprintf(line, sizeof(line), "%-24s %7llu %11.2f %10s %10s %10s\n",
+                          p.name.c_str(), static_cast<unsigned long long>(p.stats.calls),
+                          seconds * 1000.0, rows.c_str(), bytes.c_str(), allocs.c_str());
+        }
+        out << line;
+    }
+
+    std::snprintf(line, sizeof(line), "peak RSS: %.1f MB, heap allocations: %s\n",
+                  static_cast<double>(peak_rss_bytes()) / (1024.0 * 1024.0),
+                  counted ? compact(static_cast<double>(allocations())).c_str() : "not counted");
+    out << line;
+    return out.str();
+}
+
+}
@@ -0,0 +1,105 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Build with -DDECODERSCPP_INSTRUMENTATION=0 (CMake option of the same name) to compile
+// every timer/counter below down to nothing. On by default.
+#ifndef DECODERSCPP_INSTRUMENTATION
+#define DECODERSCPP_INSTRUMENTATION 1
+#endif
+
+/**
+ * Lightweight phase timing for the CLI's `stats` command and `--timing` flag.
+ *
+ * A ScopedTimer measures one phase (e.g. "csv.read") from construction to destruction:
+ * wall time, how many heap allocations the thread made meanwhile, and optionally the
+ * rows/bytes it handled. Results are summed per phase name in a process-wide registry.
+ */
+namespace instr {
+
+struct PhaseStats {
+    std::uint64_t calls = 0;
+    std::uint64_t nanos = 0;
+    std::uint64_t rows = 0;
+    std::uint64_t bytes = 0;
+    std::uint64_t allocations = 0;
+};
+
+struct PhaseEntry {
+    std::string name;
+    PhaseStats stats;
+};
+
+constexpr bool enabled() { return DECODERSCPP_INSTRUMENTATION != 0; }
+
+#if DECODERSCPP_INSTRUMENTATION
+
+class ScopedTimer {
+public:
+    explicit ScopedTimer(const char* phase);
+    ~ScopedTimer();
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    void addRows(std::uint64_t n) { m_rows += n; }
+    void addBytes(std::uint64_t n) { m_bytes += n; }
+
+private:
+    const char* m_phase;
+    std::uint64_t m_start;
+    std::uint64_t m_startAllocations;
+    std::uint64_t m_rows = 0;
+    std::uint64_t m_bytes = 0;
+};
+
+// named event counter ("calls" is the only field used)
+void count(const char* name, std::uint64_t n = 1);
+
+// heap allocations made through operator new (process total / this thread). Only counted
+// in binaries that link CountingAllocator.cpp (run_tests, benchmarks, or the cli with
+// DECODERSCPP_COUNT_ALLOCATIONS); everywhere else the allocator is left alone and these stay 0
+std::uint64_t allocations();
+std::uint64_t thread_allocations();
+bool counting_allocations();
+
+// called by the operator new replacement for every allocation
+void note_allocation();
+
+#else
+
+class ScopedTimer {
+public:
+    explicit ScopedTimer(const char*) {}
+    void addRows(std::uint64_t) {}
+    void addBytes(std::uint64_t) {}
+};
+
+inline void count(const char*, std::uint64_t = 1) {}
+inline std::uint64_t allocations() { return 0; }
+inline std::uint64_t thread_allocations() { return 0; }
+inline bool counting_allocations() { return false; }
+
+#endif
+
+// sorted by name; empty when compiled out
+std::vector<PhaseEntry> snapshot();
+void reset();
+
+// what changed between two snapshots (phases that didn't run are left out)
+std::vector<PhaseEntry> difference(const std::vector<PhaseEntry>& before,
+                                   const std::vector<PhaseEntry>& after);
+
+// peak resident set size of the process so far, 0 if the platform can't tell
+std::size_t peak_rss_bytes();
+
+// the table `stats` prints
+std::string format_report(const std::vector<PhaseEntry>& phases);
+
+}
+
+#endif // INSTRUMENTATION_H
@@ -0,0 +1,192 @@
+#include "NumericBinning.h"
+
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#include <stdexcept>
+
+BinningMode parse_binning_mode(const std::string& text) {
+    std::string s = text;
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    if (s == "off" || s == "none") return BinningMode::Off;
+    if (s == "width" || s == "equal-width" || s == "equalwidth") return BinningMode::EqualWidth;
+    if (s == "quantile" || s == "quantiles") return BinningMode::Quantile;
+    throw std::invalid_argument("Unknown binning mode: " + text);
+}
+
+std::string to_string(BinningMode mode) {
+    switch (mode) {
+        case BinningMode::Off:        return "off";
+        case BinningMode::EqualWidth: return "width";
+        case BinningMode::Quantile:   return "quantile";
+    }
+    return "off";
+}
+
+// ------------------------------------------------------------
+// IntHistogram
+// ------------------------------------------------------------
+
+void IntHistogram::add(int value) {
+    ++m_total;
+    if (m_isSparse) {
+        ++m_sparse[value];
+        return;
+    }
+    if (m_dense.empty()) {
+        m_base = value;
+        m_dense.assign(1, 0);
+    }
+
+    long long offset = static_cast<long long>(value) - m_base;
+    if (offset < 0 || offset >= static_cast<long long>(m_dense.size())) {
+        long long low = std::min<long long>(m_base, value);
+        long long high = std::max<long long>(m_base + static_cast<long long>(m_dense.size()) - 1, value);
+        if (high - low + 1 > MAX_DENSE_SPAN) {
+            for (std::size_t i = 0; i < m_dense.size(); ++i) {
+                if (m_dense[i] != 0) {
+                    m_sparse.emplace(static_cast<int>(m_base + static_cast<long long>(i)), m_dense[i]);
+                }
+            }
+            m_dense.clear();
+            m_dense.shrink_to_fit();
+            m_isSparse = true;
+            ++m_sparse[value];
+            return;
+        }
+
+        // grow past the new value by the current size, so a run of new extremes
+        // (e.g. rows sorted descending) doesn't copy the array every time
+        const long long slack = static_cast<long long>(m_dense.size());
+        if (offset < 0) {
+            low = std::max({low - slack, high - MAX_DENSE_SPAN + 1,
+                            static_cast<long long>(std::numeric_limits<int>::min())});
+        } else {
+            high = std::min({high + slack, low + MAX_DENSE_SPAN - 1,
+                             static_cast<long long>(std::numeric_limits<int>::max())});
+        }
+
+        std::vector<std::size_t> grown(static_cast<std::size_t>(high - low + 1), 0);
+        std::copy(m_dense.begin(), m_dense.end(), grown.begin() + (m_base - low));
+        m_dense.swap(grown);
+        m_base = static_cast<int>(low);
+        offset = static_cast<long long>(value) - m_base;
+    }
+    ++m_dense[static_cast<std::size_t>(offset)];
+}
+
+std::vector<std::pair<int, std::size_t>> IntHistogram::values() const {
+    std::vector<std::pair<int, std::size_t>> out;
+    if (m_isSparse) {
+        out.assign(m_sparse.begin(), m_sparse.end());
+        return out;
+    }
+    for (std::size_t i = 0; i < m_dense.size(); ++i) {
+        if (m_dense[i] != 0) {
+            out.emplace_back(static_cast<int>(m_base + static_cast<long long>(i)), m_dense[i]);
+        }
+    }
+    return out;
+}
+
+// ------------------------------------------------------------
+// NumericBins
+// ------------------------------------------------------------
+
+namespace {
+
+// fills the value -> bin table when the bins cover few enough integers
+void buildLookup(const std::vector<int>& lows, const std::vector<int>& highs, std::vector<std::uint32_t>& lookup) {
+    lookup.clear();
+    if (lows.empty()) {
+        return;
+    }
+    long long span = static_cast<long long>(highs.back()) - lows.front() + 1;
+    if (span > IntHistogram::MAX_DENSE_SPAN) {
+        return;
+    }
+    lookup.resize(static_cast<std::size_t>(span));
+    std::uint32_t bin = 0;
+    for (long long i = 0; i < span; ++i) {
+        long long value = lows.front() + i;
+        while (bin + 1 < lows.size() && value >= lows[bin + 1]) {
+            ++bin;
+        }
+        lookup[static_cast<std::size_t>(i)] = bin;
+    }
+}
+
+}
+
+NumericBins NumericBins::identity(const IntHistogram& histogram) {
+    NumericBins bins;
+    for (const auto& [value, count] : histogram.values()) {
+        bins.m_lows.push_back(value);
+        bins.m_highs.push_back(value);
+    }
+    buildLookup(bins.m_lows, bins.m_highs, bins.m_lookup);
+    return bins;
+}
+
+NumericBins NumericBins::build(const IntHistogram& histogram, const BinningOptions& options) {
+    if (options.mode == BinningMode::Off || options.bins == 0) {
+        return identity(histogram);
+    }
+
+    auto values = histogram.values();
+    NumericBins bins;
+    if (values.empty()) {
+        return bins;
+    }
+
+    const long long count = static_cast<long long>(options.bins);
+    if (options.mode == BinningMode::EqualWidth) {
+        const long long min = values.front().first;
+        const long long max = values.back().first;
+        const long long width = std::max<long long>(1, (max - min + count) / count);   // ceil((max - min + 1) / bins)
+        for (long long low = min; low <= max; low += width) {
+            bins.m_lows.push_back(static_cast<int>(low));
+            bins.m_highs.push_back(static_cast<int>(std::min(low + width - 1, max)));
+        }
+    } else {
+        // a value goes in the bin its share of the rows before it points at; a single value
+        // can't be split, so very common values can leave fewer bins than asked for
+        const double total = static_cast<double>(histogram.total());
+        std::size_t before = 0;
+        std::size_t lastBin = 0;
+        for (const auto& [value, n] : values) {
+            std::size_t bin = std::min<std::size_t>(
+                options.bins - 1, static_cast<std::size_t>(static_cast<double>(before) * static_cast<double>(options.bins) / total));
+            if (bins.m_lows.empty() || bin != lastBin) {
+                bins.m_lows.push_back(value);
+                bins.m_highs.push_back(value);
+                lastBin = bin;
+            } else {
+                bins.m_highs.back() = value;
+            }
+            before += n;
+        }
+    }
+
+    buildLookup(bins.m_lows, bins.m_highs, bins.m_lookup);
+    return bins;
+}
+
+std::size_t NumericBins::binOf(int value) const {
+    if (!m_lookup.empty()) {
+        long long offset = static_cast<long long>(value) - m_lows.front();
+        if (offset < 0) return 0;
+        if (offset >= static_cast<long long>(m_lookup.size())) return m_lows.size() - 1;
+        return m_lookup[static_cast<std::size_t>(offset)];
+    }
+    auto it = std::upper_bound(m_lows.begin(), m_lows.end(), value);
+    return it == m_lows.begin() ? 0 : static_cast<std::size_t>(it - m_lows.begin()) - 1;
+}
+
+std::string NumericBins::label(std::size_t bin) const {
+    if (m_lows[bin] == m_highs[bin]) {
+        return std::to_string(m_lows[bin]);
+    }
+    return std::to_string(m_lows[bin]) + "-" + std::to_string(m_highs[bin]);
+}
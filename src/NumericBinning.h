@@ -0,0 +1,81 @@
+#ifndef NUMERIC_BINNING_H
+#define NUMERIC_BINNING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * How numeric attributes (course load, graduation year) are grouped before counting.
+ * Off keeps every distinct number as its own value, like generate always has.
+ */
+enum class BinningMode : std::uint8_t {
+    Off,
+    EqualWidth,   // `bins` ranges of the same width between the smallest and largest value
+    Quantile      // `bins` ranges holding about the same number of people each
+};
+
+struct BinningOptions {
+    BinningMode mode = BinningMode::Off;
+    std::size_t bins = 4;
+};
+
+// "off", "width"/"equal-width", "quantile"/"quantiles"; throws std::invalid_argument otherwise
+BinningMode parse_binning_mode(const std::string& text);
+std::string to_string(BinningMode mode);
+
+/**
+ * Counts of one integer column, filled in a single pass. Values are counted in a flat array
+ * indexed from the smallest one seen, grown as new extremes come in; a column whose values
+ * spread over more than MAX_DENSE_SPAN integers switches to an ordered map instead.
+ */
+class IntHistogram {
+public:
+    static constexpr long long MAX_DENSE_SPAN = 1 << 16;
+
+    void add(int value);
+
+    std::size_t total() const { return m_total; }
+    bool dense() const { return !m_isSparse; }
+
+    // distinct values, smallest first, with how often each was added
+    std::vector<std::pair<int, std::size_t>> values() const;
+
+private:
+    int m_base = 0;                       // value of m_dense[0]
+    std::vector<std::size_t> m_dense;
+    std::map<int, std::size_t> m_sparse;
+    bool m_isSparse = false;
+    std::size_t m_total = 0;
+};
+
+/**
+ * Consecutive integer ranges covering a column. Bin i holds the values from low(i) up to
+ * the next bin's low; high(i) is the largest value it was built to cover.
+ */
+class NumericBins {
+public:
+    // every distinct value of the histogram its own bin
+    static NumericBins identity(const IntHistogram& histogram);
+    static NumericBins build(const IntHistogram& histogram, const BinningOptions& options);
+
+    std::size_t size() const { return m_lows.size(); }
+    int low(std::size_t bin) const { return m_lows[bin]; }
+    int high(std::size_t bin) const { return m_highs[bin]; }
+
+    // values below the first bin go in the first, above the last in the last
+    std::size_t binOf(int value) const;
+
+    // "4-5", or "4" when the bin is a single value
+    std::string label(std::size_t bin) const;
+
+private:
+    std::vector<int> m_lows;
+    std::vector<int> m_highs;
+    std::vector<std::uint32_t> m_lookup;   // value - m_lows.front() -> bin, when the span is small
+};
+
+#endif // NUMERIC_BINNING_H
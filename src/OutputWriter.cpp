@@ -0,0 +1,432 @@
+#include "OutputWriter.h"
+#include "PersonBinaryReader.h"
+#include "PersonEnums.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+OutputFormat parse_output_format(const std::string& text) {
+    std::string f;
+    for (char c : text) f += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    if (f == "text") return OutputFormat::Text;
+    if (f == "json") return OutputFormat::Json;
+    if (f == "ndjson") return OutputFormat::Ndjson;
+    if (f == "csv") return OutputFormat::Csv;
+    if (f == "bin" || f == "binary") return OutputFormat::Binary;
+    throw std::invalid_argument("Unknown output format: " + text);
+}
+
+const char* to_string(OutputFormat format) {
+    switch (format) {
+        case OutputFormat::Text: return "text";
+        case OutputFormat::Json: return "json";
+        case OutputFormat::Ndjson: return "ndjson";
+        case OutputFormat::Csv: return "csv";
+        case OutputFormat::Binary: return "binary";
+    }
+    return "text";
+}
+
+BufferedWriter& BufferedWriter::operator<<(int value) {
+    char buf[16];
+    auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    m_buffer.append(buf, result.ptr);
+    return *this;
+}
+
+BufferedWriter& BufferedWriter::operator<<(std::size_t value) {
+    char buf[24];
+    auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    m_buffer.append(buf, result.ptr);
+    return *this;
+}
+
+BufferedWriter& BufferedWriter::operator<<(double value) {
+    char buf[32];
+    int n = std::snprintf(buf, sizeof(buf), "%.6g", value);
+    m_buffer.append(buf, static_cast<std::size_t>(n));
+    return *this;
+}
+
+void BufferedWriter::jsonString(std::string_view text) {
+    m_buffer.push_back('"');
+    for (char c : text) {
+        switch (c) {
+            case '"': m_buffer += "\\\""; break;
+            case '\\': m_buffer += "\\\\"; break;
+            case '\n': m_buffer += "\\n"; break;
+            case '\r': m_buffer += "\\r"; break;
+            case '\t': m_buffer += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(c));
+                    m_buffer += buf;
+                } else {
+                    m_buffer.push_back(c);
+                }
+        }
+    }
+    m_buffer.push_back('"');
+}
+
+void BufferedWriter::csvField(std::string_view text) {
+    if (text.find_first_of(",\"\n\r") == std::string_view::npos) {
+        m_buffer.append(text);
+        return;
+    }
+    m_buffer.push_back('"');
+    for (char c : text) {
+        if (c == '"') m_buffer.push_back('"');
+        m_buffer.push_back(c);
+    }
+    m_buffer.push_back('"');
+}
+
+void BufferedWriter::le(std::uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        m_buffer.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+void BufferedWriter::binaryString(std::string_view text) {
+    std::size_t length = std::min<std::size_t>(text.size(), 0xFFFF);
+    le(length, 2);
+    m_buffer.append(text.data(), length);
+}
+
+void BufferedWriter::flush() {
+    if (m_buffer.empty())
+        return;
+    m_out.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+    m_out.flush();
+    m_buffer.clear();
+}
+
+namespace {
+
+std::string joinTags(const std::unordered_set<std::string>& tags) {
+    std::string out;
+    for (const auto& t : tags) {
+        if (!out.empty()) out += '-';
+        out += t;
+    }
+    return out;
+}
+
+void binaryHeader(BufferedWriter& out, const char (&magic)[5], std::size_t count) {
+    out << std::string_view(magic, 4);
+    out.le(1, 4);  // version
+    out.le(count, 8);
+}
+
+void binaryTags(BufferedWriter& out, const std::unordered_set<std::string>& tags) {
+    out.le(tags.size(), 2);
+    for (const auto& t : tags) {
+        out.binaryString(t);
+    }
+}
+
+// Json wraps the objects in {"<name>":[...]}, Ndjson puts one per line
+template <typename Item, typename WriteOne>
+void writeJsonList(BufferedWriter& out, const char* name, const std::vector<Item>& items,
+                   OutputFormat format, WriteOne writeOne) {
+    if (format == OutputFormat::Ndjson) {
+        for (std::size_t i = 0; i < items.size(); ++i) {
+            writeOne(i, items[i]);
+            out << '\n';
+        }
+        return;
+    }
+    out << "{\"" << name << "\":[";
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        out << (i == 0 ? "\n" : ",\n");
+        writeOne(i, items[i]);
+    }
+    out << "\n]}\n";
+}
+
+}
+
+// field names match what PersonJsonReader reads, so JSON output loads again
+void write_json(BufferedWriter& out, const Person& p) {
+    out << "{\"id\":";
+    out.jsonString(p.getId());
+    out << ",\"graduationYear\":" << p.getGraduationYear()
+        << ",\"region\":\"" << enum_name(p.getRegion()) << '"'
+        << ",\"primaryOS\":\"" << enum_name(p.getPrimaryOS()) << '"'
+        << ",\"engineeringFocus\":\"" << enum_name(p.getEngineeringFocus()) << '"'
+        << ",\"studyTime\":\"" << enum_name(p.getStudyTime()) << '"'
+        << ",\"courseLoad\":" << p.getCourseLoad()
+        << ",\"favoriteColors\":";
+    out.jsonString(joinTags(p.getFavoriteColors()));
+    out << ",\"hobbies\":";
+    out.jsonString(joinTags(p.getHobbies()));
+    out << ",\"languages\":";
+    out.jsonString(joinTags(p.getLanguages()));
+    out << '}';
+}
+
+void write_json(BufferedWriter& out, std::size_t index, const Insight& x) {
+    out << "{\"index\":" << index << ",\"key\":";
+    out.jsonString(x.key());
+    out << ",\"description\":";
+    out.jsonString(x.description());
+    out << ",\"score\":" << x.score
+        << ",\"support\":" << x.support
+        << ",\"population\":" << x.population
+        << ",\"confidence\":" << x.confidence() << '}';
+}
+
+void write_json(BufferedWriter& out, std::size_t rank, const PairScore& r) {
+    out << "{\"rank\":" << rank << ",\"x\":";
+    out.jsonString(r.attrX);
+    out << ",\"y\":";
+    out.jsonString(r.attrY);
+    out << ",\"insights\":" << r.count << ",\"avgScore\":" << r.avgScore << '}';
+}
+
+// {"<attr>":"<value>",...,"count":n[,"average":x,"averaged":n]}
+void write_json(BufferedWriter& out, const QueryResult& result, const QueryGroup& group) {
+    out << '{';
+    for (std::size_t i = 0; i < group.values.size(); ++i) {
+        out.jsonString(enum_name(result.groupBy[i]));
+        out << ':';
+        out.jsonString(group.values[i]);
+        out << ',';
+    }
+    out << "\"count\":" << group.count;
+    if (result.average != Attribute::Unknown) {
+        out << ",\"average\":" << group.average << ",\"averaged\":" << group.averaged;
+    }
+    out << '}';
+}
+
+void write_persons(BufferedWriter& out, const std::vector<Person>& persons, OutputFormat format) {
+    switch (format) {
+        case OutputFormat::Text:
+            if (persons.empty()) {
+                out << "No people loaded.\n";
+                return;
+            }
+            for (std::size_t i = 0; i < persons.size(); ++i) {
+                out << i << ") " << persons[i].toString() << '\n';
+            }
+            break;
+
+        case OutputFormat::Json:
+        case OutputFormat::Ndjson:
+            writeJsonList(out, "people", persons, format,
+                          [&](std::size_t, const Person& p) { write_json(out, p); });
+            break;
+
+        case OutputFormat::Csv:
+            out << "id,graduationYear,region,primaryOS,engineeringFocus,studyTime,courseLoad,"
+                   "favoriteColors,hobbies,languages\n";
+            for (const Person& p : persons) {
+                out.csvField(p.getId());
+                out << ',' << p.getGraduationYear()
+                    << ',' << enum_name(p.getRegion())
+                    << ',' << enum_name(p.getPrimaryOS())
+                    << ',' << enum_name(p.getEngineeringFocus())
+                    << ',' << enum_name(p.getStudyTime())
+                    << ',' << p.getCourseLoad() << ',';
+                out.csvField(joinTags(p.getFavoriteColors()));
+                out << ',';
+                out.csvField(joinTags(p.getHobbies()));
+                out << ',';
+                out.csvField(joinTags(p.getLanguages()));
+                out << '\n';
+            }
+            break;
+
+        case OutputFormat::Binary:
+            out << std::string_view(PersonBinaryReader::MAGIC, sizeof(PersonBinaryReader::MAGIC));
+            out.le(PersonBinaryReader::VERSION, 4);
+            out.le(persons.size(), 8);
+            for (const Person& p : persons) {
+                out.binaryString(p.getId());
+                out.le(static_cast<std::uint32_t>(p.getGraduationYear()), 4);
+                out.le(static_cast<std::uint8_t>(p.getRegion()), 1);
+                out.le(static_cast<std::uint8_t>(p.getPrimaryOS()), 1);
+                out.le(static_cast<std::uint8_t>(p.getEngineeringFocus()), 1);
+                out.le(static_cast<std::uint8_t>(p.getStudyTime()), 1);
+                out.le(static_cast<std::uint32_t>(p.getCourseLoad()), 4);
+                binaryTags(out, p.getFavoriteColors());
+                binaryTags(out, p.getHobbies());
+                binaryTags(out, p.getLanguages());
+            }
+            break;
+    }
+}
+
+void write_insights(BufferedWriter& out, const std::vector<Insight>& insights, OutputFormat format) {
+    switch (format) {
+        case OutputFormat::Text:
+            if (insights.empty()) {
+                out << "No insights generated yet.\n";
+                return;
+            }
+            for (std::size_t i = 0; i < insights.size(); ++i) {
+                out << i << ") [Score " << insights[i].score << "] "
+                    << insights[i].description() << '\n';
+            }
+            break;
+
+        case OutputFormat::Json:
+        case OutputFormat::Ndjson:
+            writeJsonList(out, "insights", insights, format,
+                          [&](std::size_t i, const Insight& x) { write_json(out, i, x); });
+            break;
+
+        case OutputFormat::Csv:
+            out << "index,key,description,score,support,population,confidence\n";
+            for (std::size_t i = 0; i < insights.size(); ++i) {
+                const Insight& x = insights[i];
+                out << i << ',';
+                out.csvField(x.key());
+                out << ',';
+                out.csvField(x.description());
+                out << ',' << x.score << ',' << x.support << ',' << x.population
+                    << ',' << x.confidence() << '\n';
+            }
+            break;
+
+        case OutputFormat::Binary:
+            binaryHeader(out, "PINS", insights.size());
+            for (const Insight& x : insights) {
+                out.binaryString(x.key());
+                out.binaryString(x.description());
+                out.le(static_cast<std::uint32_t>(x.score), 4);
+                out.le(x.support, 8);
+                out.le(x.population, 8);
+            }
+            break;
+    }
+}
+
+void write_pair_scores(BufferedWriter& out, const std::vector<PairScore>& pairs, OutputFormat format) {
+    switch (format) {
+        case OutputFormat::Text:
+            for (std::size_t i = 0; i < pairs.size(); ++i) {
+                out << (i + 1) << ". " << pairs[i].attrX << " <-> " << pairs[i].attrY
+                    << "  avg " << static_cast<int>(pairs[i].avgScore) << "/100, "
+                    << pairs[i].count << " insights\n";
+            }
+            break;
+
+        case OutputFormat::Json:
+        case OutputFormat::Ndjson:
+            writeJsonList(out, "pairs", pairs, format,
+                          [&](std::size_t i, const PairScore& r) { write_json(out, i + 1, r); });
+            break;
+
+        case OutputFormat::Csv:
+            out << "rank,x,y,insights,avgScore\n";
+            for (std::size_t i = 0; i < pairs.size(); ++i) {
+                out << (i + 1) << ',' << pairs[i].attrX << ',' << pairs[i].attrY << ','
+                    << pairs[i].count << ',' << pairs[i].avgScore << '\n';
+            }
+            break;
+
+        case OutputFormat::Binary:
+            binaryHeader(out, "PPAR", pairs.size());
+            for (const PairScore& r : pairs) {
+                out.binaryString(r.attrX);
+                out.binaryString(r.attrY);
+                out.le(static_cast<std::uint32_t>(r.count), 4);
+                std::uint64_t bits;
+                std::memcpy(&bits, &r.avgScore, sizeof(bits));
+                out.le(bits, 8);
+            }
+            break;
+    }
+}
+
+void write_query_result(BufferedWriter& out, const QueryResult& result, OutputFormat format) {
+    const bool averaging = result.average != Attribute::Unknown;
+    switch (format) {
+        case OutputFormat::Text: {
+            char share[32];
+            std::snprintf(share, sizeof(share), "%.1f%%", result.population
+                ? 100.0 * static_cast<double>(result.matched) / static_cast<double>(result.population) : 0.0);
+            out << result.matched << " of " << result.population << " people match (" << share << ")\n";
+            if (result.groupBy.empty() && !averaging) {
+                break;
+            }
+            for (std::size_t i = 0; i < result.groups.size(); ++i) {
+                const QueryGroup& group = result.groups[i];
+                out << (i + 1) << ". ";
+                for (std::size_t v = 0; v < group.values.size(); ++v) {
+                    out << (v == 0 ? "" : ", ") << enum_name(result.groupBy[v]) << " = " << group.values[v];
+                }
+                if (group.values.empty()) {
+                    out << "everyone";
+                }
+                std::snprintf(share, sizeof(share), "%.1f%%", result.matched
+                    ? 100.0 * static_cast<double>(group.count) / static_cast<double>(result.matched) : 0.0);
+                out << ": " << group.count << " (" << share << ")";
+                if (averaging) {
+                    char average[32];
+                    std::snprintf(average, sizeof(average), "%.2f", group.average);
+                    out << ", avg " << enum_name(result.average) << ' ' << average;
+                }
+                out << '\n';
+            }
+            break;
+        }
+
+        case OutputFormat::Json:
+            out << "{\"matched\":" << result.matched << ",\"population\":" << result.population << ",\"groups\":[";
+            for (std::size_t i = 0; i < result.groups.size(); ++i) {
+                out << (i == 0 ? "\n" : ",\n");
+                write_json(out, result, result.groups[i]);
+            }
+            out << "\n]}\n";
+            break;
+
+        case OutputFormat::Ndjson:
+            writeJsonList(out, "groups", result.groups, format,
+                          [&](std::size_t, const QueryGroup& g) { write_json(out, result, g); });
+            break;
+
+        case OutputFormat::Csv:
+            for (Attribute attr : result.groupBy) {
+                out << enum_name(attr) << ',';
+            }
+            out << "count" << (averaging ? ",average,averaged\n" : "\n");
+            for (const QueryGroup& group : result.groups) {
+                for (const std::string& value : group.values) {
+                    out.csvField(value);
+                    out << ',';
+                }
+                out << group.count;
+                if (averaging) {
+                    out << ',' << group.average << ',' << group.averaged;
+                }
+                out << '\n';
+            }
+            break;
+
+        case OutputFormat::Binary:
+            binaryHeader(out, "PQRY", result.groups.size());
+            out.le(result.matched, 8);
+            out.le(result.population, 8);
+            for (const QueryGroup& group : result.groups) {
+                out.le(group.values.size(), 1);
+                for (const std::string& value : group.values) {
+                    out.binaryString(value);
+                }
+                out.le(group.count, 8);
+                std::uint64_t bits;
+                std::memcpy(&bits, &group.average, sizeof(bits));
+                out.le(bits, 8);
+                out.le(group.averaged, 8);
+            }
+            break;
+    }
+}
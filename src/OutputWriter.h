@@ -0,0 +1,83 @@
+#ifndef OUTPUT_WRITER_H
+#define OUTPUT_WRITER_H
+
+#include "CohortQuery.h"
+#include "Insight.h"
+#include "InsightGenerator.h"
+#include "Person.h"
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum class OutputFormat {
+    Text,     // the human readable listing (default)
+    Json,     // one document: {"insights":[...]}, {"people":[...]} or {"pairs":[...]}
+    Ndjson,   // one JSON object per line
+    Csv,      // header row + one row per item
+    Binary    // length-prefixed records, see write_insights / write_pair_scores
+};
+
+// "text", "json", "ndjson", "csv", "bin"/"binary"; throws std::invalid_argument for anything else
+OutputFormat parse_output_format(const std::string& text);
+const char* to_string(OutputFormat format);
+
+/**
+ * Collects output in memory and hands it to the stream in one write, so listing a
+ * million insights costs one syscall instead of several per line.
+ * Flushes on destruction if flush() wasn't called.
+ */
+class BufferedWriter {
+public:
+    explicit BufferedWriter(std::ostream& out) : m_out(out) {}
+    ~BufferedWriter() { flush(); }
+
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    BufferedWriter& operator<<(std::string_view text) { m_buffer.append(text); return *this; }
+    BufferedWriter& operator<<(char c) { m_buffer.push_back(c); return *this; }
+    BufferedWriter& operator<<(int value);
+    BufferedWriter& operator<<(std::size_t value);
+    BufferedWriter& operator<<(double value);
+
+    void jsonString(std::string_view text);   // quoted and escaped
+    void csvField(std::string_view text);     // quoted only if it has to be
+    void le(std::uint64_t value, int bytes);  // little-endian integer
+    void binaryString(std::string_view text); // u16 length + bytes
+
+    std::size_t size() const { return m_buffer.size(); }
+    void flush();
+
+private:
+    std::ostream& m_out;
+    std::string m_buffer;
+};
+
+/**
+ * Writers for the CLI listings. Text reproduces the interactive output, the other
+ * formats are meant for scripts and dashboards.
+ *
+ * Binary layouts (little-endian, str = u16 length + bytes):
+ *   persons:  same as PersonBinaryReader ("PBIN"), so the output can be loaded again
+ *   insights: "PINS", u32 version, u64 count, then str key, str description,
+ *             i32 score, u64 support, u64 population
+ *   pairs:    "PPAR", u32 version, u64 count, then str attrX, str attrY,
+ *             i32 insight count, f64 average score
+ *   query:    "PQRY", u32 version, u64 group count, u64 matched, u64 population, then per group
+ *             u8 value count, str values, u64 count, f64 average, u64 averaged
+ */
+void write_persons(BufferedWriter& out, const std::vector<Person>& persons, OutputFormat format);
+void write_insights(BufferedWriter& out, const std::vector<Insight>& insights, OutputFormat format);
+void write_pair_scores(BufferedWriter& out, const std::vector<PairScore>& pairs, OutputFormat format);
+void write_query_result(BufferedWriter& out, const QueryResult& result, OutputFormat format);
+
+// single JSON objects (no newline), for embedding in other responses like the query server's
+void write_json(BufferedWriter& out, const Person& person);
+void write_json(BufferedWriter& out, std::size_t index, const Insight& insight);
+void write_json(BufferedWriter& out, std::size_t rank, const PairScore& pair);
+void write_json(BufferedWriter& out, const QueryResult& result, const QueryGroup& group);
+
+#endif // OUTPUT_WRITER_H
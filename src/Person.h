@@ -4,6 +4,7 @@
 #include "PersonEnums.h"
 #include <string>
 #include <unordered_set>
+#include <utility>
 
 // ------------------------------------------------------------
 // Person
@@ -67,26 +68,28 @@ private:
      */
     std::unordered_set<std::string> languages;
 public:
-    Person(const std::string& id,
+    // strings and tag sets are taken by value and moved in, so readers that build
+    // them just for this Person (std::move them in) don't pay for a second copy
+    Person(std::string id,
            int graduationYear,
            Region region,
            PrimaryOS primaryOS,
            EngineeringFocus engineeringFocus,
            StudyTime studyTime,
            int courseLoad,
-           const std::unordered_set<std::string>& favoriteColors = {},
-           const std::unordered_set<std::string>& hobbies = {},
-           const std::unordered_set<std::string>& languages = {})
-        : id(id),
+           std::unordered_set<std::string> favoriteColors = {},
+           std::unordered_set<std::string> hobbies = {},
+           std::unordered_set<std::string> languages = {})
+        : id(std::move(id)),
           graduationYear(graduationYear),
           region(region),
           primaryOS(primaryOS),
           engineeringFocus(engineeringFocus),
           studyTime(studyTime),
           courseLoad(courseLoad),
-          favoriteColors(favoriteColors),
-          hobbies(hobbies),
-          languages(languages)
+          favoriteColors(std::move(favoriteColors)),
+          hobbies(std::move(hobbies)),
+          languages(std::move(languages))
     {}
 
     // --- Getters (read-only access) ---
@@ -0,0 +1,101 @@
+#include "PersonBinaryReader.h"
+#include "Instrumentation.h"
+
+#include <fstream>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace {
+
+class BinaryInput {
+public:
+    explicit BinaryInput(std::istream& in) : m_in(in) {}
+
+    std::uint64_t u(int bytes) {
+        unsigned char buf[8];
+        m_in.read(reinterpret_cast<char*>(buf), bytes);
+        if (!m_in) {
+            throw std::runtime_error("Person binary file is truncated.");
+        }
+        std::uint64_t value = 0;
+        for (int i = bytes - 1; i >= 0; --i) {
+            value = (value << 8) | buf[i];
+        }
+        return value;
+    }
+
+    std::string str() {
+        std::string s(static_cast<std::size_t>(u(2)), '\0');
+        m_in.read(s.data(), static_cast<std::streamsize>(s.size()));
+        if (!m_in) {
+            throw std::runtime_error("Person binary file is truncated.");
+        }
+        return s;
+    }
+
+    std::unordered_set<std::string> tags() {
+        std::unordered_set<std::string> out;
+        std::size_t count = static_cast<std::size_t>(u(2));
+        for (std::size_t i = 0; i < count; ++i) {
+            out.insert(str());
+        }
+        return out;
+    }
+
+    // out of range values (a newer file, corruption) read as Unknown
+    template <typename Enum>
+    Enum enumValue() {
+        std::uint64_t value = u(1);
+        return value <= static_cast<std::uint64_t>(Enum::Unknown) ? static_cast<Enum>(value) : Enum::Unknown;
+    }
+
+private:
+    std::istream& m_in;
+};
+
+}
+
+PersonBinaryReader::PersonBinaryReader(const std::string& filePath) : m_filePath(filePath) {}
+
+std::vector<Person> PersonBinaryReader::read() {
+    instr::ScopedTimer timer("binary.read");
+    std::ifstream file(m_filePath, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open binary file: " + m_filePath);
+    }
+
+    char magic[4];
+    file.read(magic, sizeof(magic));
+    if (!file || std::string(magic, 4) != std::string(MAGIC, 4)) {
+        throw std::runtime_error("Not a person binary file: " + m_filePath);
+    }
+
+    BinaryInput in(file);
+    if (in.u(4) != VERSION) {
+        throw std::runtime_error("Unsupported person binary version: " + m_filePath);
+    }
+
+    std::uint64_t rows = in.u(8);
+    std::vector<Person> persons;
+    persons.reserve(static_cast<std::size_t>(rows));
+
+    for (std::uint64_t i = 0; i < rows; ++i) {
+        std::string id = in.str();
+        int graduationYear = static_cast<std::int32_t>(in.u(4));
+        auto region = in.enumValue<Region>();
+        auto os = in.enumValue<PrimaryOS>();
+        auto focus = in.enumValue<EngineeringFocus>();
+        auto study = in.enumValue<StudyTime>();
+        int courseLoad = static_cast<std::int32_t>(in.u(4));
+        auto colors = in.tags();
+        auto hobbies = in.tags();
+        auto languages = in.tags();
+
+        persons.emplace_back(std::move(id), graduationYear, region, os, focus, study, courseLoad,
+                             std::move(colors), std::move(hobbies), std::move(languages));
+    }
+
+    timer.addRows(persons.size());
+    timer.addBytes(static_cast<std::uint64_t>(file.tellg()));
+    return persons;
+}
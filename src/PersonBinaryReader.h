@@ -0,0 +1,36 @@
+#ifndef PERSON_BINARY_READER_H
+#define PERSON_BINARY_READER_H
+
+#include "PersonReader.h"
+
+#include <cstdint>
+#include <string>
+
+/**
+ * Binary implementation of PersonReader, for the files gen_dataset writes with --format bin.
+ *
+ * Layout (little-endian):
+ *   header: "PBIN", u32 version, u64 row count
+ *   row:    str id, i32 graduation year, u8 region, u8 primary OS, u8 engineering focus,
+ *           u8 study time, i32 course load, then colors, hobbies, languages as u16 count + str...
+ *   str:    u16 length + bytes
+ * Enums are stored by their position in PersonEnums.h, which is why the version is there.
+ */
+class PersonBinaryReader : public PersonReader {
+public:
+    static constexpr char MAGIC[4] = {'P', 'B', 'I', 'N'};
+    static constexpr std::uint32_t VERSION = 1;
+
+    explicit PersonBinaryReader(const std::string& filePath);
+
+    /**
+     * Read all Person rows. Throws std::runtime_error if the file can't be opened
+     * or isn't a (complete) person binary file.
+     */
+    std::vector<Person> read() override;
+
+private:
+    std::string m_filePath;
+};
+
+#endif // PERSON_BINARY_READER_H
@@ -1,6 +1,9 @@
 #include "PersonCsvReader.h"
 #include "PersonEnums.h"
+#include "Instrumentation.h"
+#include "Tracer.h"
 
+#include <filesystem>
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
@@ -8,29 +11,56 @@
 
 // helper functions 
 
-std::string PersonCsvReader::trim(const std::string& s) {
+std::string_view PersonCsvReader::trim(std::string_view s) {
     const char* ws = " \t\r\n";
     std::size_t start = s.find_first_not_of(ws);
-    if (start == std::string::npos) return "";
+    if (start == std::string_view::npos) return {};
     std::size_t end = s.find_last_not_of(ws);
     return s.substr(start, end - start + 1);
 }
 
 std::unordered_set<std::string>
-PersonCsvReader::splitHyphenSeparated(const std::string& raw) {
+PersonCsvReader::splitHyphenSeparated(std::string_view raw) {
     std::unordered_set<std::string> result;
-    std::stringstream ss(raw);
-    std::string token;
+    std::size_t start = 0;
 
-    while (std::getline(ss, token, '-')) {
-        std::string t = trim(token);
+    while (start <= raw.size()) {
+        std::size_t dash = raw.find('-', start);
+        if (dash == std::string_view::npos) dash = raw.size();
+
+        std::string_view t = trim(raw.substr(start, dash - start));
         if (!t.empty()) {
-            result.insert(t);
+            result.emplace(t);
         }
+        start = dash + 1;
     }
     return result;
 }
 
+void PersonCsvReader::splitRow(const std::string& line, std::vector<std::string>& cells) {
+    std::string_view rest(line);
+    std::size_t count = 0;
+
+    while (true) {
+        std::size_t comma = rest.find(',');
+        std::string_view cell = trim(rest.substr(0, comma));
+
+        if (count < cells.size()) {
+            cells[count].assign(cell.data(), cell.size());  // keeps the old capacity
+        } else {
+            cells.emplace_back(cell);
+        }
+        ++count;
+
+        if (comma == std::string_view::npos) break;
+        rest.remove_prefix(comma + 1);
+    }
+
+    // a trailing comma doesn't start another cell (same as getline did)
+    if (!line.empty() && line.back() == ',') --count;
+    cells.resize(count);
+}
+
 // constructor
 
 PersonCsvReader::PersonCsvReader(const std::string& filePath)
@@ -39,6 +69,7 @@ PersonCsvReader::PersonCsvReader(const std::string& filePath)
 // read() 
 
 std::vector<Person> PersonCsvReader::read() {
+    instr::ScopedTimer timer("csv.read");
     std::ifstream in(m_filePath);
     if (!in.is_open()) {
         throw std::runtime_error("Could not open CSV file: " + m_filePath);
@@ -58,7 +89,7 @@ std::vector<Person> PersonCsvReader::read() {
         std::stringstream ss(line);
         std::string col;
         while (std::getline(ss, col, ',')) {
-            headers.push_back(trim(col));
+            headers.emplace_back(trim(col));
         }
     }
 
@@ -87,17 +118,32 @@ std::vector<Person> PersonCsvReader::read() {
         throw std::runtime_error("CSV missing one or more required columns.");
     }
 
-    // 2) Read data rows
-    while (std::getline(in, line)) {
-        if (line.empty()) continue;
+    // 2) Read data rows, traced in chunks of CHUNK_ROWS and reported every PROGRESS_ROWS
+    constexpr std::size_t CHUNK_ROWS = 65536;
+    constexpr std::size_t PROGRESS_ROWS = 4096;
+    std::uint64_t chunkStart = trace::now();
+
+    std::size_t totalBytes = 0;
+    std::size_t readBytes = line.size() + 1;
+    if (m_progress) {
+        std::error_code ec;
+        auto size = std::filesystem::file_size(m_filePath, ec);
+        totalBytes = ec ? 0 : static_cast<std::size_t>(size);
+        report_progress(m_progress, readBytes, totalBytes);
+    }
+    std::size_t rowsRead = 0;
 
-        std::vector<std::string> cells;
-        std::stringstream ss(line);
-        std::string cell;
+    std::vector<std::string> cells;   // reused for every row
 
-        while (std::getline(ss, cell, ',')) {
-            cells.push_back(trim(cell));
+    while (std::getline(in, line)) {
+        timer.addBytes(line.size() + 1);
+        readBytes += line.size() + 1;
+        if (++rowsRead % PROGRESS_ROWS == 0) {
+            report_progress(m_progress, readBytes, totalBytes);
         }
+        if (line.empty()) continue;
+
+        splitRow(line, cells);
 
         if (static_cast<int>(cells.size()) < static_cast<int>(headers.size())) {
             // Malformed row; skip or handle as needed
@@ -160,20 +206,28 @@ std::vector<Person> PersonCsvReader::read() {
         // construct immutable Person 
 
         Person person(
-            id,
+            std::move(id),
             graduationYear,
             region,
             primaryOS,
             engineeringFocus,
             studyTime,
             courseLoad,
-            favoriteColors,
-            hobbies,
-            languages
+            std::move(favoriteColors),
+            std::move(hobbies),
+            std::move(languages)
         );
 
         people.push_back(std::move(person));
+
+        if (people.size() % CHUNK_ROWS == 0) {
+            std::uint64_t chunkEnd = trace::now();
+            trace::record("csv.chunk", chunkStart, chunkEnd);
+            chunkStart = chunkEnd;
+        }
     }
+    trace::record("csv.chunk", chunkStart, trace::now());
 
+    timer.addRows(people.size());
     return people;
 }
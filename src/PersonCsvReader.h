@@ -3,7 +3,9 @@
 
 #include "PersonReader.h"
 #include <string>
+#include <string_view>
 #include <unordered_set>
+#include <vector>
 
 /**
  * CSV implementation of PersonReader.
@@ -29,8 +31,11 @@ public:
 private:
     std::string m_filePath;
 
-    static std::string trim(const std::string& s);
-    static std::unordered_set<std::string> splitHyphenSeparated(const std::string& raw);
+    static std::string_view trim(std::string_view s);
+    static std::unordered_set<std::string> splitHyphenSeparated(std::string_view raw);
+
+    // splits one line into `cells`, reusing the strings already in there
+    static void splitRow(const std::string& line, std::vector<std::string>& cells);
 };
 
 #endif // PERSONCSVREADER_H
@@ -7,10 +7,10 @@
 // Helper functions for string cleanup
 // ------------------------------------------------------------
 
-// Trim whitespace from both ends of a string.
-static std::string trim(const std::string& input) {
-    int start = 0;
-    int end = input.size();
+// Trim whitespace from both ends of a string (a view into it, no copy).
+static std::string_view trim(std::string_view input) {
+    std::size_t start = 0;
+    std::size_t end = input.size();
 
     while (start < end && std::isspace(static_cast<unsigned char>(input[start]))) {
         start++;
@@ -22,11 +22,15 @@ static std::string trim(const std::string& input) {
     return input.substr(start, end - start);
 }
 
-// Convert a string to lowercase (used for matching).
-static std::string lower(std::string s) {
-    std::transform(s.begin(), s.end(), s.begin(),
-                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
-    return s;
+// Case-insensitive match against a lowercase name (used instead of lowercasing a copy).
+static bool iequals(std::string_view value, std::string_view lowerName) {
+    if (value.size() != lowerName.size())
+        return false;
+    for (std::size_t i = 0; i < value.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(value[i])) != lowerName[i])
+            return false;
+    }
+    return true;
 }
 
 // ------------------------------------------------------------
@@ -34,16 +38,16 @@ static std::string lower(std::string s) {
 // ------------------------------------------------------------
 
 PrimaryOS parse_primary_os(const std::string& s) {
-    std::string val = lower(trim(s));
+    std::string_view val = trim(s);
 
-    if (val == "macos" || val == "mac")   return PrimaryOS::MacOS;
-    if (val == "windows" || val == "win") return PrimaryOS::Windows;
-    if (val == "linux")                   return PrimaryOS::Linux;
+    if (iequals(val, "macos") || iequals(val, "mac"))     return PrimaryOS::MacOS;
+    if (iequals(val, "windows") || iequals(val, "win"))   return PrimaryOS::Windows;
+    if (iequals(val, "linux"))                            return PrimaryOS::Linux;
 
     return PrimaryOS::Unknown;
 }
 
-std::string to_string(PrimaryOS os) {
+std::string_view enum_name(PrimaryOS os) {
     switch (os) {
         case PrimaryOS::MacOS:   return "MacOS";
         case PrimaryOS::Windows: return "Windows";
@@ -52,6 +56,10 @@ std::string to_string(PrimaryOS os) {
     }
 }
 
+std::string to_string(PrimaryOS os) {
+    return std::string(enum_name(os));
+}
+
 std::vector<std::string> all_primary_os_strings() {
     return {"MacOS", "Windows", "Linux"};
 }
@@ -61,16 +69,16 @@ std::vector<std::string> all_primary_os_strings() {
 // ------------------------------------------------------------
 
 StudyTime parse_study_time(const std::string& s) {
-    std::string val = lower(trim(s));
+    std::string_view val = trim(s);
 
-    if (val == "morning")   return StudyTime::Morning;
-    if (val == "afternoon") return StudyTime::Afternoon;
-    if (val == "night" || val == "evening") return StudyTime::Night;
+    if (iequals(val, "morning"))   return StudyTime::Morning;
+    if (iequals(val, "afternoon")) return StudyTime::Afternoon;
+    if (iequals(val, "night") || iequals(val, "evening")) return StudyTime::Night;
 
     return StudyTime::Unknown;
 }
 
-std::string to_string(StudyTime st) {
+std::string_view enum_name(StudyTime st) {
     switch (st) {
         case StudyTime::Morning:   return "Morning";
         case StudyTime::Afternoon: return "Afternoon";
@@ -79,6 +87,10 @@ std::string to_string(StudyTime st) {
     }
 }
 
+std::string to_string(StudyTime st) {
+    return std::string(enum_name(st));
+}
+
 std::vector<std::string> all_study_time_strings() {
     return {"Morning", "Afternoon", "Night"};
 }
@@ -140,16 +152,16 @@ static const RegionMapping REGION_TABLE[] = {
 };
 
 Region parse_region(const std::string& s) {
-    std::string val = lower(trim(s));
+    std::string_view val = trim(s);
 
     for (const auto& entry : REGION_TABLE) {
-        if (val == entry.name)
+        if (iequals(val, entry.name))
             return entry.region;
     }
     return Region::Unknown;
 }
 
-std::string to_string(Region r) {
+std::string_view enum_name(Region r) {
     for (const auto& entry : REGION_TABLE) {
         if (entry.region == r)
             return entry.name;
@@ -157,6 +169,10 @@ std::string to_string(Region r) {
     return "unknown";
 }
 
+std::string to_string(Region r) {
+    return std::string(enum_name(r));
+}
+
 std::vector<std::string> all_region_strings() {
     std::vector<std::string> regions;
     regions.reserve(std::size(REGION_TABLE));
@@ -228,10 +244,10 @@ static const FocusMapping FOCUS_TABLE[] = {
 // Parse a string into an EngineeringFocus enum
 // ------------------------------------------------------------
 EngineeringFocus parse_engineering_focus(const std::string& s) {
-    std::string val = lower(trim(s));
+    std::string_view val = trim(s);
 
     for (const auto& entry : FOCUS_TABLE) {
-        if (val == entry.name)
+        if (iequals(val, entry.name))
             return entry.focus;
     }
 
@@ -241,7 +257,7 @@ EngineeringFocus parse_engineering_focus(const std::string& s) {
 // ------------------------------------------------------------
 // Convert an EngineeringFocus enum to a string
 // ------------------------------------------------------------
-std::string to_string(EngineeringFocus f) {
+std::string_view enum_name(EngineeringFocus f) {
     for (const auto& entry : FOCUS_TABLE) {
         if (entry.focus == f)
             return entry.name;
@@ -249,6 +265,10 @@ std::string to_string(EngineeringFocus f) {
     return "unknown";
 }
 
+std::string to_string(EngineeringFocus f) {
+    return std::string(enum_name(f));
+}
+
 // ------------------------------------------------------------
 // Return all available focus strings (for menus or validation)
 // ------------------------------------------------------------
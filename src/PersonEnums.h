@@ -2,6 +2,7 @@
 #define PERSON_ENUMS_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 enum class PrimaryOS {
@@ -109,6 +110,12 @@ std::string to_string(Region r);
 EngineeringFocus    parse_engineering_focus(const std::string& s);
 std::string         to_string(EngineeringFocus f);
 
+// same text as to_string but without building a std::string (points at static storage)
+std::string_view enum_name(PrimaryOS os);
+std::string_view enum_name(StudyTime st);
+std::string_view enum_name(Region r);
+std::string_view enum_name(EngineeringFocus f);
+
 std::vector<std::string> all_primary_os_strings();
 std::vector<std::string> all_study_time_strings();
 std::vector<std::string> all_region_strings();
@@ -1,5 +1,6 @@
 #include "PersonJsonReader.h"
 #include "PersonEnums.h"
+#include "Instrumentation.h"
 
 #include <curl/curl.h>
 #include <sstream>
@@ -16,12 +17,24 @@ static size_t WriteCallback(void* receivedContents, size_t elementSize, size_t n
     return totalBytesReceived;
 }
 
+//libcurl transfer progress; a non-zero return aborts the transfer
+static int ProgressCallbackAdapter(void* callback, curl_off_t totalToDownload, curl_off_t downloaded,
+                                   curl_off_t, curl_off_t) {
+    const ProgressCallback& progress = *static_cast<const ProgressCallback*>(callback);
+    return progress(static_cast<size_t>(downloaded), static_cast<size_t>(totalToDownload)) ? 0 : 1;
+}
+
 
 
 PersonJsonReader::PersonJsonReader(const std::string& url) : url_(url) {}
 
 std::vector<Person> PersonJsonReader::read() {
-    std::string jsonString = httpGet(url_);
+    std::string jsonString;
+    {
+        instr::ScopedTimer timer("json.fetch");
+        jsonString = httpGet(url_, m_progress);
+        timer.addBytes(jsonString.size());
+    }
     if (jsonString.empty()) {
         std::cerr << "Failed to fetch JSON from URL: " << url_ << std::endl;
         return {};
@@ -30,7 +43,7 @@ std::vector<Person> PersonJsonReader::read() {
 }
 
 
-std::string PersonJsonReader::httpGet(const std::string& url) {
+std::string PersonJsonReader::httpGet(const std::string& url, const ProgressCallback& progress) {
     std::string httpResponse;
     CURL* curlHandle = curl_easy_init();
     if (!curlHandle) {
@@ -48,12 +61,21 @@ std::string PersonJsonReader::httpGet(const std::string& url) {
     curl_easy_setopt(curlHandle, CURLOPT_TIMEOUT, 30L); // 30 second timeout
     curl_easy_setopt(curlHandle, CURLOPT_SSL_VERIFYPEER, 0L); // skip SSL verification 
     curl_easy_setopt(curlHandle, CURLOPT_SSL_VERIFYHOST, 0L);  // dkip host verification
+    if (progress) {
+        curl_easy_setopt(curlHandle, CURLOPT_NOPROGRESS, 0L);
+        curl_easy_setopt(curlHandle, CURLOPT_XFERINFOFUNCTION, ProgressCallbackAdapter);
+        curl_easy_setopt(curlHandle, CURLOPT_XFERINFODATA, &progress);
+    }
     // perform HTTP GET request
     CURLcode curlResult = curl_easy_perform(curlHandle);
 
 
 
 
+    if (curlResult == CURLE_ABORTED_BY_CALLBACK) {
+        curl_easy_cleanup(curlHandle);
+        throw OperationCancelled();
+    }
     if (curlResult != CURLE_OK) {
         std::cerr << "HTTP request failed: " << curl_easy_strerror(curlResult) << std::endl;
         httpResponse = "";
@@ -166,6 +188,8 @@ int PersonJsonReader::extractJsonInt(const std::string& jsonContent, const std::
 
 //parses JSON string into Person objects
 std::vector<Person> PersonJsonReader::parseJson(const std::string& jsonString) {
+    instr::ScopedTimer timer("json.parse");
+    timer.addBytes(jsonString.size());
     std::vector<Person> personsList;
     // find people array in the JSON
     size_t peopleArrayPosition = jsonString.find("\"people\"");
@@ -254,21 +278,22 @@ std::vector<Person> PersonJsonReader::parseJson(const std::string& jsonString) {
 
         //creates Person object using constructor, Person class is immutable
         Person newPerson(
-            personId,
+            std::move(personId),
             graduationYear,
             parsedRegion,
             parsedOperatingSystem,
             parsedEngineeringFocus,
             parsedStudyTime,
             courseLoad,
-            favoriteColorsSet,
-            hobbiesSet,
-            languagesSet
+            std::move(favoriteColorsSet),
+            std::move(hobbiesSet),
+            std::move(languagesSet)
         );
 //adds new person to list
         personsList.push_back(std::move(newPerson));
         currentPosition = objectEndPosition;
     }
 
+    timer.addRows(personsList.size());
     return personsList;
 }
@@ -21,6 +21,9 @@ public:
      */
     std::vector<Person> read() override;
 
+    // parse JSON string into Person objects (no HTTP, used by read() and the benchmarks)
+    std::vector<Person> parseJson(const std::string& jsonStr);
+
 private:
     std::string url_;
 
@@ -28,11 +31,8 @@ private:
 
 
 
-    // make HTTP GET request
-    static std::string httpGet(const std::string& url);
-
-    // parse JSON string into Person objects
-    std::vector<Person> parseJson(const std::string& jsonStr);
+    // make HTTP GET request; progress gets (bytes received, bytes expected) and can abort it
+    static std::string httpGet(const std::string& url, const ProgressCallback& progress);
 
 
     // split hyphen-separated values
@@ -2,6 +2,8 @@
 #define PERSONREADER_H
 
 #include "Person.h"
+#include "Progress.h"
+#include <utility>
 #include <vector>
 
 /**
@@ -18,6 +20,15 @@ public:
      * Execute a specific read implementation and return a collection of Person objects.
      */
     virtual std::vector<Person> read() = 0;
+
+    /**
+     * Optional: called with (bytes read, total bytes) while read() runs; returning false
+     * makes read() throw OperationCancelled. Readers that can't tell how far they are ignore it.
+     */
+    void setProgress(ProgressCallback progress) { m_progress = std::move(progress); }
+
+protected:
+    ProgressCallback m_progress;
 };
 
 #endif // PERSONREADER_H
@@ -1,17 +1,21 @@
 #include "PersonRepository.h"
 #include "PersonEnums.h"   
+#include "Instrumentation.h"
 #include <stdexcept>
 #include <fstream>         
 #include <unordered_set>   
+#include <string_view>
 
 // Initialize / replace whole dataset (copy)
 void PersonRepository::setPersons(const std::vector<Person>& persons) {
     m_persons = persons;
+    ++m_version;
 }
 
 // Initialize / replace whole dataset (move)
 void PersonRepository::setPersons(std::vector<Person>&& persons) {
     m_persons = std::move(persons);
+    ++m_version;
 }
 
 // Read only access to all persons
@@ -34,6 +38,7 @@ const Person& PersonRepository::get(std::size_t index) const {
 
 void PersonRepository::addPerson(const Person& person) {
     m_persons.push_back(person);
+    ++m_version;
 }
 
 void PersonRepository::updatePerson(std::size_t index, const Person& person) {
@@ -42,6 +47,7 @@ void PersonRepository::updatePerson(std::size_t index, const Person& person) {
     }
     // Person is immutable so entire object is replaced
     m_persons[index] = person;
+    ++m_version;
 }
 
 void PersonRepository::removePerson(std::size_t index) {
@@ -49,6 +55,71 @@ void PersonRepository::removePerson(std::size_t index) {
         throw std::out_of_range("PersonRepository::removePerson - index out of range");
     }
     m_persons.erase(m_persons.begin() + static_cast<std::ptrdiff_t>(index));
+    ++m_version;
+}
+
+namespace {
+
+std::uint64_t fnv(std::uint64_t hash, std::string_view text) {
+    for (char c : text) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::uint64_t fnvNumber(std::uint64_t hash, std::int64_t value) {
+    return fnv(hash, std::string_view(reinterpret_cast<const char*>(&value), sizeof(value)));
+}
+
+// sets iterate in no particular order, so their members are summed instead of chained
+std::uint64_t tagsHash(const std::unordered_set<std::string>& tags) {
+    std::uint64_t sum = tags.size();
+    for (const auto& t : tags) {
+        sum += fnv(14695981039346656037ULL, t) * 0x9E3779B97F4A7C15ULL;
+    }
+    return sum;
+}
+
+}
+
+std::uint64_t dataset_hash(const std::vector<Person>& persons) {
+    std::uint64_t hash = fnvNumber(14695981039346656037ULL, static_cast<std::int64_t>(persons.size()));
+    for (const Person& p : persons) {
+        hash = fnv(hash, p.getId());
+        hash = fnvNumber(hash, p.getGraduationYear());
+        hash = fnvNumber(hash, static_cast<std::int64_t>(p.getRegion()));
+        hash = fnvNumber(hash, static_cast<std::int64_t>(p.getPrimaryOS()));
+        hash = fnvNumber(hash, static_cast<std::int64_t>(p.getEngineeringFocus()));
+        hash = fnvNumber(hash, static_cast<std::int64_t>(p.getStudyTime()));
+        hash = fnvNumber(hash, p.getCourseLoad());
+        hash = fnvNumber(hash, static_cast<std::int64_t>(tagsHash(p.getFavoriteColors())));
+        hash = fnvNumber(hash, static_cast<std::int64_t>(tagsHash(p.getHobbies())));
+        hash = fnvNumber(hash, static_cast<std::int64_t>(tagsHash(p.getLanguages())));
+    }
+    return hash;
+}
+
+std::uint64_t PersonRepository::contentHash() const {
+    if (m_hashVersion != m_version) {
+        instr::ScopedTimer timer("repo.hash");
+        timer.addRows(m_persons.size());
+        m_hash = dataset_hash(m_persons);
+        m_hashVersion = m_version;
+    }
+    return m_hash;
+}
+
+const PersonIndex& PersonRepository::index() const {
+    if (!m_index || m_indexVersion != m_version) {
+        m_index = std::make_shared<const PersonIndex>(m_persons);
+        m_indexVersion = m_version;
+    }
+    return *m_index;
+}
+
+QueryResult PersonRepository::query(const CohortQuery& query) const {
+    return index().run(query);
 }
 
 // convert an unordered_set<string> to a hyphen-separated string,
@@ -64,6 +135,8 @@ static std::string joinSet(const std::unordered_set<std::string>& s) {
 }
 
 bool PersonRepository::saveToCsv(const std::string& filePath) const {
+    instr::ScopedTimer timer("repo.save_csv");
+    timer.addRows(m_persons.size());
     std::ofstream out(filePath);
     if (!out.is_open()) {
         return false; // could also throw, but bool is fine for now
@@ -86,5 +159,7 @@ bool PersonRepository::saveToCsv(const std::string& filePath) const {
             << joinSet(p.getLanguages()) << '\n';
     }
 
+    timer.addBytes(static_cast<std::uint64_t>(out.tellp()));
+
     return true;
 }
\ No newline at end of file
@@ -10,9 +10,16 @@ Return const reference to all persons for reading.
 #ifndef PERSONREPOSITORY_H
 #define PERSONREPOSITORY_H
 
+#include "CohortQuery.h"
 #include "Person.h"
+#include <memory>
 #include <vector>
 #include <cstddef> // for std::size_t
+#include <cstdint>
+
+// hash of the dataset contents (tag order doesn't matter); the same data hashes the
+// same in every run, so it can key results cached on disk
+std::uint64_t dataset_hash(const std::vector<Person>& persons);
 
 /**
  * PersonRepository
@@ -44,8 +51,26 @@ public:
     //Save dataset to the csv
     bool saveToCsv(const std::string& filePath) const;
 
+    // bumped by every change above
+    std::uint64_t version() const { return m_version; }
+    // dataset_hash of the current contents, computed once per version. Not thread safe the
+    // first time after a change; callers sharing the repository compute it under their write lock
+    std::uint64_t contentHash() const;
+
+    // filter / group by / count or average over the current data (see CohortQuery). The column
+    // index it runs on is made by the first query after a change, with the same thread safety
+    // caveat as contentHash; its columns are built as queries need them, from any thread.
+    // throws std::invalid_argument for a query that can't be answered
+    QueryResult query(const CohortQuery& query) const;
+    const PersonIndex& index() const;
+
 private:
     std::vector<Person> m_persons;
+    std::uint64_t m_version = 0;
+    mutable std::uint64_t m_hash = 0;
+    mutable std::uint64_t m_hashVersion = ~std::uint64_t(0);
+    mutable std::shared_ptr<const PersonIndex> m_index;
+    mutable std::uint64_t m_indexVersion = ~std::uint64_t(0);
 };
 
 #endif // PERSONREPOSITORY_H
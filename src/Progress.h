@@ -0,0 +1,29 @@
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+
+/**
+ * Progress hook for the long calls a GUI runs on a worker thread (readers, generator passes).
+ *
+ * Called now and then with how far the call is, in its own units (bytes for readers, passes
+ * for the generator). Returning false cancels: the call throws OperationCancelled at that
+ * point instead of finishing, so nothing half done gets returned or cached.
+ */
+using ProgressCallback = std::function<bool(std::size_t done, std::size_t total)>;
+
+class OperationCancelled : public std::runtime_error {
+public:
+    OperationCancelled() : std::runtime_error("Cancelled.") {}
+};
+
+// calls `progress` if there is one; throws OperationCancelled if it says to stop
+inline void report_progress(const ProgressCallback& progress, std::size_t done, std::size_t total) {
+    if (progress && !progress(done, total)) {
+        throw OperationCancelled();
+    }
+}
+
+#endif // PROGRESS_H
@@ -0,0 +1,537 @@
+#include "QueryServer.h"
+#include "Attribute.h"
+#include "CohortQuery.h"
+#include "Instrumentation.h"
+#include "OutputWriter.h"
+#include "PersonCsvReader.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr std::size_t MAX_REQUEST_BYTES = 1 << 20;
+
+/**
+ * A request is a flat JSON object; values are kept as text. Nested objects and
+ * arrays aren't needed by any command and are rejected.
+ */
+struct Request {
+    std::unordered_map<std::string, std::string> fields;
+    std::string idJson;   // the "id" value as JSON, echoed back in the response
+
+    bool has(const std::string& key) const { return fields.count(key) != 0; }
+
+    std::string text(const std::string& key) const {
+        auto it = fields.find(key);
+        return it == fields.end() ? std::string() : it->second;
+    }
+
+    // a whole non-negative number; stoul alone would wrap "-5" and stop quietly at "5abc"
+    std::size_t number(const std::string& key, std::size_t fallback) const {
+        auto it = fields.find(key);
+        if (it == fields.end() || it->second.empty()) return fallback;
+        const std::string& value = it->second;
+        std::size_t used = 0;
+        unsigned long parsed = 0;
+        if (std::isdigit(static_cast<unsigned char>(value[0]))) {
+            try {
+                parsed = std::stoul(value, &used);
+            } catch (const std::exception&) {
+                used = 0;
+            }
+        }
+        if (used == 0 || used != value.size()) {
+            throw std::invalid_argument("\"" + key + "\" must be a non-negative whole number");
+        }
+        return static_cast<std::size_t>(parsed);
+    }
+};
+
+void skipSpace(const std::string& s, std::size_t& pos) {
+    while (pos < s.size() && std::isspace(static_cast<unsigned char>(s[pos]))) ++pos;
+}
+
+std::string parseString(const std::string& s, std::size_t& pos) {
+    // s[pos] is the opening quote
+    std::string out;
+    for (++pos; pos < s.size(); ++pos) {
+        char c = s[pos];
+        if (c == '"') {
+            ++pos;
+            return out;
+        }
+        if (c != '\\') {
+            out += c;
+            continue;
+        }
+        if (++pos >= s.size()) break;
+        switch (s[pos]) {
+            case 'n': out += '\n'; break;
+            case 't': out += '\t'; break;
+            case 'r': out += '\r'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'u': {
+                if (pos + 4 >= s.size()) throw std::invalid_argument("bad \\u escape");
+                unsigned code = static_cast<unsigned>(std::stoul(s.substr(pos + 1, 4), nullptr, 16));
+                out += code < 0x80 ? static_cast<char>(code) : '?';  // keys and values are ASCII
+                pos += 4;
+                break;
+            }
+            default: out += s[pos];  // \" \\ \/
+        }
+    }
+    throw std::invalid_argument("unterminated string");
+}
+
+// -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+bool isJsonNumber(const std::string& s) {
+    std::size_t pos = 0;
+    auto digits = [&] {
+        std::size_t start = pos;
+        while (pos < s.size() && std::isdigit(static_cast<unsigned char>(s[pos]))) ++pos;
+        return pos > start;
+    };
+
+    if (pos < s.size() && s[pos] == '-') ++pos;
+    if (pos < s.size() && s[pos] == '0') {
+        ++pos;
+    } else if (!digits()) {
+        return false;
+    }
+    if (pos < s.size() && s[pos] == '.') {
+        ++pos;
+        if (!digits()) return false;
+    }
+    if (pos < s.size() && (s[pos] == 'e' || s[pos] == 'E')) {
+        ++pos;
+        if (pos < s.size() && (s[pos] == '+' || s[pos] == '-')) ++pos;
+        if (!digits()) return false;
+    }
+    return pos == s.size();
+}
+
+std::string jsonQuoted(const std::string& text) {
+    std::ostringstream quoted;
+    {
+        BufferedWriter out(quoted);
+        out.jsonString(text);
+    }
+    return quoted.str();
+}
+
+Request parseRequest(const std::string& line) {
+    Request request;
+    std::size_t pos = 0;
+    skipSpace(line, pos);
+    if (pos >= line.size() || line[pos] != '{')
+        throw std::invalid_argument("request must be a JSON object");
+    ++pos;
+
+    while (true) {
+        skipSpace(line, pos);
+        if (pos < line.size() && line[pos] == '}') break;
+        if (pos >= line.size() || line[pos] != '"')
+            throw std::invalid_argument("expected a quoted key");
+        std::string key = parseString(line, pos);
+
+        skipSpace(line, pos);
+        if (pos >= line.size() || line[pos] != ':')
+            throw std::invalid_argument("expected ':' after \"" + key + "\"");
+        ++pos;
+        skipSpace(line, pos);
+
+        std::string value, raw;
+        bool quoted = false;
+        if (pos < line.size() && line[pos] == '"') {
+            value = parseString(line, pos);
+            quoted = true;
+        } else if (pos < line.size() && (line[pos] == '{' || line[pos] == '[')) {
+            throw std::invalid_argument("nested values aren't supported (\"" + key + "\")");
+        } else {
+            std::size_t start = pos;
+            while (pos < line.size() && line[pos] != ',' && line[pos] != '}') ++pos;
+            raw = line.substr(start, pos - start);
+            raw.erase(raw.find_last_not_of(" \t\r\n") + 1);
+            if (raw.empty()) throw std::invalid_argument("missing value for \"" + key + "\"");
+            value = raw;
+        }
+        // the id goes into the response as is, so it has to be a JSON value on its own
+        if (key == "id") {
+            if (quoted) {
+                request.idJson = jsonQuoted(value);
+            } else if (isJsonNumber(raw)) {
+                request.idJson = raw;
+            } else {
+                throw std::invalid_argument("\"id\" must be a string or a number");
+            }
+        }
+        request.fields[key] = std::move(value);
+
+        skipSpace(line, pos);
+        if (pos < line.size() && line[pos] == ',') {
+            ++pos;
+            continue;
+        }
+        if (pos < line.size() && line[pos] == '}') break;
+        throw std::invalid_argument("expected ',' or '}'");
+    }
+    return request;
+}
+
+void writeInsightList(BufferedWriter& out, const std::vector<Insight>& insights) {
+    out << ",\"insights\":[";
+    for (std::size_t i = 0; i < insights.size(); ++i) {
+        if (i > 0) out << ',';
+        write_json(out, i, insights[i]);
+    }
+    out << ']';
+}
+
+bool sendAll(int fd, const std::string& data) {
+    std::size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        sent += static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+}
+
+QueryServer::QueryServer(ServerOptions options) : m_options(std::move(options)) {
+    m_store.loadUseful(m_options.usefulFile);
+    m_store.loadBlocked(m_options.blockedFile);
+    if (!m_options.dataset.empty()) {
+        m_repo.setPersons(PersonCsvReader(m_options.dataset).read());
+        m_datasetPath = m_options.dataset;
+        m_datasetVersion = 1;
+        m_datasetHash = m_repo.contentHash();
+        m_repo.index();
+        if (m_options.diskCache) m_cache.setDiskDirectory(m_datasetPath + ".cache");
+    }
+}
+
+QueryServer::~QueryServer() {
+    if (!m_workers.empty() || m_listenFd >= 0) {
+        m_stopping = true;
+        shutdownWorkers();
+    }
+}
+
+std::string QueryServer::handle(const std::string& line) {
+    std::ostringstream response;
+    BufferedWriter out(response);
+    Request request;
+
+    try {
+        request = parseRequest(line);
+        std::string cmd = request.text("cmd");
+        std::string phase = "server." + cmd;
+        instr::ScopedTimer timer(phase.c_str());
+
+        out << '{';
+        if (!request.idJson.empty()) out << "\"id\":" << request.idJson << ',';
+        out << "\"ok\":true";
+
+        if (cmd == "ping") {
+        }
+        else if (cmd == "info") {
+            std::shared_lock<std::shared_mutex> lock(m_stateMutex);
+            out << ",\"rows\":" << m_repo.size() << ",\"dataset\":";
+            out.jsonString(m_datasetPath);
+            out << ",\"version\":" << static_cast<std::size_t>(m_datasetVersion)
+                << ",\"blocked\":" << m_store.getBlockedKeys().size()
+                << ",\"workers\":" << m_workers.size();
+        }
+        else if (cmd == "load") {
+            std::string path = request.text("path");
+            if (path.empty()) throw std::invalid_argument("load needs \"path\"");
+            std::vector<Person> persons = PersonCsvReader(path).read();  // outside the lock
+
+            std::unique_lock<std::shared_mutex> lock(m_stateMutex);
+            m_repo.setPersons(std::move(persons));
+            m_datasetPath = path;
+            ++m_datasetVersion;
+            m_datasetHash = m_repo.contentHash();
+            m_repo.index();   // made here, under the write lock; count builds its columns thread safely
+            if (m_options.diskCache) m_cache.setDiskDirectory(m_datasetPath + ".cache");
+            out << ",\"rows\":" << m_repo.size()
+                << ",\"version\":" << static_cast<std::size_t>(m_datasetVersion);
+        }
+        else if (cmd == "generate") {
+            std::size_t limit = request.number("limit", 0);
+            std::shared_lock<std::shared_mutex> lock(m_stateMutex);
+            auto insights = m_cache.generate(m_repo.getAll(), m_datasetHash, m_store.suppression(), limit);
+            lock.unlock();
+            writeInsightList(out, insights);
+        }
+        else if (cmd == "generate-custom") {
+            std::string x = request.text("x"), y = request.text("y");
+            if (x.empty() || y.empty()) throw std::invalid_argument("generate-custom needs \"x\" and \"y\"");
+            std::size_t limit = request.number("limit", 0);
+            std::shared_lock<std::shared_mutex> lock(m_stateMutex);
+            auto insights = m_cache.generateGeneric(m_repo.getAll(), m_datasetHash, m_store.suppression(), x, y, limit);
+            lock.unlock();
+            writeInsightList(out, insights);
+        }
+        else if (cmd == "discover") {
+            // same attribute sets as discover-best / discover-all, ignoring the blocklist like they do
+            std::vector<std::string> attributes = {"os", "study", "color", "hobby", "region", "language"};
+            std::string all = request.text("all");
+            if (all == "true" || all == "1") {
+                attributes.insert(attributes.end(), {"focus", "course", "graduation"});
+            }
+            FingerprintSet none;
+            std::shared_lock<std::shared_mutex> lock(m_stateMutex);
+            auto pairs = m_cache.scorePairs(m_repo.getAll(), m_datasetHash, none, attributes);
+            lock.unlock();
+            out << ",\"pairs\":[";
+            for (std::size_t i = 0; i < pairs.size(); ++i) {
+                if (i > 0) out << ',';
+                write_json(out, i + 1, pairs[i]);
+            }
+            out << ']';
+        }
+        else if (cmd == "count") {
+            // every field besides cmd/id is a filter: {"cmd":"count","region":"china","os":"MacOS"}
+            CohortQuery query;
+            for (const auto& field : request.fields) {
+                if (field.first == "cmd" || field.first == "id") continue;
+                Attribute attr = parse_attribute(field.first);
+                if (attr == Attribute::Unknown) throw std::invalid_argument("unknown attribute: " + field.first);
+                query.filters.push_back(QueryPredicate{attr, {field.second}});
+            }
+            query.threads = 1;   // the worker pool is the parallelism here
+            std::shared_lock<std::shared_mutex> lock(m_stateMutex);
+            QueryResult result = m_repo.query(query);
+            lock.unlock();
+            out << ",\"count\":" << result.matched << ",\"population\":" << result.population;
+        }
+        else if (cmd == "block" || cmd == "unblock") {
+            std::string key = request.text("key");
+            if (key.empty()) throw std::invalid_argument(cmd + " needs \"key\"");
+            std::unique_lock<std::shared_mutex> lock(m_stateMutex);
+            if (cmd == "block")
+                m_store.addBlockedKey(key);
+            else
+                m_store.removeBlockedKey(key);
+            m_store.saveBlocked(m_options.blockedFile);
+            out << ",\"blocked\":" << m_store.getBlockedKeys().size();
+        }
+        else {
+            throw std::invalid_argument(cmd.empty() ? "missing \"cmd\"" : "unknown command: " + cmd);
+        }
+        out << '}';
+    } catch (const std::exception& ex) {
+        // start over so a half written success never goes out
+        std::ostringstream failed;
+        BufferedWriter err(failed);
+        err << '{';
+        if (!request.idJson.empty()) err << "\"id\":" << request.idJson << ',';
+        err << "\"ok\":false,\"error\":";
+        err.jsonString(ex.what());
+        err << '}';
+        err.flush();
+        return failed.str();
+    }
+
+    out.flush();
+    return response.str();
+}
+
+bool QueryServer::start() {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (m_options.socketPath.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Socket path too long: " << m_options.socketPath << "\n";
+        return false;
+    }
+    std::strcpy(address.sun_path, m_options.socketPath.c_str());
+
+    // a socket left behind by a server that didn't shut down cleanly; never remove anything else
+    struct stat existing;
+    if (::stat(m_options.socketPath.c_str(), &existing) == 0 && S_ISSOCK(existing.st_mode)) {
+        ::unlink(m_options.socketPath.c_str());
+    }
+
+    m_listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_listenFd < 0 ||
+        ::bind(m_listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(m_listenFd, 64) != 0) {
+        std::cerr << "Could not listen on " << m_options.socketPath << ": " << std::strerror(errno) << "\n";
+        if (m_listenFd >= 0) ::close(m_listenFd);
+        m_listenFd = -1;
+        return false;
+    }
+
+    if (::pipe(m_wakeFds) != 0) {
+        std::cerr << "Could not create the wake-up pipe: " << std::strerror(errno) << "\n";
+        ::close(m_listenFd);
+        m_listenFd = -1;
+        return false;
+    }
+    for (int fd : m_wakeFds) ::fcntl(fd, F_SETFL, O_NONBLOCK);
+
+    std::size_t workers = m_options.workers;
+    if (workers == 0) workers = std::max(1u, std::thread::hardware_concurrency());
+    for (std::size_t i = 0; i < workers; ++i) {
+        m_workers.emplace_back([this] { workerLoop(); });
+    }
+    return true;
+}
+
+void QueryServer::serve() {
+    std::vector<pollfd> watched;
+    std::vector<Connection> stillIdle;
+
+    while (!m_stopping) {
+        {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            for (Connection& connection : m_returned) m_idle.push_back(std::move(connection));
+            m_returned.clear();
+        }
+
+        watched.clear();
+        watched.push_back({m_listenFd, POLLIN, 0});
+        watched.push_back({m_wakeFds[0], POLLIN, 0});
+        for (const Connection& connection : m_idle) watched.push_back({connection.fd, POLLIN, 0});
+
+        int ready = ::poll(watched.data(), watched.size(), 200);  // wake up now and then to notice stop()
+        if (ready <= 0) continue;
+
+        if (watched[1].revents != 0) {
+            char drain[64];
+            while (::read(m_wakeFds[0], drain, sizeof(drain)) > 0) {}
+        }
+
+        // anything readable (a request, a hangup) goes to the workers; the rest keeps waiting
+        stillIdle.clear();
+        {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            for (std::size_t i = 0; i < m_idle.size(); ++i) {
+                if (watched[i + 2].revents != 0) {
+                    m_pending.push_back(std::move(m_idle[i]));
+                    m_queueReady.notify_one();
+                } else {
+                    stillIdle.push_back(std::move(m_idle[i]));
+                }
+            }
+        }
+        m_idle.swap(stillIdle);
+
+        if (watched[0].revents & POLLIN) {
+            int client = ::accept(m_listenFd, nullptr, nullptr);
+            if (client >= 0) m_idle.push_back(Connection{client, {}});
+        }
+    }
+    shutdownWorkers();
+}
+
+void QueryServer::workerLoop() {
+    while (true) {
+        Connection connection;
+        {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            m_queueReady.wait(lock, [this] { return m_stopping || !m_pending.empty(); });
+            if (m_stopping) return;
+            connection = std::move(m_pending.front());
+            m_pending.pop_front();
+            m_active.insert(connection.fd);
+        }
+
+        bool open = serveRequest(connection);
+
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_active.erase(connection.fd);
+        if (!open) {
+            ::close(connection.fd);
+        } else if (connection.buffer.find('\n') != std::string::npos) {
+            // more requests already read: back of the queue, behind the other clients
+            m_pending.push_back(std::move(connection));
+            m_queueReady.notify_one();
+        } else {
+            m_returned.push_back(std::move(connection));
+            char wake = 1;
+            if (::write(m_wakeFds[1], &wake, 1) < 0) {}  // a full pipe already wakes serve()
+        }
+    }
+}
+
+// one turn of a worker: read what the client sent if there isn't a whole request buffered
+// yet, then answer at most one. false once the connection should be closed
+bool QueryServer::serveRequest(Connection& connection) {
+    std::string& buffer = connection.buffer;
+    std::size_t end = buffer.find('\n');
+
+    if (end == std::string::npos) {
+        char chunk[65536];
+        ssize_t n;
+        do {
+            n = ::recv(connection.fd, chunk, sizeof(chunk), MSG_DONTWAIT);
+        } while (n < 0 && errno == EINTR);
+        if (n == 0) return false;
+        if (n < 0) return errno == EAGAIN || errno == EWOULDBLOCK;
+        buffer.append(chunk, static_cast<std::size_t>(n));
+
+        end = buffer.find('\n');
+        if (end == std::string::npos) {
+            if (buffer.size() > MAX_REQUEST_BYTES) {
+                sendAll(connection.fd, "{\"ok\":false,\"error\":\"request too large\"}\n");
+                return false;
+            }
+            return true;
+        }
+    }
+
+    std::string line = buffer.substr(0, end);
+    buffer.erase(0, end + 1);
+    if (line.find_first_not_of(" \t\r") == std::string::npos) return true;
+    return sendAll(connection.fd, handle(line) + '\n');
+}
+
+void QueryServer::shutdownWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        for (int fd : m_active) ::shutdown(fd, SHUT_RDWR);  // wakes workers blocked in send
+    }
+    m_queueReady.notify_all();
+
+    for (auto& worker : m_workers) {
+        if (worker.joinable()) worker.join();
+    }
+    m_workers.clear();
+
+    for (const Connection& connection : m_pending) ::close(connection.fd);
+    for (const Connection& connection : m_returned) ::close(connection.fd);
+    for (const Connection& connection : m_idle) ::close(connection.fd);
+    m_pending.clear();
+    m_returned.clear();
+    m_idle.clear();
+
+    for (int& fd : m_wakeFds) {
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+    }
+    if (m_listenFd >= 0) {
+        ::close(m_listenFd);
+        m_listenFd = -1;
+        ::unlink(m_options.socketPath.c_str());
+    }
+}
@@ -0,0 +1,103 @@
+#ifndef QUERY_SERVER_H
+#define QUERY_SERVER_H
+
+#include "InsightCache.h"
+#include "InsightGenerator.h"
+#include "InsightStore.h"
+#include "PersonRepository.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+struct ServerOptions {
+    std::string socketPath = "decoderscpp.sock";
+    std::size_t workers = 0;                 // 0 = one per hardware thread
+    std::string dataset;                     // CSV loaded before the first request (optional)
+    std::string usefulFile = "insights_saved.csv";
+    std::string blockedFile = "blocked_keys.txt";
+    bool diskCache = false;                  // keep cached results in <dataset>.cache/
+};
+
+/**
+ * `cli serve`: keeps one dataset in memory and answers requests on a Unix domain socket,
+ * so several analysts share a warm dataset instead of each loading their own.
+ *
+ * Protocol: one JSON object per line in, one JSON object per line out.
+ *   {"id":1,"cmd":"generate","limit":10}
+ *   -> {"id":1,"ok":true,"insights":[{...},...]}
+ * Commands: ping, info, load {path}, generate {limit}, generate-custom {x,y,limit},
+ * discover {all:true}, count {<attribute>:<value>...}, block {key}, unblock {key}.
+ * Errors come back as {"ok":false,"error":"..."}. Results go through an InsightCache,
+ * so repeated queries on the same data and blocklist are answered from memory.
+ *
+ * serve() watches idle connections with poll(); one with data goes to a worker pool for a
+ * single request and then comes back, so a few workers serve any number of persistent
+ * clients. Queries take a shared lock on the dataset/blocklist and run concurrently;
+ * load/block/unblock take it exclusively, so there is only ever one writer. A load reads
+ * the new file before taking the lock, so queries keep running against the old data meanwhile.
+ */
+class QueryServer {
+public:
+    explicit QueryServer(ServerOptions options);
+    ~QueryServer();
+
+    QueryServer(const QueryServer&) = delete;
+    QueryServer& operator=(const QueryServer&) = delete;
+
+    // answers one request line (without the trailing newline); safe to call from any thread
+    std::string handle(const std::string& request);
+
+    // binds the socket and starts the workers; false (with a message on stderr) if it can't
+    bool start();
+    // accepts connections until stop() is called
+    void serve();
+    // only sets a flag, so it can be called from a signal handler
+    void stop() { m_stopping = true; }
+
+    std::size_t workerCount() const { return m_workers.size(); }
+
+private:
+    ServerOptions m_options;
+
+    // the shared state; m_stateMutex is the reader/writer lock around all of it
+    mutable std::shared_mutex m_stateMutex;
+    PersonRepository m_repo;
+    InsightStore m_store;
+    InsightGenerator m_generator;
+    InsightCache m_cache{m_generator};    // has its own lock, shared by all workers
+    std::string m_datasetPath;
+    std::uint64_t m_datasetVersion = 0;   // bumped by every load
+    std::uint64_t m_datasetHash = 0;      // computed while loading, under the write lock
+
+    // a client and whatever it sent that isn't a whole request yet
+    struct Connection {
+        int fd = -1;
+        std::string buffer;
+    };
+
+    int m_listenFd = -1;
+    int m_wakeFds[2] = {-1, -1};          // a worker writes to [1] when it hands a connection back
+    std::atomic<bool> m_stopping{false};
+    std::mutex m_queueMutex;
+    std::condition_variable m_queueReady;
+    std::deque<Connection> m_pending;     // have data or a buffered request, waiting for a worker
+    std::vector<Connection> m_returned;   // answered, for serve() to watch again
+    std::vector<Connection> m_idle;       // watched by serve(), only touched on its thread
+    std::unordered_set<int> m_active;     // so stop can wake workers blocked in send
+    std::vector<std::thread> m_workers;
+
+    void workerLoop();
+    bool serveRequest(Connection& connection);
+    void shutdownWorkers();
+};
+
+#endif // QUERY_SERVER_H
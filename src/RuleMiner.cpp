@@ -0,0 +1,385 @@
+#include "RuleMiner.h"
+
+#include "AttributeRegistry.h"
+#include "Bits.h"
+#include "InsightGenerator.h"
+#include "Instrumentation.h"
+#include "Tracer.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+constexpr std::size_t MAX_RULE_LENGTH = 8;
+
+// out = a & b, returns the bits set in out
+std::size_t andCount(const std::uint64_t* a, const std::uint64_t* b, std::uint64_t* out, std::size_t words) {
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < words; ++i) {
+        out[i] = a[i] & b[i];
+        count += static_cast<std::size_t>(popcount64(out[i]));
+    }
+    return count;
+}
+
+struct Item {
+    Attribute attr = Attribute::Unknown;
+    std::uint32_t value = 0;
+    std::size_t support = 0;
+};
+
+std::uint64_t itemKey(Attribute attr, std::uint32_t value) {
+    return (static_cast<std::uint64_t>(attr) << 32) | value;
+}
+
+// item indices in ascending order (the order the search adds them in)
+struct Itemset {
+    std::array<std::uint32_t, MAX_RULE_LENGTH> items{};
+    std::size_t length = 0;
+    std::size_t support = 0;
+
+    bool operator==(const Itemset& other) const {
+        return length == other.length && std::equal(items.begin(), items.begin() + length, other.items.begin());
+    }
+};
+
+struct ItemsetHash {
+    std::size_t operator()(const Itemset& set) const {
+        std::uint64_t hash = 14695981039346656037ULL;
+        for (std::size_t i = 0; i < set.length; ++i) {
+            hash ^= set.items[i];
+            hash *= 1099511628211ULL;
+        }
+        return static_cast<std::size_t>(hash);
+    }
+};
+
+/**
+ * Depth-first Eclat below one prefix. A prefix is a bitmap while it's dense; once it holds
+ * fewer rows than the bitmap has words it becomes a row list, and extending it only looks up
+ * those rows' bits. The path's bitmaps and row lists are kept per depth, so the search stops
+ * allocating once it has warmed up.
+ */
+class EclatSearch {
+public:
+    EclatSearch(const std::vector<Item>& items, const std::vector<std::uint64_t>& bitmaps,
+                std::size_t words, std::size_t minCount, std::size_t maxLength)
+        : m_items(items), m_bitmaps(bitmaps), m_words(words), m_minCount(minCount), m_maxLength(maxLength),
+          m_bits(maxLength * words), m_rows(maxLength) {}
+
+    // every frequent itemset that starts with item `first`, the item itself excluded
+    void run(std::uint32_t first, std::vector<Itemset>& out) {
+        Itemset prefix;
+        prefix.items[0] = first;
+        prefix.length = 1;
+        extend(bitmapOf(first), nullptr, prefix, first + 1, out);
+    }
+
+private:
+    const std::vector<Item>& m_items;
+    const std::vector<std::uint64_t>& m_bitmaps;
+    std::size_t m_words;
+    std::size_t m_minCount;
+    std::size_t m_maxLength;
+    std::vector<std::uint64_t> m_bits;
+    std::vector<std::vector<std::uint32_t>> m_rows;
+
+    const std::uint64_t* bitmapOf(std::uint32_t item) const { return m_bitmaps.data() + item * m_words; }
+
+    // two values of a single-valued attribute never hold for the same person
+    bool excludes(const Itemset& prefix, std::uint32_t item) const {
+        Attribute attr = m_items[item].attr;
+        if (is_tag_attribute(attr)) {
+            return false;
+        }
+        for (std::size_t i = 0; i < prefix.length; ++i) {
+            if (m_items[prefix.items[i]].attr == attr) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // the prefix is either prefixBits or, when sparse, prefixRows
+    void extend(const std::uint64_t* prefixBits, const std::vector<std::uint32_t>* prefixRows,
+                Itemset& prefix, std::uint32_t from, std::vector<Itemset>& out) {
+        const std::size_t depth = prefix.length - 1;
+        std::uint64_t* bits = m_bits.data() + depth * m_words;
+        std::vector<std::uint32_t>& rows = m_rows[depth];
+
+        for (std::uint32_t next = from; next < m_items.size(); ++next) {
+            if (excludes(prefix, next)) {
+                continue;
+            }
+
+            std::size_t support = 0;
+            if (prefixRows) {
+                const std::uint64_t* itemBits = bitmapOf(next);
+                rows.clear();
+                for (std::uint32_t row : *prefixRows) {
+                    if ((itemBits[row / 64] >> (row % 64)) & 1u) {
+                        rows.push_back(row);
+                    }
+                }
+                support = rows.size();
+            } else {
+                support = andCount(prefixBits, bitmapOf(next), bits, m_words);
+            }
+            if (support < m_minCount) {
+                continue;
+            }
+
+            prefix.items[prefix.length++] = next;
+            prefix.support = support;
+            out.push_back(prefix);
+            if (prefix.length < m_maxLength) {
+                if (prefixRows) {
+                    extend(nullptr, &rows, prefix, next + 1, out);
+                } else if (support < m_words) {
+                    toRows(bits, rows);
+                    extend(nullptr, &rows, prefix, next + 1, out);
+                } else {
+                    extend(bits, nullptr, prefix, next + 1, out);
+                }
+            }
+            --prefix.length;
+        }
+    }
+
+    void toRows(const std::uint64_t* bits, std::vector<std::uint32_t>& rows) const {
+        rows.clear();
+        for (std::size_t w = 0; w < m_words; ++w) {
+            for (std::uint64_t word = bits[w]; word != 0; word &= word - 1) {
+                rows.push_back(static_cast<std::uint32_t>(w * 64 + lowest_bit(word)));
+            }
+        }
+    }
+};
+
+}
+
+RuleMiner::RuleMiner(RuleOptions options) : m_options(std::move(options)) {
+    if (!(m_options.minSupport > 0.0) || m_options.minSupport > 1.0) {
+        throw std::invalid_argument("Rule support must be between 0 and 1");
+    }
+    if (m_options.minConfidence < 0.0 || m_options.minConfidence > 1.0) {
+        throw std::invalid_argument("Rule confidence must be between 0 and 1");
+    }
+    if (m_options.maxLength < 2 || m_options.maxLength > MAX_RULE_LENGTH) {
+        throw std::invalid_argument("Rule length must be between 2 and " + std::to_string(MAX_RULE_LENGTH));
+    }
+    for (Attribute attr : m_options.attributes) {
+        if (!attribute_info(attr)) {
+            throw std::invalid_argument("Rules can't be mined over an unknown attribute");
+        }
+    }
+}
+
+MinedRules RuleMiner::mine(const std::vector<Person>& persons,
+                           const FingerprintSet& suppressed,
+                           std::size_t limit) const {
+    MinedRules result;
+    const std::size_t n = persons.size();
+    if (n == 0) {
+        return result;
+    }
+
+    std::vector<Attribute> attributes = m_options.attributes;
+    if (attributes.empty()) {
+        for (const AttributeInfo& info : attribute_registry()) {
+            attributes.push_back(info.attr);
+        }
+    }
+
+    // at least 2 people, like the pair generators
+    const std::size_t minCount = std::max<std::size_t>(
+        2, static_cast<std::size_t>(std::ceil(m_options.minSupport * static_cast<double>(n))));
+
+    auto pool = std::make_shared<InsightValuePool>();
+    std::vector<Item> items;
+    std::vector<std::uint64_t> bitmaps;
+    const std::size_t words = (n + 63) / 64;
+
+    {
+        instr::ScopedTimer timer("mine.items");
+        timer.addRows(n);
+
+        // one pass: the rows of every item (the vertical layout, as lists for now since
+        // most tag values will turn out to be infrequent)
+        std::unordered_map<std::uint64_t, std::vector<std::uint32_t>> rowsOf;
+        std::vector<ValueExtractor> extractors;
+        for (Attribute attr : attributes) {
+            extractors.push_back(value_extractor(attr));
+        }
+        std::vector<std::uint32_t> values;
+        for (std::size_t row = 0; row < n; ++row) {
+            for (std::size_t a = 0; a < attributes.size(); ++a) {
+                extractors[a](persons[row], *pool, values);
+                for (std::uint32_t value : values) {
+                    rowsOf[itemKey(attributes[a], value)].push_back(static_cast<std::uint32_t>(row));
+                }
+            }
+        }
+
+        // the frequent ones, least frequent first: every item is only extended by the ones
+        // after it, so the long extension lists hang off the rarest prefixes, which die out soonest
+        for (const auto& [key, rows] : rowsOf) {
+            if (rows.size() >= minCount) {
+                items.push_back({static_cast<Attribute>(key >> 32), static_cast<std::uint32_t>(key), rows.size()});
+            }
+        }
+        std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) {
+            if (a.support != b.support) return a.support < b.support;
+            return itemKey(a.attr, a.value) < itemKey(b.attr, b.value);
+        });
+
+        // a bitmap per frequent item
+        bitmaps.assign(items.size() * words, 0);
+        for (std::size_t i = 0; i < items.size(); ++i) {
+            std::uint64_t* bits = bitmaps.data() + i * words;
+            for (std::uint32_t row : rowsOf[itemKey(items[i].attr, items[i].value)]) {
+                bits[row / 64] |= std::uint64_t{1} << (row % 64);
+            }
+        }
+    }
+
+    result.frequentItems = items.size();
+    if (items.size() < 2) {
+        result.frequentItemsets = items.size();
+        return result;
+    }
+
+    // the search under each first item is independent; threads take the next one as they free up
+    std::vector<std::vector<Itemset>> found(items.size());
+    {
+        instr::ScopedTimer timer("mine.itemsets");
+        trace::Span span("mine.itemsets");
+
+        unsigned threads = m_options.threads != 0 ? m_options.threads : std::max(1u, std::thread::hardware_concurrency());
+        threads = static_cast<unsigned>(std::min<std::size_t>(threads, items.size()));
+
+        std::atomic<std::uint32_t> nextFirst{0};
+        auto worker = [&] {
+            EclatSearch search(items, bitmaps, words, minCount, m_options.maxLength);
+            for (std::uint32_t first = nextFirst++; first < items.size(); first = nextFirst++) {
+                trace::Span prefix("mine.prefix");
+                search.run(first, found[first]);
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < threads; ++t) {
+            workers.emplace_back(worker);
+        }
+        worker();
+        for (std::thread& t : workers) {
+            t.join();
+        }
+    }
+
+    instr::ScopedTimer timer("mine.rules");
+
+    std::unordered_map<Itemset, std::size_t, ItemsetHash> supportOf;
+    for (std::uint32_t i = 0; i < items.size(); ++i) {
+        Itemset single;
+        single.items[0] = i;
+        single.length = 1;
+        supportOf.emplace(single, items[i].support);
+    }
+    for (const auto& sets : found) {
+        for (const Itemset& set : sets) {
+            supportOf.emplace(set, set.support);
+        }
+    }
+    result.frequentItemsets = supportOf.size();
+
+    // antecedent terms in a fixed order (attribute, then value text for tags) so a rule
+    // always gets the same key, whatever the item supports were
+    auto termLess = [&](std::uint32_t a, std::uint32_t b) {
+        const Item& x = items[a];
+        const Item& y = items[b];
+        if (x.attr != y.attr) return x.attr < y.attr;
+        if (is_tag_attribute(x.attr)) return pool->text(x.value) < pool->text(y.value);
+        return x.value < y.value;
+    };
+
+    std::vector<std::size_t> consequentSupport;   // per rule, for scoring
+    for (const auto& sets : found) {
+        for (const Itemset& set : sets) {
+            // each item in turn on the right-hand side
+            for (std::size_t k = 0; k < set.length; ++k) {
+                Itemset antecedent;
+                for (std::size_t i = 0; i < set.length; ++i) {
+                    if (i != k) antecedent.items[antecedent.length++] = set.items[i];
+                }
+                std::size_t cohort = supportOf.find(antecedent)->second;
+
+                double confidence = static_cast<double>(set.support) / static_cast<double>(cohort);
+                if (confidence < m_options.minConfidence) {
+                    continue;
+                }
+                const Item& consequent = items[set.items[k]];
+                double lift = confidence * static_cast<double>(n) / static_cast<double>(consequent.support);
+                if (lift < m_options.minLift) {
+                    continue;
+                }
+
+                std::sort(antecedent.items.begin(), antecedent.items.begin() + antecedent.length, termLess);
+
+                Insight rule;
+                rule.kind = InsightKind::Rule;
+                rule.attrX = items[antecedent.items[0]].attr;
+                rule.valueX = items[antecedent.items[0]].value;
+                for (std::size_t i = 1; i < antecedent.length; ++i) {
+                    rule.moreX.push_back({items[antecedent.items[i]].attr, items[antecedent.items[i]].value});
+                }
+                rule.attrY = consequent.attr;
+                rule.valueY = consequent.value;
+                rule.values = pool;
+
+                if (!suppressed.empty() && suppressed.contains(rule.fingerprint())) {
+                    continue;
+                }
+
+                rule.support = set.support;
+                rule.population = cohort;
+                rule.lift = lift;
+                result.rules.push_back(std::move(rule));
+                consequentSupport.push_back(consequent.support);
+            }
+        }
+    }
+
+    const std::size_t ruleCount = result.rules.size();
+    std::vector<std::size_t> support(ruleCount), cohort(ruleCount);
+    for (std::size_t i = 0; i < ruleCount; ++i) {
+        support[i] = result.rules[i].support;
+        cohort[i] = result.rules[i].population;
+    }
+    std::vector<int> scores(ruleCount);
+    score_cells(m_options.scoring, support.data(), cohort.data(), consequentSupport.data(), ruleCount, n, scores.data());
+    for (std::size_t i = 0; i < ruleCount; ++i) {
+        result.rules[i].score = scores[i];
+    }
+
+    auto better = [](const Insight& a, const Insight& b) {
+        if (a.score != b.score) return a.score > b.score;
+        if (a.lift != b.lift) return a.lift > b.lift;
+        return a.support > b.support;
+    };
+    if (limit != 0 && limit < result.rules.size()) {
+        std::partial_sort(result.rules.begin(), result.rules.begin() + static_cast<std::ptrdiff_t>(limit),
+                          result.rules.end(), better);
+        result.rules.resize(limit);
+    } else {
+        std::stable_sort(result.rules.begin(), result.rules.end(), better);
+    }
+    return result;
+}
@@ -0,0 +1,57 @@
+#ifndef RULE_MINER_H
+#define RULE_MINER_H
+
+#include "Attribute.h"
+#include "FingerprintSet.h"
+#include "Insight.h"
+#include "Person.h"
+#include "Scoring.h"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Settings for RuleMiner. An item is one attribute = value (a tag counts as its own item),
+ * an itemset is a set of items that hold for the same person.
+ */
+struct RuleOptions {
+    double minSupport = 0.01;        // share of everyone an itemset (antecedent + consequent) has to cover
+    double minConfidence = 0.50;     // same threshold as the pair generators
+    double minLift = 1.2;            // 1 = no better than chance
+    std::size_t maxLength = 3;       // items per rule, antecedent + consequent (2..8)
+    std::vector<Attribute> attributes;   // empty = all of them
+    unsigned threads = 0;            // 0 = one per core
+    ScoringMode scoring = ScoringMode::Confidence;   // what Insight::score (and so the ranking) is
+};
+
+struct MinedRules {
+    std::vector<Insight> rules;      // InsightKind::Rule, best score first
+    std::size_t frequentItems = 0;
+    std::size_t frequentItemsets = 0;   // of every length, single items included
+};
+
+/**
+ * Association rules across all attributes at once, e.g.
+ * "os = linux & study = night -> hobby = gaming", with support, confidence and lift.
+ *
+ * Frequent itemsets come from Eclat over vertical bitmaps: one bit per person per frequent item,
+ * an itemset's support is the popcount of its items' bitmaps ANDed together, so extending a
+ * prefix costs n/64 word operations and never touches the Person records again (prefixes rarer
+ * than that switch to a list of their rows). The search under each single item is independent
+ * and the threads take those one at a time. Rules have one item on the right-hand side; the
+ * blocklist is applied to them like to any other insight.
+ */
+class RuleMiner {
+public:
+    explicit RuleMiner(RuleOptions options);
+
+    // throws std::invalid_argument for options out of range
+    MinedRules mine(const std::vector<Person>& persons,
+                    const FingerprintSet& suppressed,
+                    std::size_t limit = 0) const;
+
+private:
+    RuleOptions m_options;
+};
+
+#endif // RULE_MINER_H
@@ -0,0 +1,199 @@
+#include "Sampling.h"
+#include "AttributeRegistry.h"
+#include "Instrumentation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+
+ConfidenceInterval wilson_interval(std::size_t successes, std::size_t trials, double z) {
+    if (trials == 0) {
+        return {0.0, 1.0};
+    }
+    const double n = static_cast<double>(trials);
+    const double p = static_cast<double>(successes) / n;
+    const double z2 = z * z;
+    const double denom = 1.0 + z2 / n;
+    const double center = (p + z2 / (2.0 * n)) / denom;
+    const double half = z * std::sqrt(p * (1.0 - p) / n + z2 / (4.0 * n * n)) / denom;
+    return {std::max(0.0, center - half), std::min(1.0, center + half)};
+}
+
+std::size_t sample_size_for_margin(double margin, double z) {
+    if (!(margin > 0.0) || margin >= 1.0) {
+        throw std::invalid_argument("Sampling margin must be between 0 and 1");
+    }
+    return static_cast<std::size_t>(std::ceil(z * z * 0.25 / (margin * margin)));
+}
+
+double margin_for_sample_size(std::size_t rows, double z) {
+    if (rows == 0) {
+        return 1.0;
+    }
+    return z * 0.5 / std::sqrt(static_cast<double>(rows));
+}
+
+std::size_t SampleOptions::rowsFor(std::size_t population) const {
+    std::size_t rows = size != 0 ? size : sample_size_for_margin(margin);
+    return std::min(rows, population);
+}
+
+// ------------------------------------------------------------
+// Reservoir (Algorithm L)
+// ------------------------------------------------------------
+
+Reservoir::Reservoir(std::size_t capacity, std::uint64_t seed)
+    : m_capacity(capacity), m_state(seed) {
+    m_items.reserve(capacity);
+    if (capacity == 0) {
+        m_next = std::numeric_limits<std::size_t>::max();
+    }
+}
+
+// splitmix64, mapped to (0, 1) so the logs below stay finite
+double Reservoir::uniform() {
+    std::uint64_t z = (m_state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    return (static_cast<double>(z >> 11) + 0.5) * 0x1.0p-53;
+}
+
+void Reservoir::take(std::size_t item) {
+    if (m_items.size() < m_capacity) {
+        // filling up: every position is kept; once full, skipAhead jumps from the last one
+        m_items.push_back(item);
+        if (m_items.size() < m_capacity) {
+            m_next = m_items.size();
+        } else {
+            m_w = std::exp(std::log(uniform()) / static_cast<double>(m_capacity));
+            skipAhead();
+        }
+        return;
+    }
+    std::size_t slot = static_cast<std::size_t>(uniform() * static_cast<double>(m_capacity));
+    m_items[std::min(slot, m_capacity - 1)] = item;
+    m_w *= std::exp(std::log(uniform()) / static_cast<double>(m_capacity));
+    skipAhead();
+}
+
+void Reservoir::skipAhead() {
+    // geometric jump to the next position that replaces something
+    double skip = std::floor(std::log(uniform()) / std::log1p(-m_w));
+    const double room = static_cast<double>(std::numeric_limits<std::size_t>::max() - m_next);
+    if (!(skip < room - 1.0)) {
+        m_next = std::numeric_limits<std::size_t>::max();
+        return;
+    }
+    m_next += static_cast<std::size_t>(skip) + 1;
+}
+
+std::vector<std::size_t> Reservoir::sorted() const {
+    std::vector<std::size_t> items = m_items;
+    std::sort(items.begin(), items.end());
+    return items;
+}
+
+// ------------------------------------------------------------
+// Samples
+// ------------------------------------------------------------
+
+std::vector<std::size_t> reservoir_sample(std::size_t n, std::size_t k, std::uint64_t seed) {
+    Reservoir reservoir(std::min(n, k), seed);
+    // positions are row numbers, so skipped rows are never visited
+    for (std::size_t i = reservoir.next(); i < n; i = reservoir.next()) {
+        reservoir.take(i);
+    }
+    return reservoir.sorted();
+}
+
+std::vector<std::size_t> stratified_sample(const std::vector<Person>& persons, Attribute by,
+                                           std::size_t k, std::uint64_t seed) {
+    CodeReader stratumOf = code_reader(by);
+    if (!stratumOf) {
+        throw std::invalid_argument("Can only stratify by a single-valued attribute, not " +
+                                    to_string(by));
+    }
+
+    const std::size_t n = persons.size();
+    if (k >= n) {
+        std::vector<std::size_t> all(n);
+        for (std::size_t i = 0; i < n; ++i) all[i] = i;
+        return all;
+    }
+
+    // pass 1: stratum sizes (ordered, so the allocation below is deterministic)
+    std::map<std::uint32_t, std::size_t> sizes;
+    for (const Person& p : persons) {
+        ++sizes[stratumOf(p)];
+    }
+
+    // proportional shares rounded down, every stratum gets at least one row,
+    // the rest goes to the largest remainders
+    struct Stratum {
+        std::size_t share = 0;
+        std::size_t position = 0;   // rows of this stratum seen in pass 2
+        std::unique_ptr<Reservoir> reservoir;
+    };
+    std::unordered_map<std::uint32_t, Stratum> strata;
+    std::vector<std::pair<double, std::uint32_t>> byRemainder;
+    std::size_t allocated = 0;
+    for (const auto& [value, size] : sizes) {
+        double exact = static_cast<double>(k) * static_cast<double>(size) / static_cast<double>(n);
+        Stratum& s = strata[value];
+        s.share = std::max<std::size_t>(1, static_cast<std::size_t>(exact));
+        allocated += s.share;
+        byRemainder.emplace_back(exact - std::floor(exact), value);
+    }
+    std::stable_sort(byRemainder.begin(), byRemainder.end(),
+                     [](const auto& a, const auto& b) { return a.first > b.first; });
+    for (std::size_t i = 0; allocated < k && i < byRemainder.size(); ++i) {
+        Stratum& s = strata[byRemainder[i].second];
+        if (s.share < sizes[byRemainder[i].second]) {
+            ++s.share;
+            ++allocated;
+        }
+    }
+    for (auto& [value, s] : strata) {
+        s.reservoir = std::make_unique<Reservoir>(s.share, seed ^ (0x9E3779B97F4A7C15ull * (std::uint64_t{value} + 1)));
+    }
+
+    // pass 2: one reservoir per stratum
+    for (std::size_t i = 0; i < n; ++i) {
+        Stratum& s = strata.find(stratumOf(persons[i]))->second;
+        if (s.position == s.reservoir->next()) {
+            s.reservoir->take(i);
+        }
+        ++s.position;
+    }
+
+    std::vector<std::size_t> rows;
+    rows.reserve(allocated);
+    for (const auto& [value, s] : strata) {
+        auto kept = s.reservoir->sorted();
+        rows.insert(rows.end(), kept.begin(), kept.end());
+    }
+    std::sort(rows.begin(), rows.end());
+    return rows;
+}
+
+std::vector<Person> draw_sample(const std::vector<Person>& persons, const SampleOptions& options) {
+    instr::ScopedTimer timer("sample.draw");
+    timer.addRows(persons.size());
+
+    const std::size_t k = options.rowsFor(persons.size());
+    std::vector<std::size_t> rows = options.stratifyBy == Attribute::Unknown
+        ? reservoir_sample(persons.size(), k, options.seed)
+        : stratified_sample(persons, options.stratifyBy, k, options.seed);
+
+    std::vector<Person> sample;
+    sample.reserve(rows.size());
+    for (std::size_t row : rows) {
+        sample.push_back(persons[row]);
+    }
+    return sample;
+}
@@ -0,0 +1,82 @@
+#ifndef SAMPLING_H
+#define SAMPLING_H
+
+#include "Attribute.h"
+#include "Person.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Building blocks for the approximate (sampled) insight mode: uniform and stratified
+ * reservoir samples of a dataset and Wilson score intervals for the proportions measured
+ * on them.
+ */
+
+struct ConfidenceInterval {
+    double low = 0.0;
+    double high = 0.0;
+
+    bool contains(double value) const { return low <= value && value <= high; }
+};
+
+// Wilson score interval of successes/trials; z = 1.96 is 95%. Unlike the normal
+// approximation it stays inside [0, 1] and behaves for small cohorts and p near 0 or 1.
+ConfidenceInterval wilson_interval(std::size_t successes, std::size_t trials, double z = 1.96);
+
+// rows needed so a proportion's interval is at most +-margin wide (worst case p = 0.5)
+std::size_t sample_size_for_margin(double margin, double z = 1.96);
+
+// worst case half-width of a proportion's interval on `rows` rows (inverse of the above)
+double margin_for_sample_size(std::size_t rows, double z = 1.96);
+
+struct SampleOptions {
+    std::size_t size = 0;                      // rows to sample; 0 = derive from margin
+    double margin = 0.01;                      // target +-half-width of a proportion over the whole sample
+    Attribute stratifyBy = Attribute::Unknown; // Unknown = uniform; otherwise a single-valued attribute
+    std::uint64_t seed = 0x5eed;               // same seed + same data = same sample
+
+    // the number of rows that will be drawn out of `population`
+    std::size_t rowsFor(std::size_t population) const;
+};
+
+/**
+ * Reservoir sampling with Vitter/Li's Algorithm L: keeps a uniform sample of `capacity`
+ * items of a stream and, once full, jumps straight to the next item it will keep, so
+ * skipped items cost nothing. next() is the stream position that will be kept next;
+ * feed that item with take().
+ */
+class Reservoir {
+public:
+    Reservoir(std::size_t capacity, std::uint64_t seed);
+
+    std::size_t next() const { return m_next; }
+    void take(std::size_t item);
+
+    // the kept items in ascending order
+    std::vector<std::size_t> sorted() const;
+
+private:
+    std::size_t m_capacity;
+    std::vector<std::size_t> m_items;
+    std::size_t m_next = 0;
+    double m_w = 1.0;
+    std::uint64_t m_state;
+
+    double uniform();   // (0, 1)
+    void skipAhead();
+};
+
+// ascending indices of a uniform sample of min(k, n) out of n rows
+std::vector<std::size_t> reservoir_sample(std::size_t n, std::size_t k, std::uint64_t seed);
+
+// proportional stratified sample: every value of `by` gets its share of k (at least one row),
+// drawn uniformly within. Throws std::invalid_argument for tag attributes (color, hobby, language).
+std::vector<std::size_t> stratified_sample(const std::vector<Person>& persons, Attribute by,
+                                           std::size_t k, std::uint64_t seed);
+
+// the sampled rows themselves, per `options`
+std::vector<Person> draw_sample(const std::vector<Person>& persons, const SampleOptions& options);
+
+#endif // SAMPLING_H
@@ -0,0 +1,150 @@
+#include "Scoring.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+constexpr double BAYES_PSEUDO_COUNT = 20.0;
+constexpr double PI = 3.14159265358979323846;
+
+int clampScore(double raw) {
+    if (!(raw > 0.0)) {
+        return 0;
+    }
+    if (raw > 100.0) {
+        return 100;
+    }
+    return static_cast<int>(std::round(raw));
+}
+
+// -log10 of the upper tail of chi-square with 1 degree of freedom
+double minusLog10P(double chi2) {
+    if (!(chi2 > 0.0)) {
+        return 0.0;
+    }
+    double x = std::sqrt(chi2 / 2.0);
+    double p = std::erfc(x);
+    if (p > 1e-300) {
+        return -std::log10(p);
+    }
+    // erfc underflows out here; erfc(x) ~ exp(-x^2) / (x sqrt(pi))
+    return (x * x + std::log(x * std::sqrt(PI))) / std::log(10.0);
+}
+
+// o * ln(o / e), 0 when nothing was observed
+double gTerm(double observed, double expected) {
+    return observed > 0.0 ? observed * std::log(observed / expected) : 0.0;
+}
+
+}
+
+ScoringMode parse_scoring_mode(const std::string& text) {
+    std::string s = text;
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    if (s == "confidence" || s == "default") return ScoringMode::Confidence;
+    if (s == "lift") return ScoringMode::Lift;
+    if (s == "leverage") return ScoringMode::Leverage;
+    if (s == "chi2" || s == "chisquare" || s == "chi-square") return ScoringMode::ChiSquare;
+    if (s == "g" || s == "gtest" || s == "g-test") return ScoringMode::GTest;
+    if (s == "bayes" || s == "bayesian") return ScoringMode::Bayesian;
+    throw std::invalid_argument("Unknown scoring mode: " + text);
+}
+
+std::string to_string(ScoringMode mode) {
+    switch (mode) {
+        case ScoringMode::Confidence: return "confidence";
+        case ScoringMode::Lift:       return "lift";
+        case ScoringMode::Leverage:   return "leverage";
+        case ScoringMode::ChiSquare:  return "chi2";
+        case ScoringMode::GTest:      return "gtest";
+        case ScoringMode::Bayesian:   return "bayes";
+    }
+    return "confidence";
+}
+
+void score_cells(ScoringMode mode,
+                 const std::size_t* support,
+                 const std::size_t* cohort,
+                 const std::size_t* yTotal,
+                 std::size_t count,
+                 std::size_t population,
+                 int* scores) {
+    if (population == 0) {
+        std::fill(scores, scores + count, 0);
+        return;
+    }
+    const double n = static_cast<double>(population);
+
+    switch (mode) {
+        case ScoringMode::Confidence:
+        case ScoringMode::Bayesian:
+            for (std::size_t i = 0; i < count; ++i) {
+                double a = static_cast<double>(support[i]);
+                double x = static_cast<double>(cohort[i]);
+                double confidence = x > 0.0 ? a / x : 0.0;
+                if (mode == ScoringMode::Bayesian) {
+                    double prior = static_cast<double>(yTotal[i]) / n;
+                    confidence = (a + BAYES_PSEUDO_COUNT * prior) / (x + BAYES_PSEUDO_COUNT);
+                }
+                scores[i] = a > 0.0 && x > 0.0 ? clampScore((confidence * 0.7 + a / n * 0.3) * 100.0) : 0;
+            }
+            break;
+
+        case ScoringMode::Lift:
+            for (std::size_t i = 0; i < count; ++i) {
+                double expected = static_cast<double>(cohort[i]) * static_cast<double>(yTotal[i]) / n;
+                double lift = expected > 0.0 ? static_cast<double>(support[i]) / expected : 0.0;
+                scores[i] = lift > 0.0 ? clampScore((1.0 - 1.0 / lift) * 100.0) : 0;
+            }
+            break;
+
+        case ScoringMode::Leverage:
+            for (std::size_t i = 0; i < count; ++i) {
+                double leverage = static_cast<double>(support[i]) / n -
+                                  (static_cast<double>(cohort[i]) / n) * (static_cast<double>(yTotal[i]) / n);
+                scores[i] = clampScore(leverage * 400.0);
+            }
+            break;
+
+        case ScoringMode::ChiSquare:
+        case ScoringMode::GTest:
+            for (std::size_t i = 0; i < count; ++i) {
+                // the four cells: X and Y, X not Y, Y not X, neither
+                double a = static_cast<double>(support[i]);
+                double rowX = static_cast<double>(cohort[i]);
+                double colY = static_cast<double>(yTotal[i]);
+                double b = rowX - a;
+                double c = colY - a;
+                double d = n - rowX - colY + a;
+                double ea = rowX * colY / n;
+                double eb = rowX * (n - colY) / n;
+                double ec = (n - rowX) * colY / n;
+                double ed = (n - rowX) * (n - colY) / n;
+                if (!(ea > 0.0 && eb > 0.0 && ec > 0.0 && ed > 0.0) || a <= ea) {
+                    scores[i] = 0;   // a margin is empty, or X makes Y no more likely
+                    continue;
+                }
+
+                double statistic = 0.0;
+                if (mode == ScoringMode::ChiSquare) {
+                    statistic = (a - ea) * (a - ea) / ea + (b - eb) * (b - eb) / eb +
+                                (c - ec) * (c - ec) / ec + (d - ed) * (d - ed) / ed;
+                } else {
+                    statistic = 2.0 * (gTerm(a, ea) + gTerm(b, eb) + gTerm(c, ec) + gTerm(d, ed));
+                }
+                scores[i] = clampScore(minusLog10P(statistic));
+            }
+            break;
+    }
+}
+
+int score_cell(ScoringMode mode, std::size_t support, std::size_t cohort,
+               std::size_t yTotal, std::size_t population) {
+    int score = 0;
+    score_cells(mode, &support, &cohort, &yTotal, 1, population, &score);
+    return score;
+}
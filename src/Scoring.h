@@ -0,0 +1,42 @@
+#ifndef SCORING_H
+#define SCORING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * How an insight's 0-100 score is worked out from its 2x2 contingency table
+ * (people with X and Y, with X, with Y, everyone counted). The counting pass already
+ * has all four numbers, so every mode costs the same and no mode needs the data again.
+ */
+enum class ScoringMode : std::uint8_t {
+    Confidence,   // 70% confidence + 30% coverage, what generate has always ranked by
+    Lift,         // confidence / share of everyone with Y: 1x scores 0, 2x 50, 5x 80
+    Leverage,     // P(X and Y) - P(X)P(Y), x400 (the most it can be is 0.25)
+    ChiSquare,    // -log10 p of Pearson's chi-square test (1 df), positive associations only
+    GTest,        // -log10 p of the G-test (likelihood ratio), positive associations only
+    Bayesian      // Confidence, with the cohort's confidence shrunk towards P(Y) by 20 pseudo-people
+};
+
+// "confidence", "lift", "leverage", "chi2"/"chisquare", "g"/"gtest", "bayes"/"bayesian";
+// throws std::invalid_argument for anything else
+ScoringMode parse_scoring_mode(const std::string& text);
+std::string to_string(ScoringMode mode);
+
+/**
+ * Scores `count` tables at once. The counts come in as columns (support[i], cohort[i], yTotal[i]
+ * belong to table i, all out of `population`) and each mode is one straight loop over them.
+ */
+void score_cells(ScoringMode mode,
+                 const std::size_t* support,
+                 const std::size_t* cohort,
+                 const std::size_t* yTotal,
+                 std::size_t count,
+                 std::size_t population,
+                 int* scores);
+
+int score_cell(ScoringMode mode, std::size_t support, std::size_t cohort,
+               std::size_t yTotal, std::size_t population);
+
+#endif // SCORING_H
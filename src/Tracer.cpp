@@ -0,0 +1,306 @@
+#include "Tracer.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#if DECODERSCPP_INSTRUMENTATION
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#endif
+
+namespace trace {
+
+std::uint64_t now() {
+    static const auto epoch = std::chrono::steady_clock::now();
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - epoch).count());
+}
+
+#if DECODERSCPP_INSTRUMENTATION
+
+namespace {
+
+constexpr std::size_t RING_SIZE = 1 << 14;   // spans kept per thread
+constexpr std::size_t TEXT_WORDS = 6;          // 48 chars
+
+struct Event {
+    char name[48];
+    std::uint64_t start;
+    std::uint64_t end;
+    char detail[48];
+};
+
+// one ring entry, stored as relaxed atomic words so the writer can read it while its thread
+// overwrites it; `seq` is 0 while a record is half written and slot + 1 once it's whole
+struct Slot {
+    std::atomic<std::uint64_t> seq{0};
+    std::atomic<std::uint64_t> name[TEXT_WORDS];
+    std::atomic<std::uint64_t> start;
+    std::atomic<std::uint64_t> end;
+    std::atomic<std::uint64_t> detail[TEXT_WORDS];
+};
+
+// written only by the thread that holds it; `head` is published with release
+struct ThreadBuffer {
+    std::uint32_t tid = 0;
+    std::atomic<std::uint64_t> head{0};
+    std::unique_ptr<Slot[]> slots{new Slot[RING_SIZE]};
+};
+
+struct Registry {
+    std::mutex mutex;   // only taken when a thread records its first span, at thread exit, and when writing
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::vector<ThreadBuffer*> idle;   // buffers whose thread has exited, reused by the next new thread
+    std::string exitPath;
+};
+
+std::atomic<bool> g_active{false};
+
+Registry& registry() {
+    static Registry* r = new Registry;   // leaked so the atexit writer can still use it
+    return *r;
+}
+
+// hands the buffer back when its thread exits, so threads that come and go (every
+// PersonIndex::run and mining pass starts some) share a bounded set of buffers; the
+// spans already in it stay until they're overwritten
+struct BufferLease {
+    ThreadBuffer* buffer = nullptr;
+
+    ~BufferLease() {
+        if (buffer) {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            r.idle.push_back(buffer);
+        }
+    }
+};
+
+ThreadBuffer& threadBuffer() {
+    thread_local BufferLease lease;
+    if (!lease.buffer) {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        if (!r.idle.empty()) {
+            lease.buffer = r.idle.back();
+            r.idle.pop_back();
+        } else {
+            r.buffers.push_back(std::make_unique<ThreadBuffer>());
+            lease.buffer = r.buffers.back().get();
+            lease.buffer->tid = static_cast<std::uint32_t>(r.buffers.size());
+        }
+    }
+    return *lease.buffer;
+}
+
+void storeText(std::atomic<std::uint64_t> (&out)[TEXT_WORDS], const char (&text)[48]) {
+    for (std::size_t i = 0; i < TEXT_WORDS; ++i) {
+        std::uint64_t word;
+        std::memcpy(&word, text + i * sizeof(word), sizeof(word));
+        out[i].store(word, std::memory_order_relaxed);
+    }
+}
+
+void loadText(char (&out)[48], const std::atomic<std::uint64_t> (&text)[TEXT_WORDS]) {
+    for (std::size_t i = 0; i < TEXT_WORDS; ++i) {
+        std::uint64_t word = text[i].load(std::memory_order_relaxed);
+        std::memcpy(out + i * sizeof(word), &word, sizeof(word));
+    }
+    out[sizeof(out) - 1] = '\0';
+}
+
+// copies slot `index` out of the ring; false if it was overwritten meanwhile (or is mid-write)
+bool readSlot(const Slot& slot, std::uint64_t index, Event& e) {
+    if (slot.seq.load(std::memory_order_acquire) != index + 1) {
+        return false;
+    }
+    loadText(e.name, slot.name);
+    e.start = slot.start.load(std::memory_order_relaxed);
+    e.end = slot.end.load(std::memory_order_relaxed);
+    loadText(e.detail, slot.detail);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.seq.load(std::memory_order_relaxed) == index + 1;
+}
+
+void copyText(char (&out)[48], const char* detail) {
+    if (detail) {
+        std::strncpy(out, detail, sizeof(out) - 1);
+        out[sizeof(out) - 1] = '\0';
+    } else {
+        out[0] = '\0';
+    }
+}
+
+void writeJsonString(std::ostream& out, const char* s) {
+    out << '"';
+    for (; *s; ++s) {
+        char c = *s;
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            out << ' ';
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+void writeAtExit() {
+    write_chrome_trace(registry().exitPath);
+}
+
+}
+
+void start() {
+    now();   // pin the epoch before the first span
+    g_active.store(true, std::memory_order_release);
+}
+
+void stop() {
+    g_active.store(false, std::memory_order_release);
+}
+
+bool active() {
+    return g_active.load(std::memory_order_relaxed);
+}
+
+void record(const char* name, std::uint64_t startNs, std::uint64_t endNs, const char* detail) {
+    if (!active()) {
+        return;
+    }
+    Event e{};
+    copyText(e.name, name);
+    copyText(e.detail, detail);
+
+    ThreadBuffer& buffer = threadBuffer();
+    std::uint64_t index = buffer.head.load(std::memory_order_relaxed);
+    Slot& slot = buffer.slots[index % RING_SIZE];
+    slot.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    storeText(slot.name, e.name);
+    slot.start.store(startNs, std::memory_order_relaxed);
+    slot.end.store(endNs, std::memory_order_relaxed);
+    storeText(slot.detail, e.detail);
+    slot.seq.store(index + 1, std::memory_order_release);
+    buffer.head.store(index + 1, std::memory_order_release);
+}
+
+std::size_t buffer_count() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    return r.buffers.size();
+}
+
+Span::Span(const char* name, const char* detail)
+    : m_name(name), m_start(0), m_active(active()) {
+    if (m_active) {
+        copyText(m_detail, detail);
+        m_start = now();
+    }
+}
+
+Span::Span(const char* name, std::string_view x, std::string_view y)
+    : m_name(name), m_start(0), m_active(active()) {
+    if (m_active) {
+        std::string_view parts[] = {x, " -> ", y};
+        std::size_t used = 0;
+        for (std::string_view part : parts) {
+            std::size_t n = std::min(part.size(), sizeof(m_detail) - 1 - used);
+            std::memcpy(m_detail + used, part.data(), n);
+            used += n;
+        }
+        m_detail[used] = '\0';
+        m_start = now();
+    }
+}
+
+Span::~Span() {
+    if (m_active) {
+        record(m_name, m_start, now(), m_detail[0] ? m_detail : nullptr);
+    }
+}
+
+bool write_chrome_trace(const std::string& path) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        return false;
+    }
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    auto separator = [&] {
+        if (!first) out << ",\n";
+        first = false;
+    };
+
+    for (const auto& buffer : r.buffers) {
+        separator();
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid
+            << ",\"args\":{\"name\":\"thread " << buffer->tid << "\"}}";
+
+        std::uint64_t head = buffer->head.load(std::memory_order_acquire);
+        std::uint64_t begin = head > RING_SIZE ? head - RING_SIZE : 0;
+        Event e;
+        for (std::uint64_t i = begin; i < head; ++i) {
+            // a thread still recording may be lapping the oldest slots; those are dropped
+            if (!readSlot(buffer->slots[i % RING_SIZE], i, e)) {
+                continue;
+            }
+            separator();
+            out << "{\"name\":";
+            writeJsonString(out, e.name);
+            out << ",\"cat\":\"decoderscpp\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid
+                << ",\"ts\":" << (e.start / 1000) << '.' << (e.start % 1000 / 100)
+                << ",\"dur\":" << ((e.end - e.start) / 1000) << '.' << ((e.end - e.start) % 1000 / 100);
+            if (e.detail[0]) {
+                out << ",\"args\":{\"detail\":";
+                writeJsonString(out, e.detail);
+                out << '}';
+            }
+            out << '}';
+        }
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
+
+void start_with_output(const std::string& path) {
+    Registry& r = registry();
+    bool registerHandler = false;
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        registerHandler = r.exitPath.empty();
+        r.exitPath = path;
+    }
+    if (registerHandler) {
+        std::atexit(writeAtExit);
+    }
+    start();
+}
+
+#else
+
+bool write_chrome_trace(const std::string&) { return false; }
+void start_with_output(const std::string&) {}
+
+#endif
+
+std::string start_from_environment() {
+    const char* path = std::getenv("DECODERSCPP_TRACE");
+    if (!path || !*path || !instr::enabled()) {
+        return "";
+    }
+    start_with_output(path);
+    return path;
+}
+
+}
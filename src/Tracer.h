@@ -0,0 +1,83 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include "Instrumentation.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * Opt-in span tracer that writes Chrome trace_event JSON (open it in Perfetto or chrome://tracing).
+ *
+ * Every thread records into its own fixed size ring buffer, so recording a span takes no lock;
+ * when a buffer wraps the oldest spans are dropped. A thread's buffer goes back to a pool when
+ * it exits and is reused by the next new thread, so short-lived workers don't add up. Nothing is recorded until start() is called
+ * (cli --trace, the `trace` command, or the DECODERSCPP_TRACE environment variable).
+ * Every instr::ScopedTimer also shows up as a span. Compiled out with the instrumentation.
+ */
+namespace trace {
+
+// nanoseconds on the clock spans are stamped with
+std::uint64_t now();
+
+#if DECODERSCPP_INSTRUMENTATION
+
+void start();
+void stop();
+bool active();
+
+// one finished span; name and detail are copied (and cut at 47 chars)
+void record(const char* name, std::uint64_t startNs, std::uint64_t endNs, const char* detail = nullptr);
+
+// ring buffers allocated so far (at most the number of threads that recorded at the same time)
+std::size_t buffer_count();
+
+class Span {
+public:
+    explicit Span(const char* name, const char* detail = nullptr);
+    Span(const char* name, const std::string& detail) : Span(name, detail.c_str()) {}
+    // detail "x -> y" for attribute pairs, built in place (no allocation when tracing is off)
+    Span(const char* name, std::string_view x, std::string_view y);
+    ~Span();
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+private:
+    const char* m_name;
+    std::uint64_t m_start;
+    bool m_active;
+    char m_detail[48];
+};
+
+#else
+
+inline void start() {}
+inline void stop() {}
+inline bool active() { return false; }
+inline void record(const char*, std::uint64_t, std::uint64_t, const char* = nullptr) {}
+inline std::size_t buffer_count() { return 0; }
+
+class Span {
+public:
+    explicit Span(const char*, const char* = nullptr) {}
+    Span(const char*, const std::string&) {}
+    Span(const char*, std::string_view, std::string_view) {}
+};
+
+#endif
+
+// writes everything still in the buffers; false if there's nothing to write or the file can't be opened
+bool write_chrome_trace(const std::string& path);
+
+// starts tracing if DECODERSCPP_TRACE=<file> is set and writes that file at exit; returns the path or ""
+std::string start_from_environment();
+
+// start now and write `path` when the process exits
+void start_with_output(const std::string& path);
+
+}
+
+#endif // TRACER_H
@@ -863,9 +863,145 @@ int main() {
 
 
 #include "Cli.h"
+#include "QueryServer.h"
+#include "Tracer.h"
+
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+static void printUsage() {
+    std::cerr << "usage: cli [--timing] [--trace[=file]] [--format=text|json|ndjson|csv|binary]\n"
+              << "       cli [options]                             interactive prompt\n"
+              << "       cli [options] --script <file|->           run a command file\n"
+              << "       cli [options] <command> [args] [; ...]    run commands and exit\n"
+              << "       cli serve [--socket path] [--workers n] [--disk-cache] [dataset.csv]\n";
+}
+
+static QueryServer* g_server = nullptr;
+
+static void stopServer(int) {
+    if (g_server) g_server->stop();
+}
+
+// cli serve: keep the dataset loaded and answer JSON requests on a Unix socket
+static int runServer(int argc, char* argv[], int first) {
+    ServerOptions options;
+    for (int i = first; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--socket") == 0 && i + 1 < argc)
+            options.socketPath = argv[++i];
+        else if (std::strcmp(argv[i], "--disk-cache") == 0)
+            options.diskCache = true;
+        else if (std::strcmp(argv[i], "--workers") == 0 && i + 1 < argc)
+            options.workers = static_cast<std::size_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (argv[i][0] == '-') {
+            std::cerr << "unknown serve option: " << argv[i] << "\n";
+            printUsage();
+            return Cli::EXIT_USAGE;
+        }
+        else
+            options.dataset = argv[i];
+    }
+
+    try {
+        QueryServer server(options);
+        if (!server.start())
+            return Cli::EXIT_COMMAND_FAILED;
+
+        g_server = &server;
+        std::signal(SIGINT, stopServer);
+        std::signal(SIGTERM, stopServer);
+        std::cerr << "Serving on " << options.socketPath << " with " << server.workerCount()
+                  << " workers (Ctrl-C to stop)\n";
+        server.serve();
+        g_server = nullptr;
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << "\n";
+        return Cli::EXIT_COMMAND_FAILED;
+    }
+    return Cli::EXIT_OK;
+}
+
+int main(int argc, char* argv[]) {
+    bool timing = false;
+    std::string tracePath;
+    std::string scriptPath;
+    std::string formatName = "text";
+    std::string oneShot;  // everything that isn't an option, joined back into command text
+    for (int i = 1; i < argc; ++i) {
+        if (!oneShot.empty()) {  // options only before the first command
+            oneShot += ' ';
+            oneShot += argv[i];
+        }
+        else if (std::strcmp(argv[i], "--timing") == 0)
+            timing = true;
+        else if (std::strcmp(argv[i], "--trace") == 0)
+            tracePath = "trace.json";
+        else if (std::strncmp(argv[i], "--trace=", 8) == 0)
+            tracePath = argv[i] + 8;
+        else if (std::strcmp(argv[i], "--script") == 0 && i + 1 < argc)
+            scriptPath = argv[++i];
+        else if (std::strncmp(argv[i], "--script=", 9) == 0)
+            scriptPath = argv[i] + 9;
+        else if (std::strcmp(argv[i], "--format") == 0 && i + 1 < argc)
+            formatName = argv[++i];
+        else if (std::strncmp(argv[i], "--format=", 9) == 0)
+            formatName = argv[i] + 9;
+        else if (std::strcmp(argv[i], "--help") == 0) {
+            printUsage();
+            return Cli::EXIT_OK;
+        }
+        else if (argv[i][0] == '-' && argv[i][1] == '-') {
+            std::cerr << "unknown option: " << argv[i] << "\n";
+            printUsage();
+            return Cli::EXIT_USAGE;
+        }
+        else if (std::strcmp(argv[i], "serve") == 0) {
+            if (!tracePath.empty())
+                trace::start_with_output(tracePath);
+            return runServer(argc, argv, i + 1);
+        }
+        else
+            oneShot = argv[i];
+    }
+    if (!scriptPath.empty() && !oneShot.empty()) {
+        std::cerr << "--script and a command can't be combined\n";
+        return Cli::EXIT_USAGE;
+    }
+
+    OutputFormat format;
+    try {
+        format = parse_output_format(formatName);
+    } catch (const std::invalid_argument& ex) {
+        std::cerr << ex.what() << "\n";
+        printUsage();
+        return Cli::EXIT_USAGE;
+    }
+
+    // --trace[=file] (or DECODERSCPP_TRACE=file) records spans and writes them on exit
+    if (!tracePath.empty())
+        trace::start_with_output(tracePath);
+    else
+        trace::start_from_environment();
+
+    Cli cli(timing, format);
+    if (!oneShot.empty())
+        return cli.runBatch(split_batch_commands(oneShot));
+    if (scriptPath == "-")
+        return cli.runScript(std::cin);
+    if (!scriptPath.empty()) {
+        std::ifstream script(scriptPath);
+        if (!script) {
+            std::cerr << "could not open script: " << scriptPath << "\n";
+            return Cli::EXIT_USAGE;
+        }
+        return cli.runScript(script);
+    }
 
-int main() {
-    Cli cli;
     cli.run();
-    return 0;
+    return Cli::EXIT_OK;
 }
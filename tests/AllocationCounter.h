@@ -0,0 +1,40 @@
+#ifndef TESTS_ALLOCATION_COUNTER_H
+#define TESTS_ALLOCATION_COUNTER_H
+
+#include "Instrumentation.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+/**
+ * Counts the heap allocations this thread makes while the counter is alive.
+ * Uses the operator new replacement from CountingAllocator.cpp, so it only works
+ * in builds with DECODERSCPP_INSTRUMENTATION on (see SKIP_WITHOUT_ALLOCATION_COUNTING).
+ */
+class AllocationCounter {
+public:
+    AllocationCounter() : m_start(instr::thread_allocations()) {}
+
+    std::uint64_t count() const { return instr::thread_allocations() - m_start; }
+
+private:
+    std::uint64_t m_start;
+};
+
+// runs `fn` and returns how many allocations it made
+template <typename Fn>
+std::uint64_t countAllocations(Fn&& fn) {
+    AllocationCounter counter;
+    fn();
+    return counter.count();
+}
+
+#define SKIP_WITHOUT_ALLOCATION_COUNTING()                                  \
+    do {                                                                    \
+        if (!instr::counting_allocations()) {                               \
+            GTEST_SKIP() << "allocation counting needs the instrumentation"; \
+        }                                                                   \
+    } while (0)
+
+#endif // TESTS_ALLOCATION_COUNTER_H
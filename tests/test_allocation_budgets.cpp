@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include "AllocationCounter.h"
+#include "DatasetGenerator.h"
+#include "InsightGenerator.h"
+#include "PersonCsvReader.h"
+#include "PersonRepository.h"
+
+#include <cstdio>
+
+// Allocation budgets for the hot paths. The generators should allocate per distinct
+// value they count (map nodes, pooled tag strings, results), never per person.
+
+namespace {
+
+constexpr std::size_t SMALL = 2000;
+constexpr std::size_t LARGE = 20000;
+
+std::vector<Person> makePersons(std::size_t rows) {
+    DatasetConfig config;
+    config.rows = rows;
+    return DatasetGenerator(config).generate();
+}
+
+// 10x the rows may only add a few allocations (cohorts that only show up in the bigger set)
+void expectFlat(std::uint64_t small, std::uint64_t large, const std::string& what) {
+    EXPECT_LE(large, small + small / 4 + 32) << what << ": " << small << " -> " << large;
+    EXPECT_LT(large, LARGE / 10) << what;
+}
+
+}
+
+TEST(AllocationBudgetTest, GenerateGenericDoesNotAllocatePerPerson) {
+    SKIP_WITHOUT_ALLOCATION_COUNTING();
+
+    auto small = makePersons(SMALL);
+    auto large = makePersons(LARGE);
+    InsightGenerator generator;
+    FingerprintSet suppressed;
+
+    const char* pairs[][2] = {
+        {"os", "study"}, {"hobby", "language"}, {"region", "course"},
+        {"color", "graduation"}, {"focus", "hobby"}, {"language", "region"}
+    };
+    for (const auto& pair : pairs) {
+        auto run = [&](const std::vector<Person>& persons) {
+            return countAllocations([&] {
+                auto insights = generator.generateGeneric(persons, suppressed, pair[0], pair[1]);
+            });
+        };
+        expectFlat(run(small), run(large), std::string(pair[0]) + " -> " + pair[1]);
+    }
+}
+
+TEST(AllocationBudgetTest, BuiltInPairsDoNotAllocatePerPerson) {
+    SKIP_WITHOUT_ALLOCATION_COUNTING();
+
+    auto small = makePersons(SMALL);
+    auto large = makePersons(LARGE);
+    InsightGenerator generator;
+    FingerprintSet suppressed;
+
+    for (auto which : {InsightPairType::OsStudy, InsightPairType::ColorHobby,
+                       InsightPairType::RegionLanguage, InsightPairType::FocusCourse}) {
+        auto run = [&](const std::vector<Person>& persons) {
+            return countAllocations([&] {
+                auto insights = generator.generatePair(persons, suppressed, which);
+            });
+        };
+        expectFlat(run(small), run(large), "pair " + std::to_string(static_cast<int>(which)));
+    }
+
+    auto topK = [&](const std::vector<Person>& persons) {
+        return countAllocations([&] { auto insights = generator.generate(persons, suppressed, 10); });
+    };
+    expectFlat(topK(small), topK(large), "generate top 10");
+}
+
+TEST(AllocationBudgetTest, CsvReaderStaysUnderPerRowBudget) {
+    SKIP_WITHOUT_ALLOCATION_COUNTING();
+
+    // about one allocation per tag set plus one per tag, everything else is reused
+    constexpr double MAX_PER_ROW = 10.0;
+
+    DatasetConfig config;
+    config.rows = SMALL;
+    ASSERT_TRUE(DatasetGenerator(config).writeFile("test_alloc_budget.csv", DatasetFormat::Csv));
+
+    std::vector<Person> persons;
+    std::uint64_t allocations = countAllocations([&] {
+        persons = PersonCsvReader("test_alloc_budget.csv").read();
+    });
+    ASSERT_EQ(persons.size(), SMALL);
+    EXPECT_LE(static_cast<double>(allocations) / SMALL, MAX_PER_ROW);
+
+    PersonRepository repo;
+    repo.setPersons(std::move(persons));
+    allocations = countAllocations([&] { repo.saveToCsv("test_alloc_budget.csv"); });
+    EXPECT_LE(static_cast<double>(allocations) / SMALL, 2.0);
+
+    std::remove("test_alloc_budget.csv");
+}
@@ -0,0 +1,67 @@
+// tests/test_attribute_registry.cpp
+
+#include <gtest/gtest.h>
+
+#include "AttributeRegistry.h"
+
+static_assert(AttributeTraits<Attribute::Os>::cardinality == 3);
+static_assert(AttributeTraits<Attribute::Hobby>::multiValued);
+static_assert(!AttributeTraits<Attribute::Graduation>::multiValued);
+
+TEST(AttributeRegistryTest, RegistryMatchesTraits) {
+    const auto& registry = attribute_registry();
+    ASSERT_EQ(registry.size(), ATTRIBUTE_COUNT);
+    for (std::size_t i = 0; i < registry.size(); ++i) {
+        const AttributeInfo& info = registry[i];
+        EXPECT_EQ(static_cast<std::size_t>(info.attr), i);
+        EXPECT_EQ(attribute_info(info.attr), &info);
+
+        // name, label and every synonym parse back to the attribute
+        EXPECT_EQ(parse_attribute(std::string(info.name)), info.attr);
+        EXPECT_EQ(parse_attribute(std::string(info.label)), info.attr);
+        for (std::size_t s = 0; s < info.synonymCount; ++s) {
+            EXPECT_EQ(parse_attribute(std::string(info.synonyms[s])), info.attr) << info.synonyms[s];
+        }
+
+        EXPECT_NE(value_extractor(info.attr), nullptr);
+        EXPECT_EQ(code_reader(info.attr) == nullptr, info.multiValued);
+        EXPECT_EQ(is_tag_attribute(info.attr), info.multiValued);
+    }
+
+    EXPECT_EQ(parse_attribute("GradYear"), Attribute::Graduation);
+    EXPECT_EQ(parse_attribute("shoe size"), Attribute::Unknown);
+    EXPECT_EQ(attribute_info(Attribute::Unknown), nullptr);
+    EXPECT_EQ(value_extractor(Attribute::Unknown), nullptr);
+    EXPECT_EQ(attribute_display_name(Attribute::Focus), "engineering focus");
+    EXPECT_EQ(attribute_registry()[static_cast<std::size_t>(Attribute::Region)].cardinality,
+              static_cast<std::size_t>(Region::Unknown));
+}
+
+TEST(AttributeRegistryTest, ExtractsValues) {
+    Person person("p", 2026, Region::Japan, PrimaryOS::Unknown, EngineeringFocus::Neural_Engineering,
+                  StudyTime::Night, 0, {"Blue"}, {"Chess", "Gaming"});
+    InsightValuePool pool;
+    std::vector<std::uint32_t> values{42};
+
+    value_extractor(Attribute::Os)(person, pool, values);
+    EXPECT_TRUE(values.empty());
+    value_extractor(Attribute::Course)(person, pool, values);
+    EXPECT_TRUE(values.empty());
+    value_extractor(Attribute::Graduation)(person, pool, values);
+    EXPECT_EQ(values, std::vector<std::uint32_t>{2026});
+    EXPECT_EQ(code_reader(Attribute::Region)(person), static_cast<std::uint32_t>(Region::Japan));
+    EXPECT_EQ(code_reader(Attribute::Os)(person), NO_VALUE);
+
+    value_extractor(Attribute::Hobby)(person, pool, values);
+    ASSERT_EQ(values.size(), 2u);
+    EXPECT_EQ(pool.size(), 2u);
+
+    // the same instantiation, picked by value
+    std::size_t tags = visit_attribute(Attribute::Color, [&](auto attr) {
+        std::vector<std::uint32_t> out;
+        attribute_values<decltype(attr)::value>(person, pool, out);
+        return out.size();
+    });
+    EXPECT_EQ(tags, 1u);
+    EXPECT_EQ(pool.text(pool.intern("Blue")), "Blue");
+}
@@ -0,0 +1,89 @@
+// tests/test_cli.cpp
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include "Cli.h"
+#include "DatasetGenerator.h"
+
+TEST(CliBatchTest, SplitsOnNewlinesAndSemicolons) {
+    auto commands = split_batch_commands(
+        "# nightly job\n"
+        "load data.csv ; generate 5\n"
+        "\n"
+        "   save-as out.csv   \n"
+        "# trailing; comment\n"
+        "list-insights");
+
+    std::vector<std::string> expected = {"load data.csv", "generate 5", "save-as out.csv", "list-insights"};
+    EXPECT_EQ(commands, expected);
+}
+
+TEST(CliBatchTest, LoadGenerateSaveSucceeds) {
+    DatasetConfig config;
+    config.rows = 200;
+    ASSERT_TRUE(DatasetGenerator(config).writeFile("test_cli_in.csv", DatasetFormat::Csv));
+
+    Cli cli;
+    std::istringstream script("load test_cli_in.csv\ngenerate 5\nsave-as test_cli_out.csv\n");
+    EXPECT_EQ(cli.runScript(script), Cli::EXIT_OK);
+
+    std::ifstream out("test_cli_out.csv");
+    EXPECT_TRUE(out.good());
+
+    std::remove("test_cli_in.csv");
+    std::remove("test_cli_out.csv");
+}
+
+TEST(CliBatchTest, StopsAtFirstFailingCommand) {
+    Cli cli;
+    // the missing file makes the reader throw; save-as must not run afterwards
+    EXPECT_EQ(cli.runBatch({"load does_not_exist.csv", "save-as test_cli_never.csv"}),
+              Cli::EXIT_COMMAND_FAILED);
+    std::ifstream out("test_cli_never.csv");
+    EXPECT_FALSE(out.good());
+
+    EXPECT_EQ(cli.runBatch({"no-such-command"}), Cli::EXIT_COMMAND_FAILED);
+    EXPECT_EQ(cli.runBatch({"remove 3"}), Cli::EXIT_COMMAND_FAILED);
+}
+
+TEST(CliBatchTest, FailsOnBadGenerateCustomArguments) {
+    Cli cli;
+    EXPECT_EQ(cli.runBatch({"generate-custom foo os", "save-as test_cli_never.csv"}), Cli::EXIT_COMMAND_FAILED);
+    std::ifstream out("test_cli_never.csv");
+    EXPECT_FALSE(out.good());
+
+    EXPECT_EQ(cli.runBatch({"generate-custom os study abc"}), Cli::EXIT_COMMAND_FAILED);
+    EXPECT_EQ(cli.runBatch({"generate-custom os"}), Cli::EXIT_COMMAND_FAILED);
+    EXPECT_EQ(cli.runBatch({"generate-custom os study 3"}), Cli::EXIT_OK);
+}
+
+TEST(CliBatchTest, FailsOnBadGenerateArgumentsAndMissingData) {
+    Cli empty;
+    EXPECT_EQ(empty.runBatch({"generate"}), Cli::EXIT_COMMAND_FAILED);
+    EXPECT_EQ(empty.runBatch({"discover-best"}), Cli::EXIT_COMMAND_FAILED);
+    EXPECT_EQ(empty.runBatch({"discover-all"}), Cli::EXIT_COMMAND_FAILED);
+
+    DatasetConfig config;
+    config.rows = 100;
+    ASSERT_TRUE(DatasetGenerator(config).writeFile("test_cli_generate.csv", DatasetFormat::Csv));
+
+    Cli cli;
+    ASSERT_EQ(cli.runBatch({"load test_cli_generate.csv"}), Cli::EXIT_OK);
+    EXPECT_EQ(cli.runBatch({"generate abc"}), Cli::EXIT_COMMAND_FAILED);
+    EXPECT_EQ(cli.runBatch({"generate -5"}), Cli::EXIT_COMMAND_FAILED);
+    EXPECT_EQ(cli.runBatch({"generate 5x"}), Cli::EXIT_COMMAND_FAILED);
+    EXPECT_EQ(cli.runBatch({"generate-custom os study -1"}), Cli::EXIT_COMMAND_FAILED);
+    EXPECT_EQ(cli.runBatch({"generate 5", "generate", "discover-best"}), Cli::EXIT_OK);
+
+    std::remove("test_cli_generate.csv");
+}
+
+TEST(CliBatchTest, RefusesInteractiveCommands) {
+    Cli cli;
+    EXPECT_EQ(cli.runBatch({"add"}), Cli::EXIT_COMMAND_FAILED);
+    EXPECT_EQ(cli.runBatch({"edit 0"}), Cli::EXIT_COMMAND_FAILED);
+    EXPECT_EQ(cli.runBatch({"help", "quit", "add"}), Cli::EXIT_OK);
+}
@@ -0,0 +1,174 @@
+// tests/test_cohort_query.cpp
+
+#include <gtest/gtest.h>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+#include "CohortQuery.h"
+#include "OutputWriter.h"
+#include "PersonRepository.h"
+
+namespace {
+
+// deterministic mix of every attribute, with some unknowns and people without hobbies
+std::vector<Person> makePersons(std::size_t count) {
+    const PrimaryOS oses[] = {PrimaryOS::Linux, PrimaryOS::Windows, PrimaryOS::MacOS, PrimaryOS::Unknown};
+    const Region regions[] = {Region::DACH, Region::Japan, Region::US_West};
+    const StudyTime times[] = {StudyTime::Night, StudyTime::Morning, StudyTime::Afternoon};
+    const char* hobbies[] = {"Chess", "Running", "Gaming"};
+    std::vector<Person> persons;
+    for (std::size_t i = 0; i < count; ++i) {
+        std::unordered_set<std::string> tags;
+        if (i % 5 != 0) tags.insert(hobbies[i % 3]);
+        if (i % 7 == 0) tags.insert(hobbies[(i + 1) % 3]);
+        persons.emplace_back("p" + std::to_string(i), 2020 + static_cast<int>(i % 6), regions[i % 3], oses[i % 4],
+                             EngineeringFocus::Neural_Engineering, times[(i / 3) % 3], 1 + static_cast<int>(i % 8),
+                             std::unordered_set<std::string>{}, tags, std::unordered_set<std::string>{});
+    }
+    return persons;
+}
+
+}
+
+TEST(CohortQueryTest, ParsesQueries) {
+    CohortQuery q = parse_cohort_query("where os=linux,macos and course=2-4 by region,study avg graduation threads 3");
+    ASSERT_EQ(q.filters.size(), 2u);
+    EXPECT_EQ(q.filters[0].attr, Attribute::Os);
+    EXPECT_EQ(q.filters[0].values.size(), 2u);
+    EXPECT_TRUE(q.filters[1].isRange);
+    EXPECT_EQ(q.filters[1].low, 2);
+    EXPECT_EQ(q.filters[1].high, 4);
+    EXPECT_EQ(q.groupBy, (std::vector<Attribute>{Attribute::Region, Attribute::Study}));
+    EXPECT_EQ(q.average, Attribute::Graduation);
+    EXPECT_EQ(q.threads, 3u);
+
+    EXPECT_THROW(parse_cohort_query("nonsense=1"), std::invalid_argument);
+    EXPECT_THROW(parse_cohort_query("os"), std::invalid_argument);
+    EXPECT_THROW(parse_cohort_query("by os,os"), std::invalid_argument);
+    EXPECT_THROW(parse_cohort_query("avg region"), std::invalid_argument);
+
+    // dashes only make a range on numbers; a range on a tag is refused by the index
+    EXPECT_FALSE(parse_cohort_query("hobby=1-2").filters[0].isRange);
+    CohortQuery tagRange;
+    tagRange.filters.push_back(QueryPredicate{Attribute::Hobby, {}, true, 1, 2});
+    auto persons = makePersons(10);
+    PersonIndex index(persons);
+    EXPECT_THROW(index.run(tagRange), std::invalid_argument);
+}
+
+TEST(CohortQueryTest, MatchesBruteForce) {
+    auto persons = makePersons(5000);   // several 64-row words per thread chunk
+
+    // os in {linux, macos}, course 3..6, hobby chess; grouped by study time, averaging graduation
+    std::map<std::string, std::pair<std::size_t, long long>> expected;
+    std::size_t matched = 0;
+    for (const Person& p : persons) {
+        bool os = p.getPrimaryOS() == PrimaryOS::Linux || p.getPrimaryOS() == PrimaryOS::MacOS;
+        bool load = p.getCourseLoad() >= 3 && p.getCourseLoad() <= 6;
+        if (!os || !load || !p.getHobbies().count("Chess")) continue;
+        ++matched;
+        auto& cell = expected[to_string(p.getStudyTime())];
+        ++cell.first;
+        cell.second += p.getGraduationYear();
+    }
+    ASSERT_GT(matched, 0u);
+
+    PersonIndex index(persons);
+    for (unsigned threads : {1u, 4u}) {
+        CohortQuery q = parse_cohort_query("os=LINUX,macos course=3-6 hobby=chess by study avg graduation");
+        q.threads = threads;
+        QueryResult r = index.run(q);
+        EXPECT_EQ(r.matched, matched);
+        EXPECT_EQ(r.population, persons.size());
+        ASSERT_EQ(r.groups.size(), expected.size());
+        for (std::size_t i = 0; i < r.groups.size(); ++i) {
+            const QueryGroup& g = r.groups[i];
+            const auto& cell = expected.at(g.values.at(0));
+            EXPECT_EQ(g.count, cell.first);
+            EXPECT_EQ(g.averaged, cell.first);
+            EXPECT_DOUBLE_EQ(g.average, static_cast<double>(cell.second) / cell.first);
+            if (i > 0) {
+                EXPECT_GE(r.groups[i - 1].count, g.count);
+            }
+        }
+    }
+
+    // the popcount path (one group-by, no average) and the row walk agree
+    QueryResult counted = index.run(parse_cohort_query("region=dach by os"));
+    CohortQuery walkedQuery = parse_cohort_query("region=dach by os avg course");
+    walkedQuery.threads = 4;
+    QueryResult walked = index.run(walkedQuery);
+    ASSERT_EQ(counted.groups.size(), 3u);   // unknown os isn't a group
+    ASSERT_EQ(walked.groups.size(), counted.groups.size());
+    for (std::size_t i = 0; i < counted.groups.size(); ++i) {
+        EXPECT_EQ(counted.groups[i].values, walked.groups[i].values);
+        EXPECT_EQ(counted.groups[i].count, walked.groups[i].count);
+    }
+
+    // a person with two hobbies is in both groups
+    QueryResult byHobby = index.run(parse_cohort_query("by hobby"));
+    std::size_t tagged = 0;
+    for (const Person& p : persons) tagged += p.getHobbies().size();
+    std::size_t grouped = 0;
+    for (const QueryGroup& g : byHobby.groups) grouped += g.count;
+    EXPECT_EQ(grouped, tagged);
+    EXPECT_EQ(byHobby.matched, persons.size());
+}
+
+TEST(CohortQueryTest, BuildsOnlyReferencedColumnsAndListsRareValues) {
+    // 50 of 6400 people are from japan, under one in 32, so its rows are a list, not a bitmap
+    auto persons = makePersons(6400);
+    for (std::size_t i = 0; i < persons.size(); ++i) {
+        const Person& p = persons[i];
+        Region region = i % 128 == 0 ? Region::Japan : (i % 2 ? Region::DACH : Region::US_West);
+        persons[i] = Person(p.getId(), p.getGraduationYear(), region, p.getPrimaryOS(), p.getEngineeringFocus(),
+                            p.getStudyTime(), p.getCourseLoad(), {}, p.getHobbies());
+    }
+
+    PersonIndex index(persons);
+    EXPECT_EQ(index.builtColumns(), 0u);
+    EXPECT_EQ(index.run(parse_cohort_query("region=japan")).matched, 50u);
+    EXPECT_EQ(index.builtColumns(), 1u);
+
+    // filtering on and popcounting a listed value agree with the row walk and with brute force
+    for (const char* text : {"os=linux by region", "region=japan,dach by os"}) {
+        QueryResult counted = index.run(parse_cohort_query(text));
+        QueryResult walked = index.run(parse_cohort_query(text + std::string(" avg course")));
+        ASSERT_EQ(counted.groups.size(), walked.groups.size()) << text;
+        for (std::size_t i = 0; i < counted.groups.size(); ++i) {
+            EXPECT_EQ(counted.groups[i].values, walked.groups[i].values) << text;
+            EXPECT_EQ(counted.groups[i].count, walked.groups[i].count) << text;
+        }
+    }
+    std::map<std::string, std::size_t> expected;
+    for (const Person& p : persons) {
+        if (p.getPrimaryOS() == PrimaryOS::Linux) expected[to_string(p.getRegion())]++;
+    }
+    QueryResult linuxUsers = index.run(parse_cohort_query("os=linux by region"));
+    ASSERT_EQ(linuxUsers.groups.size(), expected.size());
+    for (const QueryGroup& g : linuxUsers.groups) {
+        EXPECT_EQ(g.count, expected.at(g.values.at(0)));
+    }
+    EXPECT_EQ(index.builtColumns(), 3u);   // region, os and course
+}
+
+TEST(CohortQueryTest, RepositoryReindexesAfterChanges) {
+    PersonRepository repo;
+    repo.setPersons(makePersons(100));
+    std::size_t before = repo.query(parse_cohort_query("os=linux")).matched;
+    EXPECT_EQ(before, 25u);
+
+    repo.addPerson(makePersons(1).front());   // p0 is a linux user
+    QueryResult after = repo.query(parse_cohort_query("os=linux"));
+    EXPECT_EQ(after.matched, before + 1);
+    EXPECT_EQ(after.population, 101u);
+
+    std::ostringstream json;
+    {
+        BufferedWriter out(json);
+        write_query_result(out, repo.query(parse_cohort_query("os=linux by region")), OutputFormat::Json);
+    }
+    EXPECT_NE(json.str().find("\"matched\":26"), std::string::npos);
+    EXPECT_NE(json.str().find("{\"region\":"), std::string::npos);
+}
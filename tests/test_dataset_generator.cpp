@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include "DatasetGenerator.h"
+#include "InsightGenerator.h"
+#include "PersonBinaryReader.h"
+#include "PersonCsvReader.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+
+namespace {
+
+std::string render(const DatasetConfig& config, DatasetFormat format) {
+    DatasetGenerator generator(config);
+    std::ostringstream out;
+    generator.write(out, format);
+    return out.str();
+}
+
+}
+
+TEST(DatasetGeneratorTest, SameSeedSameRows) {
+    DatasetConfig config;
+    config.rows = 200;
+    config.seed = 7;
+
+    EXPECT_EQ(render(config, DatasetFormat::Csv), render(config, DatasetFormat::Csv));
+
+    DatasetConfig other = config;
+    other.seed = 8;
+    EXPECT_NE(render(config, DatasetFormat::Csv), render(other, DatasetFormat::Csv));
+}
+
+TEST(DatasetGeneratorTest, CsvAndBinaryReadBackTheSamePeople) {
+    DatasetConfig config;
+    config.rows = 300;
+    DatasetGenerator generator(config);
+
+    ASSERT_TRUE(generator.writeFile("test_generated.csv", DatasetFormat::Csv));
+    ASSERT_TRUE(generator.writeFile("test_generated.bin", DatasetFormat::Binary));
+
+    auto expected = generator.generate();
+    auto fromCsv = PersonCsvReader("test_generated.csv").read();
+    auto fromBinary = PersonBinaryReader("test_generated.bin").read();
+
+    ASSERT_EQ(fromCsv.size(), expected.size());
+    ASSERT_EQ(fromBinary.size(), expected.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(fromCsv[i].getRegion(), expected[i].getRegion());
+        EXPECT_EQ(fromCsv[i].getLanguages(), expected[i].getLanguages());
+        EXPECT_EQ(fromBinary[i].getId(), expected[i].getId());
+        EXPECT_EQ(fromBinary[i].getEngineeringFocus(), expected[i].getEngineeringFocus());
+        EXPECT_EQ(fromBinary[i].getHobbies(), expected[i].getHobbies());
+    }
+
+    std::remove("test_generated.csv");
+    std::remove("test_generated.bin");
+}
+
+TEST(DatasetGeneratorTest, InsightGeneratorRecoversPlantedRules) {
+    DatasetConfig config;
+    config.rows = 3000;
+    config.rules = {
+        parse_planted_rule("region=china:language=mandarin:0.95"),
+        parse_planted_rule("os=macos:study=night:0.9"),
+    };
+
+    auto persons = DatasetGenerator(config).generate();
+    InsightGenerator generator;
+    FingerprintSet suppressed;
+
+    auto hasKey = [](const std::vector<Insight>& insights, const std::string& key) {
+        return std::any_of(insights.begin(), insights.end(),
+                           [&](const Insight& i) { return i.key() == key; });
+    };
+
+    auto language = generator.generatePair(persons, suppressed, InsightPairType::RegionLanguage);
+    EXPECT_TRUE(hasKey(language, "region = china -> language = mandarin"));
+
+    auto study = generator.generatePair(persons, suppressed, InsightPairType::OsStudy);
+    EXPECT_TRUE(hasKey(study, "primary_os = MacOS -> study_time = Night"));
+}
+
+TEST(DatasetGeneratorTest, RejectsMalformedRules) {
+    EXPECT_THROW(parse_planted_rule("region=china"), std::invalid_argument);
+    EXPECT_THROW(parse_planted_rule("hobby=chess:os=linux"), std::invalid_argument);
+    EXPECT_THROW(parse_planted_rule("nope=1:os=linux"), std::invalid_argument);
+    EXPECT_THROW(parse_planted_rule("os=linux:study=night:nan"), std::invalid_argument);
+    EXPECT_THROW(parse_planted_rule("os=linux:study=night:1.5"), std::invalid_argument);
+    EXPECT_THROW(parse_planted_rule("os=linux:study=night:-0.1"), std::invalid_argument);
+    EXPECT_THROW(parse_planted_rule("os=linux:study=night:0.5x"), std::invalid_argument);
+    EXPECT_THROW(parse_planted_rule("os=linux:course=many"), std::invalid_argument);
+    EXPECT_THROW(parse_planted_rule("os=linux:graduation=2024b"), std::invalid_argument);
+    EXPECT_EQ(parse_planted_rule("os=linux:course=4:1").strength, 1.0);
+}
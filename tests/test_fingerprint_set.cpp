@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include "FingerprintSet.h"
+#include "Insight.h"
+#include "PersonEnums.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_set>
+
+TEST(FingerprintSetTest, InsertContainsErase) {
+    FingerprintSet set;
+    EXPECT_TRUE(set.empty());
+    EXPECT_FALSE(set.contains(42));
+
+    // enough values to force several grow() calls and long-ish probe chains
+    std::unordered_set<std::uint64_t> reference;
+    std::uint64_t x = 0x9E3779B97F4A7C15ULL;
+    for (int i = 0; i < 5000; ++i) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        EXPECT_EQ(set.insert(x), reference.insert(x).second);
+    }
+    EXPECT_TRUE(set.insert(0));
+    EXPECT_FALSE(set.insert(0));
+    EXPECT_EQ(set.size(), reference.size() + 1);
+
+    for (std::uint64_t v : reference) {
+        EXPECT_TRUE(set.contains(v));
+    }
+
+    // remove every other value, the rest must still be reachable
+    int i = 0;
+    for (std::uint64_t v : reference) {
+        if (i++ % 2 == 0) {
+            EXPECT_TRUE(set.erase(v));
+            EXPECT_FALSE(set.erase(v));
+        }
+    }
+    i = 0;
+    for (std::uint64_t v : reference) {
+        EXPECT_EQ(set.contains(v), i++ % 2 != 0);
+    }
+    EXPECT_TRUE(set.contains(0));
+    EXPECT_TRUE(set.erase(0));
+    EXPECT_FALSE(set.contains(0));
+}
+
+TEST(FingerprintSetTest, InsightFingerprintMatchesTextKey) {
+    auto pool = std::make_shared<InsightValuePool>();
+
+    Insight os;
+    os.kind = InsightKind::OsStudy;
+    os.attrX = Attribute::Os;
+    os.attrY = Attribute::Study;
+    os.valueX = static_cast<std::uint32_t>(PrimaryOS::MacOS);
+    os.valueY = static_cast<std::uint32_t>(StudyTime::Night);
+
+    Insight region;
+    region.kind = InsightKind::RegionLanguage;
+    region.attrX = Attribute::Region;
+    region.attrY = Attribute::Language;
+    region.valueX = static_cast<std::uint32_t>(Region::South_Asia_Pakistan_Bangladesh_SriLanka);
+    region.valueY = pool->intern("Urdu");
+    region.values = pool;
+
+    Insight generic;
+    generic.kind = InsightKind::Generic;
+    generic.attrX = Attribute::Course;
+    generic.attrY = Attribute::Hobby;
+    generic.valueX = 5;
+    generic.valueY = pool->intern("Rock Climbing");
+    generic.values = pool;
+
+    // fingerprint is computed before key() is ever rendered, then compared to the text
+    for (const Insight* ins : {&os, &region, &generic}) {
+        std::uint64_t before = ins->fingerprint();
+        EXPECT_EQ(before, fingerprint_key(ins->key()));
+        EXPECT_EQ(before, ins->fingerprint());
+    }
+
+    EXPECT_EQ(os.key(), "primary_os = MacOS -> study_time = Night");
+    EXPECT_EQ(region.key(), "region = south-asia-pakistan-bangladesh-srilanka -> language = urdu");
+    EXPECT_EQ(generic.key(), "course = 5 -> hobby = rock climbing");
+
+    Insight text = Insight::fromText(os.key(), "whatever");
+    EXPECT_EQ(text.fingerprint(), os.fingerprint());
+}
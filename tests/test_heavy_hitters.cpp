@@ -0,0 +1,95 @@
+// tests/test_heavy_hitters.cpp
+
+#include <gtest/gtest.h>
+#include <map>
+#include <set>
+
+#include "DatasetGenerator.h"
+#include "HeavyHitters.h"
+#include "InsightGenerator.h"
+
+namespace {
+
+std::set<std::string> keysOf(const std::vector<Insight>& insights) {
+    std::set<std::string> keys;
+    for (const Insight& insight : insights) {
+        keys.insert(insight.key());
+    }
+    return keys;
+}
+
+}
+
+TEST(HeavyHittersTest, SpaceSavingBoundsTrueCounts) {
+    SpaceSaving sketch(8);
+    std::map<std::uint32_t, std::size_t> exact;
+
+    // two heavy values in a long tail of 1000 singletons
+    for (std::uint32_t i = 0; i < 1000; ++i) {
+        sketch.add(1000 + i);
+        exact[1000 + i]++;
+        if (i % 3 == 0) {
+            sketch.add(1);
+            exact[1]++;
+        }
+        if (i % 5 == 0) {
+            sketch.add(2);
+            exact[2]++;
+        }
+    }
+
+    EXPECT_EQ(sketch.total(), 1000u + 334u + 200u);
+    auto top = sketch.top();
+    ASSERT_LE(top.size(), 8u);
+    ASSERT_GE(top.size(), 2u);
+    EXPECT_EQ(top[0].item, 1u);
+    EXPECT_EQ(top[1].item, 2u);
+    for (std::size_t i = 0; i < top.size(); ++i) {
+        EXPECT_LE(top[i].count - top[i].error, exact[top[i].item]);
+        EXPECT_GE(top[i].count, exact[top[i].item]);
+        if (i > 0) {
+            EXPECT_GE(top[i - 1].count, top[i].count);
+        }
+    }
+}
+
+TEST(HeavyHittersTest, SketchedTagCountingMatchesExact) {
+    DatasetConfig config;
+    config.rows = 20000;
+    config.hobbyCount = 2000;
+    config.languageCount = 500;
+    config.rules.push_back(parse_planted_rule("region=china:language=mandarin"));
+    config.rules.push_back(parse_planted_rule("os=linux:hobby=hobby900:0.7"));
+    auto persons = DatasetGenerator(config).generate();
+
+    InsightGenerator exact;
+    InsightGenerator sketched;
+    sketched.setTagSketchCapacity(16);   // >= 2x the most tags a person has
+    FingerprintSet none;
+
+    // color -> hobby and region -> language inside generate()
+    auto exactAll = exact.generate(persons, none);
+    ASSERT_FALSE(exactAll.empty());
+    EXPECT_EQ(keysOf(sketched.generate(persons, none)), keysOf(exactAll));
+
+    auto exactOs = exact.generateGeneric(persons, none, "os", "hobby");
+    auto sketchedOs = sketched.generateGeneric(persons, none, "os", "hobby");
+    ASSERT_FALSE(exactOs.empty());
+    EXPECT_EQ(keysOf(sketchedOs), keysOf(exactOs));
+    for (const Insight& s : sketchedOs) {
+        for (const Insight& e : exactOs) {
+            if (e.key() == s.key()) {
+                EXPECT_EQ(s.support, e.support);   // winners are recounted exactly
+                EXPECT_EQ(s.population, e.population);
+            }
+        }
+    }
+
+    // a blocked winner hands the cohort to the runner-up, if that one still qualifies
+    FingerprintSet blocked;
+    for (const Insight& e : exactOs) {
+        blocked.insert(e.fingerprint());
+    }
+    EXPECT_EQ(keysOf(sketched.generateGeneric(persons, blocked, "os", "hobby")),
+              keysOf(exact.generateGeneric(persons, blocked, "os", "hobby")));
+}
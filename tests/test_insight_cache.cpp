@@ -0,0 +1,176 @@
+// tests/test_insight_cache.cpp
+
+#include <gtest/gtest.h>
+#include <filesystem>
+
+#include "DatasetGenerator.h"
+#include "InsightCache.h"
+#include "PersonRepository.h"
+
+namespace {
+
+std::vector<Person> makePersons(std::size_t rows) {
+    DatasetConfig config;
+    config.rows = rows;
+    config.rules.push_back(parse_planted_rule("region=china:language=mandarin"));
+    return DatasetGenerator(config).generate();
+}
+
+}
+
+TEST(InsightCacheTest, RepeatedQueriesComeFromMemory) {
+    PersonRepository repo;
+    repo.setPersons(makePersons(400));
+    InsightGenerator generator;
+    InsightCache cache(generator);
+    FingerprintSet none;
+
+    auto first = cache.generateGeneric(repo.getAll(), repo.contentHash(), none, "region", "language");
+    auto second = cache.generateGeneric(repo.getAll(), repo.contentHash(), none, "Region", "languages");
+    ASSERT_FALSE(first.empty());
+    ASSERT_EQ(first.size(), second.size());
+    EXPECT_EQ(first[0].key(), second[0].key());
+    EXPECT_EQ(cache.stats().hits, 1u);
+    EXPECT_EQ(cache.stats().misses, 1u);
+
+    // a blocked key or an edited dataset is a different entry
+    FingerprintSet blocked;
+    blocked.insert(fingerprint_key(first[0].key()));
+    auto filtered = cache.generateGeneric(repo.getAll(), repo.contentHash(), blocked, "region", "language");
+    EXPECT_NE(filtered.empty() ? std::string() : filtered[0].key(), first[0].key());
+
+    repo.removePerson(0);
+    cache.generateGeneric(repo.getAll(), repo.contentHash(), none, "region", "language");
+    EXPECT_EQ(cache.stats().misses, 3u);
+}
+
+TEST(InsightCacheTest, EvictsLeastRecentlyUsed) {
+    auto persons = makePersons(200);
+    std::uint64_t hash = dataset_hash(persons);
+    InsightGenerator generator;
+    InsightCache cache(generator, 2);
+    FingerprintSet none;
+
+    cache.generate(persons, hash, none, 1);
+    cache.generate(persons, hash, none, 2);
+    cache.generate(persons, hash, none, 1);   // hit, now most recent
+    cache.generate(persons, hash, none, 3);   // evicts limit 2
+    cache.generate(persons, hash, none, 1);   // still there
+    EXPECT_EQ(cache.stats().hits, 2u);
+    cache.generate(persons, hash, none, 2);
+    EXPECT_EQ(cache.stats().misses, 4u);
+    EXPECT_EQ(cache.stats().entries, 2u);
+}
+
+TEST(InsightCacheTest, DiskTierSurvivesANewCache) {
+    const std::string dir = "test_insight_cache_dir";
+    std::filesystem::remove_all(dir);
+
+    auto persons = makePersons(300);
+    std::uint64_t hash = dataset_hash(persons);
+    InsightGenerator generator;
+    FingerprintSet none;
+    std::vector<std::string> attributes = {"os", "study", "region", "language"};
+
+    std::vector<Insight> insights;
+    std::vector<PairScore> pairs;
+    {
+        InsightCache cache(generator);
+        cache.setDiskDirectory(dir);
+        insights = cache.generate(persons, hash, none, 5);
+        pairs = cache.scorePairs(persons, hash, none, attributes);
+    }
+
+    InsightCache restarted(generator);
+    restarted.setDiskDirectory(dir);
+    auto cachedInsights = restarted.generate(persons, hash, none, 5);
+    auto cachedPairs = restarted.scorePairs(persons, hash, none, attributes);
+    EXPECT_EQ(restarted.stats().diskHits, 2u);
+    EXPECT_EQ(restarted.stats().misses, 0u);
+
+    ASSERT_EQ(cachedInsights.size(), insights.size());
+    for (std::size_t i = 0; i < insights.size(); ++i) {
+        EXPECT_EQ(cachedInsights[i].key(), insights[i].key());
+        EXPECT_EQ(cachedInsights[i].description(), insights[i].description());
+        EXPECT_EQ(cachedInsights[i].score, insights[i].score);
+        EXPECT_EQ(cachedInsights[i].support, insights[i].support);
+    }
+    ASSERT_EQ(cachedPairs.size(), pairs.size());
+    for (std::size_t i = 0; i < pairs.size(); ++i) {
+        EXPECT_EQ(cachedPairs[i].attrX, pairs[i].attrX);
+        EXPECT_EQ(cachedPairs[i].avgScore, pairs[i].avgScore);
+    }
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(InsightCacheTest, DiskTierKeepsOnlyItsCapacity) {
+    const std::string dir = "test_insight_cache_bounded";
+    std::filesystem::remove_all(dir);
+
+    auto persons = makePersons(100);
+    InsightGenerator generator;
+    FingerprintSet none;
+    InsightCache cache(generator);
+    cache.setDiskDirectory(dir);
+    cache.setDiskCapacity(2);
+
+    // every dataset hash is a new file; only the newest two stay
+    for (std::uint64_t hash = 1; hash <= 5; ++hash) {
+        cache.generate(persons, hash, none, 3);
+    }
+    std::size_t files = 0;
+    for (const auto& item : std::filesystem::directory_iterator(dir)) {
+        files += item.path().extension() == ".cache";
+    }
+    EXPECT_EQ(files, 2u);
+
+    InsightCache restarted(generator);
+    restarted.setDiskDirectory(dir);
+    restarted.generate(persons, 5, none, 3);
+    EXPECT_EQ(restarted.stats().diskHits, 1u);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(InsightCacheTest, DatasetHashFollowsContent) {
+    auto persons = makePersons(50);
+    std::uint64_t hash = dataset_hash(persons);
+    EXPECT_EQ(dataset_hash(makePersons(50)), hash);
+
+    PersonRepository repo;
+    repo.setPersons(persons);
+    EXPECT_EQ(repo.contentHash(), hash);
+    std::uint64_t version = repo.version();
+    repo.removePerson(3);
+    EXPECT_GT(repo.version(), version);
+    EXPECT_NE(repo.contentHash(), hash);
+}
+
+TEST(InsightCacheTest, CancelledRunsCacheNothing) {
+    auto persons = makePersons(400);
+    InsightGenerator generator;
+    InsightCache cache(generator);
+    FingerprintSet none;
+
+    // stop after the second of the four default passes
+    std::vector<std::size_t> seen;
+    auto cancelAtTwo = [&](std::size_t done, std::size_t total) {
+        EXPECT_EQ(total, 4u);
+        seen.push_back(done);
+        return done < 2;
+    };
+    EXPECT_THROW(cache.generate(persons, 1, none, 0, cancelAtTwo), OperationCancelled);
+    EXPECT_EQ(seen, (std::vector<std::size_t>{0, 1, 2}));
+    EXPECT_EQ(cache.stats().entries, 0u);
+
+    seen.clear();
+    auto all = [&](std::size_t done, std::size_t) { seen.push_back(done); return true; };
+    EXPECT_EQ(cache.generate(persons, 1, none, 0, all).size(), generator.generate(persons, none).size());
+    EXPECT_EQ(seen.back(), 4u);
+    EXPECT_EQ(cache.stats().entries, 1u);
+
+    EXPECT_THROW(cache.generateGeneric(persons, 1, none, "os", "hobby", 0,
+                                       [](std::size_t, std::size_t) { return false; }),
+                 OperationCancelled);
+}
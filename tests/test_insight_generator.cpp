@@ -4,6 +4,8 @@
 #include "Person.h"
 #include "PersonEnums.h"
 
+#include <algorithm>
+#include <map>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -83,7 +85,7 @@ TEST(InsightGeneratorTest, GeneratesOsToStudyTimeInsight) {
     );
 
     InsightGenerator gen;
-    std::unordered_set<std::string> suppressed;
+    FingerprintSet suppressed;
 
     auto insights = gen.generate(persons, suppressed);
 
@@ -98,7 +100,7 @@ TEST(InsightGeneratorTest, GeneratesOsToStudyTimeInsight) {
 
     const Insight* found = nullptr;
     for (const auto& ins : insights) {
-        if (ins.key == expectedKey) {
+        if (ins.key() == expectedKey) {
             found = &ins;
             break;
         }
@@ -106,8 +108,8 @@ TEST(InsightGeneratorTest, GeneratesOsToStudyTimeInsight) {
 
     ASSERT_NE(found, nullptr) << "Did not find expected Windows→Night insight";
 
-    EXPECT_EQ(found->key, expectedKey);
-    EXPECT_EQ(found->description, expectedDescription);
+    EXPECT_EQ(found->key(), expectedKey);
+    EXPECT_EQ(found->description(), expectedDescription);
     EXPECT_EQ(found->support, 3u);
     EXPECT_EQ(found->population, 4u);
 }
@@ -177,12 +179,199 @@ TEST(InsightGeneratorTest, RespectsSuppressedKeys) {
         "primary_os = " + to_string(PrimaryOS::Windows) +
         " -> study_time = " + to_string(StudyTime::Night);
 
-    std::unordered_set<std::string> suppressed = { suppressedKey };
+    FingerprintSet suppressed;
+    suppressed.insert(fingerprint_key(suppressedKey));
 
     auto insights = gen.generate(persons, suppressed);
 
     for (const auto& ins : insights) {
-        EXPECT_NE(ins.key, suppressedKey)
+        EXPECT_NE(ins.key(), suppressedKey)
             << "Suppressed key still appeared in generated insights";
     }
 }
+
+TEST(InsightGeneratorTest, TopKMatchesPrefixOfFullGeneration) {
+    std::vector<Person> persons;
+
+    const std::vector<std::string> colors = {"red", "blue", "green", "sage", "black"};
+    const std::vector<std::string> hobbies = {"gaming", "reading", "gym"};
+    const std::vector<std::string> languages = {"english", "spanish"};
+
+    // mixed dataset so every generator produces something and scores tie in places
+    for (int i = 0; i < 60; ++i) {
+        persons.emplace_back(
+            "p" + std::to_string(i),
+            2025 + (i % 3),
+            (i % 2 == 0) ? Region::US_Northeast : Region::China,
+            (i % 3 == 0) ? PrimaryOS::Linux : PrimaryOS::MacOS,
+            (i % 4 == 0) ? EngineeringFocus::Electronics : EngineeringFocus::Cybersecurity,
+            (i % 5 < 3) ? StudyTime::Night : StudyTime::Morning,
+            4 + (i % 2),
+            std::unordered_set<std::string>{colors[i % colors.size()]},
+            std::unordered_set<std::string>{hobbies[(i / 2) % hobbies.size()]},
+            std::unordered_set<std::string>{languages[(i % 7 == 0) ? 1 : 0]}
+        );
+    }
+
+    InsightGenerator gen;
+    FingerprintSet suppressed;
+
+    auto all = gen.generate(persons, suppressed);
+    ASSERT_GT(all.size(), 3u);
+
+    for (std::size_t k : {std::size_t{1}, std::size_t{3}, all.size(), all.size() + 5}) {
+        auto top = gen.generate(persons, suppressed, k);
+        ASSERT_EQ(top.size(), std::min(k, all.size()));
+        for (std::size_t i = 0; i < top.size(); ++i) {
+            EXPECT_EQ(top[i].key(), all[i].key());
+            EXPECT_EQ(top[i].description(), all[i].description());
+            EXPECT_EQ(top[i].score, all[i].score);
+        }
+    }
+
+    auto allGeneric = gen.generateGeneric(persons, suppressed, "color", "hobby");
+    auto topGeneric = gen.generateGeneric(persons, suppressed, "color", "hobby", 2);
+    ASSERT_EQ(topGeneric.size(), std::min<std::size_t>(2, allGeneric.size()));
+    for (std::size_t i = 0; i < topGeneric.size(); ++i) {
+        EXPECT_EQ(topGeneric[i].key(), allGeneric[i].key());
+        EXPECT_FALSE(topGeneric[i].description().empty());
+    }
+}
+
+TEST(InsightGeneratorTest, GenericInsightRendersTextOnDemand) {
+    std::vector<Person> persons;
+
+    for (int i = 0; i < 4; ++i) {
+        persons.emplace_back(
+            "p" + std::to_string(i),
+            2026,
+            Region::DACH,
+            PrimaryOS::Linux,
+            EngineeringFocus::Robotics_CE,
+            StudyTime::Night,
+            5,
+            std::unordered_set<std::string>{"Blue"},
+            std::unordered_set<std::string>{"Gaming"},
+            std::unordered_set<std::string>{"German"}
+        );
+    }
+
+    InsightGenerator gen;
+    FingerprintSet suppressed;
+
+    auto insights = gen.generateGeneric(persons, suppressed, "hobbies", "lang");
+    ASSERT_EQ(insights.size(), 1u);
+
+    const Insight& ins = insights[0];
+    EXPECT_EQ(ins.kind, InsightKind::Generic);
+    EXPECT_EQ(ins.attrX, Attribute::Hobby);
+    EXPECT_EQ(ins.attrY, Attribute::Language);
+    EXPECT_EQ(ins.support, 4u);
+
+    EXPECT_EQ(ins.key(), "hobby = gaming -> language = german");
+    EXPECT_EQ(ins.description(), "People whose hobby is Gaming tend to have language of German.");
+
+    // copies keep working after the generator's data is gone
+    Insight copy = ins;
+    insights.clear();
+    EXPECT_EQ(copy.description(), "People whose hobby is Gaming tend to have language of German.");
+}
+
+TEST(InsightGeneratorTest, BlockedBestYLetsNextBestSurface) {
+    std::vector<Person> persons;
+
+    // blue cohort: gaming 4/4, reading 3/4
+    for (int i = 0; i < 4; ++i) {
+        std::unordered_set<std::string> hobbies = {"gaming"};
+        if (i < 3) hobbies.insert("reading");
+        persons.emplace_back(
+            "p" + std::to_string(i),
+            2026,
+            Region::US_West,
+            PrimaryOS::Linux,
+            EngineeringFocus::Networking,
+            StudyTime::Night,
+            4,
+            std::unordered_set<std::string>{"blue"},
+            hobbies,
+            std::unordered_set<std::string>{"english"}
+        );
+    }
+
+    InsightGenerator gen;
+    FingerprintSet suppressed;
+
+    auto before = gen.generateGeneric(persons, suppressed, "color", "hobby");
+    ASSERT_EQ(before.size(), 1u);
+    EXPECT_EQ(before[0].key(), "color = blue -> hobby = gaming");
+
+    suppressed.insert(fingerprint_key("color = blue -> hobby = gaming"));
+
+    auto after = gen.generateGeneric(persons, suppressed, "color", "hobby");
+    ASSERT_EQ(after.size(), 1u);
+    EXPECT_EQ(after[0].key(), "color = blue -> hobby = reading");
+    EXPECT_EQ(after[0].support, 3u);
+    EXPECT_EQ(after[0].population, 4u);
+
+    // once reading is blocked too nothing is left for blue
+    suppressed.insert(fingerprint_key("color = blue -> hobby = reading"));
+    EXPECT_TRUE(gen.generateGeneric(persons, suppressed, "color", "hobby").empty());
+}
+
+TEST(InsightGeneratorTest, EnumPairKernelMatchesBruteForce) {
+    std::vector<Person> persons;
+    for (int i = 0; i < 3000; ++i) {
+        // region i % 7 mostly has focus (region * 3) % 20, the rest spread out
+        int region = i % 7;
+        int focus = (i / 7) % 3 == 0 ? (i * 13) % 20 : (region * 3) % 20;
+        persons.emplace_back(
+            "p" + std::to_string(i), 2026,
+            i % 101 == 0 ? Region::Unknown : static_cast<Region>(region),
+            PrimaryOS::Linux,
+            static_cast<EngineeringFocus>(focus),
+            StudyTime::Night, 4,
+            std::unordered_set<std::string>{}, std::unordered_set<std::string>{});
+    }
+
+    // the generic hashed path, written out by hand
+    std::map<std::pair<int, int>, std::size_t> joint;
+    std::map<int, std::size_t> cohort;
+    for (const Person& p : persons) {
+        if (p.getRegion() == Region::Unknown) continue;
+        joint[{static_cast<int>(p.getRegion()), static_cast<int>(p.getEngineeringFocus())}]++;
+        cohort[static_cast<int>(p.getRegion())]++;
+    }
+
+    InsightGenerator gen;
+    FingerprintSet none;
+    auto insights = gen.generateGeneric(persons, none, "region", "focus");
+    ASSERT_EQ(insights.size(), 7u);
+    for (const Insight& insight : insights) {
+        EXPECT_EQ(insight.kind, InsightKind::Generic);
+        std::size_t best = 0;
+        for (const auto& [cell, count] : joint) {
+            if (cell.first == static_cast<int>(insight.valueX)) best = std::max(best, count);
+        }
+        EXPECT_EQ(insight.support, best);
+        EXPECT_EQ(insight.support, (joint[{static_cast<int>(insight.valueX), static_cast<int>(insight.valueY)}]));
+        EXPECT_EQ(insight.population, cohort[static_cast<int>(insight.valueX)]);
+    }
+
+    // blocking a winner falls back to the runner-up, which is below 50% here
+    FingerprintSet blocked;
+    blocked.insert(insights[0].fingerprint());
+    auto after = gen.generateGeneric(persons, blocked, "region", "focus");
+    EXPECT_EQ(after.size(), 6u);
+
+    // ties go to the lowest code, like the ordered maps generate() used before
+    std::vector<Person> tied;
+    for (StudyTime study : {StudyTime::Night, StudyTime::Morning, StudyTime::Night, StudyTime::Morning}) {
+        tied.emplace_back("t", 2026, Region::US_West, PrimaryOS::Windows, EngineeringFocus::Networking,
+                          study, 4, std::unordered_set<std::string>{}, std::unordered_set<std::string>{});
+    }
+    auto osStudy = gen.generatePair(tied, none, InsightPairType::OsStudy);
+    ASSERT_EQ(osStudy.size(), 1u);
+    EXPECT_EQ(osStudy[0].kind, InsightKind::OsStudy);
+    EXPECT_EQ(osStudy[0].valueY, static_cast<std::uint32_t>(StudyTime::Morning));
+    EXPECT_EQ(osStudy[0].support, 2u);
+}
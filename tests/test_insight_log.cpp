@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include "InsightLog.h"
+#include "InsightStore.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+void removeLog(const std::string& path) {
+    std::remove(path.c_str());
+    std::remove((path + ".idx").c_str());
+}
+
+Insight makeInsight(const std::string& key, const std::string& description, int score) {
+    Insight i = Insight::fromText(key, description);
+    i.score = score;
+    i.support = 5;
+    i.population = 20;
+    return i;
+}
+
+}
+
+TEST(InsightLogTest, EscapesFieldsAndFindsByKey) {
+    std::string path = "test_insight_log.csv";
+    removeLog(path);
+
+    {
+        InsightLog log(path);
+        ASSERT_TRUE(log.open());
+        EXPECT_TRUE(log.append(makeInsight("a = x, y -> b = z", "line one,\twith tab\nand newline \\ done", 70)));
+        EXPECT_TRUE(log.append(makeInsight("K2", "plain", 55)));
+        EXPECT_FALSE(log.append(makeInsight("K2", "plain", 55)));
+        EXPECT_EQ(log.size(), 2u);
+    }
+
+    // reopening goes through the index, not a parse of every record
+    InsightLog reopened(path);
+    ASSERT_TRUE(reopened.open());
+    EXPECT_EQ(reopened.size(), 2u);
+
+    auto found = reopened.find("a = x, y -> b = z");
+    ASSERT_TRUE(found.has_value());
+    EXPECT_EQ(found->description(), "line one,\twith tab\nand newline \\ done");
+    EXPECT_EQ(found->score, 70);
+    EXPECT_FALSE(reopened.find("missing").has_value());
+
+    auto all = reopened.readAll();
+    ASSERT_EQ(all.size(), 2u);
+    EXPECT_EQ(all[1].key(), "K2");
+
+    removeLog(path);
+}
+
+TEST(InsightLogTest, SkipsTornRecordAndKeepsAppending) {
+    std::string path = "test_insight_log_torn.csv";
+    removeLog(path);
+
+    {
+        InsightLog log(path);
+        ASSERT_TRUE(log.open());
+        log.append(makeInsight("K1", "first", 60));
+    }
+
+    // a crash halfway through a write, with a stale index left behind
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::app);
+        out << "deadbeef\tK2\thalf a rec";
+    }
+
+    InsightLog log(path);
+    ASSERT_TRUE(log.open());
+    EXPECT_EQ(log.size(), 1u);
+    EXPECT_TRUE(log.append(makeInsight("K3", "third", 65)));
+
+    auto all = log.readAll();
+    ASSERT_EQ(all.size(), 2u);
+    EXPECT_EQ(all[0].key(), "K1");
+    EXPECT_EQ(all[1].key(), "K3");
+
+    removeLog(path);
+}
+
+TEST(InsightLogTest, MigratesLegacyCommaFile) {
+    std::string path = "test_insight_log_legacy.csv";
+    removeLog(path);
+
+    {
+        std::ofstream out(path);
+        out << "K1,Mac users study at night,88,12,40\n";
+        out << "K2,Windows users like mornings,72,8,40\n";
+        out << "K1,Mac users study at night,88,12,40\n";
+    }
+
+    InsightLog log(path);
+    EXPECT_FALSE(log.open());   // only rewritten when asked
+    ASSERT_TRUE(log.open(true));
+    EXPECT_EQ(log.size(), 2u);
+
+    auto k2 = log.find("K2");
+    ASSERT_TRUE(k2.has_value());
+    EXPECT_EQ(k2->score, 72);
+    EXPECT_EQ(k2->support, 8u);
+    EXPECT_EQ(k2->population, 40u);
+
+    removeLog(path);
+}
+
+TEST(InsightLogTest, RefusesOtherFiles) {
+    std::string path = "test_insight_log_other.csv";
+    removeLog(path);
+
+    const std::string csv = "index,key,description,score\n0,K1,\"a, b\",88\n";
+    {
+        std::ofstream out(path);
+        out << csv;
+    }
+
+    InsightLog log(path);
+    EXPECT_FALSE(log.open());
+    EXPECT_FALSE(log.open(true));   // not an old saved-insights file either
+
+    std::ifstream in(path);
+    std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(contents, csv);
+    EXPECT_FALSE(std::ifstream(path + ".idx").good());
+
+    InsightStore store;
+    EXPECT_THROW(store.saveUseful({makeInsight("K1", "first", 60)}, path), std::runtime_error);
+
+    removeLog(path);
+}
+
+TEST(InsightLogTest, CreatesFilesOnFirstAppendOnly) {
+    std::string path = "test_insight_log_lazy.csv";
+    removeLog(path);
+
+    InsightLog log(path);
+    ASSERT_TRUE(log.open());
+    EXPECT_EQ(log.size(), 0u);
+    EXPECT_TRUE(log.readAll().empty());
+    EXPECT_FALSE(log.contains("K1"));
+    EXPECT_EQ(log.appendAll({}), 0u);
+    EXPECT_FALSE(std::ifstream(path).good());
+    EXPECT_FALSE(std::ifstream(path + ".idx").good());
+
+    EXPECT_TRUE(log.append(makeInsight("K1", "first", 60)));
+    EXPECT_TRUE(std::ifstream(path).good());
+    EXPECT_TRUE(std::ifstream(path + ".idx").good());
+
+    InsightLog reopened(path);
+    ASSERT_TRUE(reopened.open());
+    EXPECT_EQ(reopened.size(), 1u);
+    EXPECT_TRUE(reopened.contains("K1"));
+
+    removeLog(path);
+}
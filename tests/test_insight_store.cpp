@@ -1,24 +1,23 @@
 #include <gtest/gtest.h>
 #include "InsightStore.h"
 
+#include <cstdio>
 #include <fstream>
 #include <vector>
 #include <string>
 
 TEST(InsightStoreTest, SaveAndLoadUsefulRoundTrip) {
     std::string filename = "test_useful_insights.csv";
+    std::remove(filename.c_str());
+    std::remove((filename + ".idx").c_str());
 
     // Build some test insights
-    Insight a;
-    a.key = "K1";
-    a.description = "Mac users study at night";
+    Insight a = Insight::fromText("K1", "Mac users study at night");
     a.score = 88;
     a.support = 12;
     a.population = 40;
 
-    Insight b;
-    b.key = "K2";
-    b.description = "Windows users like mornings";
+    Insight b = Insight::fromText("K2", "Windows users like mornings");
     b.score = 72;
     b.support = 8;
     b.population = 40;
@@ -34,10 +33,43 @@ TEST(InsightStoreTest, SaveAndLoadUsefulRoundTrip) {
 
     const auto& loadedVec = loaded.getUseful();
     ASSERT_EQ(loadedVec.size(), 2u);
-    EXPECT_EQ(loadedVec[0].key, "K1");
-    EXPECT_EQ(loadedVec[0].description, "Mac users study at night");
-    EXPECT_EQ(loadedVec[1].key, "K2");
-    EXPECT_EQ(loadedVec[1].description, "Windows users like mornings");
+    EXPECT_EQ(loadedVec[0].key(), "K1");
+    EXPECT_EQ(loadedVec[0].description(), "Mac users study at night");
+    EXPECT_EQ(loadedVec[1].key(), "K2");
+    EXPECT_EQ(loadedVec[1].description(), "Windows users like mornings");
+    EXPECT_TRUE(loaded.isSaved("K2"));
+
+    // saving the same insights again doesn't duplicate them
+    EXPECT_EQ(loaded.saveUseful(toSave, filename), 0u);
+    EXPECT_EQ(loaded.getUseful().size(), 2u);
+
+    std::remove(filename.c_str());
+    std::remove((filename + ".idx").c_str());
+}
+
+TEST(InsightStoreTest, SaveUsefulDropsRepeatsWithinOneBatch) {
+    std::string filename = "test_useful_repeats.csv";
+    std::remove(filename.c_str());
+    std::remove((filename + ".idx").c_str());
+
+    Insight a = Insight::fromText("K1", "Mac users study at night");
+    Insight b = Insight::fromText("K2", "Windows users like mornings");
+
+    InsightStore store;
+    store.loadUseful(filename);
+    EXPECT_EQ(store.saveUseful({a, a, b, a}, filename), 2u);
+    EXPECT_EQ(store.getUseful().size(), 2u);
+
+    // and through a log that isn't the store's own
+    InsightStore other;
+    EXPECT_EQ(other.saveUseful({b, b}, filename), 0u);
+
+    InsightStore loaded;
+    loaded.loadUseful(filename);
+    EXPECT_EQ(loaded.getUseful().size(), 2u);
+
+    std::remove(filename.c_str());
+    std::remove((filename + ".idx").c_str());
 }
 
 TEST(InsightStoreTest, SaveLoadBlockedAndFilter) {
@@ -58,15 +90,12 @@ TEST(InsightStoreTest, SaveLoadBlockedAndFilter) {
     EXPECT_FALSE(loaded.isBlocked("GOODKEY"));
 
     // filterBlocked should remove BAD1 but keep GOOD
-    Insight bad;
-    bad.key = "BAD1";
-
-    Insight good;
-    good.key = "GOOD";
+    Insight bad = Insight::fromText("BAD1", "");
+    Insight good = Insight::fromText("GOOD", "");
 
     std::vector<Insight> input = { bad, good };
     auto output = loaded.filterBlocked(input);
 
     ASSERT_EQ(output.size(), 1u);
-    EXPECT_EQ(output[0].key, "GOOD");
+    EXPECT_EQ(output[0].key(), "GOOD");
 }
@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+#include "Instrumentation.h"
+
+#include <algorithm>
+#include <memory>
+
+namespace {
+
+const instr::PhaseEntry* findPhase(const std::vector<instr::PhaseEntry>& phases, const std::string& name) {
+    auto it = std::find_if(phases.begin(), phases.end(),
+                           [&](const instr::PhaseEntry& p) { return p.name == name; });
+    return it == phases.end() ? nullptr : &*it;
+}
+
+}
+
+TEST(InstrumentationTest, ScopedTimerRecordsRowsBytesAndAllocations) {
+    if (!instr::enabled()) {
+        GTEST_SKIP() << "instrumentation compiled out";
+    }
+
+    auto before = instr::snapshot();
+    for (int i = 0; i < 2; ++i) {
+        instr::ScopedTimer timer("test.phase");
+        timer.addRows(10);
+        timer.addBytes(100);
+        auto p = std::make_unique<int>(i);
+        EXPECT_EQ(*p, i);
+    }
+    instr::count("test.counter", 3);
+
+    auto diff = instr::difference(before, instr::snapshot());
+    const auto* phase = findPhase(diff, "test.phase");
+    ASSERT_NE(phase, nullptr);
+    EXPECT_EQ(phase->stats.calls, 2u);
+    EXPECT_EQ(phase->stats.rows, 20u);
+    EXPECT_EQ(phase->stats.bytes, 200u);
+    EXPECT_GE(phase->stats.allocations, 2u);
+
+    const auto* counter = findPhase(diff, "test.counter");
+    ASSERT_NE(counter, nullptr);
+    EXPECT_EQ(counter->stats.calls, 3u);
+
+    EXPECT_NE(instr::format_report(diff).find("test.phase"), std::string::npos);
+    EXPECT_GT(instr::peak_rss_bytes(), 0u);
+}
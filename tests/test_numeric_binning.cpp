@@ -0,0 +1,103 @@
+// tests/test_numeric_binning.cpp
+
+#include <gtest/gtest.h>
+#include <stdexcept>
+
+#include "InsightGenerator.h"
+#include "NumericBinning.h"
+
+namespace {
+
+IntHistogram histogramOf(std::initializer_list<std::pair<int, std::size_t>> counts) {
+    IntHistogram histogram;
+    for (const auto& [value, n] : counts) {
+        for (std::size_t i = 0; i < n; ++i) {
+            histogram.add(value);
+        }
+    }
+    return histogram;
+}
+
+}
+
+TEST(NumericBinningTest, BuildsRanges) {
+    // added out of order, so the dense array has to grow both ways
+    IntHistogram histogram = histogramOf({{5, 10}, {2, 10}, {8, 10}, {3, 40}, {9, 30}});
+    EXPECT_TRUE(histogram.dense());
+    EXPECT_EQ(histogram.total(), 100u);
+    auto values = histogram.values();
+    ASSERT_EQ(values.size(), 5u);
+    EXPECT_EQ(values.front(), (std::pair<int, std::size_t>{2, 10}));
+    EXPECT_EQ(values.back(), (std::pair<int, std::size_t>{9, 30}));
+
+    NumericBins identity = NumericBins::identity(histogram);
+    ASSERT_EQ(identity.size(), 5u);
+    EXPECT_EQ(identity.binOf(8), 3u);
+    EXPECT_EQ(identity.label(3), "8");
+
+    // 2..9 in widths of 3
+    NumericBins width = NumericBins::build(histogram, {BinningMode::EqualWidth, 3});
+    ASSERT_EQ(width.size(), 3u);
+    EXPECT_EQ(width.label(0), "2-4");
+    EXPECT_EQ(width.label(1), "5-7");
+    EXPECT_EQ(width.label(2), "8-9");
+    EXPECT_EQ(width.binOf(4), 0u);
+    EXPECT_EQ(width.binOf(6), 1u);
+    EXPECT_EQ(width.binOf(100), 2u);
+    EXPECT_EQ(width.binOf(-3), 0u);
+
+    // halves by row count: 2-3 hold 50 people, 5-9 the other 50
+    NumericBins quantile = NumericBins::build(histogram, {BinningMode::Quantile, 2});
+    ASSERT_EQ(quantile.size(), 2u);
+    EXPECT_EQ(quantile.label(0), "2-3");
+    EXPECT_EQ(quantile.label(1), "5-9");
+    EXPECT_EQ(quantile.binOf(4), 0u);   // between the bins, goes with the lower one
+
+    // one value can't be split
+    NumericBins single = NumericBins::build(histogramOf({{4, 90}, {6, 10}}), {BinningMode::Quantile, 4});
+    EXPECT_EQ(single.size(), 2u);
+
+    // a wide spread moves to the sparse map and still bins the same way
+    IntHistogram wide = histogramOf({{1, 1}, {1000000, 1}, {500000, 2}});
+    EXPECT_FALSE(wide.dense());
+    NumericBins wideBins = NumericBins::build(wide, {BinningMode::EqualWidth, 2});
+    ASSERT_EQ(wideBins.size(), 2u);
+    EXPECT_EQ(wideBins.binOf(500000), 0u);
+    EXPECT_EQ(wideBins.binOf(999999), 1u);
+
+    EXPECT_EQ(parse_binning_mode("Quantile"), BinningMode::Quantile);
+    EXPECT_THROW(parse_binning_mode("log"), std::invalid_argument);
+}
+
+TEST(NumericBinningTest, GeneratesRangeInsights) {
+    // networking takes 4 or 5 courses, never the same number often enough on its own
+    std::vector<Person> persons;
+    for (int i = 0; i < 20; ++i) {
+        int load = i < 8 ? 4 : (i < 16 ? 5 : 1 + i % 3);
+        persons.emplace_back("p" + std::to_string(i), 2020 + i % 10, Region::US_West, PrimaryOS::Linux,
+                             EngineeringFocus::Networking, StudyTime::Night, load,
+                             std::unordered_set<std::string>{}, std::unordered_set<std::string>{});
+    }
+
+    InsightGenerator gen;
+    FingerprintSet none;
+    EXPECT_TRUE(gen.generatePair(persons, none, InsightPairType::FocusCourse).empty());
+
+    gen.setBinning({BinningMode::EqualWidth, 2});
+    auto ranged = gen.generatePair(persons, none, InsightPairType::FocusCourse);
+    ASSERT_EQ(ranged.size(), 1u);
+    EXPECT_EQ(ranged[0].key(), "engineering_focus = networking -> course_load = 4-5");
+    EXPECT_EQ(ranged[0].support, 16u);
+    EXPECT_NE(ranged[0].description().find("about 4-5 courses"), std::string::npos);
+
+    // generic pairs bin either side, and blocking a range works like blocking a value
+    auto generic = gen.generateGeneric(persons, none, "graduation", "course");
+    ASSERT_FALSE(generic.empty());
+    for (const Insight& insight : generic) {
+        EXPECT_TRUE(is_range_value(insight.valueX));
+        EXPECT_NE(insight.key().find("graduation = 20"), std::string::npos);
+    }
+    FingerprintSet blocked;
+    blocked.insert(fingerprint_key(ranged[0].key()));
+    EXPECT_TRUE(gen.generatePair(persons, blocked, InsightPairType::FocusCourse).empty());
+}
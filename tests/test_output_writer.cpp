@@ -0,0 +1,89 @@
+// tests/test_output_writer.cpp
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "DatasetGenerator.h"
+#include "OutputWriter.h"
+#include "PersonBinaryReader.h"
+
+TEST(OutputWriterTest, ParsesFormatNames) {
+    EXPECT_EQ(parse_output_format("JSON"), OutputFormat::Json);
+    EXPECT_EQ(parse_output_format("ndjson"), OutputFormat::Ndjson);
+    EXPECT_EQ(parse_output_format("bin"), OutputFormat::Binary);
+    EXPECT_THROW(parse_output_format("yaml"), std::invalid_argument);
+}
+
+TEST(OutputWriterTest, WritesOnlyOnFlush) {
+    std::ostringstream stream;
+    BufferedWriter out(stream);
+    out << "a,";
+    out.csvField("has \"quotes\", and commas");
+    out << ',';
+    out.jsonString("line\nbreak \\ \"q\"");
+    EXPECT_TRUE(stream.str().empty());
+
+    out.flush();
+    EXPECT_EQ(stream.str(), "a,\"has \"\"quotes\"\", and commas\",\"line\\nbreak \\\\ \\\"q\\\"\"");
+}
+
+TEST(OutputWriterTest, InsightsAsJsonNdjsonAndCsv) {
+    std::vector<Insight> insights = {
+        Insight::fromText("a = 1 -> b = 2", "People with a 1, tend to b 2."),
+        Insight::fromText("c = 3 -> d = 4", "People with c tend to d.")
+    };
+    insights[0].score = 70;
+    insights[0].support = 7;
+    insights[0].population = 10;
+
+    std::ostringstream json, ndjson, csv;
+    {
+        BufferedWriter a(json), b(ndjson), c(csv);
+        write_insights(a, insights, OutputFormat::Json);
+        write_insights(b, insights, OutputFormat::Ndjson);
+        write_insights(c, insights, OutputFormat::Csv);
+    }
+
+    EXPECT_EQ(json.str().rfind("{\"insights\":[\n{\"index\":0,\"key\":\"a = 1 -> b = 2\"", 0), 0u);
+    EXPECT_NE(json.str().find("\"score\":70,\"support\":7,\"population\":10,\"confidence\":0.7}"),
+              std::string::npos);
+
+    std::istringstream lines(ndjson.str());
+    std::string line;
+    int count = 0;
+    while (std::getline(lines, line)) {
+        EXPECT_EQ(line.front(), '{');
+        EXPECT_EQ(line.back(), '}');
+        ++count;
+    }
+    EXPECT_EQ(count, 2);
+
+    EXPECT_EQ(csv.str(),
+              "index,key,description,score,support,population,confidence\n"
+              "0,a = 1 -> b = 2,\"People with a 1, tend to b 2.\",70,7,10,0.7\n"
+              "1,c = 3 -> d = 4,People with c tend to d.,0,0,0,0\n");
+}
+
+TEST(OutputWriterTest, BinaryPersonsLoadWithBinaryReader) {
+    DatasetConfig config;
+    config.rows = 50;
+    auto persons = DatasetGenerator(config).generate();
+
+    {
+        std::ofstream file("test_output_writer.pbin", std::ios::binary);
+        BufferedWriter out(file);
+        write_persons(out, persons, OutputFormat::Binary);
+    }
+
+    auto loaded = PersonBinaryReader("test_output_writer.pbin").read();
+    ASSERT_EQ(loaded.size(), persons.size());
+    for (std::size_t i = 0; i < persons.size(); ++i) {
+        EXPECT_EQ(loaded[i].getId(), persons[i].getId());
+        EXPECT_EQ(loaded[i].getRegion(), persons[i].getRegion());
+        EXPECT_EQ(loaded[i].getHobbies(), persons[i].getHobbies());
+    }
+    std::remove("test_output_writer.pbin");
+}
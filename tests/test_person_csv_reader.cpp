@@ -0,0 +1,33 @@
+// tests/test_person_csv_reader.cpp
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <filesystem>
+
+#include "DatasetGenerator.h"
+#include "PersonCsvReader.h"
+
+TEST(PersonCsvReaderTest, ReportsProgressAndCancels) {
+    DatasetConfig config;
+    config.rows = 20000;
+    ASSERT_TRUE(DatasetGenerator(config).writeFile("test_csv_reader_progress.csv", DatasetFormat::Csv));
+    std::size_t fileBytes = std::filesystem::file_size("test_csv_reader_progress.csv");
+
+    PersonCsvReader reader("test_csv_reader_progress.csv");
+    std::size_t calls = 0, last = 0;
+    reader.setProgress([&](std::size_t done, std::size_t total) {
+        EXPECT_EQ(total, fileBytes);
+        EXPECT_GE(done, last);
+        last = done;
+        ++calls;
+        return true;
+    });
+    EXPECT_EQ(reader.read().size(), 20000u);
+    EXPECT_GT(calls, 3u);
+    EXPECT_LE(last, fileBytes);
+
+    reader.setProgress([](std::size_t done, std::size_t total) { return done < total / 2; });
+    EXPECT_THROW(reader.read(), OperationCancelled);
+
+    std::remove("test_csv_reader_progress.csv");
+}
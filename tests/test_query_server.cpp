@@ -0,0 +1,180 @@
+// tests/test_query_server.cpp
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "DatasetGenerator.h"
+#include "PersonCsvReader.h"
+#include "QueryServer.h"
+
+namespace {
+
+ServerOptions testOptions() {
+    ServerOptions options;
+    options.socketPath = "test_query_server.sock";
+    options.usefulFile = "test_query_server_saved.csv";
+    options.blockedFile = "test_query_server_blocked.txt";
+    options.workers = 2;
+    return options;
+}
+
+void removeTestFiles() {
+    std::remove("test_query_server.csv");
+    std::remove("test_query_server_saved.csv");
+    std::remove("test_query_server_saved.csv.idx");
+    std::remove("test_query_server_blocked.txt");
+}
+
+bool contains(const std::string& text, const std::string& part) {
+    return text.find(part) != std::string::npos;
+}
+
+int connectTo(const char* path) {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strcpy(address.sun_path, path);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// sends one request line and reads its one response line
+std::string roundTrip(int fd, const std::string& request) {
+    std::string line = request + "\n";
+    if (::send(fd, line.data(), line.size(), 0) != static_cast<ssize_t>(line.size())) return "";
+    std::string received;
+    char c;
+    while (::recv(fd, &c, 1, 0) == 1 && c != '\n') received += c;
+    return received;
+}
+
+}
+
+TEST(QueryServerTest, AnswersRequestsAgainstTheLoadedDataset) {
+    DatasetConfig config;
+    config.rows = 500;
+    config.rules.push_back(parse_planted_rule("region=china:language=mandarin"));
+    ASSERT_TRUE(DatasetGenerator(config).writeFile("test_query_server.csv", DatasetFormat::Csv));
+
+    QueryServer server(testOptions());
+    EXPECT_EQ(server.handle(R"({"id":7,"cmd":"ping"})"), R"({"id":7,"ok":true})");
+
+    std::string loaded = server.handle(R"({"cmd":"load","path":"test_query_server.csv"})");
+    EXPECT_TRUE(contains(loaded, "\"ok\":true,\"rows\":500,\"version\":1")) << loaded;
+
+    std::string generated = server.handle(R"({"id":"g","cmd":"generate-custom","x":"region","y":"language"})");
+    EXPECT_TRUE(contains(generated, "\"key\":\"region = china -> language = mandarin\"")) << generated;
+
+    std::string counted = server.handle(R"({"cmd":"count","region":"China"})");
+    EXPECT_TRUE(contains(counted, "\"population\":500")) << counted;
+
+    // count goes through the cohort index; check it against a plain scan of the file
+    std::vector<Person> persons = PersonCsvReader("test_query_server.csv").read();
+    std::size_t expected = std::count_if(persons.begin(), persons.end(), [](const Person& p) {
+        bool mandarin = std::any_of(p.getLanguages().begin(), p.getLanguages().end(), [](const std::string& l) {
+            return l == "mandarin" || l == "Mandarin";
+        });
+        return p.getRegion() == Region::China && p.getCourseLoad() == 3 && mandarin;
+    });
+    ASSERT_GT(expected, 0u);
+    counted = server.handle(R"({"cmd":"count","region":"china","course":"3","language":"MANDARIN"})");
+    EXPECT_TRUE(contains(counted, "\"count\":" + std::to_string(expected) + ",")) << counted;
+
+    // blocking goes through the writer path and is seen by the next query
+    server.handle(R"({"cmd":"block","key":"region = china -> language = mandarin"})");
+    generated = server.handle(R"({"cmd":"generate-custom","x":"region","y":"language"})");
+    EXPECT_FALSE(contains(generated, "region = china -> language = mandarin")) << generated;
+
+    removeTestFiles();
+}
+
+TEST(QueryServerTest, ReportsBadRequests) {
+    QueryServer server(testOptions());
+    EXPECT_TRUE(contains(server.handle("not json"), "\"ok\":false"));
+    EXPECT_TRUE(contains(server.handle(R"({"id":3,"cmd":"fly"})"),
+                         R"({"id":3,"ok":false,"error":"unknown command: fly"})"));
+    EXPECT_TRUE(contains(server.handle(R"({"cmd":"count","shoe":"9"})"), "unknown attribute: shoe"));
+    for (const char* limit : {"-5", "abc", "5x"}) {
+        std::string request = std::string(R"({"cmd":"generate","limit":")") + limit + "\"}";
+        EXPECT_TRUE(contains(server.handle(request), "\"limit\\\" must be a non-negative whole number")) << limit;
+    }
+    EXPECT_TRUE(contains(server.handle(R"({"cmd":"load","path":"missing.csv"})"), "\"ok\":false"));
+
+    // the id is echoed only when it's a JSON string or number
+    EXPECT_EQ(server.handle(R"({"id":-1.5e3,"cmd":"ping"})"), R"({"id":-1.5e3,"ok":true})");
+    EXPECT_EQ(server.handle(R"({"id":"a\"b\u0041","cmd":"ping"})"), R"({"id":"a\"bA","ok":true})");
+    EXPECT_EQ(server.handle(R"({"id":1]},"x":{"cmd":"ping"})"),
+              R"({"ok":false,"error":"\"id\" must be a string or a number"})");
+    EXPECT_EQ(server.handle(R"({"id":true,"cmd":"ping"})"),
+              R"({"ok":false,"error":"\"id\" must be a string or a number"})");
+    removeTestFiles();
+}
+
+TEST(QueryServerTest, ServesOverUnixSocket) {
+    QueryServer server(testOptions());
+    ASSERT_TRUE(server.start());
+    std::thread acceptor([&] { server.serve(); });
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strcpy(address.sun_path, "test_query_server.sock");
+    ASSERT_EQ(::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+
+    std::string request = "{\"id\":1,\"cmd\":\"ping\"}\n{\"id\":2,\"cmd\":\"info\"}\n";
+    ASSERT_EQ(::send(fd, request.data(), request.size(), 0), static_cast<ssize_t>(request.size()));
+
+    std::string received;
+    char buf[4096];
+    while (std::count(received.begin(), received.end(), '\n') < 2) {
+        ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+        ASSERT_GT(n, 0);
+        received.append(buf, static_cast<std::size_t>(n));
+    }
+    ::close(fd);
+
+    server.stop();
+    acceptor.join();
+
+    EXPECT_EQ(received.substr(0, received.find('\n')), R"({"id":1,"ok":true})");
+    EXPECT_TRUE(contains(received, "{\"id\":2,\"ok\":true,\"rows\":0")) << received;
+    removeTestFiles();
+}
+
+TEST(QueryServerTest, ServesMorePersistentClientsThanWorkers) {
+    ServerOptions options = testOptions();
+    options.workers = 1;
+    QueryServer server(options);
+    ASSERT_TRUE(server.start());
+    std::thread acceptor([&] { server.serve(); });
+
+    // three clients stay connected the whole time and take turns on the one worker
+    int clients[3];
+    for (int& fd : clients) {
+        fd = connectTo("test_query_server.sock");
+        ASSERT_GE(fd, 0);
+    }
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 3; ++i) {
+            std::string id = std::to_string(round * 3 + i);
+            EXPECT_EQ(roundTrip(clients[i], "{\"id\":" + id + ",\"cmd\":\"ping\"}"),
+                      "{\"id\":" + id + ",\"ok\":true}");
+        }
+    }
+    for (int fd : clients) ::close(fd);
+
+    server.stop();
+    acceptor.join();
+    removeTestFiles();
+}
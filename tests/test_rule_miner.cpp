@@ -0,0 +1,114 @@
+// tests/test_rule_miner.cpp
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <stdexcept>
+
+#include "InsightGenerator.h"
+#include "RuleMiner.h"
+
+namespace {
+
+// os and study spread evenly; linux users who study at night almost all game,
+// nobody else does, and half of everyone hikes
+std::vector<Person> makePersons(std::size_t rows) {
+    const PrimaryOS oses[] = {PrimaryOS::MacOS, PrimaryOS::Windows, PrimaryOS::Linux};
+    const StudyTime studies[] = {StudyTime::Morning, StudyTime::Afternoon, StudyTime::Night};
+
+    std::vector<Person> persons;
+    for (std::size_t i = 0; i < rows; ++i) {
+        PrimaryOS os = oses[i % 3];
+        StudyTime study = studies[(i / 3) % 3];
+        std::unordered_set<std::string> hobbies;
+        if (os == PrimaryOS::Linux && study == StudyTime::Night && i % 10 != 0) {
+            hobbies.insert("Gaming");
+        } else {
+            hobbies.insert("Reading");
+        }
+        if (i % 2 == 0) {
+            hobbies.insert("Hiking");
+        }
+        persons.emplace_back("p" + std::to_string(i), 2025, Region::US_West, os,
+                             EngineeringFocus::Neural_Engineering, study, 4,
+                             std::unordered_set<std::string>{"Blue"}, std::move(hobbies));
+    }
+    return persons;
+}
+
+const Insight* findRule(const std::vector<Insight>& rules, const std::string& key) {
+    auto it = std::find_if(rules.begin(), rules.end(), [&](const Insight& r) { return r.key() == key; });
+    return it == rules.end() ? nullptr : &*it;
+}
+
+}
+
+TEST(RuleMinerTest, FindsMultiAttributeRule) {
+    auto persons = makePersons(9000);
+    RuleOptions options;
+    options.attributes = {Attribute::Os, Attribute::Study, Attribute::Hobby};
+    MinedRules mined = RuleMiner(options).mine(persons, FingerprintSet{});
+
+    const Insight* rule = findRule(mined.rules, "os = linux & study = night -> hobby = gaming");
+    ASSERT_NE(rule, nullptr);
+    EXPECT_EQ(rule->kind, InsightKind::Rule);
+    EXPECT_EQ(rule->population, 1000u);
+    EXPECT_EQ(rule->support, 900u);
+    EXPECT_NEAR(rule->lift, 9.0, 1e-9);   // 90% of the cohort vs 10% of everyone
+    EXPECT_NE(rule->description().find("study time is Night"), std::string::npos);
+
+    // neither half of the antecedent is enough on its own, and nothing predicts hiking
+    EXPECT_EQ(findRule(mined.rules, "os = linux -> hobby = gaming"), nullptr);
+    for (const Insight& r : mined.rules) {
+        EXPECT_GE(r.confidence(), 0.5);
+        EXPECT_GE(r.lift, 1.2);
+        EXPECT_EQ(r.key().find("-> hobby = hiking"), std::string::npos);
+    }
+
+    // single-threaded gives the same rules in the same order
+    options.threads = 1;
+    MinedRules serial = RuleMiner(options).mine(persons, FingerprintSet{});
+    ASSERT_EQ(serial.rules.size(), mined.rules.size());
+    for (std::size_t i = 0; i < serial.rules.size(); ++i) {
+        EXPECT_EQ(serial.rules[i].key(), mined.rules[i].key());
+    }
+    EXPECT_EQ(serial.frequentItemsets, mined.frequentItemsets);
+}
+
+TEST(RuleMinerTest, AppliesLimitsAndBlocklist) {
+    auto persons = makePersons(9000);
+    RuleOptions options;
+    options.attributes = {Attribute::Os, Attribute::Study, Attribute::Hobby};
+    options.maxLength = 2;
+    MinedRules pairs = RuleMiner(options).mine(persons, FingerprintSet{});
+    for (const Insight& r : pairs.rules) {
+        EXPECT_TRUE(r.moreX.empty());
+    }
+    EXPECT_EQ(findRule(pairs.rules, "os = linux & study = night -> hobby = gaming"), nullptr);
+
+    // gaming's 10% share is below a 20% minimum support
+    options.maxLength = 3;
+    options.minSupport = 0.2;
+    MinedRules frequent = RuleMiner(options).mine(persons, FingerprintSet{});
+    EXPECT_EQ(findRule(frequent.rules, "os = linux & study = night -> hobby = gaming"), nullptr);
+
+    // a blocked key doesn't come back, and single-term rules share keys with generate-custom
+    options.minSupport = 0.01;
+    FingerprintSet blocked;
+    blocked.insert(fingerprint_key("os = linux & study = night -> hobby = gaming"));
+    MinedRules unblocked = RuleMiner(options).mine(persons, FingerprintSet{});
+    MinedRules filtered = RuleMiner(options).mine(persons, blocked);
+    EXPECT_EQ(filtered.rules.size() + 1, unblocked.rules.size());
+    EXPECT_EQ(findRule(filtered.rules, "os = linux & study = night -> hobby = gaming"), nullptr);
+
+    const Insight* single = findRule(unblocked.rules, "hobby = gaming -> os = linux");
+    ASSERT_NE(single, nullptr);
+    auto generic = InsightGenerator().generateGeneric(persons, FingerprintSet{}, "hobby", "os");
+    const Insight* same = findRule(generic, single->key());
+    ASSERT_NE(same, nullptr);
+    EXPECT_EQ(same->fingerprint(), single->fingerprint());
+
+    EXPECT_EQ(RuleMiner(options).mine(persons, FingerprintSet{}, 1).rules.size(), 1u);
+
+    options.maxLength = 1;
+    EXPECT_THROW(RuleMiner{options}, std::invalid_argument);
+}
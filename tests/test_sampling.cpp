@@ -0,0 +1,131 @@
+// tests/test_sampling.cpp
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <map>
+#include <set>
+
+#include "DatasetGenerator.h"
+#include "InsightGenerator.h"
+#include "Sampling.h"
+
+namespace {
+
+std::vector<Person> makePersons(std::size_t rows) {
+    DatasetConfig config;
+    config.rows = rows;
+    config.rules.push_back(parse_planted_rule("region=china:language=mandarin"));
+    return DatasetGenerator(config).generate();
+}
+
+}
+
+TEST(SamplingTest, WilsonIntervalMatchesKnownValues) {
+    ConfidenceInterval half = wilson_interval(50, 100);
+    EXPECT_NEAR(half.low, 0.4038, 1e-3);
+    EXPECT_NEAR(half.high, 0.5962, 1e-3);
+
+    // stays inside [0, 1] where the normal approximation wouldn't
+    ConfidenceInterval none = wilson_interval(0, 10);
+    EXPECT_DOUBLE_EQ(none.low, 0.0);
+    EXPECT_GT(none.high, 0.0);
+    ConfidenceInterval all = wilson_interval(10, 10);
+    EXPECT_DOUBLE_EQ(all.high, 1.0);
+    EXPECT_LT(all.low, 1.0);
+
+    EXPECT_EQ(sample_size_for_margin(0.01), 9604u);
+    EXPECT_NEAR(margin_for_sample_size(9604), 0.01, 1e-4);
+    EXPECT_THROW(sample_size_for_margin(0.0), std::invalid_argument);
+}
+
+TEST(SamplingTest, ReservoirSampleIsUniformAndDistinct) {
+    auto rows = reservoir_sample(1000000, 5000, 7);
+    ASSERT_EQ(rows.size(), 5000u);
+    EXPECT_TRUE(std::is_sorted(rows.begin(), rows.end()));
+    EXPECT_EQ(std::set<std::size_t>(rows.begin(), rows.end()).size(), rows.size());
+    EXPECT_LT(rows.back(), 1000000u);
+
+    // each tenth of the range gets about a tenth of the sample
+    std::vector<int> buckets(10, 0);
+    for (std::size_t r : rows) buckets[r / 100000]++;
+    for (int b : buckets) {
+        EXPECT_GT(b, 400);
+        EXPECT_LT(b, 600);
+    }
+
+    EXPECT_EQ(reservoir_sample(10, 50, 7).size(), 10u);   // k > n takes everything
+    EXPECT_EQ(reservoir_sample(1000, 100, 3), reservoir_sample(1000, 100, 3));
+}
+
+TEST(SamplingTest, StratifiedSampleKeepsProportions) {
+    auto persons = makePersons(20000);
+    auto rows = stratified_sample(persons, Attribute::Region, 2000, 11);
+    EXPECT_GE(rows.size(), 2000u);
+    EXPECT_LE(rows.size(), 2100u);   // every region gets at least one row
+
+    std::map<Region, std::size_t> full, sampled;
+    for (const Person& p : persons) full[p.getRegion()]++;
+    for (std::size_t r : rows) sampled[persons[r].getRegion()]++;
+    for (const auto& [region, count] : full) {
+        double expected = 2000.0 * static_cast<double>(count) / 20000.0;
+        EXPECT_NEAR(static_cast<double>(sampled[region]), expected, 1.0 + 0.01 * expected);
+    }
+
+    EXPECT_THROW(stratified_sample(persons, Attribute::Hobby, 100, 1), std::invalid_argument);
+}
+
+TEST(SamplingTest, ApproximateInsightsCarryIntervalsAndVerify) {
+    auto persons = makePersons(20000);
+    InsightGenerator generator;
+    FingerprintSet none;
+    SampleOptions options;
+    options.size = 4000;
+
+    auto approx = generator.generateGenericApprox(persons, none, "region", "language", options);
+    EXPECT_EQ(approx.sampleRows, 4000u);
+    EXPECT_EQ(approx.populationRows, 20000u);
+    ASSERT_FALSE(approx.insights.empty());
+
+    // the planted rule is found and its exact confidence lies inside the interval
+    auto exact = generator.generateGeneric(persons, none, "region", "language");
+    bool foundPlanted = false;
+    for (const ApproximateInsight& a : approx.insights) {
+        EXPECT_LE(a.confidence.low, a.insight.confidence());
+        EXPECT_GE(a.confidence.high, a.insight.confidence());
+        EXPECT_GE(a.confidence.high, 0.5);
+        if (a.borderline) {
+            continue;
+        }
+        for (const Insight& e : exact) {
+            if (e.key() == a.insight.key()) {
+                foundPlanted = true;
+                EXPECT_TRUE(a.confidence.contains(e.confidence()));
+            }
+        }
+    }
+    EXPECT_TRUE(foundPlanted);
+
+    // verification leaves nothing borderline; once it ran, every insight has exact counts
+    // and the full table's score, so the ranking doesn't mix sample and full-data scores
+    bool anyBorderline = std::any_of(approx.insights.begin(), approx.insights.end(),
+                                     [](const ApproximateInsight& a) { return a.borderline; });
+    auto verified = generator.generateGenericApprox(persons, none, "region", "language", options, true);
+    for (const ApproximateInsight& a : verified.insights) {
+        EXPECT_FALSE(a.borderline);
+        EXPECT_EQ(a.verified, anyBorderline);
+        if (a.verified) {
+            EXPECT_DOUBLE_EQ(a.confidence.low, a.insight.confidence());
+            EXPECT_GE(a.insight.confidence(), 0.5);
+            auto match = std::find_if(exact.begin(), exact.end(),
+                                      [&](const Insight& e) { return e.key() == a.insight.key(); });
+            ASSERT_NE(match, exact.end());
+            EXPECT_EQ(a.insight.score, match->score);
+        }
+    }
+
+    auto pairs = generator.scorePairsApprox(persons, none, {"os", "region", "language"}, options);
+    ASSERT_FALSE(pairs.pairs.empty());
+    EXPECT_EQ(pairs.pairs[0].attrX, "region");
+    EXPECT_EQ(pairs.pairs[0].attrY, "language");
+    EXPECT_NEAR(pairs.margin, margin_for_sample_size(4000), 1e-12);
+}
@@ -0,0 +1,90 @@
+// tests/test_scoring.cpp
+
+#include <gtest/gtest.h>
+#include <stdexcept>
+
+#include "InsightCache.h"
+#include "InsightGenerator.h"
+#include "PersonRepository.h"
+#include "Scoring.h"
+
+namespace {
+
+// almost everyone speaks english; a us-west cohort all does, china mostly speaks mandarin
+std::vector<Person> makePersons() {
+    std::vector<Person> persons;
+    auto add = [&](Region region, const char* language, int count) {
+        for (int i = 0; i < count; ++i) {
+            persons.emplace_back("p" + std::to_string(persons.size()), 2025, region, PrimaryOS::Linux,
+                                 EngineeringFocus::Neural_Engineering, StudyTime::Night, 4,
+                                 std::unordered_set<std::string>{}, std::unordered_set<std::string>{},
+                                 std::unordered_set<std::string>{language});
+        }
+    };
+    add(Region::US_West, "English", 50);
+    add(Region::Japan, "English", 40);
+    add(Region::China, "Mandarin", 7);
+    add(Region::China, "English", 3);
+    return persons;
+}
+
+}
+
+TEST(ScoringTest, ScoresContingencyTables) {
+    // 100 people: 40 with X, 50 with Y, 30 with both
+    EXPECT_EQ(score_cell(ScoringMode::Confidence, 30, 40, 50, 100), InsightGenerator::scoreFromCounts(30, 40, 100));
+    EXPECT_EQ(score_cell(ScoringMode::Lift, 30, 40, 50, 100), 33);       // lift 1.5
+    EXPECT_EQ(score_cell(ScoringMode::Leverage, 30, 40, 50, 100), 40);   // 0.30 - 0.40 * 0.50
+    EXPECT_EQ(score_cell(ScoringMode::ChiSquare, 30, 40, 50, 100), 4);   // chi2 16.7, p 4e-5
+    EXPECT_EQ(score_cell(ScoringMode::GTest, 30, 40, 50, 100), 4);       // G 17.3, p 3e-5
+    EXPECT_EQ(score_cell(ScoringMode::Bayesian, 30, 40, 50, 100), 56);   // confidence 40/60
+
+    // negative association, empty margins and huge tables stay in range
+    EXPECT_EQ(score_cell(ScoringMode::ChiSquare, 10, 40, 50, 100), 0);
+    EXPECT_EQ(score_cell(ScoringMode::Lift, 10, 40, 50, 100), 0);
+    EXPECT_EQ(score_cell(ScoringMode::GTest, 40, 40, 100, 100), 0);
+    EXPECT_EQ(score_cell(ScoringMode::ChiSquare, 400000, 500000, 500000, 1000000), 100);
+
+    // the batch gives what one cell at a time does
+    const std::size_t support[] = {30, 7, 50, 1};
+    const std::size_t cohort[] = {40, 10, 50, 3};
+    const std::size_t yTotal[] = {50, 7, 93, 80};
+    int scores[4];
+    for (ScoringMode mode : {ScoringMode::Confidence, ScoringMode::Lift, ScoringMode::Leverage,
+                             ScoringMode::ChiSquare, ScoringMode::GTest, ScoringMode::Bayesian}) {
+        score_cells(mode, support, cohort, yTotal, 4, 100, scores);
+        for (int i = 0; i < 4; ++i) {
+            EXPECT_EQ(scores[i], score_cell(mode, support[i], cohort[i], yTotal[i], 100)) << to_string(mode);
+        }
+        EXPECT_EQ(parse_scoring_mode(to_string(mode)), mode);
+    }
+    EXPECT_THROW(parse_scoring_mode("pagerank"), std::invalid_argument);
+}
+
+TEST(ScoringTest, LiftDemotesGloballyPopularValues) {
+    auto persons = makePersons();
+    FingerprintSet none;
+    InsightGenerator generator;
+
+    auto byConfidence = generator.generateGeneric(persons, none, "region", "language");
+    ASSERT_EQ(byConfidence.size(), 3u);
+    EXPECT_NE(byConfidence[0].key().find("english"), std::string::npos);
+
+    generator.setScoring(ScoringMode::Lift);
+    auto byLift = generator.generateGeneric(persons, none, "region", "language");
+    ASSERT_EQ(byLift.size(), 3u);
+    EXPECT_EQ(byLift[0].key(), "region = china -> language = mandarin");
+    EXPECT_EQ(byLift[0].support, 7u);   // only the score changes, not what was found
+    EXPECT_LT(byLift[1].score, 10);
+
+    // the cache keeps the two rankings apart
+    PersonRepository repo;
+    repo.setPersons(persons);
+    InsightCache cache(generator);
+    auto cachedLift = cache.generateGeneric(repo.getAll(), repo.contentHash(), none, "region", "language");
+    generator.setScoring(ScoringMode::Confidence);
+    auto cachedConfidence = cache.generateGeneric(repo.getAll(), repo.contentHash(), none, "region", "language");
+    EXPECT_EQ(cachedLift[0].key(), byLift[0].key());
+    EXPECT_EQ(cachedConfidence[0].key(), byConfidence[0].key());
+    EXPECT_EQ(cache.stats().misses, 2u);
+}
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include "Tracer.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(TracerTest, WritesSpansFromEveryThread) {
+    if (!instr::enabled()) {
+        GTEST_SKIP() << "instrumentation compiled out";
+    }
+
+    trace::start();
+    {
+        trace::Span span("test.main_span", "os", "study");
+    }
+    std::thread worker([] {
+        trace::Span span("test.worker_span");
+    });
+    worker.join();
+    trace::stop();
+
+    // not recorded once stopped
+    {
+        trace::Span span("test.after_stop");
+    }
+
+    std::string path = "test_trace.json";
+    ASSERT_TRUE(trace::write_chrome_trace(path));
+
+    std::ifstream in(path);
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    std::string json = buffer.str();
+
+    EXPECT_EQ(json.rfind("{\"displayTimeUnit\"", 0), 0u);
+    EXPECT_NE(json.find("\"name\":\"test.main_span\""), std::string::npos);
+    EXPECT_NE(json.find("\"detail\":\"os -> study\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"test.worker_span\""), std::string::npos);
+    EXPECT_EQ(json.find("test.after_stop"), std::string::npos);
+
+    std::remove(path.c_str());
+}
+
+TEST(TracerTest, ReusesBuffersOfExitedThreads) {
+    if (!instr::enabled()) {
+        GTEST_SKIP() << "instrumentation compiled out";
+    }
+
+    trace::start();
+    auto burst = [] {
+        std::vector<std::thread> workers;
+        for (int i = 0; i < 4; ++i) {
+            workers.emplace_back([] { trace::Span span("test.burst"); });
+        }
+        for (auto& w : workers) w.join();
+    };
+    burst();
+    std::size_t buffers = trace::buffer_count();
+    for (int round = 0; round < 20; ++round) {
+        burst();
+    }
+    EXPECT_EQ(trace::buffer_count(), buffers);
+    trace::stop();
+}
+
+TEST(TracerTest, WritesWhileAThreadWrapsItsBuffer) {
+    if (!instr::enabled()) {
+        GTEST_SKIP() << "instrumentation compiled out";
+    }
+
+    std::string path = "test_trace_live.json";
+    trace::start();
+    std::atomic<bool> done{false};
+    std::thread recorder([&] {
+        while (!done.load()) {
+            trace::record("test.live", 1000, 2000, "detail");
+        }
+    });
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_TRUE(trace::write_chrome_trace(path));
+    }
+    done = true;
+    recorder.join();
+    trace::stop();
+
+    std::ifstream in(path);
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    std::string json = buffer.str();
+    EXPECT_EQ(json.substr(json.size() - 4), "\n]}\n");
+
+    // every span that made it out is whole, none torn by the recorder
+    auto occurrences = [&](const std::string& needle) {
+        std::size_t n = 0;
+        for (std::size_t at = json.find(needle); at != std::string::npos; at = json.find(needle, at + 1)) ++n;
+        return n;
+    };
+    std::size_t spans = occurrences("\"name\":\"test.live\"");
+    EXPECT_GT(spans, 0u);
+    EXPECT_EQ(occurrences("\"dur\":1.0,\"args\":{\"detail\":\"detail\"}"), spans);
+
+    std::remove(path.c_str());
+}